@@ -8,25 +8,117 @@
 #define FT_UART_PORT_NUM    (1)
 #define FT_UART_TXD         (27)    /* P4 GPIO27 → target RXD0 */
 #define FT_UART_RXD         (26)    /* P4 GPIO26 ← target TXD0 */
-#define FT_UART_BAUD_RATE   (115200)
+#define FT_UART_BAUD_RATE   (115200)  /* Default rate when auto-baud is off */
+
+/* Serial monitor baud selection — auto-baud tries the candidates in order
+ * (74880 is the ESP8266 / 26 MHz-crystal ROM bootloader rate) */
+#define FT_UART_AUTO_BAUD        (0)        /* Start in auto-baud mode */
+#define FT_UART_BAUD_CANDIDATES  { 115200, 74880, 921600, 2000000, 460800, \
+                                   230400, 1500000, 57600, 9600 }
+#define FT_BAUD_PROBE_BYTES      (256)      /* Clean bytes needed to lock */
+#define FT_BAUD_PROBE_MS         (600)      /* Give up on a candidate after this */
+#define FT_BAUD_RECHECK_BYTES    (1024)     /* Re-score window while locked */
+#define FT_BAUD_REHUNT_WINDOWS   (3)        /* Garbage windows in a row to re-hunt */
 
 /* Bootloader entry GPIOs (expansion header — update after checking schematic) */
 #define FT_TARGET_GPIO0     (21)    /* Pull low to enter bootloader */
 #define FT_TARGET_EN        (22)    /* Pulse low to reset target */
 
+/* USB serial RX buffer (PSRAM) — absorbs RX task stalls without losing
+ * bytes: 1 MB is ~5 s at 2 Mbaud, ~90 s at 115200 */
+#define FT_SERIAL_RX_BUF_SIZE (1024 * 1024)
+
+/* Per-stage pipeline latency histograms (serial/latency_stats.h) */
+#define FT_LATENCY_STATS        1       /* Record from boot (can be toggled at runtime) */
+#define FT_LATENCY_PUSH_TABLE   1024    /* Ring push times kept for UI render timing */
+
+/* Serial monitor log view: monospace font rasterized into a glyph atlas */
+#define FT_LOG_VIEW_FONT        lv_font_unscii_16
+
 /* SD card mount point (set by BSP config, usually /sdcard) */
 #define FT_SD_MOUNT_POINT   "/sdcard"
 
-/* Log ring buffer (allocated in PSRAM) */
-#define FT_LOG_RING_SIZE    (4096)  /* ~4000 log entries */
+/* Log ring buffer (allocated in PSRAM) — lines are packed into a byte arena,
+ * so capacity depends on line length: ~50k lines at 40 bytes per line */
+#define FT_LOG_RING_SIZE    (65536)             /* Max lines (power of two) */
+#define FT_LOG_ARENA_SIZE   (2 * 1024 * 1024)   /* Raw line bytes (power of two) */
+#define FT_LOG_LINE_MAX_LEN (512)               /* Longer lines are truncated */
 #define FT_LOG_MSG_MAX_LEN  (256)
 #define FT_LOG_TAG_MAX_LEN  (24)
+#define FT_LOG_TAG_TABLE_SIZE (256)             /* Distinct tags per session */
+
+/* SD log writer — lines are batched into two large buffers and written in
+ * one go, so the card sees few big writes instead of one per line */
+#define FT_LOG_SD_BUF_SIZE    (32 * 1024)   /* Per buffer (multiple of FT_LOG_SD_ALIGN) */
+#define FT_LOG_SD_ALIGN       (512)         /* SD sector size */
+#define FT_LOG_SD_FLUSH_BYTES (16 * 1024)   /* Default size threshold */
+#define FT_LOG_SD_FLUSH_MS    (1000)        /* Default age threshold */
+#define FT_LOG_SD_SYNC_MS     (5000)        /* Default periodic fsync */
+#define FT_LOG_SD_BINARY      (0)           /* Default format: 0 = text, 1 = binary .ftl */
+
+/* Sidecar index (.idx next to each log): one record per block of lines
+ * with its offset, time range and level/tag bitmaps, for seeking */
+#define FT_LOG_INDEX_BLOCK_LINES (256)
+
+/* Search — a trigram Bloom filter per block of 256 lines (ring and SD
+ * index alike); 8192 bits keep a 256-line block around 25% full */
+#define FT_LOG_SEARCH_BLOOM_BYTES (1024)    /* Power of two */
+#define FT_LOG_SEARCH_MAX_LEN     (64)
+
+/* Cold history tier (PSRAM) — lines about to leave the log ring are
+ * compacted into compressed blocks so the UI can still scroll back to
+ * and search them; ~15 bytes a line including the search filters */
+#define FT_LOG_COLD_SIZE        (8 * 1024 * 1024)
+#define FT_LOG_COLD_MAX_BLOCKS  (4096)          /* 256 lines each at most */
+#define FT_LOG_HISTORY_LINES    (512 * 1024)    /* Display index entries (power of two) */
+
+/* Repeat folding at ingest — a run of lines with the same message (or the
+ * same apart from numbers) is kept as its first line plus summary lines */
+#define FT_LOG_DEDUP_MODE       (0)             /* log_dedup_mode_t at boot (0 = off) */
+#define FT_LOG_DEDUP_IDLE_MS    (1000)          /* Summarize a run this long after its last repeat */
+#define FT_LOG_DEDUP_SUMMARY_MS (5000)          /* ...and at least this often while it lasts */
+
+/* Live log statistics (rates, per-level and per-tag counts, gaps) */
+#define FT_LOG_STATS_SECONDS      (60)          /* Per-second history for rates and sparklines */
+#define FT_LOG_STATS_TAG_WINDOW_S (10)          /* Per-tag rate window */
+
+/* Numeric series extracted at ingest (serial/log_series.h) — extractors
+ * are read from FT_SERIES_FILE at startup */
+#define FT_SERIES_MAX              (16)
+#define FT_SERIES_PATTERN_MAX_LEN  (32)
+#define FT_SERIES_POOL_SIZE        (4 * 1024 * 1024)    /* PSRAM, shared by all series */
+#define FT_SERIES_CHUNK_SIZE       (512)                /* Bytes per compressed chunk */
+
+/* Target clock fit (serial/clock_fit.h) — lower envelope of receive
+ * delay per window, least squares over the session */
+#define FT_CLOCK_FIT_WINDOW_MS      (1000)      /* Target time per envelope point */
+#define FT_CLOCK_FIT_MIN_POINTS     (10)        /* Before drift and jitter are reported */
+#define FT_CLOCK_FIT_RESTART_MS     (1000)      /* Timestamp falling back this far = target reboot */
+#define FT_CLOCK_FIT_MARKER_MS      (10 * 60 * 1000)    /* Re-anchor the log this often */
+
+/* Boot profiler (serial/boot_profile.h) — extra milestones are read
+ * from FT_BOOT_PROFILE_FILE at startup */
+#define FT_TARGET_RESET_HOLD_MS         (100)   /* EN held low per reset pulse */
+#define FT_BOOT_PROFILE_MAX_USER        (8)     /* Milestones beyond the 4 built in */
+#define FT_BOOT_PROFILE_TEXT_MAX_LEN    (48)    /* Including the terminator */
+#define FT_BOOT_PROFILE_MAX_RUNS        (50)
+#define FT_BOOT_PROFILE_TIMEOUT_MS      (15000) /* Per boot, for milestones never printed */
+#define FT_BOOT_PROFILE_SETTLE_MS       (500)   /* Between a boot's last milestone and the next reset */
+
+/* Trigger engine — patterns are read from FT_TRIGGERS_FILE at startup */
+#define FT_TRIGGER_MAX_PATTERNS     (512)
+#define FT_TRIGGER_PATTERN_MAX_LEN  (64)    /* Including the terminator */
+#define FT_TRIGGER_SNAPSHOT_PRE     (200)   /* History lines saved from before the hit */
+#define FT_TRIGGER_SNAPSHOT_POST_MS (2000)  /* ...and lines arriving this long after */
 
 /* Firmware storage paths on SD card */
 #define FT_FIRMWARE_DIR     FT_SD_MOUNT_POINT "/firmware"
 #define FT_LOGS_DIR         FT_SD_MOUNT_POINT "/logs"
 #define FT_CONFIG_DIR       FT_SD_MOUNT_POINT "/config"
 #define FT_ENCRYPTION_KEY   FT_SD_MOUNT_POINT "/keys/flash_encryption_key.bin"
+#define FT_TRIGGERS_FILE    FT_CONFIG_DIR "/triggers.txt"
+#define FT_SERIES_FILE      FT_CONFIG_DIR "/series.txt"
+#define FT_BOOT_PROFILE_FILE FT_CONFIG_DIR "/boot_milestones.txt"
 
 /* WiFi Hotspot */
 #define FT_WIFI_AP_SSID     "RCWM"
@@ -34,6 +126,26 @@
 #define FT_WIFI_AP_MAX_CONN (4)
 #define FT_WIFI_AP_CHANNEL  (1)
 
+/* Live log server (wifi/log_server.h) — runs while the SoftAP is up */
+#define FT_LOG_SERVER_PORT          (80)
+#define FT_LOG_SERVER_MAX_CLIENTS   FT_WIFI_AP_MAX_CONN
+#define FT_LOG_SERVER_FRAME_SIZE    (8 * 1024)  /* Lines batched per WebSocket frame / HTTP chunk */
+#define FT_LOG_SERVER_POLL_MS       (20)        /* Idle client check for new lines */
+#define FT_LOG_SERVER_BACKLOG_LINES (200)       /* Sent to a client when it connects */
+#define FT_LOG_SERVER_MAX_LAG_LINES (8192)      /* Further behind than this skips to the newest */
+
+/* Network serial bridge (wifi/serial_bridge.h) — listens on the AP and STA interfaces */
+#define FT_BRIDGE_RFC2217_PORT  (4000)      /* rfc2217://ip:4000 (esptool, idf.py monitor) */
+#define FT_BRIDGE_RAW_PORT      (4001)      /* Plain bytes at the monitor's rate (nc, socket://) */
+#define FT_BRIDGE_RX_BUF_SIZE   (32 * 1024) /* Target-to-client buffer, PSRAM */
+#define FT_BRIDGE_SEGMENT       (1460)      /* Target bytes gathered per send (one TCP MSS) */
+#define FT_BRIDGE_BATCH_MS      (2)         /* Max wait to fill a segment while data streams */
+
+/* Wall clock — SNTP once the station is up; until then an RTC reading
+ * after this date (2024-01-01) is trusted */
+#define FT_SNTP_SERVER          "pool.ntp.org"
+#define FT_WALL_CLOCK_MIN_EPOCH (1704067200)
+
 /* Firmware download — chemproject GCS bucket */
 #define FT_FW_CHECK_URL     "https://chemical-monitor-api-57459833175.us-central1.run.app/api/checkFirmwareUpdate"
 #define FT_FW_DEVICE_ID     "field-tool"
@@ -10,6 +10,7 @@
 #include "sdcard/sdcard_manager.h"
 #include "serial/serial_monitor.h"
 #include "wifi/wifi_manager.h"
+#include "wifi/serial_bridge.h"
 #include "ui/ui_manager.h"
 #include "ui/ui_home.h"
 
@@ -73,6 +74,12 @@ void app_main(void)
     ret = serial_monitor_init();
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Serial monitor unavailable: %s", esp_err_to_name(ret));
+    } else {
+        /* Network serial port for the target, on whichever interface is up */
+        ret = serial_bridge_start();
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Serial bridge unavailable: %s", esp_err_to_name(ret));
+        }
     }
 
     ESP_LOGI(TAG, "Field Tool ready. Touch the screen to navigate.");
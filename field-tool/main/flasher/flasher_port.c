@@ -12,6 +12,7 @@
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "freertos/stream_buffer.h"
 
 #include <unistd.h>
@@ -142,11 +143,25 @@ void loader_port_reset_target(void)
     if (!s_device) return;
 
     xStreamBufferReset(s_rx_buf);
-    /* EN LOW (reset): RTS=false → ACTIVE */
-    cdc_acm_host_set_control_line_state(s_device, true, false);
-    loader_port_delay_ms(SERIAL_FLASHER_RESET_HOLD_TIME_MS);
-    /* Release: both true → INACTIVE */
-    cdc_acm_host_set_control_line_state(s_device, true, true);
+    flasher_port_pulse_reset(s_device, SERIAL_FLASHER_RESET_HOLD_TIME_MS, NULL);
+}
+
+esp_err_t flasher_port_pulse_reset(cdc_acm_dev_hdl_t device, uint32_t hold_ms,
+                                   int64_t *released_us)
+{
+    /* Same inverted polarity as loader_port_enter_bootloader() */
+    /* EN LOW (reset): RTS=false → ACTIVE, GPIO0 free */
+    esp_err_t err = cdc_acm_host_set_control_line_state(device, true, false);
+    if (err != ESP_OK) {
+        return err;
+    }
+    vTaskDelay(pdMS_TO_TICKS(hold_ms));
+    /* Release: both true → INACTIVE; the target starts once this lands */
+    err = cdc_acm_host_set_control_line_state(device, true, true);
+    if (released_us != NULL) {
+        *released_us = esp_timer_get_time();
+    }
+    return err;
 }
 
 void loader_port_delay_ms(const uint32_t ms)
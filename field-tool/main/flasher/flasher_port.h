@@ -31,6 +31,19 @@ esp_loader_error_t flasher_port_deinit(void);
  */
 void flasher_port_feed_rx(const uint8_t *data, size_t len);
 
+/**
+ * @brief Reset the target into its normal boot (EN pulsed low, GPIO0 left high)
+ *
+ * Uses the same CH340 DTR/RTS wiring as the flasher's reset. Also safe
+ * while the serial monitor owns the device, under its device lock.
+ *
+ * @param device       Open CDC device
+ * @param hold_ms      How long EN is held low
+ * @param released_us  Receives the esp_timer time EN was released (may be NULL)
+ */
+esp_err_t flasher_port_pulse_reset(cdc_acm_dev_hdl_t device, uint32_t hold_ms,
+                                   int64_t *released_us);
+
 /**
  * @brief Get total RX bytes received (for debug)
  */
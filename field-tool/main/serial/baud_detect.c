@@ -0,0 +1,101 @@
+#include "baud_detect.h"
+#include <string.h>
+
+/* Thresholds in permille of the window */
+#define PRINTABLE_GOOD   (970)
+#define PRINTABLE_BAD    (900)
+#define MAX_AVG_LINE     (256)   /* Longer average lines mean no real line breaks */
+
+static inline bool is_printable(uint8_t c)
+{
+    return (c >= 0x20 && c <= 0x7E) || c == '\t' || c == '\r' || c == '\n' || c == 0x1B;
+}
+
+static bool is_known_prefix(const uint8_t *h)
+{
+    /* "I (", "W (" ... — ESP-IDF log lines */
+    if (h[0] != '\0' && strchr("EWIDV", h[0]) && h[1] == ' ' && h[2] == '(') {
+        return true;
+    }
+    /* ROM bootloader banner: "rst:0x..", "ets Jun  8 2016", "ESP-ROM:esp32s3-.." */
+    return memcmp(h, "rst", 3) == 0 || memcmp(h, "ets", 3) == 0 ||
+           memcmp(h, "ESP", 3) == 0;
+}
+
+void baud_detect_reset(baud_detect_t *det)
+{
+    memset(det, 0, sizeof(*det));
+}
+
+void baud_detect_feed(baud_detect_t *det, const uint8_t *data, size_t len)
+{
+    det->total += len;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+        if (is_printable(c)) {
+            det->printable++;
+        }
+
+        if (c == '\n') {
+            det->newlines++;
+            det->head_len = 0;
+            det->in_escape = false;
+            continue;
+        }
+
+        /* Collect the first three visible bytes of each line */
+        if (det->in_escape) {
+            det->in_escape = !((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'));
+        } else if (c == 0x1B) {
+            det->in_escape = true;
+        } else if (c != '\r' && det->head_len < sizeof(det->head)) {
+            det->head[det->head_len++] = c;
+            if (det->head_len == sizeof(det->head) && is_known_prefix(det->head)) {
+                det->prefix_hits++;
+            }
+        }
+    }
+}
+
+uint32_t baud_detect_score(const baud_detect_t *det)
+{
+    if (det->total == 0) {
+        return 0;
+    }
+
+    uint32_t score = (uint32_t)((uint64_t)det->printable * 1000 / det->total);
+
+    /* Text with no line breaks is suspicious; log prefixes are strong evidence */
+    if (det->total > MAX_AVG_LINE && det->total / (det->newlines + 1) > MAX_AVG_LINE) {
+        score = score > 300 ? score - 300 : 0;
+    }
+    if (det->prefix_hits > 0 && score >= PRINTABLE_BAD) {
+        score += 10 * (det->prefix_hits < 3 ? det->prefix_hits : 3);
+    }
+    return score > 1000 ? 1000 : score;
+}
+
+baud_verdict_t baud_detect_verdict(const baud_detect_t *det, uint32_t min_bytes)
+{
+    if (det->total == 0) {
+        return BAUD_VERDICT_UNSURE;
+    }
+
+    uint32_t printable = (uint32_t)((uint64_t)det->printable * 1000 / det->total);
+
+    /* Garbage shows up fast — no need to wait for a full window */
+    if (det->total >= 32 && printable < PRINTABLE_BAD) {
+        return BAUD_VERDICT_BAD;
+    }
+    if (det->total < min_bytes) {
+        /* ...but a log prefix in clean text is enough on its own */
+        return (det->prefix_hits >= 2 && printable >= PRINTABLE_GOOD) ?
+               BAUD_VERDICT_GOOD : BAUD_VERDICT_UNSURE;
+    }
+    if (printable >= PRINTABLE_GOOD &&
+        (det->prefix_hits > 0 ||
+         (det->newlines > 0 && det->total / det->newlines <= MAX_AVG_LINE))) {
+        return BAUD_VERDICT_GOOD;
+    }
+    return BAUD_VERDICT_BAD;
+}
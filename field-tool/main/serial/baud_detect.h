@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Byte-stream scorer for auto-baud.
+ *
+ * At the wrong rate a UART delivers framing garbage: bytes above 0x7F,
+ * stray control codes and no line structure. At the right rate ESP
+ * targets send printable text in lines, usually starting with an
+ * ESP-IDF log prefix ("I (") or a ROM banner ("rst:", "ets ", "ESP-ROM").
+ * The detector counts those features over a window of received bytes.
+ */
+
+typedef enum {
+    BAUD_VERDICT_UNSURE = 0,    /* Not enough evidence yet */
+    BAUD_VERDICT_GOOD,
+    BAUD_VERDICT_BAD,
+} baud_verdict_t;
+
+typedef struct {
+    uint32_t total;
+    uint32_t printable;     /* 0x20-0x7E, tab, CR, LF, ESC */
+    uint32_t newlines;
+    uint32_t prefix_hits;   /* Lines starting like ESP-IDF / ROM output */
+    uint8_t  head[3];       /* First visible bytes of the current line */
+    uint8_t  head_len;
+    bool     in_escape;     /* Inside an ANSI color sequence */
+} baud_detect_t;
+
+/**
+ * @brief Start a new window
+ */
+void baud_detect_reset(baud_detect_t *det);
+
+/**
+ * @brief Account for received bytes
+ */
+void baud_detect_feed(baud_detect_t *det, const uint8_t *data, size_t len);
+
+/**
+ * @brief Score the window (0-1000, higher is more likely the right rate)
+ */
+uint32_t baud_detect_score(const baud_detect_t *det);
+
+/**
+ * @brief Decide whether the window looks like the right rate
+ * @param min_bytes  Bytes needed before a GOOD verdict is given
+ */
+baud_verdict_t baud_detect_verdict(const baud_detect_t *det, uint32_t min_bytes);
@@ -0,0 +1,454 @@
+#include "boot_profile.h"
+#include "serial_monitor.h"
+#include "sdcard/sdcard_manager.h"
+#include "wifi/wall_clock.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "BOOT_PROF";
+
+#define NOT_SEEN        (UINT32_MAX)
+#define POLL_MS         (20)
+#define VERSION_KEY     "App version:"
+
+typedef struct {
+    char    name[BOOT_PROFILE_NAME_MAX];
+    char    text[FT_BOOT_PROFILE_TEXT_MAX_LEN];
+    uint8_t text_len;
+} milestone_t;
+
+static milestone_t s_milestones[BOOT_PROFILE_MAX_MILESTONES] = {
+    { "ROM",        "rst:0x",             6 },
+    { "Bootloader", "boot: ESP-IDF",      13 },
+    { "App start",  "cpu_start: ",        11 },
+    { "app_main",   "Calling app_main()", 18 },
+};
+static uint8_t s_milestone_count = 4;
+
+/* Current boot (the RX task fills it in while s_armed) */
+static volatile bool s_armed = false;
+static int64_t s_arm_us;                                /* Lines received before this are old */
+static uint32_t s_hit_us[BOOT_PROFILE_MAX_MILESTONES];  /* Line start, tool time, low 32 bits */
+static volatile uint8_t s_hits;
+static char s_version[BOOT_PROFILE_VERSION_MAX];
+
+/* Finished boots, us from reset release (NOT_SEEN if missed) */
+static uint32_t s_runs[FT_BOOT_PROFILE_MAX_RUNS][BOOT_PROFILE_MAX_MILESTONES];
+static boot_profile_milestone_t s_summary[BOOT_PROFILE_MAX_MILESTONES];
+static SemaphoreHandle_t s_mutex = NULL;               /* Summary and status */
+
+static volatile boot_profile_state_t s_state = BOOT_PROFILE_IDLE;
+static volatile bool s_stop = false;
+static uint32_t s_runs_done = 0;
+static uint32_t s_runs_total = 0;
+static char s_path[96];
+static esp_err_t s_result = ESP_OK;
+
+/* ── Milestones file ─────────────────────────────────────────────────── */
+
+static char *trim(char *s)
+{
+    while (*s == ' ' || *s == '\t') {
+        s++;
+    }
+    size_t n = strlen(s);
+    while (n > 0 && (s[n - 1] == ' ' || s[n - 1] == '\t')) {
+        s[--n] = '\0';
+    }
+    return s;
+}
+
+/* "name = text" or "text" */
+static bool parse_milestone(char *line, milestone_t *m)
+{
+    char *name = line;
+    char *text = line;
+    char *eq = strstr(line, " = ");
+    if (eq != NULL) {
+        *eq = '\0';
+        name = trim(line);
+        text = trim(eq + 3);
+    }
+    size_t len = strlen(text);
+    if (name[0] == '\0' || len == 0 || strlen(name) >= BOOT_PROFILE_NAME_MAX ||
+        len >= FT_BOOT_PROFILE_TEXT_MAX_LEN) {
+        return false;
+    }
+    strcpy(m->name, name);
+    memcpy(m->text, text, len);
+    m->text_len = (uint8_t)len;
+    return true;
+}
+
+static void load_file(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return;
+    }
+    char line[BOOT_PROFILE_NAME_MAX + FT_BOOT_PROFILE_TEXT_MAX_LEN + 8];
+    while (s_milestone_count < BOOT_PROFILE_MAX_MILESTONES && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *text = trim(line);
+        if (*text == '#' || *text == '\0') {
+            continue;
+        }
+        if (!parse_milestone(text, &s_milestones[s_milestone_count])) {
+            ESP_LOGW(TAG, "Milestone skipped: %s", text);
+            continue;
+        }
+        s_milestone_count++;
+    }
+    fclose(f);
+}
+
+/* First occurrence of text in the line, NULL if none */
+static const char *find(const char *hay, size_t n, const char *text, size_t len)
+{
+    if (len > n) {
+        return NULL;
+    }
+    const char *p = hay;
+    const char *last = hay + n - len;
+    while (p <= last) {
+        p = memchr(p, text[0], last - p + 1);
+        if (p == NULL) {
+            return NULL;
+        }
+        if (memcmp(p + 1, text + 1, len - 1) == 0) {
+            return p;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+/* ── Results ─────────────────────────────────────────────────────────── */
+
+/* Nearest-rank percentile of a sorted list */
+static uint32_t percentile(const uint32_t *sorted, uint32_t n, uint32_t pct)
+{
+    uint32_t rank = (n * pct + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/* Redo each milestone's distribution over the finished runs */
+static void summarize(void)
+{
+    uint32_t values[FT_BOOT_PROFILE_MAX_RUNS];
+    for (uint8_t m = 0; m < s_milestone_count; m++) {
+        uint32_t n = 0;
+        for (uint32_t r = 0; r < s_runs_done; r++) {
+            uint32_t v = s_runs[r][m];
+            if (v == NOT_SEEN) {
+                continue;
+            }
+            uint32_t i = n++;
+            while (i > 0 && values[i - 1] > v) {
+                values[i] = values[i - 1];
+                i--;
+            }
+            values[i] = v;
+        }
+
+        boot_profile_milestone_t s = { .seen = n };
+        memcpy(s.name, s_milestones[m].name, sizeof(s.name));
+        if (n > 0) {
+            s.min_us = values[0];
+            s.median_us = percentile(values, n, 50);
+            s.p95_us = percentile(values, n, 95);
+            s.max_us = values[n - 1];
+        }
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_summary[m] = s;
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+static void write_value(FILE *f, uint32_t v)
+{
+    if (v != NOT_SEEN) {
+        fprintf(f, ",%lu", (unsigned long)v);
+    } else {
+        fputs(",", f);
+    }
+}
+
+/* boot_<time>.csv with every run, plus one row per milestone in boot_history.csv */
+static esp_err_t save_results(void)
+{
+    if (!sdcard_manager_is_mounted()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sdcard_manager_ensure_dir(FT_LOGS_DIR);
+
+    char stamp[24];
+    char when[32];
+    int64_t wall_us = wall_clock_us(esp_timer_get_time());
+    if (wall_us != 0) {
+        wall_clock_format(stamp, sizeof(stamp), wall_us, true);
+        wall_clock_format(when, sizeof(when), wall_us, false);
+        when[19] = '\0';
+    } else {
+        snprintf(stamp, sizeof(stamp), "%lu", (unsigned long)(esp_timer_get_time() / 1000000));
+        snprintf(when, sizeof(when), "uptime %s s", stamp);
+    }
+
+    char path[96];
+    snprintf(path, sizeof(path), "%s/boot_%s.csv", FT_LOGS_DIR, stamp);
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        ESP_LOGW(TAG, "Failed to open %s", path);
+        return ESP_FAIL;
+    }
+    fprintf(f, "# Boot profile %s, target app version \"%s\", %lu runs\n",
+            when, s_version, (unsigned long)s_runs_done);
+    fprintf(f, "# Microseconds from reset release to the start of each milestone line\n");
+    fputs("run", f);
+    for (uint8_t m = 0; m < s_milestone_count; m++) {
+        fprintf(f, ",%s", s_milestones[m].name);
+    }
+    fputs("\n", f);
+    for (uint32_t r = 0; r < s_runs_done; r++) {
+        fprintf(f, "%lu", (unsigned long)(r + 1));
+        for (uint8_t m = 0; m < s_milestone_count; m++) {
+            write_value(f, s_runs[r][m]);
+        }
+        fputs("\n", f);
+    }
+    static const char *const rows[] = { "min", "median", "p95", "max", "seen" };
+    for (int row = 0; row < 5; row++) {
+        fputs(rows[row], f);
+        for (uint8_t m = 0; m < s_milestone_count; m++) {
+            const boot_profile_milestone_t *s = &s_summary[m];
+            uint32_t v = row == 4 ? s->seen :
+                         s->seen == 0 ? NOT_SEEN :
+                         row == 0 ? s->min_us : row == 1 ? s->median_us :
+                         row == 2 ? s->p95_us : s->max_us;
+            write_value(f, v);
+        }
+        fputs("\n", f);
+    }
+    esp_err_t err = fclose(f) == 0 ? ESP_OK : ESP_FAIL;
+    snprintf(s_path, sizeof(s_path), "%s", path);
+
+    /* Long format, so the file stays valid when milestones change */
+    char history[64];
+    snprintf(history, sizeof(history), "%s/boot_history.csv", FT_LOGS_DIR);
+    FILE *h = fopen(history, "a");
+    if (h != NULL) {
+        if (ftell(h) == 0) {
+            fputs("when,version,runs,milestone,seen,min_us,median_us,p95_us,max_us\n", h);
+        }
+        for (uint8_t m = 0; m < s_milestone_count; m++) {
+            const boot_profile_milestone_t *s = &s_summary[m];
+            fprintf(h, "%s,\"%s\",%lu,%s,%lu,%lu,%lu,%lu,%lu\n", when, s_version,
+                    (unsigned long)s_runs_done, s->name, (unsigned long)s->seen,
+                    (unsigned long)s->min_us, (unsigned long)s->median_us,
+                    (unsigned long)s->p95_us, (unsigned long)s->max_us);
+        }
+        fclose(h);
+    }
+    ESP_LOGI(TAG, "Saved %s", path);
+    return err;
+}
+
+/* ── Profiler task ───────────────────────────────────────────────────── */
+
+/* One boot: reset, then wait for every milestone or the timeout */
+static esp_err_t time_boot(uint32_t *out)
+{
+    for (uint8_t m = 0; m < s_milestone_count; m++) {
+        s_hit_us[m] = NOT_SEEN;
+    }
+    s_hits = 0;
+    s_arm_us = esp_timer_get_time();
+    s_armed = true;
+
+    int64_t released_us = 0;
+    esp_err_t err = serial_monitor_reset_target(&released_us);
+    if (err != ESP_OK) {
+        s_armed = false;
+        return err;
+    }
+    while (s_hits < s_milestone_count && !s_stop &&
+           esp_timer_get_time() - released_us < (int64_t)FT_BOOT_PROFILE_TIMEOUT_MS * 1000) {
+        vTaskDelay(pdMS_TO_TICKS(POLL_MS));
+    }
+    s_armed = false;
+    vTaskDelay(pdMS_TO_TICKS(POLL_MS));     /* Let a line being noted finish */
+
+    for (uint8_t m = 0; m < s_milestone_count; m++) {
+        uint32_t hit = s_hit_us[m];
+        /* Line starts can fall just before the release is confirmed */
+        int32_t us = hit != NOT_SEEN ? (int32_t)(hit - (uint32_t)released_us) : 0;
+        out[m] = hit == NOT_SEEN ? NOT_SEEN : us > 0 ? (uint32_t)us : 0;
+    }
+    return ESP_OK;
+}
+
+static void profile_task(void *arg)
+{
+    (void)arg;
+    s_version[0] = '\0';
+    esp_err_t err = ESP_OK;
+    for (uint32_t r = 0; r < s_runs_total && !s_stop; r++) {
+        err = time_boot(s_runs[r]);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Reset failed: %s", esp_err_to_name(err));
+            break;
+        }
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_runs_done = r + 1;
+        xSemaphoreGive(s_mutex);
+        summarize();
+        ESP_LOGI(TAG, "Boot %lu/%lu timed", (unsigned long)(r + 1), (unsigned long)s_runs_total);
+        vTaskDelay(pdMS_TO_TICKS(FT_BOOT_PROFILE_SETTLE_MS));
+    }
+
+    esp_err_t saved = s_runs_done > 0 ? save_results() : ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_result = err != ESP_OK ? err : saved;
+    s_state = err != ESP_OK && s_runs_done == 0 ? BOOT_PROFILE_FAILED : BOOT_PROFILE_DONE;
+    xSemaphoreGive(s_mutex);
+    vTaskDelete(NULL);
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+esp_err_t boot_profile_init(void)
+{
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (sdcard_manager_is_mounted()) {
+        load_file(FT_BOOT_PROFILE_FILE);
+    }
+    ESP_LOGI(TAG, "%u boot milestones", s_milestone_count);
+    return ESP_OK;
+}
+
+void boot_profile_note_line(const log_span_t *span, size_t wire_len)
+{
+    if (!s_armed || span->rx_us < s_arm_us) {
+        return;
+    }
+
+    /* Back from the end of the line to its first byte on the wire */
+    uint32_t baud = serial_monitor_get_baud();
+    int64_t start_us = span->rx_us;
+    if (baud != 0) {
+        start_us -= (int64_t)wire_len * 10 * 1000000 / baud;
+    }
+
+    for (uint8_t m = 0; m < s_milestone_count; m++) {
+        const milestone_t *ms = &s_milestones[m];
+        if (s_hit_us[m] == NOT_SEEN &&
+            find(span->raw, span->raw_len, ms->text, ms->text_len) != NULL) {
+            s_hit_us[m] = (uint32_t)start_us;
+            s_hits++;
+        }
+    }
+
+    if (s_version[0] == '\0') {
+        const char *key = find(span->raw, span->raw_len, VERSION_KEY, sizeof(VERSION_KEY) - 1);
+        if (key != NULL) {
+            const char *v = key + sizeof(VERSION_KEY) - 1;
+            const char *end = span->raw + span->raw_len;
+            while (v < end && *v == ' ') {
+                v++;
+            }
+            size_t n = (size_t)(end - v);
+            if (n >= sizeof(s_version)) {
+                n = sizeof(s_version) - 1;
+            }
+            memcpy(s_version, v, n);
+            s_version[n] = '\0';
+        }
+    }
+}
+
+esp_err_t boot_profile_start(uint32_t runs)
+{
+    if (runs == 0 || runs > FT_BOOT_PROFILE_MAX_RUNS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex == NULL || s_state == BOOT_PROFILE_RUNNING || !serial_monitor_is_connected()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_runs_total = runs;
+    s_runs_done = 0;
+    s_path[0] = '\0';
+    s_result = ESP_OK;
+    memset(s_summary, 0, sizeof(s_summary));
+    s_stop = false;
+    s_state = BOOT_PROFILE_RUNNING;
+    xSemaphoreGive(s_mutex);
+
+    if (xTaskCreate(profile_task, "boot_prof", 4096, NULL, 3, NULL) != pdPASS) {
+        s_state = BOOT_PROFILE_IDLE;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Profiling %lu boots", (unsigned long)runs);
+    return ESP_OK;
+}
+
+void boot_profile_stop(void)
+{
+    s_stop = true;
+}
+
+void boot_profile_get_status(boot_profile_status_t *status)
+{
+    memset(status, 0, sizeof(*status));
+    if (s_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    status->state = s_state;
+    status->runs_done = s_runs_done;
+    status->runs_total = s_runs_total;
+    status->result = s_result;
+    snprintf(status->path, sizeof(status->path), "%s", s_path);
+    xSemaphoreGive(s_mutex);
+
+    status->waiting_for = s_milestone_count;
+    if (status->state == BOOT_PROFILE_RUNNING && s_armed) {
+        for (uint8_t m = 0; m < s_milestone_count; m++) {
+            if (s_hit_us[m] == NOT_SEEN) {
+                status->waiting_for = m;
+                break;
+            }
+        }
+    }
+    memcpy(status->version, s_version, sizeof(status->version));
+    status->version[sizeof(status->version) - 1] = '\0';
+}
+
+uint8_t boot_profile_milestone_count(void)
+{
+    return s_milestone_count;
+}
+
+bool boot_profile_get_milestone(uint8_t index, boot_profile_milestone_t *milestone)
+{
+    if (index >= s_milestone_count || s_mutex == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *milestone = s_summary[index];
+    xSemaphoreGive(s_mutex);
+    if (milestone->name[0] == '\0') {
+        memcpy(milestone->name, s_milestones[index].name, sizeof(milestone->name));
+    }
+    return true;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "log_parser.h"
+#include "app_config.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Target boot-time profiler.
+ *
+ * Resets the target N times through DTR/RTS and times, for each boot, the
+ * first line holding each milestone's text. Four milestones are built in:
+ *
+ *     ROM          "rst:0x"                 ROM reset-reason line
+ *     Bootloader   "boot: ESP-IDF"          2nd stage bootloader banner
+ *     App start    "cpu_start: "            first app startup line
+ *     app_main     "Calling app_main()"
+ *
+ * and more are read from FT_BOOT_PROFILE_FILE, one per line ('#'
+ * comments), as "name = text" or just "text":
+ *
+ *     sensor ready = Sensor ready
+ *     Modbus up
+ *
+ * Times are in microseconds from the reset release to the start of the
+ * milestone line: its USB receive time less the time its bytes took on
+ * the wire at the current baud rate. Each milestone gets min, median, p95
+ * and max over the boots that reached it.
+ *
+ * Results go to FT_LOGS_DIR as boot_<time>.csv (one row per boot plus the
+ * summary), and one row per milestone is appended to boot_history.csv
+ * with the target's "App version:", so firmware versions can be compared.
+ */
+
+#define BOOT_PROFILE_NAME_MAX       (24)
+#define BOOT_PROFILE_MAX_MILESTONES (4 + FT_BOOT_PROFILE_MAX_USER)
+#define BOOT_PROFILE_VERSION_MAX    (32)
+
+typedef enum {
+    BOOT_PROFILE_IDLE = 0,
+    BOOT_PROFILE_RUNNING,
+    BOOT_PROFILE_DONE,          /* All runs finished (or stopped), results saved if possible */
+    BOOT_PROFILE_FAILED,        /* Couldn't reset the target */
+} boot_profile_state_t;
+
+typedef struct {
+    boot_profile_state_t state;
+    uint32_t runs_done;
+    uint32_t runs_total;
+    uint8_t  waiting_for;       /* Milestone the current boot hasn't reached, while running */
+    char     version[BOOT_PROFILE_VERSION_MAX];     /* Target app version, "" if not seen */
+    char     path[96];          /* CSV written, "" if none */
+    esp_err_t result;
+} boot_profile_status_t;
+
+/**
+ * One milestone's distribution over the runs so far
+ */
+typedef struct {
+    char     name[BOOT_PROFILE_NAME_MAX];
+    uint32_t seen;              /* Boots that reached it */
+    uint32_t min_us;
+    uint32_t median_us;
+    uint32_t p95_us;
+    uint32_t max_us;
+} boot_profile_milestone_t;
+
+/**
+ * @brief Load the milestones (built-in plus FT_BOOT_PROFILE_FILE)
+ */
+esp_err_t boot_profile_init(void);
+
+/**
+ * @brief Check a received line against the milestones (RX task; cheap when idle)
+ * @param wire_len  Bytes the line took on the wire, terminator and escapes included
+ */
+void boot_profile_note_line(const log_span_t *span, size_t wire_len);
+
+/**
+ * @brief Start profiling in the background
+ * @param runs  Boots to time (1..FT_BOOT_PROFILE_MAX_RUNS)
+ * @return ESP_ERR_INVALID_STATE if already running or no target is connected
+ */
+esp_err_t boot_profile_start(uint32_t runs);
+
+/**
+ * @brief Stop after the boot in progress (results so far are kept and saved)
+ */
+void boot_profile_stop(void);
+
+void boot_profile_get_status(boot_profile_status_t *status);
+
+uint8_t boot_profile_milestone_count(void);
+
+bool boot_profile_get_milestone(uint8_t index, boot_profile_milestone_t *milestone);
@@ -0,0 +1,246 @@
+#include "clock_fit.h"
+#include "wifi/wall_clock.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "CLOCK_FIT";
+
+/*
+ * Points are (x = target ms since the session's first line, d = arrival
+ * minus where it would be if both clocks agreed and there were no delay),
+ * so d stays small and the slope of d against x is the drift.
+ */
+
+static clock_fit_emit_cb_t s_emit = NULL;
+
+/* RX task only */
+static bool     s_active = false;       /* A session has started */
+static uint32_t s_session = 0;
+static uint32_t s_t0_ms;                /* Session origin: first line's timestamp... */
+static int64_t  s_r0_us;                /* ...and arrival */
+static uint32_t s_last_ts;
+static uint32_t s_lines;
+
+static uint32_t s_win;                  /* Window the candidate point is from */
+static bool     s_win_has;
+static uint32_t s_win_x;
+static int64_t  s_win_d;                /* Least d in the window so far */
+
+static double   s_n, s_sx, s_sy, s_sxx, s_sxy;     /* x in s, d in us */
+static uint32_t s_last_x;
+static bool     s_valid = false;
+static int64_t  s_a_us;                 /* Fitted d at x = 0 */
+static int64_t  s_b_ppb;                /* Slope of d, ns per s */
+static int64_t  s_jit_sq;               /* Mean of residual^2 over ~1000 lines (us^2) */
+static uint32_t s_jit_max;
+static int64_t  s_next_marker_us;
+
+/* Published copy for readers, under a sequence count (odd while writing) */
+static clock_fit_t s_pub;
+static _Atomic uint32_t s_pub_seq;
+
+static uint32_t isqrt64(uint64_t v)
+{
+    uint64_t r = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+static void publish(void)
+{
+    uint32_t seq = atomic_load_explicit(&s_pub_seq, memory_order_relaxed);
+    atomic_store_explicit(&s_pub_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    s_pub.session = s_session;
+    s_pub.valid = s_valid;
+    s_pub.points = (uint32_t)s_n;
+    s_pub.span_ms = s_last_x;
+    s_pub.lines = s_lines;
+    s_pub.drift_ppm = -(float)s_b_ppb / 1000.0f;
+    s_pub.boot_us = s_r0_us - (int64_t)s_t0_ms * 1000 + s_a_us -
+                    s_b_ppb * (int64_t)s_t0_ms / 1000000;
+    s_pub.jitter_us = isqrt64((uint64_t)s_jit_sq);
+    s_pub.jitter_max_us = s_jit_max;
+
+    atomic_store_explicit(&s_pub_seq, seq + 2, memory_order_release);
+}
+
+static void reset_session(void)
+{
+    s_win_has = false;
+    s_n = s_sx = s_sy = s_sxx = s_sxy = 0;
+    s_last_x = 0;
+    s_lines = 0;
+    s_valid = false;
+    s_a_us = 0;
+    s_b_ppb = 0;
+    s_jit_sq = 0;
+    s_jit_max = 0;
+    s_next_marker_us = 0;
+}
+
+/* Fold a window's lower-envelope point into the fit */
+static void add_point(uint32_t x_ms, int64_t d_us)
+{
+    double x = x_ms / 1000.0;
+    double y = (double)d_us;
+    s_n += 1;
+    s_sx += x;
+    s_sy += y;
+    s_sxx += x * x;
+    s_sxy += x * y;
+    s_last_x = x_ms;
+
+    double den = s_n * s_sxx - s_sx * s_sx;
+    if (s_n < FT_CLOCK_FIT_MIN_POINTS || den <= 0) {
+        return;
+    }
+    double b = (s_n * s_sxy - s_sx * s_sy) / den;
+    s_a_us = (int64_t)((s_sy - b * s_sx) / s_n);
+    s_b_ppb = (int64_t)(b * 1000.0);
+    s_valid = true;
+}
+
+/* Tell the log where this session's target time 0 falls */
+static void emit_marker(int64_t now_us)
+{
+    clock_fit_t fit;
+    clock_fit_get(&fit);
+
+    char when[48];
+    wall_clock_source_t source = wall_clock_source();
+    if (source != WALL_CLOCK_NONE) {
+        size_t n = wall_clock_format(when, sizeof(when), wall_clock_us(fit.boot_us), false);
+        snprintf(when + n, sizeof(when) - n, " UTC (%s)", wall_clock_source_name(source));
+    } else {
+        snprintf(when, sizeof(when), "tool uptime %lld.%06lld s",
+                 (long long)(fit.boot_us / 1000000), (long long)(fit.boot_us % 1000000));
+    }
+
+    char text[160];
+    int drift_x10 = (int)(fit.drift_ppm * 10.0f + (fit.drift_ppm < 0 ? -0.5f : 0.5f));
+    int n = snprintf(text, sizeof(text),
+                     CLOCK_FIT_MARKER_PREFIX "0 ms = %s, drift %c%d.%d ppm, jitter %lu us ---",
+                     when, drift_x10 < 0 ? '-' : '+', (drift_x10 < 0 ? -drift_x10 : drift_x10) / 10,
+                     (drift_x10 < 0 ? -drift_x10 : drift_x10) % 10, (unsigned long)fit.jitter_us);
+    if (n >= (int)sizeof(text)) {
+        n = sizeof(text) - 1;
+    }
+    log_span_t span = {
+        .raw = text,
+        .raw_len = (uint16_t)n,
+        .level = ' ',
+        .rx_us = now_us,
+    };
+    if (s_emit != NULL) {
+        s_emit(&span);
+    }
+    s_next_marker_us = now_us + (int64_t)FT_CLOCK_FIT_MARKER_MS * 1000;
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+void clock_fit_init(clock_fit_emit_cb_t emit)
+{
+    s_emit = emit;
+    reset_session();
+    publish();
+}
+
+void clock_fit_note_line(const log_span_t *span)
+{
+    if (span->level == ' ' || span->msg_off == 0 || span->rx_us == 0) {
+        return;     /* No "(12345)" to compare */
+    }
+    uint32_t ts = span->timestamp_ms;
+
+    /* Backwards: the target restarted its clock */
+    if (!s_active || ts + FT_CLOCK_FIT_RESTART_MS < s_last_ts) {
+        if (s_active) {
+            ESP_LOGI(TAG, "Target clock restarted (%lu -> %lu ms)",
+                     (unsigned long)s_last_ts, (unsigned long)ts);
+        }
+        reset_session();
+        s_active = true;
+        s_session++;
+        s_t0_ms = ts;
+        s_r0_us = span->rx_us;
+    }
+    if (ts < s_t0_ms) {
+        ts = s_t0_ms;   /* A little out of order across tasks on the target */
+    }
+    s_last_ts = ts;
+    s_lines++;
+
+    uint32_t x = ts - s_t0_ms;
+    int64_t d = span->rx_us - s_r0_us - (int64_t)x * 1000;
+
+    uint32_t win = x / FT_CLOCK_FIT_WINDOW_MS;
+    if (s_win_has && win < s_win) {
+        win = s_win;
+    }
+    bool closed = false;
+    if (!s_win_has || win != s_win) {
+        if (s_win_has) {
+            add_point(s_win_x, s_win_d);
+            closed = true;
+        }
+        s_win = win;
+        s_win_has = true;
+        s_win_x = x;
+        s_win_d = d;
+    } else if (d < s_win_d) {
+        s_win_x = x;
+        s_win_d = d;
+    }
+
+    /* Delay above the fitted floor */
+    if (s_valid) {
+        int64_t res = d - (s_a_us + s_b_ppb * (int64_t)x / 1000000);
+        int64_t sq = res * res;
+        s_jit_sq += (sq - s_jit_sq) / 1024;
+        if (res > (int64_t)s_jit_max) {
+            s_jit_max = (uint32_t)res;
+        }
+    }
+
+    if (closed || (s_lines & 63) == 0) {
+        publish();
+    }
+    if (closed && s_valid && span->rx_us >= s_next_marker_us) {
+        emit_marker(span->rx_us);
+    }
+}
+
+void clock_fit_restart(void)
+{
+    s_active = false;
+    reset_session();
+    publish();
+}
+
+void clock_fit_get(clock_fit_t *fit)
+{
+    uint32_t seq;
+    do {
+        seq = atomic_load_explicit(&s_pub_seq, memory_order_acquire);
+        *fit = s_pub;
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) != 0 || seq != atomic_load_explicit(&s_pub_seq, memory_order_relaxed));
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "log_parser.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Target clock against receive time.
+ *
+ * Every timestamped line pairs the target's "(12345)" millisecond
+ * timestamp with the esp_timer time its last byte arrived over USB. The
+ * arrival is the print time plus a delay that is never negative, so for
+ * each FT_CLOCK_FIT_WINDOW_MS of target time only the least-delayed line
+ * is kept, and a least-squares line through those lower-envelope points
+ * gives the target clock's drift and the tool time its clock started
+ * from. Each line's delay above that line is the receive jitter (it
+ * includes up to 1 ms from the target's whole-millisecond stamps).
+ *
+ * A timestamp that goes backwards starts a new session (the target
+ * rebooted). Once a session's fit has settled, and every
+ * FT_CLOCK_FIT_MARKER_MS after, a marker line anchoring target time 0 to
+ * wall-clock time (or tool uptime if the clock isn't set) goes into the
+ * log, so timelines from different boots and different files line up:
+ *
+ *   --- target clock: 0 ms = 2026-10-16 12:34:56.123456 UTC (SNTP), drift +12.3 ppm, jitter 410 us ---
+ *
+ * Lines are noted in the RX task; clock_fit_get() may be called from any
+ * task.
+ */
+
+#define CLOCK_FIT_MARKER_PREFIX     "--- target clock: "
+
+typedef struct {
+    uint32_t session;           /* Target boots seen (0 before any timestamped line) */
+    bool     valid;             /* Enough points for the fields below */
+    uint32_t points;            /* Lower-envelope points in the fit */
+    uint32_t span_ms;           /* Target time they cover */
+    uint32_t lines;             /* Timestamped lines this session */
+    float    drift_ppm;         /* Target clock rate against the tool's (+ = target fast) */
+    int64_t  boot_us;           /* esp_timer time the target clock read 0 (plus the least USB delay) */
+    uint32_t jitter_us;         /* RMS of the delay above the fit, last ~1000 lines */
+    uint32_t jitter_max_us;     /* Largest delay above the fit this session */
+} clock_fit_t;
+
+/**
+ * @brief Receives marker lines (RX task); the span is only valid inside
+ */
+typedef void (*clock_fit_emit_cb_t)(log_span_t *marker);
+
+void clock_fit_init(clock_fit_emit_cb_t emit);
+
+/**
+ * @brief Add a received line (RX task; lines without a timestamp are ignored)
+ */
+void clock_fit_note_line(const log_span_t *span);
+
+/**
+ * @brief Forget the session (a different target may be attached)
+ */
+void clock_fit_restart(void);
+
+void clock_fit_get(clock_fit_t *fit);
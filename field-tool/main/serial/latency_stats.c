@@ -0,0 +1,232 @@
+#include "latency_stats.h"
+#include "sdcard/sdcard_manager.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "LATENCY";
+
+/*
+ * Bucket layout: values 0-7 get a bucket each; above that every power of
+ * two [2^e, 2^(e+1)) is split into four equal sub-buckets. 124 buckets
+ * cover the full uint32_t range.
+ */
+#define LINEAR_BUCKETS  (8)
+#define SUB_BITS        (2)
+#define BUCKET_COUNT    (LINEAR_BUCKETS + (32 - 3) * (1 << SUB_BITS))
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t bytes;
+    uint64_t sum_us;
+    uint32_t buckets[BUCKET_COUNT];
+} stage_hist_t;
+
+static stage_hist_t s_stages[LAT_STAGE_COUNT];
+static volatile bool s_enabled = FT_LATENCY_STATS;
+
+/* Push time (low 32 bits of esp_timer) per ring sequence number */
+static volatile uint32_t s_push_us[FT_LATENCY_PUSH_TABLE];
+static volatile uint32_t s_push_seq[FT_LATENCY_PUSH_TABLE];
+
+static const char *const s_stage_names[LAT_STAGE_COUNT] = {
+    [LAT_STAGE_USB_RX]    = "usb_rx",
+    [LAT_STAGE_FRAME]     = "frame",
+    [LAT_STAGE_PARSE]     = "parse",
+    [LAT_STAGE_RING_PUSH] = "ring_push",
+    [LAT_STAGE_UI_RENDER] = "ui_render",
+    [LAT_STAGE_UI_DRAW]   = "ui_draw",
+    [LAT_STAGE_UI_REFRESH] = "ui_refresh",
+    [LAT_STAGE_SD_WRITE]  = "sd_write",
+    [LAT_STAGE_SD_COMMIT] = "sd_commit",
+};
+
+/* ── Buckets ─────────────────────────────────────────────────────────── */
+
+static inline uint32_t bucket_index(uint32_t us)
+{
+    if (us < LINEAR_BUCKETS) {
+        return us;
+    }
+    uint32_t e = 31 - __builtin_clz(us);    /* >= 3 */
+    uint32_t sub = (us >> (e - SUB_BITS)) & ((1 << SUB_BITS) - 1);
+    return LINEAR_BUCKETS + (e - 3) * (1 << SUB_BITS) + sub;
+}
+
+/* Largest value that lands in a bucket */
+static uint32_t bucket_upper(uint32_t index)
+{
+    if (index < LINEAR_BUCKETS) {
+        return index;
+    }
+    uint32_t e = (index - LINEAR_BUCKETS) / (1 << SUB_BITS) + 3;
+    uint32_t sub = (index - LINEAR_BUCKETS) % (1 << SUB_BITS);
+    uint32_t width = 1u << (e - SUB_BITS);
+    return (((1u << SUB_BITS) + sub) << (e - SUB_BITS)) + (width - 1);
+}
+
+/* ── Recording ───────────────────────────────────────────────────────── */
+
+void latency_stats_set_enabled(bool enabled)
+{
+    s_enabled = enabled;
+}
+
+bool latency_stats_is_enabled(void)
+{
+    return s_enabled;
+}
+
+void latency_record(lat_stage_t stage, uint32_t us, uint32_t bytes)
+{
+    if (!s_enabled || stage >= LAT_STAGE_COUNT) {
+        return;
+    }
+    stage_hist_t *h = &s_stages[stage];
+    h->buckets[bucket_index(us)]++;
+    h->count++;
+    h->bytes += bytes;
+    h->sum_us += us;
+    if (us > h->max_us) {
+        h->max_us = us;
+    }
+}
+
+void latency_note_push(uint32_t seq, int64_t now_us)
+{
+    uint32_t i = seq % FT_LATENCY_PUSH_TABLE;
+    s_push_us[i] = (uint32_t)now_us;
+    s_push_seq[i] = seq;
+}
+
+uint32_t latency_push_age_us(uint32_t seq, int64_t now_us)
+{
+    uint32_t i = seq % FT_LATENCY_PUSH_TABLE;
+    uint32_t pushed = s_push_us[i];
+    if (s_push_seq[i] != seq) {
+        return 0;
+    }
+    return (uint32_t)now_us - pushed;
+}
+
+/* ── Reading ─────────────────────────────────────────────────────────── */
+
+void latency_get(lat_stage_t stage, lat_stage_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (stage >= LAT_STAGE_COUNT) {
+        return;
+    }
+
+    /* Copy first so the percentiles are computed over one consistent view */
+    stage_hist_t snap = s_stages[stage];
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        total += snap.buckets[i];
+    }
+
+    stats->count = snap.count;
+    stats->bytes = snap.bytes;
+    stats->sum_us = snap.sum_us;
+    stats->max_us = snap.max_us;
+    if (total == 0) {
+        return;
+    }
+
+    /* Rank targets rounded up: p99 of 10 samples is the 10th */
+    uint32_t want50 = (total * 50 + 99) / 100;
+    uint32_t want90 = (total * 90 + 99) / 100;
+    uint32_t want99 = (uint32_t)(((uint64_t)total * 99 + 99) / 100);
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        if (snap.buckets[i] == 0) {
+            continue;
+        }
+        uint32_t before = seen;
+        seen += snap.buckets[i];
+        uint32_t upper = bucket_upper(i);
+        if (upper > snap.max_us) {
+            upper = snap.max_us;
+        }
+        if (before < want50 && seen >= want50) {
+            stats->p50_us = upper;
+        }
+        if (before < want90 && seen >= want90) {
+            stats->p90_us = upper;
+        }
+        if (seen >= want99) {
+            stats->p99_us = upper;
+            break;
+        }
+    }
+}
+
+const char *latency_stage_name(lat_stage_t stage)
+{
+    return stage < LAT_STAGE_COUNT ? s_stage_names[stage] : "?";
+}
+
+void latency_reset(void)
+{
+    /* A sample racing the clear may survive it — fine for diagnostics */
+    memset(s_stages, 0, sizeof(s_stages));
+}
+
+/* ── CSV export ──────────────────────────────────────────────────────── */
+
+esp_err_t latency_save_csv(char *path, size_t path_len)
+{
+    if (!sdcard_manager_is_mounted()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sdcard_manager_ensure_dir(FT_LOGS_DIR);
+
+    char filename[96];
+    snprintf(filename, sizeof(filename), "%s/latency_%lu.csv", FT_LOGS_DIR,
+             (unsigned long)(esp_timer_get_time() / 1000000));
+    FILE *f = fopen(filename, "w");
+    if (f == NULL) {
+        ESP_LOGW(TAG, "Failed to open %s", filename);
+        return ESP_FAIL;
+    }
+
+    /* Summary rows, then one row per non-empty bucket */
+    fprintf(f, "stage,count,bytes,mean_us,p50_us,p90_us,p99_us,max_us\n");
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        lat_stage_stats_t st;
+        latency_get(s, &st);
+        fprintf(f, "%s,%lu,%llu,%llu,%lu,%lu,%lu,%lu\n", s_stage_names[s],
+                (unsigned long)st.count, (unsigned long long)st.bytes,
+                (unsigned long long)(st.count ? st.sum_us / st.count : 0),
+                (unsigned long)st.p50_us, (unsigned long)st.p90_us,
+                (unsigned long)st.p99_us, (unsigned long)st.max_us);
+    }
+
+    fprintf(f, "\nstage,bucket_le_us,count\n");
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+            uint32_t n = s_stages[s].buckets[i];
+            if (n > 0) {
+                fprintf(f, "%s,%lu,%lu\n", s_stage_names[s],
+                        (unsigned long)bucket_upper(i), (unsigned long)n);
+            }
+        }
+    }
+
+    bool ok = (ferror(f) == 0);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        ESP_LOGW(TAG, "Write failed: %s", filename);
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Latency histograms saved to %s", filename);
+    if (path != NULL && path_len > 0) {
+        snprintf(path, path_len, "%s", filename);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Per-stage latency histograms for the serial ingest pipeline.
+ *
+ * Each stage keeps a fixed log-scale histogram of microsecond samples
+ * (four sub-buckets per power of two, so percentiles are within 25%)
+ * plus event, byte and time totals. Recording is a count-leading-zeros
+ * and three increments with no locks: every stage has a single writer
+ * task, and readers tolerate a sample in flight.
+ */
+
+typedef enum {
+    LAT_STAGE_USB_RX = 0,   /* USB callback -> RX task dequeue (per chunk) */
+    LAT_STAGE_FRAME,        /* Dequeue -> line framed (per line) */
+    LAT_STAGE_PARSE,        /* Parse + tag intern (per line) */
+    LAT_STAGE_RING_PUSH,    /* Triggers, routing, ring push, SD buffering (per line) */
+    LAT_STAGE_UI_RENDER,    /* Ring push -> line built on screen (per line) */
+    LAT_STAGE_UI_DRAW,      /* Log view rows drawn in one UI update (per update) */
+    LAT_STAGE_UI_REFRESH,   /* LVGL display refresh (per frame) */
+    LAT_STAGE_SD_WRITE,     /* write() of one buffer (per flush) */
+    LAT_STAGE_SD_COMMIT,    /* Oldest buffered line -> on card (per flush) */
+    LAT_STAGE_COUNT,
+} lat_stage_t;
+
+/**
+ * Summary of one stage
+ */
+typedef struct {
+    uint32_t count;         /* Samples */
+    uint64_t bytes;         /* Payload bytes through the stage */
+    uint64_t sum_us;
+    uint32_t max_us;
+    uint32_t p50_us;        /* Bucket upper bounds, capped at max_us */
+    uint32_t p90_us;
+    uint32_t p99_us;
+} lat_stage_stats_t;
+
+/**
+ * @brief Turn recording on or off (on at boot when FT_LATENCY_STATS is set)
+ */
+void latency_stats_set_enabled(bool enabled);
+
+bool latency_stats_is_enabled(void);
+
+/**
+ * @brief Add a sample to a stage
+ * @param us     Latency in microseconds
+ * @param bytes  Payload bytes the sample covers (0 if not applicable)
+ */
+void latency_record(lat_stage_t stage, uint32_t us, uint32_t bytes);
+
+/**
+ * @brief Remember when a ring line was pushed (RX task)
+ *
+ * A small table indexed by sequence number lets a reader time how long a
+ * line waited in the ring; entries are overwritten FT_LATENCY_PUSH_TABLE
+ * lines later.
+ */
+void latency_note_push(uint32_t seq, int64_t now_us);
+
+/**
+ * @brief Microseconds since a ring line was pushed
+ * @return 0 if the entry has already been reused
+ */
+uint32_t latency_push_age_us(uint32_t seq, int64_t now_us);
+
+/**
+ * @brief Get a stage summary
+ */
+void latency_get(lat_stage_t stage, lat_stage_stats_t *stats);
+
+/**
+ * @brief Short display name of a stage
+ */
+const char *latency_stage_name(lat_stage_t stage);
+
+/**
+ * @brief Clear all histograms and counters
+ */
+void latency_reset(void);
+
+/**
+ * @brief Write every stage's summary and histogram to FT_LOGS_DIR as CSV
+ * @param path      Receives the file name (may be NULL)
+ * @param path_len  Size of path
+ * @return ESP_ERR_INVALID_STATE if the SD card isn't mounted,
+ *         ESP_FAIL if the file can't be written
+ */
+esp_err_t latency_save_csv(char *path, size_t path_len);
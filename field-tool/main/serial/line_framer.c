@@ -0,0 +1,127 @@
+#include "line_framer.h"
+#include <string.h>
+
+/*
+ * Word-at-a-time search for CR/LF: XOR a word with the byte repeated and
+ * any zero byte in the result marks a match. The classic "has zero byte"
+ * test finds one in a few ALU ops per word.
+ */
+typedef uintptr_t word_t;
+
+#define WORD_ONES   ((word_t)-1 / 0xFF)     /* 0x0101...01 */
+#define WORD_HIGHS  (WORD_ONES * 0x80)      /* 0x8080...80 */
+#define HAS_ZERO_BYTE(x)  (((x) - WORD_ONES) & ~(x) & WORD_HIGHS)
+
+static inline bool is_eol(char c)
+{
+    return c == '\n' || c == '\r';
+}
+
+static char *find_eol(char *p, const char *end)
+{
+    /* Byte steps up to word alignment */
+    while (p < end && ((uintptr_t)p & (sizeof(word_t) - 1)) != 0) {
+        if (is_eol(*p)) {
+            return p;
+        }
+        p++;
+    }
+
+    /* Whole words — stop at the first word holding a CR or LF */
+    while (end - p >= (ptrdiff_t)sizeof(word_t)) {
+        word_t w;
+        memcpy(&w, p, sizeof(w));
+        if (HAS_ZERO_BYTE(w ^ (WORD_ONES * '\n')) | HAS_ZERO_BYTE(w ^ (WORD_ONES * '\r'))) {
+            break;
+        }
+        p += sizeof(word_t);
+    }
+
+    /* Pinpoint the byte within the word, or finish the tail */
+    while (p < end) {
+        if (is_eol(*p)) {
+            return p;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static void emit(line_framer_t *framer, char *line, size_t len, bool cut)
+{
+    if (len > FT_LOG_LINE_MAX_LEN) {
+        framer->truncated_bytes += len - FT_LOG_LINE_MAX_LEN;
+        len = FT_LOG_LINE_MAX_LEN;
+        cut = true;
+    }
+    if (cut) {
+        framer->truncated++;
+    }
+    framer->cb(line, len, framer->ctx);
+}
+
+static void carry_append(line_framer_t *framer, const char *data, size_t len)
+{
+    size_t room = sizeof(framer->carry) - framer->carry_len;
+    if (len > room) {
+        framer->truncated_bytes += len - room;
+        len = room;
+        framer->carry_cut = true;
+    }
+    memcpy(framer->carry + framer->carry_len, data, len);
+    framer->carry_len += len;
+}
+
+void line_framer_init(line_framer_t *framer, line_framer_cb_t cb, void *ctx)
+{
+    framer->cb = cb;
+    framer->ctx = ctx;
+    framer->truncated = 0;
+    framer->truncated_bytes = 0;
+    line_framer_reset(framer);
+}
+
+void line_framer_feed(line_framer_t *framer, char *data, size_t len)
+{
+    char *p = data;
+    const char *end = data + len;
+
+    /* Finish a line that started in an earlier chunk */
+    if (framer->carry_len > 0) {
+        char *eol = find_eol(p, end);
+        carry_append(framer, p, (eol ? eol : end) - p);
+        if (eol == NULL) {
+            return;
+        }
+        emit(framer, framer->carry, framer->carry_len, framer->carry_cut);
+        line_framer_reset(framer);
+        p = eol + 1;
+    }
+
+    /* Complete lines are handed out in place */
+    while (p < end) {
+        char *eol = find_eol(p, end);
+        if (eol == NULL) {
+            carry_append(framer, p, end - p);
+            return;
+        }
+        if (eol > p) {
+            emit(framer, p, eol - p, false);
+        }
+        p = eol + 1;
+    }
+}
+
+void line_framer_flush(line_framer_t *framer)
+{
+    if (framer->carry_len > 0) {
+        emit(framer, framer->carry, framer->carry_len, framer->carry_cut);
+    }
+    line_framer_reset(framer);
+}
+
+void line_framer_reset(line_framer_t *framer)
+{
+    framer->carry_len = 0;
+    framer->carry_cut = false;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "app_config.h"
+
+/**
+ * Splits a raw serial byte stream into lines on CR and/or LF.
+ *
+ * Chunks are scanned a machine word at a time. Complete lines are handed
+ * to the callback as spans straight into the caller's chunk; only a line
+ * that straddles two chunks is copied (into the carry buffer). Empty
+ * lines are skipped, and lines longer than FT_LOG_LINE_MAX_LEN are cut.
+ */
+
+/**
+ * @brief Called once per complete line
+ * @param line  Line bytes, without CR/LF and not null-terminated. Points
+ *              into the fed chunk (or the carry buffer) and may be
+ *              modified in place; only valid during the callback.
+ * @param len   Line length (1..FT_LOG_LINE_MAX_LEN)
+ * @param ctx   User context
+ */
+typedef void (*line_framer_cb_t)(char *line, size_t len, void *ctx);
+
+typedef struct {
+    line_framer_cb_t cb;
+    void            *ctx;
+    size_t           carry_len;     /* Bytes of a partial line held from the last chunk */
+    bool             carry_cut;     /* Partial line already exceeded the max length */
+    uint32_t         truncated;     /* Lines cut at FT_LOG_LINE_MAX_LEN */
+    uint32_t         truncated_bytes;   /* Bytes dropped by those cuts */
+    char             carry[FT_LOG_LINE_MAX_LEN];
+} line_framer_t;
+
+/**
+ * @brief Initialize a framer
+ */
+void line_framer_init(line_framer_t *framer, line_framer_cb_t cb, void *ctx);
+
+/**
+ * @brief Feed a chunk of received bytes
+ *
+ * Calls the callback for each line completed by this chunk. A trailing
+ * partial line is kept until the next feed.
+ */
+void line_framer_feed(line_framer_t *framer, char *data, size_t len);
+
+/**
+ * @brief Emit a held partial line now, as if it had ended
+ *
+ * Used when the stream is known to have a gap, so the bytes before the
+ * gap are not glued to the bytes after it.
+ */
+void line_framer_flush(line_framer_t *framer);
+
+/**
+ * @brief Discard any partial line
+ */
+void line_framer_reset(line_framer_t *framer);
@@ -0,0 +1,474 @@
+#include "log_codec.h"
+#include <string.h>
+
+static const char s_level_chars[8] = { ' ', 'E', 'W', 'I', 'D', 'V', ' ', ' ' };
+
+/* ── Shared ──────────────────────────────────────────────────────────── */
+
+/* Bitwise CRC-32 (IEEE), four bits at a time */
+uint32_t log_codec_crc32(uint32_t crc, const void *data, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+size_t log_codec_format_header(char *out, char level, uint32_t timestamp_ms,
+                               const char *tag, size_t tag_len)
+{
+    char digits[10];
+    int nd = 0;
+    do {
+        digits[nd++] = (char)('0' + timestamp_ms % 10);
+        timestamp_ms /= 10;
+    } while (timestamp_ms > 0);
+
+    char *p = out;
+    *p++ = level;
+    *p++ = ' ';
+    *p++ = '(';
+    while (nd > 0) {
+        *p++ = digits[--nd];
+    }
+    *p++ = ')';
+    *p++ = ' ';
+    memcpy(p, tag, tag_len);
+    p += tag_len;
+    *p++ = ':';
+    *p++ = ' ';
+    return p - out;
+}
+
+bool log_codec_header_matches(const char *raw, size_t msg_off, char level,
+                              uint32_t timestamp_ms, const char *tag, size_t tag_len)
+{
+    char header[LOG_CODEC_HEADER_MAX(LOG_CODEC_TAG_MAX_LEN)];
+    if (tag_len == 0 || tag_len > LOG_CODEC_TAG_MAX_LEN || msg_off > sizeof(header)) {
+        return false;
+    }
+    size_t n = log_codec_format_header(header, level, timestamp_ms, tag, tag_len);
+    return n == msg_off && memcmp(header, raw, n) == 0;
+}
+
+static uint8_t level_code(char level)
+{
+    switch (level) {
+    case 'E': return 1;
+    case 'W': return 2;
+    case 'I': return 3;
+    case 'D': return 4;
+    case 'V': return 5;
+    default:  return 0;
+    }
+}
+
+static size_t put_varint(uint8_t *out, uint32_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static bool get_varint(const uint8_t **p, const uint8_t *end, uint32_t *v)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35 && *p < end; shift += 7) {
+        uint8_t b = *(*p)++;
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ── LZ (LZ4 block format) ───────────────────────────────────────────── */
+
+#define LZ_MIN_MATCH    (4)
+#define LZ_LAST_LITERALS (5)        /* The block ends with at least this many literals */
+#define LZ_MATCH_GUARD  (12)        /* No match starts this close to the end */
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz_hash(uint32_t v)
+{
+    return (v * 2654435761u) >> (32 - LOG_CODEC_LZ_HASH_BITS);
+}
+
+static uint8_t *put_length(uint8_t *op, size_t len)
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static uint8_t *emit_sequence(uint8_t *op, const uint8_t *lit, size_t lit_len,
+                              uint16_t offset, size_t match_len)
+{
+    uint8_t *token = op++;
+    *token = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15) {
+        op = put_length(op, lit_len - 15);
+    }
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (match_len == 0) {
+        return op;      /* Final literals */
+    }
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    size_t ml = match_len - LZ_MIN_MATCH;
+    *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+    if (ml >= 15) {
+        op = put_length(op, ml - 15);
+    }
+    return op;
+}
+
+/*
+ * Greedy single-probe matcher (positions + 1 in a 4096-entry table, 0 =
+ * empty). Blocks are at most 64 KB, so every offset fits in 16 bits.
+ */
+size_t log_codec_lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap,
+                             void *work)
+{
+    uint16_t *table = work;
+    memset(table, 0, LOG_CODEC_WORK_SIZE);
+    uint8_t *op = dst;
+    size_t anchor = 0;
+
+    if (len > LZ_MATCH_GUARD) {
+        size_t limit = len - LZ_MATCH_GUARD;
+        size_t match_end = len - LZ_LAST_LITERALS;
+        size_t ip = 0;
+        while (ip < limit) {
+            uint32_t seq = read32(src + ip);
+            uint32_t h = lz_hash(seq);
+            size_t ref = table[h];
+            table[h] = (uint16_t)(ip + 1);
+            if (ref == 0 || read32(src + ref - 1) != seq) {
+                ip += 1 + ((ip - anchor) >> 6);     /* Speed up through incompressible data */
+                continue;
+            }
+            ref--;
+
+            size_t ml = LZ_MIN_MATCH;
+            while (ip + ml < match_end && src[ref + ml] == src[ip + ml]) {
+                ml++;
+            }
+            /* Worst case: token + lengths + literals + offset */
+            if ((size_t)(op - dst) + 1 + (ip - anchor) + (ip - anchor) / 255 + 2 + ml / 255 + 2 > cap) {
+                return 0;
+            }
+            op = emit_sequence(op, src + anchor, ip - anchor, (uint16_t)(ip - ref), ml);
+            ip += ml;
+            anchor = ip;
+        }
+    }
+
+    size_t lit = len - anchor;
+    if ((size_t)(op - dst) + 1 + lit + lit / 255 + 1 > cap) {
+        return 0;
+    }
+    op = emit_sequence(op, src + anchor, lit, 0, 0);
+    return op - dst;
+}
+
+static bool get_length(const uint8_t **ip, const uint8_t *end, size_t *len)
+{
+    uint8_t b;
+    do {
+        if (*ip >= end) {
+            return false;
+        }
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return true;
+}
+
+long log_codec_lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap)
+{
+    const uint8_t *ip = src;
+    const uint8_t *end = src + len;
+    uint8_t *op = dst;
+    uint8_t *op_end = dst + cap;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && !get_length(&ip, end, &lit)) {
+            return -1;
+        }
+        if ((size_t)(end - ip) < lit || (size_t)(op_end - op) < lit) {
+            return -1;
+        }
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == end) {
+            break;      /* Final literals */
+        }
+
+        if (end - ip < 2) {
+            return -1;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t ml = token & 0x0F;
+        if (ml == 15 && !get_length(&ip, end, &ml)) {
+            return -1;
+        }
+        ml += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - dst) || (size_t)(op_end - op) < ml) {
+            return -1;
+        }
+        const uint8_t *ref = op - offset;
+        for (size_t i = 0; i < ml; i++) {
+            op[i] = ref[i];     /* May overlap: byte at a time */
+        }
+        op += ml;
+    }
+    return (long)(op - dst);
+}
+
+/* ── Encoding ────────────────────────────────────────────────────────── */
+
+void log_codec_file_header(log_codec_file_header_t *hdr)
+{
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, LOG_CODEC_FILE_MAGIC, sizeof(hdr->magic));
+    hdr->version = LOG_CODEC_VERSION;
+}
+
+void log_codec_encoder_reset(log_codec_encoder_t *enc)
+{
+    memset(enc, 0, sizeof(*enc));
+}
+
+void log_codec_encoder_set_tag_gen(log_codec_encoder_t *enc, uint8_t gen)
+{
+    if (enc->tag_gen != gen) {
+        memset(enc->tag_num, 0, sizeof(enc->tag_num));
+        enc->tag_gen = gen;
+    }
+}
+
+size_t log_codec_encode_line(log_codec_encoder_t *enc, uint8_t *out, size_t cap,
+                             const log_codec_line_t *line)
+{
+    if (cap < LOG_CODEC_LINE_BOUND(line->text_len)) {
+        return 0;
+    }
+
+    uint8_t code = level_code(line->level);
+    bool header = line->header && line->tag_id < LOG_CODEC_MAX_TAGS &&
+                  line->tag_len <= LOG_CODEC_TAG_MAX_LEN;
+    uint8_t *p = out + 1;
+    uint8_t flags = code;
+
+    if (header) {
+        /* Out of block tag numbers: refuse before the timestamp delta
+         * moves, or the decoder's previous timestamp falls behind ours */
+        uint8_t num = enc->tag_num[line->tag_id];
+        if (num == 0 && enc->tag_count >= LOG_CODEC_MAX_TAGS - 1) {
+            return 0;
+        }
+
+        flags |= LOG_CODEC_REC_HEADER;
+        int32_t delta = (int32_t)(line->timestamp_ms - enc->prev_ts);
+        p += put_varint(p, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+        enc->prev_ts = line->timestamp_ms;
+
+        if (num == 0) {
+            flags |= LOG_CODEC_REC_NEW_TAG;
+            *p++ = line->tag_len;
+            memcpy(p, line->tag, line->tag_len);
+            p += line->tag_len;
+            enc->tag_num[line->tag_id] = (uint8_t)(++enc->tag_count);
+        } else {
+            p += put_varint(p, num - 1);
+        }
+
+        if (!enc->has_ts || line->timestamp_ms < enc->min_ts) {
+            enc->min_ts = line->timestamp_ms;
+        }
+        if (!enc->has_ts || line->timestamp_ms > enc->max_ts) {
+            enc->max_ts = line->timestamp_ms;
+        }
+        enc->has_ts = true;
+    }
+    out[0] = flags;
+
+    p += put_varint(p, line->text_len);
+    memcpy(p, line->text, line->text_len);
+    p += line->text_len;
+
+    enc->lines++;
+    enc->levels |= 1 << code;
+    enc->text_bytes += line->text_len + 1;
+    if (header) {
+        uint32_t digits = 1;
+        for (uint32_t ts = line->timestamp_ms; ts >= 10; ts /= 10) {
+            digits++;
+        }
+        enc->text_bytes += 7 + digits + line->tag_len;
+    }
+    return p - out;
+}
+
+size_t log_codec_seal_block(const log_codec_encoder_t *enc, const uint8_t *records,
+                            size_t raw_len, uint32_t first_line, uint8_t *out, void *work)
+{
+    log_codec_block_header_t hdr = {
+        .magic = LOG_CODEC_BLOCK_MAGIC,
+        .raw_len = raw_len,
+        .first_line = first_line,
+        .min_ts_ms = enc->min_ts,
+        .max_ts_ms = enc->max_ts,
+        .lines = enc->lines,
+        .levels = enc->levels,
+    };
+    uint8_t *payload = out + sizeof(hdr);
+
+    /* Keep the records as they are if compression doesn't pay */
+    size_t packed = log_codec_lz_compress(records, raw_len, payload, raw_len, work);
+    if (packed == 0) {
+        memcpy(payload, records, raw_len);
+        packed = raw_len;
+        hdr.flags |= LOG_CODEC_BLOCK_STORED;
+    }
+    hdr.packed_len = packed;
+
+    /* CRC over the header after the crc field, then the payload */
+    const size_t crc_from = offsetof(log_codec_block_header_t, packed_len);
+    uint32_t crc = log_codec_crc32(0, (const uint8_t *)&hdr + crc_from, sizeof(hdr) - crc_from);
+    hdr.crc = log_codec_crc32(crc, payload, packed);
+    memcpy(out, &hdr, sizeof(hdr));
+    return sizeof(hdr) + packed;
+}
+
+/* ── Decoding ────────────────────────────────────────────────────────── */
+
+long log_codec_check_block(const uint8_t *p, size_t avail, log_codec_block_header_t *hdr)
+{
+    if (avail < sizeof(*hdr)) {
+        return 0;
+    }
+    memcpy(hdr, p, sizeof(*hdr));
+    if (hdr->magic != LOG_CODEC_BLOCK_MAGIC || hdr->raw_len > LOG_CODEC_MAX_RAW ||
+        hdr->packed_len > LOG_CODEC_BLOCK_BOUND(LOG_CODEC_MAX_RAW)) {
+        return -1;
+    }
+    if (avail < sizeof(*hdr) + hdr->packed_len) {
+        return 0;
+    }
+    const size_t crc_from = offsetof(log_codec_block_header_t, packed_len);
+    uint32_t crc = log_codec_crc32(0, p + crc_from, sizeof(*hdr) - crc_from);
+    crc = log_codec_crc32(crc, p + sizeof(*hdr), hdr->packed_len);
+    if (crc != hdr->crc) {
+        return -1;
+    }
+    return (long)(sizeof(*hdr) + hdr->packed_len);
+}
+
+bool log_codec_unpack_block(const uint8_t *block, const log_codec_block_header_t *hdr,
+                            uint8_t *raw)
+{
+    const uint8_t *payload = block + sizeof(*hdr);
+    if (hdr->flags & LOG_CODEC_BLOCK_STORED) {
+        if (hdr->packed_len != hdr->raw_len) {
+            return false;
+        }
+        memcpy(raw, payload, hdr->raw_len);
+        return true;
+    }
+    return log_codec_lz_decompress(payload, hdr->packed_len, raw, hdr->raw_len) ==
+           (long)hdr->raw_len;
+}
+
+void log_codec_decoder_init(log_codec_decoder_t *dec, const uint8_t *raw, size_t len)
+{
+    dec->p = raw;
+    dec->end = raw + len;
+    dec->prev_ts = 0;
+    dec->tag_count = 0;
+}
+
+bool log_codec_decode_line(log_codec_decoder_t *dec, char *out, size_t cap,
+                           log_codec_decoded_t *line)
+{
+    if (dec->p >= dec->end) {
+        return false;
+    }
+    uint8_t flags = *dec->p++;
+    line->level = s_level_chars[flags & LOG_CODEC_REC_LEVEL];
+    line->has_ts = (flags & LOG_CODEC_REC_HEADER) != 0;
+    size_t n = 0;
+
+    if (line->has_ts) {
+        uint32_t zz, num;
+        if (!get_varint(&dec->p, dec->end, &zz)) {
+            return false;
+        }
+        dec->prev_ts += (uint32_t)((zz >> 1) ^ -(zz & 1));
+        line->timestamp_ms = dec->prev_ts;
+
+        if (flags & LOG_CODEC_REC_NEW_TAG) {
+            if (dec->p >= dec->end || dec->tag_count >= LOG_CODEC_MAX_TAGS) {
+                return false;
+            }
+            uint8_t len = *dec->p++;
+            if (len > LOG_CODEC_TAG_MAX_LEN || dec->end - dec->p < len) {
+                return false;
+            }
+            dec->tag_name[dec->tag_count] = dec->p;
+            dec->tag_len[dec->tag_count] = len;
+            num = dec->tag_count++;
+            dec->p += len;
+        } else if (!get_varint(&dec->p, dec->end, &num) || num >= dec->tag_count) {
+            return false;
+        }
+
+        if (cap < LOG_CODEC_HEADER_MAX(dec->tag_len[num])) {
+            return false;
+        }
+        n = log_codec_format_header(out, line->level, line->timestamp_ms,
+                                    (const char *)dec->tag_name[num], dec->tag_len[num]);
+    } else {
+        line->timestamp_ms = 0;
+    }
+
+    uint32_t text_len;
+    if (!get_varint(&dec->p, dec->end, &text_len) || (uint32_t)(dec->end - dec->p) < text_len) {
+        return false;
+    }
+    size_t copy = text_len < cap - n ? text_len : cap - n;
+    memcpy(out + n, dec->p, copy);
+    dec->p += text_len;
+    line->len = n + copy;
+    return true;
+}
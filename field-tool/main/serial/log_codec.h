@@ -0,0 +1,219 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Compact binary SD log format (.ftl).
+ *
+ * A file is an 8-byte header followed by self-delimiting blocks. Each
+ * block is one SD write buffer: a 36-byte header (magic, CRC-32, sizes,
+ * first line number, timestamp range, level mask) and a payload holding
+ * the block's line records, LZ-compressed (LZ4 block format) unless that
+ * wouldn't save space. Every block decodes on its own, so a power cut or
+ * a bad sector costs at most the blocks it touches, and a reader can skip
+ * whole blocks by their headers.
+ *
+ * Line record, before compression:
+ *   u8      flags: level code (bits 0-2), LOG_CODEC_REC_HEADER, LOG_CODEC_REC_NEW_TAG
+ *   [HEADER] varint  zigzag timestamp delta from the previous header line
+ *   [HEADER] NEW_TAG: u8 length + tag name (gets the next block tag number)
+ *            else:    varint block tag number
+ *   varint  text length, text bytes (the message for HEADER lines, else
+ *           the whole line)
+ *
+ * HEADER lines are those whose "X (ts) TAG: " prefix is exactly what
+ * log_codec_format_header() produces, so decoding restores every line
+ * byte for byte.
+ *
+ * Plain C with no ESP-IDF dependencies: tools/ftlog_decode.c builds it
+ * on the host.
+ */
+
+#define LOG_CODEC_FILE_MAGIC    "FTLB"
+#define LOG_CODEC_VERSION       (1)
+#define LOG_CODEC_BLOCK_MAGIC   (0x314B4C46u)   /* "FLK1" little-endian */
+
+#define LOG_CODEC_MAX_TAGS      (256)           /* Device tag IDs, and tags per block */
+#define LOG_CODEC_TAG_MAX_LEN   (63)
+#define LOG_CODEC_MAX_RAW       (65535)         /* Record bytes per block */
+
+/* Record flags */
+#define LOG_CODEC_REC_LEVEL     (0x07)
+#define LOG_CODEC_REC_HEADER    (1 << 3)
+#define LOG_CODEC_REC_NEW_TAG   (1 << 4)
+
+/* Block flags */
+#define LOG_CODEC_BLOCK_STORED  (1 << 0)        /* Payload not compressed */
+
+/* Work area for log_codec_seal_block() (LZ hash table) */
+#define LOG_CODEC_LZ_HASH_BITS  (12)
+#define LOG_CODEC_WORK_SIZE     ((1 << LOG_CODEC_LZ_HASH_BITS) * sizeof(uint16_t))
+
+/* Longest canonical header with a @p tag_len tag: "X (4294967295) TAG: " */
+#define LOG_CODEC_HEADER_MAX(tag_len)   ((size_t)(tag_len) + 17)
+
+/* Worst-case encoded size of a line with @p len text bytes */
+#define LOG_CODEC_LINE_BOUND(len)   ((size_t)(len) + 8 + LOG_CODEC_TAG_MAX_LEN + 2)
+
+/* Worst-case sealed size of a block of @p raw record bytes */
+#define LOG_CODEC_BLOCK_BOUND(raw)  (sizeof(log_codec_block_header_t) + (raw) + (raw) / 255 + 16)
+
+typedef struct {
+    char    magic[4];
+    uint8_t version;
+    uint8_t reserved[3];
+} log_codec_file_header_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t crc;               /* CRC-32 of the rest of the header and the payload */
+    uint32_t packed_len;        /* Payload bytes */
+    uint32_t raw_len;           /* Record bytes after decompression */
+    uint32_t first_line;        /* Line number in the file of the first record */
+    uint32_t min_ts_ms;         /* Target timestamps of HEADER lines (if any) */
+    uint32_t max_ts_ms;
+    uint16_t lines;
+    uint8_t  levels;            /* Bit per level code present */
+    uint8_t  flags;             /* LOG_CODEC_BLOCK_* */
+    uint32_t reserved;
+} log_codec_block_header_t;
+
+/**
+ * One line to encode
+ */
+typedef struct {
+    char        level;          /* 'E','W','I','D','V' or anything else for none */
+    bool        header;         /* Canonical header: ts and tag are stored, text is the message */
+    uint32_t    timestamp_ms;
+    uint16_t    tag_id;         /* Device tag ID (< LOG_CODEC_MAX_TAGS) */
+    const char *tag;
+    uint8_t     tag_len;
+    const char *text;
+    uint16_t    text_len;
+} log_codec_line_t;
+
+/**
+ * Per-block encoder state
+ */
+typedef struct {
+    uint8_t  tag_num[LOG_CODEC_MAX_TAGS];   /* Device tag ID -> block tag number + 1 */
+    uint16_t tag_count;
+    uint32_t prev_ts;
+    uint32_t min_ts;
+    uint32_t max_ts;
+    bool     has_ts;
+    uint16_t lines;
+    uint8_t  levels;
+    uint32_t text_bytes;        /* Size the lines would have as text */
+    uint8_t  tag_gen;           /* Tag table generation the tag_num IDs are from */
+} log_codec_encoder_t;
+
+/**
+ * Decoder state for the records of one block
+ */
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    uint32_t prev_ts;
+    uint16_t tag_count;
+    const uint8_t *tag_name[LOG_CODEC_MAX_TAGS];
+    uint8_t  tag_len[LOG_CODEC_MAX_TAGS];
+} log_codec_decoder_t;
+
+/**
+ * One decoded line
+ */
+typedef struct {
+    char     level;             /* ' ' if none */
+    bool     has_ts;
+    uint32_t timestamp_ms;
+    size_t   len;               /* Bytes written to the output buffer */
+} log_codec_decoded_t;
+
+/* ── Shared ──────────────────────────────────────────────────────────── */
+
+uint32_t log_codec_crc32(uint32_t crc, const void *data, size_t len);
+
+/**
+ * @brief Write the canonical ESP-IDF header "X (ts) TAG: "
+ * @param out  At least LOG_CODEC_HEADER_MAX(tag_len) bytes
+ * @return Header length
+ */
+size_t log_codec_format_header(char *out, char level, uint32_t timestamp_ms,
+                               const char *tag, size_t tag_len);
+
+/**
+ * @brief Whether a line starts with exactly the canonical header
+ * @param msg_off  Where the parser found the message (header length)
+ */
+bool log_codec_header_matches(const char *raw, size_t msg_off, char level,
+                              uint32_t timestamp_ms, const char *tag, size_t tag_len);
+
+size_t log_codec_lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap,
+                             void *work);
+
+/**
+ * @return Decompressed length, or -1 if the input is malformed
+ */
+long log_codec_lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+
+/* ── Encoding (device) ───────────────────────────────────────────────── */
+
+void log_codec_file_header(log_codec_file_header_t *hdr);
+
+void log_codec_encoder_reset(log_codec_encoder_t *enc);
+
+/**
+ * @brief Note the tag table generation (tag_table.h) of the lines to come
+ *
+ * Device tag IDs are handed out again after a tag table reset, so a new
+ * generation forgets the block's ID mapping; tags are defined again in
+ * the block as they next appear.
+ */
+void log_codec_encoder_set_tag_gen(log_codec_encoder_t *enc, uint8_t gen);
+
+/**
+ * @brief Append one line record
+ * @return Bytes written; 0 if @p cap is too small, or if the line has a
+ *         header and the block is out of tag numbers (the encoder is left
+ *         as it was, so the line can go again without its header)
+ */
+size_t log_codec_encode_line(log_codec_encoder_t *enc, uint8_t *out, size_t cap,
+                             const log_codec_line_t *line);
+
+/**
+ * @brief Compress a block's records and frame them
+ * @param records     Record bytes (at most LOG_CODEC_MAX_RAW)
+ * @param first_line  File line number of the first record
+ * @param out         At least LOG_CODEC_BLOCK_BOUND(raw_len) bytes
+ * @param work        LOG_CODEC_WORK_SIZE bytes of scratch
+ * @return Block size
+ */
+size_t log_codec_seal_block(const log_codec_encoder_t *enc, const uint8_t *records,
+                            size_t raw_len, uint32_t first_line, uint8_t *out, void *work);
+
+/* ── Decoding (host tool, readers) ───────────────────────────────────── */
+
+/**
+ * @brief Validate a block at @p p
+ * @return Total block size, 0 if more bytes are needed, -1 if it is corrupt
+ */
+long log_codec_check_block(const uint8_t *p, size_t avail, log_codec_block_header_t *hdr);
+
+/**
+ * @brief Unpack a checked block's records into @p raw (hdr->raw_len bytes)
+ * @return false if the payload doesn't decompress to the stated size
+ */
+bool log_codec_unpack_block(const uint8_t *block, const log_codec_block_header_t *hdr,
+                            uint8_t *raw);
+
+void log_codec_decoder_init(log_codec_decoder_t *dec, const uint8_t *raw, size_t len);
+
+/**
+ * @brief Decode the next line as text (no newline, not terminated)
+ * @return false at the end of the records or if they are malformed
+ */
+bool log_codec_decode_line(log_codec_decoder_t *dec, char *out, size_t cap,
+                           log_codec_decoded_t *line);
@@ -0,0 +1,503 @@
+#include "log_cold.h"
+#include "log_codec.h"
+#include "log_parser.h"
+#include "tag_table.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "LOG_COLD";
+
+#define BLOCK_LINES     LOG_SEARCH_RING_BLOCK_LINES
+#define STAGE_SIZE      (32 * 1024)             /* Records of one block before sealing */
+#define RAW_SIZE        (STAGE_SIZE + BLOCK_LINES)
+#define ARENA_MASK      (FT_LOG_COLD_SIZE - 1)  /* Size is a power of two */
+#define DIR_MASK        (FT_LOG_COLD_MAX_BLOCKS - 1)
+#define CACHE_TEXT_SIZE (BLOCK_LINES * FT_LOG_LINE_MAX_LEN)
+#define POLL_MS         (250)
+
+/*
+ * Arena layout: blocks sit back to back at increasing absolute positions
+ * and never wrap (the tail is skipped instead), like lines in the ring.
+ * A block is the ring's search filter for its lines (if it still had
+ * it) followed by a sealed log_codec block whose raw bytes are the line
+ * records, then one sink mask byte per line.
+ */
+typedef struct {
+    uint32_t pos;               /* Absolute arena position */
+    uint32_t size;              /* Arena bytes, filter included */
+    uint32_t first_seq;
+    uint16_t lines;
+    uint16_t records_len;       /* Raw bytes before the sink masks */
+    uint32_t text_bytes;
+    bool     has_filter;
+} cold_block_t;
+
+/* A decompressed block, lines as text */
+typedef struct {
+    bool     valid;
+    uint32_t id;                /* Directory position (monotonic) */
+    uint32_t first_seq;
+    uint16_t lines;
+    uint32_t off[BLOCK_LINES + 1];
+    char     level[BLOCK_LINES];
+    uint8_t  sinks[BLOCK_LINES];
+    char    *text;              /* CACHE_TEXT_SIZE (PSRAM) */
+} cold_cache_t;
+
+/* ── State ───────────────────────────────────────────────────────────── */
+
+/* Guarded by s_mutex */
+static SemaphoreHandle_t s_mutex;
+static uint8_t *s_arena = NULL;             /* FT_LOG_COLD_SIZE (PSRAM) */
+static uint32_t s_head_pos;                 /* Arena position of the next block */
+static cold_block_t *s_dir = NULL;          /* FT_LOG_COLD_MAX_BLOCKS (PSRAM) */
+static uint32_t s_dir_head;                 /* Directory positions, monotonic */
+static uint32_t s_dir_tail;
+static cold_cache_t s_cache[2];
+static uint32_t s_cache_mru;                /* Cache slot used last */
+static uint8_t *s_raw;                      /* Decompression buffer (PSRAM) */
+static log_cold_stats_t s_stats;
+static uint32_t s_epoch;                    /* Bumped by log_cold_clear() */
+
+/* Compaction task only */
+static const log_ring_t *s_ring;
+static uint32_t s_next_seq;                 /* Next ring line to compact */
+static uint8_t *s_stage;                    /* Records + sink masks (PSRAM) */
+static uint8_t s_stage_sinks[BLOCK_LINES];
+static uint32_t s_stage_fill;
+static uint32_t s_stage_first;
+static log_codec_encoder_t s_enc;
+static uint8_t *s_pack;                     /* Filter + sealed block (PSRAM) */
+static void *s_lz_work;
+
+static inline bool pos_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+/* ── Directory (s_mutex held) ────────────────────────────────────────── */
+
+static void evict_oldest(void)
+{
+    cold_block_t *b = &s_dir[s_dir_tail & DIR_MASK];
+    s_stats.lines -= b->lines;
+    s_stats.text_bytes -= b->text_bytes;
+    s_stats.evicted_blocks++;
+    s_dir_tail++;
+}
+
+static void commit_block(cold_block_t *blk, const uint8_t *src, uint32_t epoch)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (epoch == s_epoch) {
+        uint32_t off = s_head_pos & ARENA_MASK;
+        if (off + blk->size > FT_LOG_COLD_SIZE) {
+            s_head_pos += FT_LOG_COLD_SIZE - off;
+        }
+        while (s_dir_tail != s_dir_head &&
+               (s_dir_head - s_dir_tail == FT_LOG_COLD_MAX_BLOCKS ||
+                s_head_pos + blk->size - s_dir[s_dir_tail & DIR_MASK].pos > FT_LOG_COLD_SIZE)) {
+            evict_oldest();
+        }
+        memcpy(s_arena + (s_head_pos & ARENA_MASK), src, blk->size);
+        blk->pos = s_head_pos;
+        s_dir[s_dir_head & DIR_MASK] = *blk;
+        s_dir_head++;
+        s_head_pos += blk->size;
+        s_stats.lines += blk->lines;
+        s_stats.text_bytes += blk->text_bytes;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+/* Directory position of the block holding @p seq */
+static log_ring_read_t find_block(uint32_t seq, uint32_t *id)
+{
+    if (s_dir_tail == s_dir_head || pos_before(seq, s_dir[s_dir_tail & DIR_MASK].first_seq)) {
+        return LOG_RING_READ_OVERWRITTEN;
+    }
+    /* Last block starting at or before seq */
+    uint32_t lo = s_dir_tail, hi = s_dir_head;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (pos_before(seq, s_dir[mid & DIR_MASK].first_seq)) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    const cold_block_t *b = &s_dir[lo & DIR_MASK];
+    if (seq - b->first_seq >= b->lines) {
+        /* Newer than the tier, or in a gap the compactor never saw */
+        return lo + 1 == s_dir_head ? LOG_RING_READ_PENDING : LOG_RING_READ_OVERWRITTEN;
+    }
+    *id = lo;
+    return LOG_RING_READ_OK;
+}
+
+/* Decompress a block into a cache slot (or find it there already) */
+static const cold_cache_t *load_block(uint32_t id)
+{
+    for (int i = 0; i < 2; i++) {
+        if (s_cache[i].valid && s_cache[i].id == id) {
+            s_cache_mru = i;
+            return &s_cache[i];
+        }
+    }
+
+    const cold_block_t *b = &s_dir[id & DIR_MASK];
+    const uint8_t *block = s_arena + (b->pos & ARENA_MASK) +
+                           (b->has_filter ? FT_LOG_SEARCH_BLOOM_BYTES : 0);
+    log_codec_block_header_t hdr;
+    memcpy(&hdr, block, sizeof(hdr));
+    if (hdr.raw_len > RAW_SIZE || !log_codec_unpack_block(block, &hdr, s_raw)) {
+        ESP_LOGW(TAG, "Block at seq %lu does not decode", (unsigned long)b->first_seq);
+        return NULL;
+    }
+
+    cold_cache_t *c = &s_cache[s_cache_mru ^ 1];
+    s_cache_mru ^= 1;
+    c->valid = false;
+
+    log_codec_decoder_t dec;
+    log_codec_decoder_init(&dec, s_raw, b->records_len);
+    log_codec_decoded_t line;
+    uint32_t n = 0, off = 0;
+    while (n < b->lines && off + FT_LOG_LINE_MAX_LEN <= CACHE_TEXT_SIZE &&
+           log_codec_decode_line(&dec, c->text + off, FT_LOG_LINE_MAX_LEN, &line)) {
+        c->off[n] = off;
+        c->level[n] = line.level;
+        c->sinks[n] = s_raw[b->records_len + n];
+        off += line.len;
+        n++;
+    }
+    c->off[n] = off;
+    c->lines = n;
+    c->first_seq = b->first_seq;
+    c->id = id;
+    c->valid = true;
+    return c;
+}
+
+/* ── Compaction task ─────────────────────────────────────────────────── */
+
+static void stage_reset(void)
+{
+    s_stage_fill = 0;
+    log_codec_encoder_reset(&s_enc);
+}
+
+/* Compress the staged lines into a block and add it to the arena */
+static void seal_stage(uint32_t epoch)
+{
+    if (s_enc.lines == 0) {
+        return;
+    }
+    int64_t start = esp_timer_get_time();
+
+    cold_block_t blk = {
+        .first_seq = s_stage_first,
+        .lines = s_enc.lines,
+        .records_len = (uint16_t)s_stage_fill,
+        .text_bytes = s_enc.text_bytes,
+    };
+    memcpy(s_stage + s_stage_fill, s_stage_sinks, s_enc.lines);
+
+    /* The ring's filter for these lines' block, if it hasn't moved on */
+    blk.has_filter = log_search_copy_ring_filter(s_stage_first, s_pack);
+    uint8_t *out = s_pack + FT_LOG_SEARCH_BLOOM_BYTES;
+    size_t len = log_codec_seal_block(&s_enc, s_stage, s_stage_fill + s_enc.lines,
+                                      s_stage_first, out, s_lz_work);
+    blk.size = len + (blk.has_filter ? FT_LOG_SEARCH_BLOOM_BYTES : 0);
+    s_stats.last_compact_us = (uint32_t)(esp_timer_get_time() - start);
+
+    commit_block(&blk, blk.has_filter ? s_pack : out, epoch);
+    stage_reset();
+}
+
+static void stage_line(uint32_t seq, const log_span_t *span, uint32_t epoch)
+{
+    if (s_enc.lines > 0 && (seq != s_stage_first + s_enc.lines ||
+                            s_stage_fill + LOG_CODEC_LINE_BOUND(span->raw_len) > STAGE_SIZE)) {
+        seal_stage(epoch);      /* Lines must be consecutive; split full blocks */
+    }
+    if (s_enc.lines == 0) {
+        s_stage_first = seq;
+    }
+
+    log_codec_line_t line = {
+        .level = span->level,
+        .text = span->raw,
+        .text_len = span->raw_len,
+    };
+    if (span->tag_id != 0 && span->tag_id < LOG_CODEC_MAX_TAGS &&
+        log_codec_header_matches(span->raw, span->msg_off, span->level, span->timestamp_ms,
+                                 span->raw + span->tag_off, span->tag_len)) {
+        log_codec_encoder_set_tag_gen(&s_enc, tag_table_generation());
+        line.header = true;
+        line.timestamp_ms = span->timestamp_ms;
+        line.tag_id = span->tag_id;
+        line.tag = span->raw + span->tag_off;
+        line.tag_len = span->tag_len;
+        line.text = span->raw + span->msg_off;
+        line.text_len = span->raw_len - span->msg_off;
+    }
+    s_stage_sinks[s_enc.lines] = span->sinks;
+    size_t n = log_codec_encode_line(&s_enc, s_stage + s_stage_fill, STAGE_SIZE - s_stage_fill,
+                                     &line);
+    if (n == 0) {
+        /* Block ran out of tag numbers: keep the line, header and all */
+        line.header = false;
+        line.text = span->raw;
+        line.text_len = span->raw_len;
+        n = log_codec_encode_line(&s_enc, s_stage + s_stage_fill, STAGE_SIZE - s_stage_fill,
+                                  &line);
+    }
+    s_stage_fill += n;
+}
+
+static void note_lost(uint32_t lines, uint32_t epoch)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (epoch == s_epoch) {
+        s_stats.lost_lines += lines;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+/* Compact every 256-line ring block that has filled up */
+static void compact_ready(void)
+{
+    static uint32_t seen_epoch = 0;
+    char buf[FT_LOG_LINE_MAX_LEN];
+    log_span_t span;
+
+    uint32_t epoch = s_epoch;
+    if (epoch != seen_epoch) {
+        seen_epoch = epoch;
+        stage_reset();
+        s_next_seq = log_ring_first_seq(s_ring);
+    }
+
+    uint32_t next = log_ring_next_seq(s_ring);
+    while (true) {
+        uint32_t first = log_ring_first_seq(s_ring);
+        if (pos_before(s_next_seq, first)) {
+            note_lost(first - s_next_seq, epoch);
+            s_next_seq = first;
+        }
+        uint32_t end = (s_next_seq | (BLOCK_LINES - 1)) + 1;
+        if (pos_before(next, end)) {
+            break;      /* Block still filling; its lines stay hot */
+        }
+        for (; s_next_seq != end; s_next_seq++) {
+            if (log_ring_read(s_ring, s_next_seq, buf, sizeof(buf), &span) == LOG_RING_READ_OK) {
+                stage_line(s_next_seq, &span, epoch);
+            } else {
+                note_lost(1, epoch);
+            }
+        }
+        seal_stage(epoch);
+    }
+}
+
+static void log_cold_task(void *arg)
+{
+    s_next_seq = log_ring_first_seq(s_ring);
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(POLL_MS));
+        compact_ready();
+    }
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+esp_err_t log_cold_init(const log_ring_t *ring)
+{
+    s_ring = ring;
+    s_arena = heap_caps_malloc(FT_LOG_COLD_SIZE, MALLOC_CAP_SPIRAM);
+    s_dir = heap_caps_malloc(FT_LOG_COLD_MAX_BLOCKS * sizeof(cold_block_t), MALLOC_CAP_SPIRAM);
+    s_raw = heap_caps_malloc(RAW_SIZE, MALLOC_CAP_SPIRAM);
+    s_stage = heap_caps_malloc(RAW_SIZE, MALLOC_CAP_SPIRAM);
+    s_pack = heap_caps_malloc(FT_LOG_SEARCH_BLOOM_BYTES + LOG_CODEC_BLOCK_BOUND(RAW_SIZE),
+                              MALLOC_CAP_SPIRAM);
+    s_lz_work = heap_caps_malloc(LOG_CODEC_WORK_SIZE, MALLOC_CAP_INTERNAL);
+    for (int i = 0; i < 2; i++) {
+        s_cache[i].text = heap_caps_malloc(CACHE_TEXT_SIZE, MALLOC_CAP_SPIRAM);
+        if (s_cache[i].text == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_arena == NULL || s_dir == NULL || s_raw == NULL || s_stage == NULL ||
+        s_pack == NULL || s_lz_work == NULL || s_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    stage_reset();
+
+    BaseType_t ret = xTaskCreatePinnedToCore(log_cold_task, "log_cold", 4096, NULL, 1, NULL, 1);
+    if (ret != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Cold history: %d KB arena, up to %d blocks", FT_LOG_COLD_SIZE / 1024,
+             FT_LOG_COLD_MAX_BLOCKS);
+    return ESP_OK;
+}
+
+bool log_cold_first_seq(uint32_t *seq)
+{
+    if (s_mutex == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool any = s_dir_tail != s_dir_head;
+    if (any) {
+        *seq = s_dir[s_dir_tail & DIR_MASK].first_seq;
+    }
+    xSemaphoreGive(s_mutex);
+    return any;
+}
+
+log_ring_read_t log_cold_read(uint32_t seq, char *buf, size_t buf_size, log_span_t *span)
+{
+    if (s_mutex == NULL) {
+        return LOG_RING_READ_OVERWRITTEN;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint32_t id;
+    log_ring_read_t r = find_block(seq, &id);
+    const cold_cache_t *c = NULL;
+    if (r == LOG_RING_READ_OK) {
+        c = load_block(id);
+    }
+    uint32_t i = seq - (c ? c->first_seq : 0);
+    if (c == NULL || i >= c->lines) {
+        xSemaphoreGive(s_mutex);
+        return r == LOG_RING_READ_OK ? LOG_RING_READ_OVERWRITTEN : r;
+    }
+    size_t len = c->off[i + 1] - c->off[i];
+    if (len > buf_size) {
+        len = buf_size;
+    }
+    memcpy(buf, c->text + c->off[i], len);
+    char level = c->level[i];
+    uint8_t sinks = c->sinks[i];
+    xSemaphoreGive(s_mutex);
+
+    log_parser_parse_span(buf, len, span);
+    span->level = level;        /* Also right for lines leveled by their color */
+    span->sinks = sinks;
+    span->tag_id = 0;
+    return LOG_RING_READ_OK;
+}
+
+bool log_cold_search(const log_search_query_t *query, uint32_t from_seq, bool backward,
+                     uint8_t sinks, uint32_t *seq, log_search_stats_t *stats)
+{
+    log_search_stats_t st = { 0 };
+    int64_t start_us = esp_timer_get_time();
+    bool found = false;
+    if (s_mutex == NULL) {
+        if (stats != NULL) {
+            *stats = st;
+        }
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint32_t id;
+    log_ring_read_t r = s_dir_tail == s_dir_head ? LOG_RING_READ_OVERWRITTEN :
+                        find_block(from_seq, &id);
+
+    /* Start from the block holding from_seq, else the nearest one that way */
+    bool any = true;
+    if (r == LOG_RING_READ_PENDING) {
+        any = backward;
+        id = s_dir_head - 1;
+        from_seq = backward ? s_dir[id & DIR_MASK].first_seq + s_dir[id & DIR_MASK].lines - 1
+                            : from_seq;
+    } else if (r == LOG_RING_READ_OVERWRITTEN) {
+        any = s_dir_tail != s_dir_head && !backward;
+        id = s_dir_tail;
+        if (any && !pos_before(from_seq, s_dir[id & DIR_MASK].first_seq)) {
+            /* In a gap between blocks: the next block up */
+            while (id != s_dir_head && pos_before(s_dir[id & DIR_MASK].first_seq, from_seq)) {
+                id++;
+            }
+            any = id != s_dir_head;
+        }
+    }
+
+    while (any && !found) {
+        const cold_block_t *b = &s_dir[id & DIR_MASK];
+        st.blocks++;
+        const uint8_t *filter = s_arena + (b->pos & ARENA_MASK);
+        if (!b->has_filter || log_search_bloom_test(filter, query)) {
+            st.candidates++;
+            const cold_cache_t *c = load_block(id);
+            for (uint32_t k = 0; c != NULL && k < c->lines; k++) {
+                uint32_t i = backward ? c->lines - 1 - k : k;
+                uint32_t s = c->first_seq + i;
+                if (backward ? pos_before(from_seq, s) : pos_before(s, from_seq)) {
+                    continue;
+                }
+                st.lines_read++;
+                if ((c->sinks[i] & sinks) &&
+                    log_search_match(query, c->text + c->off[i], c->off[i + 1] - c->off[i])) {
+                    *seq = s;
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (backward) {
+            any = id != s_dir_tail;
+            id--;
+        } else {
+            id++;
+            any = id != s_dir_head;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+
+    st.elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (stats != NULL) {
+        *stats = st;
+    }
+    return found;
+}
+
+void log_cold_clear(void)
+{
+    if (s_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_dir_tail = s_dir_head;
+    s_stats.lines = 0;
+    s_stats.text_bytes = 0;
+    s_cache[0].valid = false;
+    s_cache[1].valid = false;
+    s_epoch++;
+    xSemaphoreGive(s_mutex);
+}
+
+void log_cold_get_stats(log_cold_stats_t *stats)
+{
+    if (s_mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    stats->blocks = s_dir_head - s_dir_tail;
+    stats->bytes = stats->blocks ? s_head_pos - s_dir[s_dir_tail & DIR_MASK].pos : 0;
+    xSemaphoreGive(s_mutex);
+}
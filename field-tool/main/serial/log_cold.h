@@ -0,0 +1,79 @@
+#pragma once
+
+#include "log_ring.h"
+#include "log_search.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Cold history tier: compressed blocks of old log lines in PSRAM.
+ *
+ * The log ring (hot tier) keeps recent lines uncompressed. A low-priority
+ * task follows it and, as each 256-line search block of the ring
+ * completes, encodes those lines with log_codec (interned tags,
+ * timestamp deltas, LZ per block) into a FT_LOG_COLD_SIZE arena together
+ * with the block's trigram filter. Lines keep their ring sequence
+ * numbers, so once the ring evicts a line it can still be read here by
+ * the same number; the oldest blocks are dropped when the arena is full.
+ *
+ * Reads decompress a whole block into one of two small caches, so
+ * scrolling through a block costs one decompression. Searches skip
+ * blocks by their filters before decompressing anything.
+ *
+ * Lines the ring evicts before the task reaches them (it would have to
+ * fall a whole ring behind) are counted in lost_lines.
+ */
+
+/**
+ * Tier totals
+ */
+typedef struct {
+    uint32_t blocks;
+    uint32_t lines;             /* Lines held */
+    uint32_t bytes;             /* Arena bytes in use */
+    uint32_t text_bytes;        /* Size of the held lines as text */
+    uint32_t evicted_blocks;    /* Dropped for space since boot */
+    uint32_t lost_lines;        /* Left the ring before they were compacted */
+    uint32_t last_compact_us;   /* Encoding and compressing the last block */
+} log_cold_stats_t;
+
+/**
+ * @brief Allocate the arena and start the compaction task
+ * @param ring  The hot tier it follows
+ */
+esp_err_t log_cold_init(const log_ring_t *ring);
+
+/**
+ * @brief Oldest line held
+ * @return false if the tier is empty
+ */
+bool log_cold_first_seq(uint32_t *seq);
+
+/**
+ * @brief Copy one line out of the cold tier
+ *
+ * Same contract as log_ring_read(); any task may call it. The span's
+ * tag_id is 0 (cold lines are not interned).
+ *
+ * @return LOG_RING_READ_OVERWRITTEN if the line is older than the tier
+ *         (or was never compacted), LOG_RING_READ_PENDING if it is newer
+ */
+log_ring_read_t log_cold_read(uint32_t seq, char *buf, size_t buf_size, log_span_t *span);
+
+/**
+ * @brief Find the nearest matching line held in the cold tier
+ *
+ * Same contract as log_search_ring(): searches from @p from_seq
+ * (inclusive) towards newer lines, or older ones if @p backward.
+ */
+bool log_cold_search(const log_search_query_t *query, uint32_t from_seq, bool backward,
+                     uint8_t sinks, uint32_t *seq, log_search_stats_t *stats);
+
+/**
+ * @brief Drop everything held (with serial_monitor_clear())
+ */
+void log_cold_clear(void);
+
+void log_cold_get_stats(log_cold_stats_t *stats);
@@ -0,0 +1,238 @@
+#include "log_dedup.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include <stdio.h>
+
+static const char *TAG = "LOG_DEDUP";
+
+typedef struct {
+    bool     active;
+    char     level;
+    uint8_t  sinks;
+    uint16_t key_len;
+    char     key[FT_LOG_LINE_MAX_LEN];  /* "TAG: message", digits folded in numbers mode */
+    int64_t  last_us;                   /* Last line of the run (first or repeat) */
+    int64_t  summary_us;                /* Last summary, or the run's first line */
+
+    /* The repeats the next summary stands for */
+    uint32_t count;
+    bool     has_ts;
+    uint32_t first_ts;
+    uint32_t last_ts;
+    int64_t  first_us;
+    uint8_t  field_count;
+    uint32_t field_min[LOG_DEDUP_MAX_FIELDS];
+    uint32_t field_max[LOG_DEDUP_MAX_FIELDS];
+} dedup_run_t;
+
+static log_dedup_emit_cb_t s_emit = NULL;
+static volatile log_dedup_mode_t s_mode = FT_LOG_DEDUP_MODE;   /* Set by the UI */
+static log_dedup_mode_t s_run_mode = FT_LOG_DEDUP_MODE;        /* RX task's copy */
+static dedup_run_t s_run;
+static char s_key[FT_LOG_LINE_MAX_LEN];
+static uint32_t s_folded = 0;
+
+/*
+ * Comparison key: the line from its tag on (the timestamp always
+ * differs). In numbers mode every run of digits becomes one '#' and the
+ * first LOG_DEDUP_MAX_FIELDS of them are parsed into @p values.
+ */
+static uint16_t make_key(const log_span_t *span, log_dedup_mode_t mode,
+                         uint32_t *values, uint8_t *value_count)
+{
+    uint16_t from = span->tag_len > 0 ? span->tag_off : span->msg_off;
+    const char *src = span->raw + from;
+    uint16_t len = span->raw_len - from;
+    *value_count = 0;
+
+    if (mode != LOG_DEDUP_NUMBERS) {
+        memcpy(s_key, src, len);
+        return len;
+    }
+
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < len; i++) {
+        char c = src[i];
+        if (c < '0' || c > '9') {
+            s_key[n++] = c;
+            continue;
+        }
+        uint32_t v = 0;
+        while (i < len && src[i] >= '0' && src[i] <= '9') {
+            v = v < 429496729u ? v * 10 + (src[i] - '0') : UINT32_MAX;
+            i++;
+        }
+        i--;
+        if (*value_count < LOG_DEDUP_MAX_FIELDS) {
+            values[(*value_count)++] = v;
+        }
+        s_key[n++] = '#';
+    }
+    return n;
+}
+
+static void note_repeat(const log_span_t *span, int64_t now_us,
+                        const uint32_t *values, uint8_t value_count)
+{
+    dedup_run_t *r = &s_run;
+    if (r->count == 0) {
+        r->first_us = now_us;
+        r->has_ts = false;
+        r->field_count = value_count;
+        for (uint8_t i = 0; i < value_count; i++) {
+            r->field_min[i] = values[i];
+            r->field_max[i] = values[i];
+        }
+    }
+    for (uint8_t i = 0; i < r->field_count && i < value_count; i++) {
+        if (values[i] < r->field_min[i]) {
+            r->field_min[i] = values[i];
+        }
+        if (values[i] > r->field_max[i]) {
+            r->field_max[i] = values[i];
+        }
+    }
+    if (span->tag_len > 0) {
+        if (!r->has_ts) {
+            r->first_ts = span->timestamp_ms;
+        }
+        r->last_ts = span->timestamp_ms;
+        r->has_ts = true;
+    }
+    r->count++;
+    r->last_us = now_us;
+}
+
+/* Hand the repeats counted so far to the sinks as one summary line */
+static void emit_summary(int64_t now_us)
+{
+    dedup_run_t *r = &s_run;
+    if (r->count == 0) {
+        return;
+    }
+
+    char text[192];
+    int n;
+    if (r->has_ts) {
+        n = snprintf(text, sizeof(text), LOG_DEDUP_PREFIX "%lu more times, %lu..%lu ms",
+                     (unsigned long)r->count, (unsigned long)r->first_ts,
+                     (unsigned long)r->last_ts);
+    } else {
+        n = snprintf(text, sizeof(text), LOG_DEDUP_PREFIX "%lu more times over %lu ms",
+                     (unsigned long)r->count, (unsigned long)((r->last_us - r->first_us) / 1000));
+    }
+    for (uint8_t i = 0; i < r->field_count && n < (int)sizeof(text); i++) {
+        const char *sep = i == 0 ? " |" : "";
+        if (r->field_min[i] == r->field_max[i]) {
+            n += snprintf(text + n, sizeof(text) - n, "%s #%u %lu", sep, i + 1,
+                          (unsigned long)r->field_min[i]);
+        } else {
+            n += snprintf(text + n, sizeof(text) - n, "%s #%u %lu..%lu", sep, i + 1,
+                          (unsigned long)r->field_min[i], (unsigned long)r->field_max[i]);
+        }
+    }
+    if (n < (int)sizeof(text)) {
+        n += snprintf(text + n, sizeof(text) - n, " ---");
+    }
+    if (n >= (int)sizeof(text)) {
+        n = sizeof(text) - 1;
+    }
+
+    log_span_t span = {
+        .raw = text,
+        .raw_len = (uint16_t)n,
+        .level = r->level,
+        .timestamp_ms = r->has_ts ? r->last_ts : 0,
+        .sinks = r->sinks,
+    };
+    s_folded += r->count;
+    r->count = 0;
+    r->summary_us = now_us;
+    if (s_emit != NULL) {
+        s_emit(&span);
+    }
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+void log_dedup_init(log_dedup_emit_cb_t emit)
+{
+    s_emit = emit;
+    memset(&s_run, 0, sizeof(s_run));
+}
+
+void log_dedup_set_mode(log_dedup_mode_t mode)
+{
+    s_mode = mode;
+    ESP_LOGI(TAG, "Repeat folding %s", mode == LOG_DEDUP_OFF ? "off" :
+                                       mode == LOG_DEDUP_EXACT ? "on (exact)" : "on (numbers)");
+}
+
+log_dedup_mode_t log_dedup_get_mode(void)
+{
+    return s_mode;
+}
+
+bool log_dedup_offer(const log_span_t *span, int64_t now_us)
+{
+    log_dedup_mode_t mode = s_mode;
+    if (mode != s_run_mode) {
+        log_dedup_flush();      /* Keys from the old mode don't compare */
+        s_run_mode = mode;
+    }
+    if (mode == LOG_DEDUP_OFF || span->sinks == 0) {
+        return false;
+    }
+
+    uint32_t values[LOG_DEDUP_MAX_FIELDS];
+    uint8_t value_count;
+    uint16_t len = make_key(span, mode, values, &value_count);
+
+    dedup_run_t *r = &s_run;
+    if (r->active && span->level == r->level && span->sinks == r->sinks &&
+        len == r->key_len && memcmp(s_key, r->key, len) == 0) {
+        note_repeat(span, now_us, values, value_count);
+        if (now_us - r->summary_us >= (int64_t)FT_LOG_DEDUP_SUMMARY_MS * 1000) {
+            emit_summary(now_us);
+        }
+        return true;
+    }
+
+    /* A new line: close the old run, this one may start the next */
+    emit_summary(now_us);
+    r->active = true;
+    r->level = span->level;
+    r->sinks = span->sinks;
+    r->key_len = len;
+    memcpy(r->key, s_key, len);
+    r->last_us = now_us;
+    r->summary_us = now_us;
+    r->count = 0;
+    return false;
+}
+
+void log_dedup_poll(int64_t now_us)
+{
+    dedup_run_t *r = &s_run;
+    if (!r->active) {
+        return;
+    }
+    if (now_us - r->last_us >= (int64_t)FT_LOG_DEDUP_IDLE_MS * 1000) {
+        emit_summary(now_us);
+        r->active = false;
+    } else if (r->count > 0 &&
+               now_us - r->summary_us >= (int64_t)FT_LOG_DEDUP_SUMMARY_MS * 1000) {
+        emit_summary(now_us);
+    }
+}
+
+void log_dedup_flush(void)
+{
+    emit_summary(s_run.last_us);
+    s_run.active = false;
+}
+
+uint32_t log_dedup_folded(void)
+{
+    return s_folded;
+}
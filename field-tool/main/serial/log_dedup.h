@@ -0,0 +1,84 @@
+#pragma once
+
+#include "log_parser.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Repeat folding at ingest.
+ *
+ * Consecutive lines with the same level, tag and message (in
+ * LOG_DEDUP_NUMBERS mode, the same apart from the digits in it) form a
+ * run. The first line of a run goes to the sinks as usual; the repeats
+ * are only counted, and a summary line stands in for them:
+ *
+ *   --- repeated 1234 more times, 1503..6710 ms | #1 12..19 #2 0 ---
+ *
+ * giving the count, the first and last target timestamps of the repeats
+ * and, in numbers mode, the range each of the first numbers in the
+ * message took. A summary is emitted when the run ends (a different line
+ * arrives, or none for FT_LOG_DEDUP_IDLE_MS) and every
+ * FT_LOG_DEDUP_SUMMARY_MS while it lasts, and goes to the same sinks as
+ * the run's first line.
+ *
+ * Everything here runs in the RX task except log_dedup_set_mode(), which
+ * takes effect at the next line.
+ */
+
+#define LOG_DEDUP_PREFIX        "--- repeated "
+#define LOG_DEDUP_PREFIX_LEN    (sizeof(LOG_DEDUP_PREFIX) - 1)
+#define LOG_DEDUP_MAX_FIELDS    (4)     /* Numbers tracked per run */
+
+typedef enum {
+    LOG_DEDUP_OFF = 0,
+    LOG_DEDUP_EXACT,            /* Identical messages */
+    LOG_DEDUP_NUMBERS,          /* Identical once every digit run counts as one '#' */
+} log_dedup_mode_t;
+
+/**
+ * @brief Receives summary lines (RX task); the span is only valid inside
+ */
+typedef void (*log_dedup_emit_cb_t)(log_span_t *summary);
+
+void log_dedup_init(log_dedup_emit_cb_t emit);
+
+void log_dedup_set_mode(log_dedup_mode_t mode);
+
+log_dedup_mode_t log_dedup_get_mode(void);
+
+/**
+ * @brief Offer a routed line
+ *
+ * If the line ends the current run, the run's summary is emitted first.
+ * Lines routed to no sink are ignored and don't break a run.
+ *
+ * @param now_us  esp_timer time the line arrived
+ * @return true if the line repeats the run and must not be stored
+ */
+bool log_dedup_offer(const log_span_t *span, int64_t now_us);
+
+/**
+ * @brief End a run that went idle, or summarize one that has gone on too
+ *        long without a summary (call every RX poll)
+ */
+void log_dedup_poll(int64_t now_us);
+
+/**
+ * @brief Emit any pending summary and forget the run (disconnect, clear)
+ */
+void log_dedup_flush(void);
+
+/**
+ * @brief Lines folded into summaries since boot
+ */
+uint32_t log_dedup_folded(void);
+
+/**
+ * @brief Whether a stored line is a summary
+ */
+static inline bool log_dedup_is_summary(const char *raw, size_t len)
+{
+    return len > LOG_DEDUP_PREFIX_LEN && raw[0] == '-' &&
+           memcmp(raw, LOG_DEDUP_PREFIX, LOG_DEDUP_PREFIX_LEN) == 0;
+}
@@ -0,0 +1,304 @@
+#include "log_filter.h"
+#include "tag_table.h"
+#include "app_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+static const char *TAG = "LOG_FILTER";
+
+/* ── Compiled matcher ───────────────────────────────────────────────── */
+
+#define TAG_WORDS  ((FT_LOG_TAG_TABLE_SIZE + 1 + 31) / 32)
+
+typedef struct {
+    uint8_t len;
+    char    text[LOG_FILTER_TERM_MAX_LEN];
+} filter_term_t;
+
+typedef struct {
+    bool          pass_all;             /* No rule can reject — skip matching */
+    bool          enabled;
+    uint8_t       level_mask;           /* Bit per level_rank() */
+    bool          any_tag;              /* Include list empty */
+    uint8_t       include_count;
+    uint8_t       exclude_count;
+    uint32_t      tag_include[TAG_WORDS];
+    uint32_t      tag_exclude[TAG_WORDS];
+    filter_term_t include[LOG_FILTER_MAX_TERMS];
+    filter_term_t exclude[LOG_FILTER_MAX_TERMS];
+} log_filter_t;
+
+/* ── State ──────────────────────────────────────────────────────────── */
+
+/* Matchers in use — owned by the RX task */
+static log_filter_t *s_active[LOG_SINK_COUNT];
+
+/* Newly compiled matchers waiting for the RX task to adopt them */
+static _Atomic(log_filter_t *) s_pending[LOG_SINK_COUNT];
+
+static log_filter_rules_t s_rules[LOG_SINK_COUNT];
+static SemaphoreHandle_t s_rules_mutex;
+
+static volatile uint32_t s_rejected[LOG_SINK_COUNT];
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+/* 0 = unparsed, 1 = most severe ... 5 = most verbose */
+static int level_rank(char level)
+{
+    switch (level) {
+    case 'E': return 1;
+    case 'W': return 2;
+    case 'I': return 3;
+    case 'D': return 4;
+    case 'V': return 5;
+    default:  return 0;
+    }
+}
+
+static inline bool tag_bit(const uint32_t *bits, uint16_t id)
+{
+    return (bits[id >> 5] >> (id & 31)) & 1;
+}
+
+static bool contains(const char *hay, size_t n, const filter_term_t *term)
+{
+    if (term->len == 0) {
+        return true;
+    }
+    if (term->len > n) {
+        return false;
+    }
+
+    /* memchr for the first byte, then compare the rest */
+    const char *p = hay;
+    const char *last = hay + n - term->len;
+    while (p <= last) {
+        p = memchr(p, term->text[0], last - p + 1);
+        if (p == NULL) {
+            return false;
+        }
+        if (memcmp(p + 1, term->text + 1, term->len - 1) == 0) {
+            return true;
+        }
+        p++;
+    }
+    return false;
+}
+
+static bool match(const log_filter_t *f, const log_span_t *span)
+{
+    if (f->pass_all) {
+        return true;
+    }
+    if (!f->enabled || !(f->level_mask & (1u << level_rank(span->level)))) {
+        return false;
+    }
+    if (!f->any_tag && !tag_bit(f->tag_include, span->tag_id)) {
+        return false;
+    }
+    if (tag_bit(f->tag_exclude, span->tag_id)) {
+        return false;
+    }
+
+    const char *msg = span->raw + span->msg_off;
+    size_t msg_len = log_span_msg_len(span);
+    for (int i = 0; i < f->exclude_count; i++) {
+        if (contains(msg, msg_len, &f->exclude[i])) {
+            return false;
+        }
+    }
+    if (f->include_count == 0) {
+        return true;
+    }
+    for (int i = 0; i < f->include_count; i++) {
+        if (contains(msg, msg_len, &f->include[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static esp_err_t compile(const log_filter_rules_t *rules, log_filter_t *f)
+{
+    int min_rank = level_rank(rules->min_level);
+    if (min_rank == 0 ||
+        rules->include_tag_count > LOG_FILTER_MAX_TAGS ||
+        rules->exclude_tag_count > LOG_FILTER_MAX_TAGS ||
+        rules->include_text_count > LOG_FILTER_MAX_TERMS ||
+        rules->exclude_text_count > LOG_FILTER_MAX_TERMS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(f, 0, sizeof(*f));
+    f->enabled = rules->enabled;
+    f->level_mask = (uint8_t)((2u << min_rank) - 2) | (rules->pass_unparsed ? 1 : 0);
+
+    /* Tags are interned now so a rule for a tag not seen yet still works */
+    f->any_tag = (rules->include_tag_count == 0);
+    for (int i = 0; i < rules->include_tag_count; i++) {
+        const char *name = rules->include_tags[i];
+        uint16_t id = tag_table_intern(name, strnlen(name, FT_LOG_TAG_MAX_LEN));
+        if (id != TAG_ID_NONE) {
+            f->tag_include[id >> 5] |= 1u << (id & 31);
+        }
+    }
+    for (int i = 0; i < rules->exclude_tag_count; i++) {
+        const char *name = rules->exclude_tags[i];
+        uint16_t id = tag_table_intern(name, strnlen(name, FT_LOG_TAG_MAX_LEN));
+        if (id != TAG_ID_NONE) {
+            f->tag_exclude[id >> 5] |= 1u << (id & 31);
+        }
+    }
+
+    for (int i = 0; i < rules->include_text_count; i++) {
+        filter_term_t *t = &f->include[f->include_count++];
+        t->len = strnlen(rules->include_text[i], LOG_FILTER_TERM_MAX_LEN - 1);
+        memcpy(t->text, rules->include_text[i], t->len);
+    }
+    for (int i = 0; i < rules->exclude_text_count; i++) {
+        filter_term_t *t = &f->exclude[f->exclude_count];
+        t->len = strnlen(rules->exclude_text[i], LOG_FILTER_TERM_MAX_LEN - 1);
+        if (t->len > 0) {
+            memcpy(t->text, rules->exclude_text[i], t->len);
+            f->exclude_count++;     /* An empty exclude term would reject everything */
+        }
+    }
+
+    f->pass_all = f->enabled && min_rank == level_rank('V') && rules->pass_unparsed &&
+                  f->any_tag && rules->exclude_tag_count == 0 &&
+                  f->include_count == 0 && f->exclude_count == 0;
+    return ESP_OK;
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+void log_filter_rules_default(log_filter_rules_t *rules)
+{
+    memset(rules, 0, sizeof(*rules));
+    rules->enabled = true;
+    rules->min_level = 'V';
+    rules->pass_unparsed = true;
+}
+
+esp_err_t log_filter_init(void)
+{
+    if (s_rules_mutex == NULL) {
+        s_rules_mutex = xSemaphoreCreateMutex();
+        if (s_rules_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    for (int sink = 0; sink < LOG_SINK_COUNT; sink++) {
+        log_filter_rules_t rules;
+        log_filter_rules_default(&rules);
+        if (sink == LOG_SINK_NETWORK) {
+            rules.enabled = false;      /* Enabled by the network server when it starts */
+        }
+        esp_err_t err = log_filter_set_rules(sink, &rules);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t log_filter_set_rules(log_sink_t sink, const log_filter_rules_t *rules)
+{
+    if (sink >= LOG_SINK_COUNT || rules == NULL || s_rules_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    log_filter_t *f = malloc(sizeof(log_filter_t));
+    if (f == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    /* Compiled under the mutex so a tag table reset can't slip in between */
+    xSemaphoreTake(s_rules_mutex, portMAX_DELAY);
+    esp_err_t err = compile(rules, f);
+    if (err != ESP_OK) {
+        xSemaphoreGive(s_rules_mutex);
+        free(f);
+        return err;
+    }
+    s_rules[sink] = *rules;
+    /* A matcher still pending was never seen by the RX task — free it here */
+    free(atomic_exchange_explicit(&s_pending[sink], f, memory_order_acq_rel));
+    xSemaphoreGive(s_rules_mutex);
+
+    ESP_LOGI(TAG, "Sink %d: %s, level <= %c, %d/%d tags, %d/%d terms", sink,
+             rules->enabled ? "on" : "off", rules->min_level,
+             rules->include_tag_count, rules->exclude_tag_count,
+             rules->include_text_count, rules->exclude_text_count);
+    return ESP_OK;
+}
+
+void log_filter_get_rules(log_sink_t sink, log_filter_rules_t *rules)
+{
+    if (sink >= LOG_SINK_COUNT || rules == NULL) {
+        return;
+    }
+    if (s_rules_mutex == NULL) {
+        log_filter_rules_default(rules);
+        return;
+    }
+    xSemaphoreTake(s_rules_mutex, portMAX_DELAY);
+    *rules = s_rules[sink];
+    xSemaphoreGive(s_rules_mutex);
+}
+
+uint8_t log_filter_route(const log_span_t *span)
+{
+    uint8_t sinks = 0;
+    for (int sink = 0; sink < LOG_SINK_COUNT; sink++) {
+        /* Adopt new rules between lines */
+        if (atomic_load_explicit(&s_pending[sink], memory_order_relaxed) != NULL) {
+            log_filter_t *f = atomic_exchange_explicit(&s_pending[sink], NULL,
+                                                       memory_order_acquire);
+            if (f != NULL) {
+                free(s_active[sink]);
+                s_active[sink] = f;
+            }
+        }
+
+        const log_filter_t *f = s_active[sink];
+        if (f == NULL || match(f, span)) {
+            sinks |= LOG_SINK_BIT(sink);
+        } else if (f->enabled) {
+            s_rejected[sink]++;
+        }
+    }
+    return sinks;
+}
+
+void log_filter_retag(void)
+{
+    if (s_rules_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_rules_mutex, portMAX_DELAY);
+    for (int sink = 0; sink < LOG_SINK_COUNT; sink++) {
+        log_filter_t *f = malloc(sizeof(log_filter_t));
+        if (f == NULL || compile(&s_rules[sink], f) != ESP_OK) {
+            /* Pass everything rather than match on IDs that now mean other tags */
+            free(f);
+            f = NULL;
+            ESP_LOGW(TAG, "Sink %d: rules not recompiled, passing all lines", sink);
+        }
+        free(atomic_exchange_explicit(&s_pending[sink], NULL, memory_order_acq_rel));
+        free(s_active[sink]);
+        s_active[sink] = f;
+    }
+    xSemaphoreGive(s_rules_mutex);
+}
+
+uint32_t log_filter_rejected(log_sink_t sink)
+{
+    return sink < LOG_SINK_COUNT ? s_rejected[sink] : 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "log_parser.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Ingest-time routing of log lines to sinks.
+ *
+ * Every sink has its own rule set. A rule set is compiled once (tag names
+ * resolved to tag-ID bitmaps, levels to a bitmask, text terms
+ * pre-measured) into a matcher that the RX task evaluates per line
+ * before the line is pushed anywhere. New rules are swapped in by the
+ * RX task at the next line, so setting rules never blocks ingest.
+ */
+
+typedef enum {
+    LOG_SINK_DISPLAY = 0,   /* Log ring (UI) */
+    LOG_SINK_SD,            /* SD card log file */
+    LOG_SINK_CONSOLE,       /* ESP_LOG echo on the tool's own console */
+    LOG_SINK_NETWORK,       /* Network streaming (read from the ring) */
+    LOG_SINK_COUNT,
+} log_sink_t;
+
+#define LOG_SINK_BIT(sink)      (1u << (sink))
+#define LOG_SINK_ALL            ((1u << LOG_SINK_COUNT) - 1)
+
+#define LOG_FILTER_MAX_TAGS     (8)     /* Per include/exclude list */
+#define LOG_FILTER_MAX_TERMS    (4)     /* Per include/exclude list */
+#define LOG_FILTER_TERM_MAX_LEN (32)
+
+/**
+ * Rules for one sink. A line passes if it is enabled, its level is at
+ * least as severe as min_level, its tag is in include_tags (or the list
+ * is empty) and not in exclude_tags, and its message contains one of
+ * include_text (or the list is empty) and none of exclude_text.
+ * Text matching is case-sensitive.
+ */
+typedef struct {
+    bool    enabled;
+    char    min_level;          /* 'E', 'W', 'I', 'D' or 'V' (everything) */
+    bool    pass_unparsed;      /* Lines with no level (' ') */
+    uint8_t include_tag_count;
+    uint8_t exclude_tag_count;
+    uint8_t include_text_count;
+    uint8_t exclude_text_count;
+    char    include_tags[LOG_FILTER_MAX_TAGS][FT_LOG_TAG_MAX_LEN];
+    char    exclude_tags[LOG_FILTER_MAX_TAGS][FT_LOG_TAG_MAX_LEN];
+    char    include_text[LOG_FILTER_MAX_TERMS][LOG_FILTER_TERM_MAX_LEN];
+    char    exclude_text[LOG_FILTER_MAX_TERMS][LOG_FILTER_TERM_MAX_LEN];
+} log_filter_rules_t;
+
+/**
+ * @brief Initialize filtering (every sink passes everything except
+ *        LOG_SINK_NETWORK, which starts disabled)
+ */
+esp_err_t log_filter_init(void);
+
+/**
+ * @brief Fill rules that pass every line
+ */
+void log_filter_rules_default(log_filter_rules_t *rules);
+
+/**
+ * @brief Compile and install rules for a sink
+ *
+ * Safe to call from any task. Tags named in the rules are interned, so
+ * they match as soon as they first appear.
+ *
+ * @return ESP_ERR_INVALID_ARG for an unknown level or too many entries,
+ *         ESP_ERR_NO_MEM if the matcher can't be allocated
+ */
+esp_err_t log_filter_set_rules(log_sink_t sink, const log_filter_rules_t *rules);
+
+/**
+ * @brief Get the rules last set for a sink
+ */
+void log_filter_get_rules(log_sink_t sink, log_filter_rules_t *rules);
+
+/**
+ * @brief Decide which sinks take a line
+ *
+ * RX task only. span->tag_id must already be set.
+ *
+ * @return Bitmask of LOG_SINK_BIT() for the sinks that accept the line
+ */
+uint8_t log_filter_route(const log_span_t *span);
+
+/**
+ * @brief Recompile every sink's rules after tag_table_reset()
+ *
+ * RX task only. Tag IDs from before the reset name other tags now.
+ */
+void log_filter_retag(void);
+
+/**
+ * @brief Lines rejected by a sink's rules since boot
+ */
+uint32_t log_filter_rejected(log_sink_t sink);
@@ -0,0 +1,400 @@
+#include "log_history.h"
+#include "log_parser.h"
+#include "log_search.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+static const char *TAG = "LOG_HIST";
+
+#define TAIL_GROW   (64)        /* Blocks added per allocation step */
+
+/* ── State ───────────────────────────────────────────────────────────── */
+
+static _Atomic log_history_state_t s_state = LOG_HISTORY_CLOSED;
+static char s_path[128];
+static FILE *s_file = NULL;
+
+static log_index_block_t *s_blocks = NULL;     /* PSRAM */
+static uint32_t s_block_count = 0;
+static uint32_t s_block_cap = 0;
+static log_history_info_t s_info;
+
+static log_history_line_t s_scratch;           /* Line being tested by a search */
+static log_search_query_t s_query;              /* Compiled filter text */
+
+/* ── Line reading ────────────────────────────────────────────────────── */
+
+/*
+ * Read one line into out->text, clean it up with the span parser and
+ * fill in the header fields. Over-long lines are cut like on ingest; the
+ * rest is consumed so the next read starts on the next line.
+ */
+static bool read_line(FILE *f, log_history_line_t *out, log_span_t *span)
+{
+    if (fgets(out->text, sizeof(out->text), f) == NULL) {
+        return false;
+    }
+    size_t len = strlen(out->text);
+    if (len > 0 && out->text[len - 1] == '\n') {
+        len--;
+    } else {
+        int c;
+        while ((c = fgetc(f)) != EOF && c != '\n') {
+        }
+    }
+
+    log_parser_parse_span(out->text, len, span);
+    out->len = span->raw_len;
+    out->text[out->len] = '\0';
+    out->level = span->level;
+    out->has_ts = log_index_span_has_ts(span);
+    out->timestamp_ms = out->has_ts ? span->timestamp_ms : 0;
+    return true;
+}
+
+/* Position the file at the start of a line inside a block */
+static bool seek_line(const log_index_block_t *block, uint32_t line)
+{
+    if (fseek(s_file, block->offset, SEEK_SET) != 0) {
+        return false;
+    }
+    log_span_t span;
+    for (uint32_t n = block->first_line; n < line; n++) {
+        if (!read_line(s_file, &s_scratch, &span)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Block holding a line (binary search on first_line) */
+static int32_t block_for_line(uint32_t line)
+{
+    if (s_block_count == 0 || line >= s_info.lines) {
+        return -1;
+    }
+    uint32_t lo = 0, hi = s_block_count - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        if (s_blocks[mid].first_line <= line) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return (int32_t)lo;
+}
+
+/* ── Loading ─────────────────────────────────────────────────────────── */
+
+static bool grow_blocks(uint32_t need)
+{
+    if (need <= s_block_cap) {
+        return true;
+    }
+    uint32_t cap = need + TAIL_GROW;
+    log_index_block_t *p = heap_caps_realloc(s_blocks, cap * sizeof(log_index_block_t),
+                                             MALLOC_CAP_SPIRAM);
+    if (p == NULL) {
+        return false;
+    }
+    s_blocks = p;
+    s_block_cap = cap;
+    return true;
+}
+
+/* Load the sidecar; false if it is missing or doesn't describe this file */
+static bool load_index(uint32_t file_bytes)
+{
+    char idx_path[128];
+    log_index_path(s_path, idx_path, sizeof(idx_path));
+
+    FILE *f = fopen(idx_path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+
+    log_index_header_t hdr;
+    struct stat st;
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+              memcmp(hdr.magic, LOG_INDEX_MAGIC, sizeof(hdr.magic)) == 0 &&
+              hdr.version == LOG_INDEX_VERSION &&
+              hdr.record_size == sizeof(log_index_block_t) &&
+              stat(idx_path, &st) == 0;
+
+    /* A record cut short by power loss is ignored */
+    uint32_t count = ok ? (st.st_size - sizeof(hdr)) / sizeof(log_index_block_t) : 0;
+    ok = ok && grow_blocks(count) && fread(s_blocks, sizeof(log_index_block_t), count, f) == count;
+    fclose(f);
+    if (!ok) {
+        return false;
+    }
+
+    /* Blocks must tile the file from the start */
+    uint32_t offset = 0, line = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const log_index_block_t *b = &s_blocks[i];
+        if (b->offset != offset || b->first_line != line || b->lines == 0) {
+            ESP_LOGW(TAG, "%s: block %lu out of place", idx_path, (unsigned long)i);
+            return false;
+        }
+        offset += b->bytes;
+        line += b->lines;
+    }
+    if (offset > file_bytes) {
+        ESP_LOGW(TAG, "%s: indexes past the end of the log", idx_path);
+        return false;
+    }
+
+    s_block_count = count;
+    s_info.lines = line;
+    return true;
+}
+
+/* Index whatever follows the last block: the writer's unflushed tail */
+static bool index_tail(void)
+{
+    uint32_t offset = 0, line = 0;
+    if (s_block_count > 0) {
+        const log_index_block_t *last = &s_blocks[s_block_count - 1];
+        offset = last->offset + last->bytes;
+        line = last->first_line + last->lines;
+    }
+    if (fseek(s_file, offset, SEEK_SET) != 0) {
+        return false;
+    }
+
+    log_index_builder_t b;
+    log_index_builder_init(&b, line, offset);
+    log_index_block_t done;
+    log_span_t span;
+    while (true) {
+        long start = ftell(s_file);
+        if (!read_line(s_file, &s_scratch, &span)) {
+            break;
+        }
+        uint32_t bytes = (uint32_t)(ftell(s_file) - start);
+        if (log_index_builder_add(&b, &span, bytes, &done)) {
+            if (!grow_blocks(s_block_count + 1)) {
+                return false;
+            }
+            s_blocks[s_block_count++] = done;
+        }
+    }
+    if (log_index_builder_finish(&b, &done)) {
+        if (!grow_blocks(s_block_count + 1)) {
+            return false;
+        }
+        s_blocks[s_block_count++] = done;
+    }
+
+    s_info.tail_lines = b.next_line - line;
+    s_info.lines = b.next_line;
+    return true;
+}
+
+static void loader_task(void *arg)
+{
+    (void)arg;
+    struct stat st;
+    bool ok = stat(s_path, &st) == 0;
+    uint32_t file_bytes = ok ? (uint32_t)st.st_size : 0;
+
+    if (ok && !load_index(file_bytes)) {
+        atomic_store(&s_state, LOG_HISTORY_REBUILDING);
+        ok = log_index_rebuild(s_path) == ESP_OK && load_index(file_bytes);
+        s_info.rebuilt = true;
+    }
+
+    s_file = ok ? fopen(s_path, "r") : NULL;
+    ok = s_file != NULL && index_tail();
+
+    if (ok) {
+        s_info.blocks = s_block_count;
+        s_info.file_bytes = file_bytes;
+        ESP_LOGI(TAG, "%s: %lu lines in %lu blocks (%lu from tail scan%s)", s_path,
+                 (unsigned long)s_info.lines, (unsigned long)s_info.blocks,
+                 (unsigned long)s_info.tail_lines, s_info.rebuilt ? ", index rebuilt" : "");
+        atomic_store(&s_state, LOG_HISTORY_READY);
+    } else {
+        ESP_LOGW(TAG, "Cannot open %s", s_path);
+        atomic_store(&s_state, LOG_HISTORY_FAILED);
+    }
+    vTaskDelete(NULL);
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+esp_err_t log_history_open(const char *log_path)
+{
+    log_history_state_t state = atomic_load(&s_state);
+    if (state == LOG_HISTORY_LOADING || state == LOG_HISTORY_REBUILDING) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    log_history_close();
+
+    snprintf(s_path, sizeof(s_path), "%s", log_path);
+    memset(&s_info, 0, sizeof(s_info));
+    atomic_store(&s_state, LOG_HISTORY_LOADING);
+
+    BaseType_t ret = xTaskCreatePinnedToCore(loader_task, "log_hist", 8192, NULL, 2, NULL, 1);
+    if (ret != pdPASS) {
+        atomic_store(&s_state, LOG_HISTORY_FAILED);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void log_history_close(void)
+{
+    log_history_state_t state = atomic_load(&s_state);
+    if (state == LOG_HISTORY_LOADING || state == LOG_HISTORY_REBUILDING) {
+        return;
+    }
+    if (s_file != NULL) {
+        fclose(s_file);
+        s_file = NULL;
+    }
+    s_block_count = 0;
+    atomic_store(&s_state, LOG_HISTORY_CLOSED);
+}
+
+log_history_state_t log_history_get_state(void)
+{
+    return atomic_load(&s_state);
+}
+
+void log_history_get_info(log_history_info_t *info)
+{
+    *info = s_info;
+}
+
+size_t log_history_read(uint32_t first_line, log_history_line_t *out, size_t max)
+{
+    if (atomic_load(&s_state) != LOG_HISTORY_READY) {
+        return 0;
+    }
+    int32_t b = block_for_line(first_line);
+    if (b < 0 || !seek_line(&s_blocks[b], first_line)) {
+        return 0;
+    }
+
+    size_t n = 0;
+    log_span_t span;
+    while (n < max && first_line + n < s_info.lines && read_line(s_file, &out[n], &span)) {
+        out[n].line = first_line + n;
+        n++;
+    }
+    return n;
+}
+
+bool log_history_find_time(uint32_t ms, uint32_t *line)
+{
+    if (atomic_load(&s_state) != LOG_HISTORY_READY) {
+        return false;
+    }
+
+    /* First block covering the time, else the first one entirely after it */
+    int32_t target = -1;
+    for (uint32_t i = 0; i < s_block_count; i++) {
+        const log_index_block_t *b = &s_blocks[i];
+        if (!(b->flags & LOG_INDEX_HAS_TS)) {
+            continue;
+        }
+        if (b->min_ts_ms <= ms && ms <= b->max_ts_ms) {
+            target = i;
+            break;
+        }
+        if (b->min_ts_ms > ms && target < 0) {
+            target = i;
+        }
+    }
+    if (target < 0) {
+        return false;
+    }
+
+    const log_index_block_t *b = &s_blocks[target];
+    if (!seek_line(b, b->first_line)) {
+        return false;
+    }
+    log_span_t span;
+    for (uint32_t n = 0; n < b->lines && read_line(s_file, &s_scratch, &span); n++) {
+        if (s_scratch.has_ts && s_scratch.timestamp_ms >= ms) {
+            *line = b->first_line + n;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool line_matches(const log_span_t *span, const log_history_filter_t *filter)
+{
+    if (filter->levels != 0 && !(log_index_level_bit(span->level) & filter->levels)) {
+        return false;
+    }
+    if (filter->tag != NULL) {
+        size_t len = strlen(filter->tag);
+        if (span->tag_len != len || memcmp(span->raw + span->tag_off, filter->tag, len) != 0) {
+            return false;
+        }
+    }
+    if (filter->text != NULL && !log_search_match(&s_query, s_scratch.text, s_scratch.len)) {
+        return false;
+    }
+    return true;
+}
+
+bool log_history_find_next(uint32_t from_line, const log_history_filter_t *filter,
+                           uint32_t *line, uint32_t *skipped)
+{
+    if (skipped != NULL) {
+        *skipped = 0;
+    }
+    if (atomic_load(&s_state) != LOG_HISTORY_READY) {
+        return false;
+    }
+    int32_t first = block_for_line(from_line);
+    if (first < 0) {
+        return false;
+    }
+    if (filter->text != NULL) {
+        log_search_compile(filter->text, &s_query);
+    }
+
+    for (uint32_t i = first; i < s_block_count; i++) {
+        const log_index_block_t *b = &s_blocks[i];
+
+        /* The bitmaps only ever say "maybe", so a skip is always safe */
+        if ((filter->levels != 0 && !(b->levels & filter->levels)) ||
+            (filter->tag != NULL &&
+             !log_index_block_may_have_tag(b, filter->tag, strlen(filter->tag))) ||
+            (filter->text != NULL && !log_search_bloom_test(b->grams, &s_query))) {
+            if (skipped != NULL) {
+                (*skipped)++;
+            }
+            continue;
+        }
+
+        uint32_t start = from_line > b->first_line ? from_line : b->first_line;
+        if (!seek_line(b, start)) {
+            return false;
+        }
+        log_span_t span;
+        for (uint32_t n = start; n < b->first_line + b->lines; n++) {
+            if (!read_line(s_file, &s_scratch, &span)) {
+                return false;
+            }
+            if (line_matches(&span, filter)) {
+                *line = n;
+                return true;
+            }
+        }
+    }
+    return false;
+}
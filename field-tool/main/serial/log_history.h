@@ -0,0 +1,102 @@
+#pragma once
+
+#include "log_index.h"
+#include "app_config.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Random access into a recorded SD log through its sidecar index.
+ *
+ * Opening a log loads its .idx into PSRAM (rebuilding it first if it is
+ * missing or doesn't match the text) and indexes whatever was appended
+ * after the last complete block, which covers the file still being
+ * recorded. After that, going to a line or a time reads at most one
+ * block, and a filtered search only reads blocks whose level and tag
+ * bitmaps and trigram filter say they may contain a match.
+ *
+ * One log open at a time. Loading runs in its own task; the query
+ * functions are for a single caller (the history screen) once the state
+ * is LOG_HISTORY_READY.
+ */
+
+typedef enum {
+    LOG_HISTORY_CLOSED = 0,
+    LOG_HISTORY_LOADING,
+    LOG_HISTORY_REBUILDING,     /* No usable index, reading the whole file */
+    LOG_HISTORY_READY,
+    LOG_HISTORY_FAILED,
+} log_history_state_t;
+
+/**
+ * One line read back from the file
+ */
+typedef struct {
+    uint32_t line;              /* 0-based line number */
+    uint32_t timestamp_ms;      /* Valid if has_ts */
+    bool     has_ts;
+    char     level;             /* As log_span_t.level */
+    uint16_t len;
+    char     text[FT_LOG_LINE_MAX_LEN + 1];   /* ANSI-free, null-terminated */
+} log_history_line_t;
+
+/**
+ * Search filter (all set conditions must hold)
+ */
+typedef struct {
+    uint8_t     levels;         /* LOG_INDEX_LEVEL_* accepted, 0 = any */
+    const char *tag;            /* Exact tag, NULL = any */
+    const char *text;           /* Substring of the line, any case; NULL = any */
+} log_history_filter_t;
+
+/**
+ * Totals for the open log
+ */
+typedef struct {
+    uint32_t lines;
+    uint32_t blocks;
+    uint32_t file_bytes;
+    uint32_t tail_lines;        /* Lines indexed by the open-time tail scan */
+    bool     rebuilt;           /* The .idx had to be regenerated */
+} log_history_info_t;
+
+/**
+ * @brief Start loading a log file (returns at once; poll the state)
+ * @return ESP_ERR_INVALID_STATE while another load is running
+ */
+esp_err_t log_history_open(const char *log_path);
+
+/**
+ * @brief Release the open log
+ */
+void log_history_close(void);
+
+log_history_state_t log_history_get_state(void);
+
+void log_history_get_info(log_history_info_t *info);
+
+/**
+ * @brief Read consecutive lines
+ * @return Lines read (fewer at the end of the file)
+ */
+size_t log_history_read(uint32_t first_line, log_history_line_t *out, size_t max);
+
+/**
+ * @brief First line logged at or after a target time
+ *
+ * Targets reboot and restart their clock, so the first block whose range
+ * covers @p ms wins; failing that, the first line stamped later than it.
+ *
+ * @return false if no line is that late
+ */
+bool log_history_find_time(uint32_t ms, uint32_t *line);
+
+/**
+ * @brief Next line at or after @p from_line that passes a filter
+ * @param skipped  Receives how many blocks the index let us skip (may be NULL)
+ * @return false if there is none
+ */
+bool log_history_find_next(uint32_t from_line, const log_history_filter_t *filter,
+                           uint32_t *line, uint32_t *skipped);
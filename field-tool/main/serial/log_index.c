@@ -0,0 +1,191 @@
+#include "log_index.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char *TAG = "LOG_INDEX";
+
+/* ── Bits ────────────────────────────────────────────────────────────── */
+
+uint8_t log_index_level_bit(char level)
+{
+    switch (level) {
+    case 'E': return LOG_INDEX_LEVEL_E;
+    case 'W': return LOG_INDEX_LEVEL_W;
+    case 'I': return LOG_INDEX_LEVEL_I;
+    case 'D': return LOG_INDEX_LEVEL_D;
+    case 'V': return LOG_INDEX_LEVEL_V;
+    default:  return LOG_INDEX_LEVEL_OTHER;
+    }
+}
+
+/* FNV-1a folded to 8 bits */
+uint32_t log_index_tag_bit(const char *tag, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)tag[i]) * 16777619u;
+    }
+    return (h ^ (h >> 8) ^ (h >> 16) ^ (h >> 24)) & 0xFF;
+}
+
+bool log_index_block_may_have_tag(const log_index_block_t *block, const char *tag, size_t len)
+{
+    uint32_t bit = log_index_tag_bit(tag, len);
+    return (block->tags[bit / 32] >> (bit % 32)) & 1;
+}
+
+bool log_index_span_has_ts(const log_span_t *span)
+{
+    return span->msg_off > 3 && span->raw[1] == ' ' && span->raw[2] == '(';
+}
+
+/* ── Builder ─────────────────────────────────────────────────────────── */
+
+static void start_block(log_index_builder_t *b)
+{
+    memset(&b->cur, 0, sizeof(b->cur));
+    b->cur.offset = b->next_offset;
+    b->cur.first_line = b->next_line;
+}
+
+void log_index_builder_init(log_index_builder_t *b, uint32_t first_line, uint32_t offset)
+{
+    b->next_line = first_line;
+    b->next_offset = offset;
+    start_block(b);
+}
+
+bool log_index_builder_add(log_index_builder_t *b, const log_span_t *span, uint32_t bytes,
+                           log_index_block_t *done)
+{
+    log_index_block_t *blk = &b->cur;
+
+    blk->lines++;
+    blk->bytes += bytes;
+    blk->levels |= log_index_level_bit(span->level);
+    if (span->tag_len > 0) {
+        uint32_t bit = log_index_tag_bit(span->raw + span->tag_off, span->tag_len);
+        blk->tags[bit / 32] |= 1u << (bit % 32);
+    }
+    log_search_bloom_add(blk->grams, span->raw, span->raw_len);
+    if (log_index_span_has_ts(span)) {
+        if (!(blk->flags & LOG_INDEX_HAS_TS)) {
+            blk->min_ts_ms = span->timestamp_ms;
+            blk->max_ts_ms = span->timestamp_ms;
+            blk->flags |= LOG_INDEX_HAS_TS;
+        } else if (span->timestamp_ms < blk->min_ts_ms) {
+            blk->min_ts_ms = span->timestamp_ms;
+        } else if (span->timestamp_ms > blk->max_ts_ms) {
+            blk->max_ts_ms = span->timestamp_ms;
+        }
+    }
+
+    b->next_line++;
+    b->next_offset += bytes;
+    if (blk->lines < FT_LOG_INDEX_BLOCK_LINES) {
+        return false;
+    }
+    *done = *blk;
+    start_block(b);
+    return true;
+}
+
+bool log_index_builder_finish(log_index_builder_t *b, log_index_block_t *done)
+{
+    if (b->cur.lines == 0) {
+        return false;
+    }
+    *done = b->cur;
+    start_block(b);
+    return true;
+}
+
+/* ── Files ───────────────────────────────────────────────────────────── */
+
+void log_index_path(const char *log_path, char *out, size_t out_len)
+{
+    snprintf(out, out_len, "%s", log_path);
+    char *dot = strrchr(out, '.');
+    char *slash = strrchr(out, '/');
+    size_t len = strlen(out);
+    if (dot != NULL && (slash == NULL || dot > slash)) {
+        len = dot - out;
+    }
+    if (len + 5 <= out_len) {
+        memcpy(out + len, ".idx", 5);
+    }
+}
+
+esp_err_t log_index_write_header(int fd)
+{
+    log_index_header_t hdr = {
+        .magic = { 'F', 'T', 'I', 'X' },
+        .version = LOG_INDEX_VERSION,
+        .block_lines = FT_LOG_INDEX_BLOCK_LINES,
+        .record_size = sizeof(log_index_block_t),
+    };
+    return write(fd, &hdr, sizeof(hdr)) == sizeof(hdr) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t log_index_rebuild(const char *log_path)
+{
+    char idx_path[128];
+    log_index_path(log_path, idx_path, sizeof(idx_path));
+
+    FILE *in = fopen(log_path, "r");
+    if (in == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    int out = open(idx_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        fclose(in);
+        return ESP_FAIL;
+    }
+
+    esp_err_t ret = log_index_write_header(out);
+    log_index_builder_t b;
+    log_index_builder_init(&b, 0, 0);
+    log_index_block_t done;
+    char line[FT_LOG_LINE_MAX_LEN + 2];
+    log_span_t span;
+    uint32_t blocks = 0;
+
+    while (ret == ESP_OK && fgets(line, sizeof(line), in) != NULL) {
+        size_t len = strlen(line);
+        bool complete = (len > 0 && line[len - 1] == '\n');
+        uint32_t bytes = len;
+
+        /* Over-long line: the rest belongs to the same line */
+        if (!complete) {
+            int c;
+            while ((c = fgetc(in)) != EOF) {
+                bytes++;
+                if (c == '\n') {
+                    break;
+                }
+            }
+        } else {
+            len--;
+        }
+
+        log_parser_parse_span(line, len, &span);
+        if (log_index_builder_add(&b, &span, bytes, &done)) {
+            ret = write(out, &done, sizeof(done)) == sizeof(done) ? ESP_OK : ESP_FAIL;
+            blocks++;
+        }
+    }
+    if (ret == ESP_OK && log_index_builder_finish(&b, &done)) {
+        ret = write(out, &done, sizeof(done)) == sizeof(done) ? ESP_OK : ESP_FAIL;
+        blocks++;
+    }
+
+    fclose(in);
+    close(out);
+    ESP_LOGI(TAG, "Rebuilt %s: %lu lines, %lu blocks", idx_path,
+             (unsigned long)b.next_line, (unsigned long)blocks);
+    return ret;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "log_parser.h"
+#include "log_search.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Sidecar index for SD log files.
+ *
+ * Every log_<uptime>.txt gets a log_<uptime>.idx written next to it. The
+ * index is a header followed by one fixed-size record per block of
+ * FT_LOG_INDEX_BLOCK_LINES lines: where the block starts, its target
+ * timestamp range, and bitmaps of the levels and tags it contains. A
+ * reader can seek to any line or time by binary search and skip blocks
+ * that cannot match a filter without reading them.
+ *
+ * Tags are hashed by name into a 256-bit bitmap (a one-hash Bloom
+ * filter), so the index stays valid across reboots and tag-table
+ * sessions; a set bit means "may contain". Each record also carries the
+ * block's trigram filter (log_search.h) for text search.
+ */
+
+#define LOG_INDEX_MAGIC     "FTIX"
+#define LOG_INDEX_VERSION   (2)
+
+/* Level bits in log_index_block_t.levels */
+#define LOG_INDEX_LEVEL_E      (1 << 0)
+#define LOG_INDEX_LEVEL_W      (1 << 1)
+#define LOG_INDEX_LEVEL_I      (1 << 2)
+#define LOG_INDEX_LEVEL_D      (1 << 3)
+#define LOG_INDEX_LEVEL_V      (1 << 4)
+#define LOG_INDEX_LEVEL_OTHER  (1 << 5)    /* Unparsed lines, markers */
+
+/* Block flags */
+#define LOG_INDEX_HAS_TS       (1 << 0)    /* At least one line had a timestamp */
+
+#define LOG_INDEX_TAG_WORDS    (8)         /* 256-bit tag bitmap */
+
+/**
+ * On-card file header
+ */
+typedef struct {
+    char     magic[4];
+    uint16_t version;
+    uint16_t block_lines;       /* FT_LOG_INDEX_BLOCK_LINES when written */
+    uint32_t record_size;       /* sizeof(log_index_block_t) */
+} log_index_header_t;
+
+/**
+ * One block of consecutive lines (on-card record)
+ */
+typedef struct {
+    uint32_t offset;            /* File offset of the block's first line */
+    uint32_t bytes;             /* Bytes in the block, newlines included */
+    uint32_t first_line;        /* 0-based line number of the first line */
+    uint32_t min_ts_ms;         /* Target timestamp range (LOG_INDEX_HAS_TS) */
+    uint32_t max_ts_ms;
+    uint16_t lines;
+    uint8_t  levels;            /* LOG_INDEX_LEVEL_* present */
+    uint8_t  flags;             /* LOG_INDEX_HAS_TS */
+    uint32_t tags[LOG_INDEX_TAG_WORDS];
+    uint8_t  grams[FT_LOG_SEARCH_BLOOM_BYTES];     /* Trigram filter of the text */
+} log_index_block_t;
+
+/**
+ * Accumulates lines into blocks
+ */
+typedef struct {
+    log_index_block_t cur;
+    uint32_t next_line;
+    uint32_t next_offset;
+} log_index_builder_t;
+
+/**
+ * @brief Start building at a given line number and file offset
+ */
+void log_index_builder_init(log_index_builder_t *b, uint32_t first_line, uint32_t offset);
+
+/**
+ * @brief Account for one line
+ * @param span   The parsed line
+ * @param bytes  Bytes the line takes in the file (newline included)
+ * @param done   Receives the block if this line completed one
+ * @return true if @p done was filled
+ */
+bool log_index_builder_add(log_index_builder_t *b, const log_span_t *span, uint32_t bytes,
+                           log_index_block_t *done);
+
+/**
+ * @brief Close the partial block, if any
+ * @return true if @p done was filled
+ */
+bool log_index_builder_finish(log_index_builder_t *b, log_index_block_t *done);
+
+/**
+ * @brief Level bit for a level character
+ */
+uint8_t log_index_level_bit(char level);
+
+/**
+ * @brief Bit number of a tag name in the tag bitmap
+ */
+uint32_t log_index_tag_bit(const char *tag, size_t len);
+
+/**
+ * @brief Whether a block may contain a tag (false = certainly not)
+ */
+bool log_index_block_may_have_tag(const log_index_block_t *block, const char *tag, size_t len);
+
+/**
+ * @brief Whether a span has a real "X (12345) TAG: " timestamp
+ *
+ * Colorized lines can get a level from their color with no timestamp.
+ */
+bool log_index_span_has_ts(const log_span_t *span);
+
+/**
+ * @brief Index file name for a log file (".txt" -> ".idx")
+ */
+void log_index_path(const char *log_path, char *out, size_t out_len);
+
+/**
+ * @brief Write a fresh index file header
+ * @return ESP_FAIL on a write error
+ */
+esp_err_t log_index_write_header(int fd);
+
+/**
+ * @brief Rebuild the index of a log file by reading it start to finish
+ *
+ * For captures recorded before indexing existed, or whose index is
+ * missing or damaged. Slow (reads the whole file) — run off the UI task.
+ */
+esp_err_t log_index_rebuild(const char *log_path);
@@ -1,62 +1,276 @@
 #include "log_parser.h"
 #include <string.h>
-#include <stdlib.h>
-#include <stdio.h>
 
-bool log_parser_parse(const char *line, log_entry_t *entry)
+/* Copy len bytes into a fixed buffer, truncating and null-terminating */
+static void copy_field(char *dst, size_t dst_size, const char *src, size_t len)
 {
-    memset(entry, 0, sizeof(*entry));
-    snprintf(entry->raw, sizeof(entry->raw), "%s", line);
+    if (len >= dst_size) {
+        len = dst_size - 1;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
 
-    /* Must start with a valid log level character */
-    if (line[0] != 'I' && line[0] != 'W' && line[0] != 'E' &&
-        line[0] != 'D' && line[0] != 'V') {
-        /* Not a standard ESP-IDF log line — store as-is */
-        entry->level = ' ';
-        snprintf(entry->message, sizeof(entry->message), "%s", line);
-        return false;
+#define ESC  '\033'
+
+static inline bool is_level_char(char c)
+{
+    return c == 'I' || c == 'W' || c == 'E' || c == 'D' || c == 'V';
+}
+
+/* Level implied by an SGR foreground color (ESP-IDF's LOG_COLOR_E/W/I) */
+static char level_from_color(int fg)
+{
+    switch (fg) {
+    case 31: case 91: return 'E';
+    case 33: case 93: return 'W';
+    case 32: case 92: return 'I';
+    default:          return ' ';
+    }
+}
+
+/*
+ * Skip one escape sequence starting at p (which points at ESC). SGR
+ * sequences ("ESC [ 0 ; 32 m") report their first foreground color via
+ * *fg. Returns the number of bytes consumed.
+ */
+static size_t skip_escape(const char *p, const char *end, int *fg)
+{
+    if (p + 1 >= end || p[1] != '[') {
+        return (p + 1 < end) ? 2 : 1;   /* Two-byte escape, or a stray ESC */
     }
 
-    /* Check for " (" after the level character */
-    if (line[1] != ' ' || line[2] != '(') {
-        entry->level = ' ';
-        snprintf(entry->message, sizeof(entry->message), "%s", line);
-        return false;
+    const char *q = p + 2;
+    int param = 0;
+    for (; q < end; q++) {
+        char c = *q;
+        if (c >= '0' && c <= '9') {
+            if (param < 1000) {     /* Long digit runs are no color anyway */
+                param = param * 10 + (c - '0');
+            }
+            continue;
+        }
+        bool sgr = (c == 'm');
+        if ((c == ';' || sgr) && *fg < 0 &&
+            ((param >= 30 && param <= 37) || (param >= 90 && param <= 97))) {
+            *fg = param;
+        }
+        if (c != ';') {
+            q++;        /* Final byte ends the sequence */
+            break;
+        }
+        param = 0;
+    }
+    return q - p;
+}
+
+/* Header parser states, one step per visible byte */
+typedef enum {
+    ST_LEVEL,       /* Expect the level letter */
+    ST_SPACE,       /* Expect ' ' */
+    ST_PAREN,       /* Expect '(' */
+    ST_TS,          /* Timestamp digits up to ')' */
+    ST_AFTER_TS,    /* The byte after ')' (normally ' ') */
+    ST_TAG,         /* Tag text up to ':' */
+    ST_TAG_COLON,   /* Just saw ':' — ' ' ends the tag */
+    ST_BODY,        /* Header done, rest is message */
+    ST_RAW,         /* Not an ESP-IDF header, whole line is message */
+} parse_state_t;
+
+/*
+ * Single pass over the line. Escape sequences are stripped in place as
+ * they are met (colorized logs from CONFIG_LOG_COLORS), and the header
+ * fields are recognized from the remaining visible bytes by a small
+ * state machine. Once the header is done, the body is moved in
+ * memchr/memmove segments between escapes, so plain lines cost one
+ * memchr over the message and nothing else. No copies, no formatting,
+ * no library number parsing.
+ *
+ * Timestamps are either milliseconds since boot ("(12345)") or, with
+ * CONFIG_LOG_TIMESTAMP_SOURCE_SYSTEM, time of day ("(12:34:56.789)"),
+ * which is converted to milliseconds since midnight.
+ */
+bool log_parser_parse_span(char *line, size_t len, log_span_t *span)
+{
+    if (len > FT_LOG_LINE_MAX_LEN) {
+        len = FT_LOG_LINE_MAX_LEN;
     }
 
-    entry->level = line[0];
+    const char *end = line + len;
+    const char *r = line;       /* Read position */
+    char *w = line;             /* Write position (lags r once escapes are stripped) */
+    parse_state_t st = ST_LEVEL;
+    char level = ' ';
+    int fg = -1;
+    uint32_t ts = 0, val = 0;
+    bool clock = false, frac = false;
+    size_t tag_off = 0, tag_len = 0, colon = 0, msg_off = 0;
 
-    /* Parse timestamp: "(12345) " */
-    const char *ts_start = line + 3;
-    const char *ts_end = strchr(ts_start, ')');
-    if (ts_end == NULL) {
-        entry->level = ' ';
-        snprintf(entry->message, sizeof(entry->message), "%s", line);
-        return false;
+    /* Header: byte at a time */
+    while (r < end && st != ST_BODY && st != ST_RAW) {
+        if (*r == ESC) {
+            r += skip_escape(r, end, &fg);
+            continue;
+        }
+        char c = *r++;
+        *w++ = c;
+
+        switch (st) {
+        case ST_LEVEL:
+            st = is_level_char(c) ? ST_SPACE : ST_RAW;
+            level = c;
+            break;
+        case ST_SPACE:
+            st = (c == ' ') ? ST_PAREN : ST_RAW;
+            break;
+        case ST_PAREN:
+            st = (c == '(') ? ST_TS : ST_RAW;
+            break;
+        case ST_TS:
+            if (c >= '0' && c <= '9') {
+                val = val * 10 + (uint32_t)(c - '0');
+            } else if (c == ':') {
+                ts = (ts + val) * 60;
+                val = 0;
+                clock = true;
+            } else if (c == '.') {
+                ts = (ts + val) * 1000;
+                val = 0;
+                frac = true;
+            } else if (c == ')') {
+                st = ST_AFTER_TS;
+            }
+            break;
+        case ST_AFTER_TS:
+            tag_off = w - line;
+            st = ST_TAG;
+            break;
+        case ST_TAG:
+            if (c == ':') {
+                colon = w - line - 1;
+                st = ST_TAG_COLON;
+            }
+            break;
+        case ST_TAG_COLON:
+            if (c == ' ') {
+                tag_len = colon - tag_off;
+                msg_off = w - line;
+                st = ST_BODY;
+            } else if (c != ':') {
+                st = ST_TAG;
+            } else {
+                colon = w - line - 1;
+            }
+            break;
+        case ST_BODY:
+        case ST_RAW:
+            break;
+        }
+    }
+
+    /* Body: move the segments between escapes */
+    while (r < end) {
+        const char *esc = memchr(r, ESC, end - r);
+        const char *seg_end = esc ? esc : end;
+        if (w != r) {
+            memmove(w, r, seg_end - r);
+        }
+        w += seg_end - r;
+        r = seg_end;
+        if (esc) {
+            r += skip_escape(r, end, &fg);
+        }
     }
 
-    entry->timestamp_ms = (uint32_t)strtoul(ts_start, NULL, 10);
+    span->raw = line;
+    span->raw_len = (uint16_t)(w - line);
+    span->timestamp_ms = 0;
+    span->tag_off = 0;
+    span->tag_len = 0;
+    span->tag_id = 0;
+    span->sinks = 0;
+    span->rx_us = 0;
 
-    /* After ") " comes the tag, then ": ", then the message */
-    const char *tag_start = ts_end + 2; /* skip ") " */
-    const char *colon = strstr(tag_start, ": ");
-    if (colon == NULL) {
-        /* No colon separator — treat rest as message */
-        snprintf(entry->message, sizeof(entry->message), "%s", tag_start);
-        return true;
+    /* Where did the header stop? */
+    bool parsed = true;
+    switch (st) {
+    case ST_LEVEL:
+    case ST_SPACE:
+    case ST_PAREN:
+    case ST_TS:
+    case ST_RAW:
+        /* Not a standard ESP-IDF log line — the whole line is the message */
+        parsed = false;
+        break;
+    case ST_AFTER_TS:
+        msg_off = span->raw_len;
+        break;
+    case ST_TAG:
+    case ST_TAG_COLON:
+        /* No colon separator — rest of the line is the message */
+        msg_off = tag_off;
+        break;
+    case ST_BODY:
+        break;
     }
 
-    /* Extract tag */
-    size_t tag_len = colon - tag_start;
-    if (tag_len >= sizeof(entry->tag)) {
-        tag_len = sizeof(entry->tag) - 1;
+    if (!parsed) {
+        /* Colorized line without a level letter — take the level from its color */
+        span->level = level_from_color(fg);
+        span->msg_off = 0;
+        return false;
     }
-    memcpy(entry->tag, tag_start, tag_len);
-    entry->tag[tag_len] = '\0';
 
-    /* Extract message */
-    const char *msg_start = colon + 2;
-    snprintf(entry->message, sizeof(entry->message), "%s", msg_start);
+    if (frac) {
+        ts += val;
+    } else if (clock) {
+        ts = (ts + val) * 1000;
+    } else {
+        ts = val;
+    }
+    if (tag_len >= FT_LOG_TAG_MAX_LEN) {
+        tag_len = FT_LOG_TAG_MAX_LEN - 1;
+    }
 
+    span->level = level;
+    span->timestamp_ms = ts;
+    span->tag_off = (uint16_t)tag_off;
+    span->tag_len = (uint8_t)tag_len;
+    span->msg_off = (uint16_t)msg_off;
     return true;
 }
+
+size_t log_span_copy_tag(const log_span_t *span, char *buf, size_t buf_size)
+{
+    copy_field(buf, buf_size, span->raw + span->tag_off, span->tag_len);
+    return span->tag_len < buf_size ? span->tag_len : buf_size - 1;
+}
+
+size_t log_span_copy_message(const log_span_t *span, char *buf, size_t buf_size)
+{
+    size_t len = log_span_msg_len(span);
+    copy_field(buf, buf_size, span->raw + span->msg_off, len);
+    return len < buf_size ? len : buf_size - 1;
+}
+
+void log_parser_span_to_entry(const log_span_t *span, log_entry_t *entry)
+{
+    entry->level = span->level;
+    entry->timestamp_ms = span->timestamp_ms;
+    log_span_copy_tag(span, entry->tag, sizeof(entry->tag));
+    log_span_copy_message(span, entry->message, sizeof(entry->message));
+    copy_field(entry->raw, sizeof(entry->raw), span->raw, span->raw_len);
+}
+
+bool log_parser_parse(const char *line, log_entry_t *entry)
+{
+    /* The span parser strips escapes in place, so work on a copy */
+    char buf[FT_LOG_LINE_MAX_LEN];
+    size_t len = strnlen(line, sizeof(buf));
+    memcpy(buf, line, len);
+
+    log_span_t span;
+    bool ok = log_parser_parse_span(buf, len, &span);
+    log_parser_span_to_entry(&span, entry);
+    return ok;
+}
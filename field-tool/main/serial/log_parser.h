@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "app_config.h"
 
 /**
@@ -15,6 +16,30 @@ typedef struct {
     char     raw[FT_LOG_MSG_MAX_LEN + 48];  /* Original raw line for SD card storage */
 } log_entry_t;
 
+/**
+ * Zero-copy view of a log line: the raw bytes plus where each field lives
+ * inside them. The raw bytes are not copied and not null-terminated, so
+ * the span is only valid while the buffer it points into is.
+ */
+typedef struct {
+    const char *raw;            /* Raw line bytes */
+    uint16_t    raw_len;
+    uint16_t    msg_off;        /* Message is raw[msg_off .. raw_len) */
+    uint16_t    tag_off;        /* Tag is raw[tag_off .. tag_off + tag_len) */
+    uint8_t     tag_len;        /* 0 if the line has no tag */
+    uint16_t    tag_id;         /* Interned tag (tag_table.h), 0 if none/not yet interned */
+    uint8_t     sinks;          /* Sinks that took the line (log_filter.h), set at ingest */
+    char        level;          /* Same meaning as log_entry_t.level */
+    uint32_t    timestamp_ms;
+    int64_t     rx_us;          /* esp_timer time the line's end arrived over USB, 0 if unknown */
+} log_span_t;
+
+/* Length of the message part of a span */
+static inline uint16_t log_span_msg_len(const log_span_t *span)
+{
+    return span->raw_len - span->msg_off;
+}
+
 /**
  * @brief Parse a single line of ESP-IDF log output.
  *
@@ -28,3 +53,43 @@ typedef struct {
  * @return true if parsed as a valid ESP-IDF log line
  */
 bool log_parser_parse(const char *line, log_entry_t *entry);
+
+/**
+ * @brief Parse a line into a span without copying any bytes.
+ *
+ * Same rules as log_parser_parse(); unparsed lines get level ' ' and the
+ * whole line as the message. Walks the line once and never allocates,
+ * so it is the one to use on the ingest path; materialize strings from
+ * the span only where they are needed.
+ *
+ * ANSI escape sequences (CONFIG_LOG_COLORS output) are stripped in place
+ * during the same pass, so the span and @p line afterwards hold only the
+ * visible text. A colorized line with no level letter gets its level
+ * from the color (red 'E', yellow 'W', green 'I').
+ *
+ * @param line  Raw line bytes (no trailing newline, need not be
+ *              terminated); modified in place
+ * @param len   Number of bytes (clamped to FT_LOG_LINE_MAX_LEN)
+ * @param span  Output span pointing into @p line
+ * @return true if parsed as a valid ESP-IDF log line
+ */
+bool log_parser_parse_span(char *line, size_t len, log_span_t *span);
+
+/**
+ * @brief Copy the tag out of a span as a C string (truncated to fit)
+ * @return Length of the copied string
+ */
+size_t log_span_copy_tag(const log_span_t *span, char *buf, size_t buf_size);
+
+/**
+ * @brief Copy the message out of a span as a C string (truncated to fit)
+ * @return Length of the copied string
+ */
+size_t log_span_copy_message(const log_span_t *span, char *buf, size_t buf_size);
+
+/**
+ * @brief Copy a span's fields into a fixed-size log entry
+ *
+ * Fields longer than the entry's buffers are truncated.
+ */
+void log_parser_span_to_entry(const log_span_t *span, log_entry_t *entry);
@@ -0,0 +1,246 @@
+#include "log_ring.h"
+#include "tag_table.h"
+#include "log_codec.h"
+#include <string.h>
+
+/*
+ * Synchronization (seqlock-style, single writer):
+ *
+ *   writer: advance tail_seq past lines it is about to overwrite,
+ *           release fence, overwrite bytes + slot, publish head_seq.
+ *   reader: check seq is in [tail, head), copy bytes + slot,
+ *           acquire fence, re-check tail — if the line was evicted in the
+ *           meantime the copy may be torn and is thrown away.
+ *
+ * Sequence numbers are compared with signed differences so they may wrap.
+ */
+
+static inline bool seq_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+/* Move tail_seq forward to new_tail unless someone (clear) already moved it further */
+static void advance_tail(log_ring_t *ring, uint32_t new_tail)
+{
+    uint32_t cur = atomic_load_explicit(&ring->tail_seq, memory_order_relaxed);
+    while (seq_before(cur, new_tail) &&
+           !atomic_compare_exchange_weak_explicit(&ring->tail_seq, &cur, new_tail,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+void log_ring_init(log_ring_t *ring, char *arena, uint32_t arena_size,
+                   log_ring_slot_t *slots, uint32_t slot_count)
+{
+    ring->arena = arena;
+    ring->arena_mask = arena_size - 1;
+    ring->slots = slots;
+    ring->slot_mask = slot_count - 1;
+    ring->head_pos = 0;
+    atomic_init(&ring->head_seq, 0);
+    atomic_init(&ring->tail_seq, 0);
+}
+
+void log_ring_push(log_ring_t *ring, const log_span_t *span)
+{
+    const char *src = span->raw;
+    uint32_t len = span->raw_len;
+    uint8_t flags = 0;
+
+    /* Drop the header bytes if they can be rebuilt exactly on read */
+    if (span->tag_id != 0 && span->tag_len > 0 &&
+        span->tag_len == tag_table_name_len(span->tag_id)) {
+        char header[LOG_CODEC_HEADER_MAX(FT_LOG_TAG_MAX_LEN)];
+        size_t n = log_codec_format_header(header, span->level, span->timestamp_ms,
+                                           span->raw + span->tag_off, span->tag_len);
+        if (n == span->msg_off && memcmp(header, span->raw, n) == 0) {
+            src += n;
+            len -= n;
+            flags |= LOG_RING_SLOT_COMPACT;
+        }
+    }
+    if (len > FT_LOG_LINE_MAX_LEN) {
+        len = FT_LOG_LINE_MAX_LEN;
+    }
+
+    /* Lines never wrap inside the arena: skip the tail if this one won't fit */
+    uint32_t off = ring->head_pos & ring->arena_mask;
+    if (off + len > ring->arena_mask + 1) {
+        ring->head_pos += (ring->arena_mask + 1) - off;
+        off = 0;
+    }
+    uint32_t end = ring->head_pos + len;
+
+    /* Evict oldest lines until both the slot and its bytes are free.
+     * Lines sit in the arena in sequence order, so the oldest line's
+     * position bounds the bytes still in use. */
+    uint32_t head = atomic_load_explicit(&ring->head_seq, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail_seq, memory_order_relaxed);
+    uint32_t new_tail = tail;
+    while (new_tail != head) {
+        const log_ring_slot_t *oldest = &ring->slots[new_tail & ring->slot_mask];
+        bool slots_full = (head - new_tail) > ring->slot_mask;
+        bool arena_full = (end - oldest->pos) > ring->arena_mask + 1;
+        if (!slots_full && !arena_full) {
+            break;
+        }
+        new_tail++;
+    }
+    if (new_tail != tail) {
+        advance_tail(ring, new_tail);
+    }
+
+    /* Readers must see the new tail before any of the bytes we overwrite */
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(ring->arena + off, src, len);
+
+    log_ring_slot_t *slot = &ring->slots[head & ring->slot_mask];
+    slot->rx_us = span->rx_us;
+    slot->pos = ring->head_pos;
+    slot->timestamp_ms = span->timestamp_ms;
+    slot->len = (uint16_t)len;
+    slot->tag_id = span->tag_id;
+    slot->level = span->level;
+    slot->flags = flags;
+    slot->sinks = span->sinks;
+    slot->tag_gen = tag_table_generation();
+
+    ring->head_pos = end;
+    atomic_store_explicit(&ring->head_seq, head + 1, memory_order_release);
+}
+
+uint32_t log_ring_first_seq(const log_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->tail_seq, memory_order_acquire);
+}
+
+uint32_t log_ring_next_seq(const log_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->head_seq, memory_order_acquire);
+}
+
+uint32_t log_ring_count(const log_ring_t *ring)
+{
+    uint32_t tail = log_ring_first_seq(ring);
+    uint32_t head = log_ring_next_seq(ring);
+    return seq_before(tail, head) ? head - tail : 0;
+}
+
+log_ring_read_t log_ring_read(const log_ring_t *ring, uint32_t seq,
+                              char *buf, size_t buf_size, log_span_t *span)
+{
+    if (!seq_before(seq, log_ring_next_seq(ring))) {
+        return LOG_RING_READ_PENDING;
+    }
+    if (seq_before(seq, log_ring_first_seq(ring))) {
+        return LOG_RING_READ_OVERWRITTEN;
+    }
+
+    /* Copy first, validate after — a torn slot can't send us outside the arena */
+    log_ring_slot_t slot = ring->slots[seq & ring->slot_mask];
+    uint32_t off = slot.pos & ring->arena_mask;
+    uint32_t len = slot.len;
+    if (off + len > ring->arena_mask + 1) {
+        len = ring->arena_mask + 1 - off;
+    }
+
+    /* Compact lines get their header rebuilt in front of the message,
+     * with the tag name the ID had when the line was stored */
+    char header[LOG_CODEC_HEADER_MAX(FT_LOG_TAG_MAX_LEN)];
+    char tag[FT_LOG_TAG_MAX_LEN];
+    size_t header_len = 0;
+    size_t tag_off = 0;
+    uint8_t tag_len = 0;
+    if (slot.flags & LOG_RING_SLOT_COMPACT) {
+        tag_len = tag_table_copy_name(slot.tag_id, slot.tag_gen, tag);
+        header_len = log_codec_format_header(header, slot.level, slot.timestamp_ms, tag,
+                                             tag_len);
+        tag_off = header_len - tag_len - 2;     /* Where "TAG: " starts */
+        if (header_len > buf_size) {
+            header_len = buf_size;
+        }
+    }
+    if (header_len + len > buf_size) {
+        len = (uint32_t)(buf_size - header_len);
+    }
+    memcpy(buf + header_len, ring->arena + off, len);
+
+    atomic_thread_fence(memory_order_acquire);
+    if (seq_before(seq, atomic_load_explicit(&ring->tail_seq, memory_order_relaxed))) {
+        return LOG_RING_READ_OVERWRITTEN;
+    }
+
+    if (slot.flags & LOG_RING_SLOT_COMPACT) {
+        memcpy(buf, header, header_len);
+        span->raw = buf;
+        span->raw_len = (uint16_t)(header_len + len);
+        span->tag_off = (uint16_t)tag_off;
+        span->tag_len = tag_len;
+        span->msg_off = (uint16_t)header_len;
+        if (tag_off + span->tag_len > span->raw_len) {
+            span->tag_len = 0;
+        }
+    } else {
+        /* Stored verbatim (odd header or untagged) — find the fields again */
+        log_parser_parse_span(buf, len, span);
+    }
+    /* IDs from before a tag table reset mean nothing now */
+    span->tag_id = slot.tag_gen == tag_table_generation() ? slot.tag_id : TAG_ID_NONE;
+    span->sinks = slot.sinks;
+    span->level = slot.level;
+    span->timestamp_ms = slot.timestamp_ms;
+    span->rx_us = slot.rx_us;
+    return LOG_RING_READ_OK;
+}
+
+log_ring_read_t log_ring_peek_sinks(const log_ring_t *ring, uint32_t seq, uint8_t *sinks)
+{
+    if (!seq_before(seq, log_ring_next_seq(ring))) {
+        return LOG_RING_READ_PENDING;
+    }
+    uint8_t value = ring->slots[seq & ring->slot_mask].sinks;
+
+    atomic_thread_fence(memory_order_acquire);
+    if (seq_before(seq, atomic_load_explicit(&ring->tail_seq, memory_order_relaxed))) {
+        return LOG_RING_READ_OVERWRITTEN;
+    }
+    *sinks = value;
+    return LOG_RING_READ_OK;
+}
+
+void log_ring_cursor_init(const log_ring_t *ring, log_ring_cursor_t *cursor)
+{
+    cursor->seq = log_ring_first_seq(ring);
+    cursor->lost = 0;
+}
+
+bool log_ring_cursor_next(const log_ring_t *ring, log_ring_cursor_t *cursor,
+                          char *buf, size_t buf_size, log_span_t *span)
+{
+    while (true) {
+        switch (log_ring_read(ring, cursor->seq, buf, buf_size, span)) {
+        case LOG_RING_READ_OK:
+            cursor->seq++;
+            return true;
+        case LOG_RING_READ_PENDING:
+            return false;
+        case LOG_RING_READ_OVERWRITTEN: {
+            /* Lapped by the writer — skip to the oldest line still held */
+            uint32_t first = log_ring_first_seq(ring);
+            if (seq_before(cursor->seq, first)) {
+                cursor->lost += first - cursor->seq;
+                cursor->seq = first;
+            }
+            break;
+        }
+        }
+    }
+}
+
+void log_ring_clear(log_ring_t *ring)
+{
+    advance_tail(ring, log_ring_next_seq(ring));
+}
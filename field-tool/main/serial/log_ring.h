@@ -0,0 +1,151 @@
+#pragma once
+
+#include "log_parser.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/**
+ * Packed, variable-length log line store.
+ *
+ * Each line is kept exactly once as its raw bytes in a byte arena. A slot
+ * table holds the per-line metadata (level, timestamp, tag ID) and the
+ * arena position of the bytes. When either the arena or the slot table
+ * runs out of room the oldest lines are evicted.
+ *
+ * Lines whose header is in canonical ESP-IDF form ("I (123) TAG: ") are
+ * stored compact: only the message bytes go into the arena and the
+ * header is rebuilt from the slot and the tag table on read.
+ *
+ * Lines are identified by a 32-bit sequence number that increases by one
+ * per line and is never reused (until it wraps). The ring is lock-free
+ * with exactly one writer (log_ring_push) and any number of readers:
+ * readers copy a line out and then check that it was not evicted while
+ * they were copying, so they never block the writer and never return a
+ * torn line.
+ */
+
+#define LOG_RING_SLOT_COMPACT  (1 << 0)   /* Arena holds the message only */
+
+/**
+ * Per-line metadata (24 bytes)
+ */
+typedef struct {
+    int64_t  rx_us;             /* span->rx_us at push */
+    uint32_t pos;               /* Absolute arena position of the stored bytes */
+    uint32_t timestamp_ms;
+    uint16_t len;               /* Stored bytes */
+    uint16_t tag_id;
+    char     level;
+    uint8_t  flags;             /* LOG_RING_SLOT_* */
+    uint8_t  sinks;             /* span->sinks at push */
+    uint8_t  tag_gen;           /* Tag table generation of tag_id */
+} log_ring_slot_t;
+
+typedef struct {
+    char               *arena;
+    uint32_t            arena_mask;    /* arena size - 1 (size is a power of two) */
+    log_ring_slot_t    *slots;
+    uint32_t            slot_mask;     /* slot count - 1 (count is a power of two) */
+    uint32_t            head_pos;      /* Writer only: arena position of the next line */
+    _Atomic uint32_t    head_seq;      /* Sequence number of the next line */
+    _Atomic uint32_t    tail_seq;      /* Sequence number of the oldest valid line */
+} log_ring_t;
+
+typedef enum {
+    LOG_RING_READ_OK = 0,
+    LOG_RING_READ_PENDING,          /* Sequence number not written yet */
+    LOG_RING_READ_OVERWRITTEN,      /* Evicted before or during the read */
+} log_ring_read_t;
+
+/**
+ * Reader position for tailing the ring in order
+ */
+typedef struct {
+    uint32_t seq;                   /* Next sequence number to read */
+    uint32_t lost;                  /* Lines skipped because the writer lapped us */
+} log_ring_cursor_t;
+
+/**
+ * @brief Initialize a ring over caller-provided memory
+ * @param arena       Byte arena for raw line data
+ * @param arena_size  Arena size in bytes (power of two, > FT_LOG_LINE_MAX_LEN)
+ * @param slots       Slot table
+ * @param slot_count  Number of slots (power of two)
+ */
+void log_ring_init(log_ring_t *ring, char *arena, uint32_t arena_size,
+                   log_ring_slot_t *slots, uint32_t slot_count);
+
+/**
+ * @brief Append a line, evicting the oldest lines as needed
+ *
+ * Writer side — only one task may call this. At most span->raw_len
+ * bytes are copied into the arena; span->tag_id must already be set.
+ * Never blocks.
+ */
+void log_ring_push(log_ring_t *ring, const log_span_t *span);
+
+/**
+ * @brief Sequence number of the oldest line still held
+ */
+uint32_t log_ring_first_seq(const log_ring_t *ring);
+
+/**
+ * @brief Sequence number the next pushed line will get
+ */
+uint32_t log_ring_next_seq(const log_ring_t *ring);
+
+/**
+ * @brief Number of lines currently held
+ */
+uint32_t log_ring_count(const log_ring_t *ring);
+
+/**
+ * @brief Copy one line out of the ring
+ *
+ * Safe to call from any task concurrently with the writer. On success
+ * @p span describes the copy in @p buf; lines longer than @p buf_size are
+ * truncated.
+ *
+ * @param seq       Sequence number of the line
+ * @param buf       Destination for the raw bytes
+ * @param buf_size  Size of @p buf
+ * @param span      Output span pointing into @p buf
+ */
+log_ring_read_t log_ring_read(const log_ring_t *ring, uint32_t seq,
+                              char *buf, size_t buf_size, log_span_t *span);
+
+/**
+ * @brief Get a line's sink mask without copying the line
+ *
+ * Lets a reader index the ring cheaply (the UI list keeps only the
+ * lines routed to the display).
+ *
+ * @return LOG_RING_READ_OK with @p sinks set, or why the line isn't held
+ */
+log_ring_read_t log_ring_peek_sinks(const log_ring_t *ring, uint32_t seq, uint8_t *sinks);
+
+/**
+ * @brief Start a cursor at the oldest line currently held
+ */
+void log_ring_cursor_init(const log_ring_t *ring, log_ring_cursor_t *cursor);
+
+/**
+ * @brief Read the next line for a cursor
+ *
+ * If the writer has overwritten lines the cursor had not read yet, it
+ * skips ahead to the oldest available line and adds the gap to
+ * cursor->lost.
+ *
+ * @return true if a line was read, false if the cursor is caught up
+ */
+bool log_ring_cursor_next(const log_ring_t *ring, log_ring_cursor_t *cursor,
+                          char *buf, size_t buf_size, log_span_t *span);
+
+/**
+ * @brief Drop all lines currently held
+ *
+ * Safe to call from any task; sequence numbers keep counting up.
+ */
+void log_ring_clear(log_ring_t *ring);
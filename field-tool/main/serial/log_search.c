@@ -0,0 +1,239 @@
+#include "log_search.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "LOG_SEARCH";
+
+#define BLOOM_MASK          (FT_LOG_SEARCH_BLOOM_BYTES * 8 - 1)   /* Size is a power of two */
+#define RING_BLOCK_LINES    LOG_SEARCH_RING_BLOCK_LINES
+#define RING_BLOCK_SHIFT    (8)                 /* log2(RING_BLOCK_LINES) */
+#define RING_BLOCKS         (FT_LOG_RING_SIZE / RING_BLOCK_LINES)
+
+/* ── State ───────────────────────────────────────────────────────────── */
+
+/* One filter per 256 ring lines, reused round-robin by block number */
+static uint8_t *s_ring_blooms = NULL;               /* RING_BLOCKS filters (PSRAM) */
+static uint32_t s_ring_block_id[RING_BLOCKS];       /* seq >> RING_BLOCK_SHIFT held */
+
+/* ── Trigrams ────────────────────────────────────────────────────────── */
+
+static inline uint8_t fold(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c | 0x20) : (uint8_t)c;
+}
+
+/* Two independent multiplicative hashes of a 24-bit trigram */
+static inline void gram_bits(uint32_t gram, uint16_t *b1, uint16_t *b2)
+{
+    *b1 = (uint16_t)(((gram * 0x9E3779B1u) >> 16) & BLOOM_MASK);
+    *b2 = (uint16_t)(((gram * 0x85EBCA77u) >> 16) & BLOOM_MASK);
+}
+
+void log_search_bloom_add(uint8_t *bloom, const char *text, size_t len)
+{
+    if (len < 3) {
+        return;
+    }
+    uint32_t gram = (fold(text[0]) << 8) | fold(text[1]);
+    for (size_t i = 2; i < len; i++) {
+        gram = ((gram << 8) | fold(text[i])) & 0xFFFFFF;
+        uint16_t b1, b2;
+        gram_bits(gram, &b1, &b2);
+        bloom[b1 >> 3] |= 1 << (b1 & 7);
+        bloom[b2 >> 3] |= 1 << (b2 & 7);
+    }
+}
+
+bool log_search_bloom_test(const uint8_t *bloom, const log_search_query_t *query)
+{
+    for (uint16_t i = 0; i < query->bit_count; i++) {
+        uint16_t b = query->bits[i];
+        if (!(bloom[b >> 3] & (1 << (b & 7)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool log_search_compile(const char *text, log_search_query_t *query)
+{
+    size_t len = strlen(text);
+    if (len > FT_LOG_SEARCH_MAX_LEN) {
+        len = FT_LOG_SEARCH_MAX_LEN;
+    }
+    for (size_t i = 0; i < len; i++) {
+        query->text[i] = (char)fold(text[i]);
+    }
+    query->text[len] = '\0';
+    query->len = len;
+
+    query->bit_count = 0;
+    for (size_t i = 2; i < len; i++) {
+        uint32_t gram = ((uint8_t)query->text[i - 2] << 16) |
+                        ((uint8_t)query->text[i - 1] << 8) | (uint8_t)query->text[i];
+        uint16_t b1, b2;
+        gram_bits(gram, &b1, &b2);
+        query->bits[query->bit_count++] = b1;
+        query->bits[query->bit_count++] = b2;
+    }
+    return len > 0;
+}
+
+bool log_search_match(const log_search_query_t *query, const char *text, size_t len)
+{
+    if (query->len == 0 || len < query->len) {
+        return query->len == 0;
+    }
+    uint8_t first = (uint8_t)query->text[0];
+    for (size_t i = 0; i + query->len <= len; i++) {
+        if (fold(text[i]) != first) {
+            continue;
+        }
+        size_t j = 1;
+        while (j < query->len && fold(text[i + j]) == (uint8_t)query->text[j]) {
+            j++;
+        }
+        if (j == query->len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ── Ring ────────────────────────────────────────────────────────────── */
+
+esp_err_t log_search_init(void)
+{
+    s_ring_blooms = heap_caps_calloc(RING_BLOCKS, FT_LOG_SEARCH_BLOOM_BYTES, MALLOC_CAP_SPIRAM);
+    if (s_ring_blooms == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(s_ring_block_id, 0xFF, sizeof(s_ring_block_id));
+    ESP_LOGI(TAG, "Ring search filters: %d x %d bytes", RING_BLOCKS, FT_LOG_SEARCH_BLOOM_BYTES);
+    return ESP_OK;
+}
+
+void log_search_note_line(uint32_t seq, const log_span_t *span)
+{
+    if (s_ring_blooms == NULL) {
+        return;
+    }
+    uint32_t block = seq >> RING_BLOCK_SHIFT;
+    uint32_t slot = block & (RING_BLOCKS - 1);
+    uint8_t *bloom = s_ring_blooms + slot * FT_LOG_SEARCH_BLOOM_BYTES;
+
+    /* The block this slot held is older than anything the ring still has */
+    if (s_ring_block_id[slot] != block) {
+        memset(bloom, 0, FT_LOG_SEARCH_BLOOM_BYTES);
+        s_ring_block_id[slot] = block;
+    }
+    log_search_bloom_add(bloom, span->raw, span->raw_len);
+}
+
+bool log_search_copy_ring_filter(uint32_t seq, uint8_t *bloom)
+{
+    uint32_t block = seq >> RING_BLOCK_SHIFT;
+    uint32_t slot = block & (RING_BLOCKS - 1);
+    if (s_ring_blooms == NULL || s_ring_block_id[slot] != block) {
+        return false;
+    }
+    memcpy(bloom, s_ring_blooms + slot * FT_LOG_SEARCH_BLOOM_BYTES, FT_LOG_SEARCH_BLOOM_BYTES);
+    return s_ring_block_id[slot] == block;   /* Not reused while copying */
+}
+
+/* Whether a ring block may hold a match (blocks with no filter must be read) */
+static bool ring_block_may_match(uint32_t block, const log_search_query_t *query)
+{
+    uint32_t slot = block & (RING_BLOCKS - 1);
+    if (s_ring_blooms == NULL || s_ring_block_id[slot] != block) {
+        return true;
+    }
+    return log_search_bloom_test(s_ring_blooms + slot * FT_LOG_SEARCH_BLOOM_BYTES, query);
+}
+
+static bool ring_line_matches(const log_ring_t *ring, uint32_t seq,
+                              const log_search_query_t *query, uint8_t sinks)
+{
+    char buf[FT_LOG_LINE_MAX_LEN];
+    log_span_t span;
+    return log_ring_read(ring, seq, buf, sizeof(buf), &span) == LOG_RING_READ_OK &&
+           (span.sinks & sinks) && log_search_match(query, span.raw, span.raw_len);
+}
+
+bool log_search_ring(const log_ring_t *ring, const log_search_query_t *query,
+                     uint32_t from_seq, bool backward, uint8_t sinks,
+                     uint32_t *seq, log_search_stats_t *stats)
+{
+    log_search_stats_t st = { 0 };
+    int64_t start_us = esp_timer_get_time();
+    uint32_t first = log_ring_first_seq(ring);
+    uint32_t next = log_ring_next_seq(ring);
+    bool found = false;
+
+    /* Distances from first keep this right across sequence wrap */
+    uint32_t held = next - first;
+    uint32_t from = from_seq - first;
+    if ((int32_t)from < 0) {
+        from = 0;
+        if (backward) {
+            held = 0;
+        }
+    } else if (from >= held) {
+        from = held - 1;
+        if (!backward) {
+            held = 0;
+        }
+    }
+
+    while (held > 0 && !found) {
+        uint32_t s = first + from;
+        uint32_t block = s >> RING_BLOCK_SHIFT;
+        uint32_t in_block = s & (RING_BLOCK_LINES - 1);
+        uint32_t n;
+        if (!backward) {
+            n = RING_BLOCK_LINES - in_block;
+            if (n > held - from) {
+                n = held - from;
+            }
+        } else {
+            n = in_block + 1;
+            if (n > from + 1) {
+                n = from + 1;
+            }
+        }
+
+        st.blocks++;
+        if (ring_block_may_match(block, query)) {
+            st.candidates++;
+            for (uint32_t i = 0; i < n; i++) {
+                uint32_t cand = backward ? s - i : s + i;
+                st.lines_read++;
+                if (ring_line_matches(ring, cand, query, sinks)) {
+                    *seq = cand;
+                    found = true;
+                    break;
+                }
+            }
+        }
+
+        if (!backward) {
+            from += n;
+            if (from >= held) {
+                break;
+            }
+        } else {
+            if (from < n) {
+                break;
+            }
+            from -= n;
+        }
+    }
+
+    st.elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (stats != NULL) {
+        *stats = st;
+    }
+    return found;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "log_ring.h"
+#include "app_config.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Case-insensitive substring search backed by trigram Bloom filters.
+ *
+ * Every block of lines (256 ring lines, or one SD index block) keeps a
+ * FT_LOG_SEARCH_BLOOM_BYTES Bloom filter of the lower-cased trigrams in
+ * its text, filled in as lines arrive. A query is cut into its trigrams;
+ * a block is read only if every trigram may be in its filter, and only
+ * the lines of those candidate blocks are compared. Queries shorter than
+ * three characters have no trigrams and check every block.
+ */
+
+#define LOG_SEARCH_RING_BLOCK_LINES  (256)   /* Ring lines per filter */
+
+/**
+ * A compiled query
+ */
+typedef struct {
+    char     text[FT_LOG_SEARCH_MAX_LEN + 1];   /* Lower-cased */
+    uint16_t len;
+    uint16_t bit_count;
+    uint16_t bits[2 * FT_LOG_SEARCH_MAX_LEN];   /* Two filter bits per trigram */
+} log_search_query_t;
+
+/**
+ * Work done by one search
+ */
+typedef struct {
+    uint32_t blocks;            /* Blocks considered */
+    uint32_t candidates;        /* Blocks whose filter passed (lines were read) */
+    uint32_t lines_read;
+    uint32_t elapsed_us;
+} log_search_stats_t;
+
+/**
+ * @brief Allocate the ring's block filters (PSRAM)
+ */
+esp_err_t log_search_init(void);
+
+/**
+ * @brief Add a line just pushed to the ring (RX task)
+ * @param seq  Ring sequence number the line got
+ */
+void log_search_note_line(uint32_t seq, const log_span_t *span);
+
+/**
+ * @brief Copy the filter of the 256-line ring block holding @p seq
+ *
+ * For the cold history tier, which keeps a block's filter when it
+ * compacts the block's lines.
+ *
+ * @param bloom  FT_LOG_SEARCH_BLOOM_BYTES bytes
+ * @return false if the filter has already been reused for a newer block
+ */
+bool log_search_copy_ring_filter(uint32_t seq, uint8_t *bloom);
+
+/**
+ * @brief Compile a query (longer text is cut to FT_LOG_SEARCH_MAX_LEN)
+ * @return false for an empty query
+ */
+bool log_search_compile(const char *text, log_search_query_t *query);
+
+/**
+ * @brief Add a line's trigrams to a block filter
+ */
+void log_search_bloom_add(uint8_t *bloom, const char *text, size_t len);
+
+/**
+ * @brief Whether a block filter may hold every trigram of a query
+ */
+bool log_search_bloom_test(const uint8_t *bloom, const log_search_query_t *query);
+
+/**
+ * @brief Whether a line contains the query (case-insensitive)
+ */
+bool log_search_match(const log_search_query_t *query, const char *text, size_t len);
+
+/**
+ * @brief Find the nearest matching ring line
+ *
+ * Searches from @p from_seq (inclusive) towards newer lines, or towards
+ * older ones if @p backward, within the lines the ring still holds.
+ *
+ * @param sinks  Only lines routed to one of these sinks (log_filter.h)
+ * @param seq    Receives the matching line's sequence number
+ * @param stats  Receives the work done (may be NULL)
+ * @return false if nothing matches in that direction
+ */
+bool log_search_ring(const log_ring_t *ring, const log_search_query_t *query,
+                     uint32_t from_seq, bool backward, uint8_t sinks,
+                     uint32_t *seq, log_search_stats_t *stats);
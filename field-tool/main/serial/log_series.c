@@ -0,0 +1,888 @@
+#include "log_series.h"
+#include "tag_table.h"
+#include "sdcard/sdcard_manager.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+static const char *TAG = "LOG_SERIES";
+
+/* ── Extractors ─────────────────────────────────────────────────────── */
+
+typedef struct {
+    char     name[LOG_SERIES_NAME_MAX];
+    char     prefix[FT_SERIES_PATTERN_MAX_LEN];     /* Key, or template text before '*' */
+    char     suffix[FT_SERIES_PATTERN_MAX_LEN];     /* Template text after '*' */
+    uint8_t  prefix_len;
+    uint8_t  suffix_len;
+    bool     is_key;            /* Needs '=' or ':' after the key */
+    uint16_t tag_id;            /* TAG_ID_NONE = any line */
+    char     tag[FT_LOG_TAG_MAX_LEN];                /* Kept to re-intern after a reset */
+    uint8_t  tag_len;
+} extractor_t;
+
+/* ── Chunk pool ─────────────────────────────────────────────────────── */
+
+#define NO_CHUNK        (0xFFFF)
+#define CHUNK_BITS      (FT_SERIES_CHUNK_SIZE * 8)
+#define SAMPLE_MAX_BITS (4 + 32 + 2 + 5 + 5 + 32)       /* Worst timestamp + value */
+
+/*
+ * Chunk header. The first sample is stored here, so each chunk decodes on
+ * its own; the bitstream holds the rest. Chunks are handed out from the
+ * pool in a ring, so a series' chunks are always in allocation order and
+ * the one about to be reused is the oldest of its series.
+ */
+typedef struct {
+    uint32_t serial;            /* Allocation number, never reused */
+    uint8_t  series;
+    uint16_t next;              /* Next chunk of the series, NO_CHUNK at the tail */
+    uint16_t count;
+    uint16_t bits;              /* Bitstream bits used */
+    uint32_t first_ms;
+    uint32_t last_ms;
+    uint32_t first_value;       /* Float bits */
+    float    min;
+    float    max;
+    uint32_t min_ms;
+    uint32_t max_ms;
+} chunk_hdr_t;
+
+/* RX task's encoder state per series */
+typedef struct {
+    uint16_t head;              /* Oldest chunk */
+    uint16_t tail;              /* Chunk being filled */
+    uint32_t prev_ms;
+    int32_t  prev_delta;
+    uint32_t prev_value;
+    uint8_t  lead;              /* XOR window of the previous value */
+    uint8_t  trail;
+    uint32_t samples;
+    uint32_t dropped;
+    float    last_value;
+} series_t;
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t pos;
+    uint32_t end;
+} bit_reader_t;
+
+static extractor_t s_extractors[FT_SERIES_MAX];
+static uint8_t s_extractor_count = 0;
+static series_t s_series[FT_SERIES_MAX];
+
+static chunk_hdr_t *s_chunks = NULL;    /* PSRAM */
+static uint8_t *s_pool = NULL;          /* PSRAM, FT_SERIES_CHUNK_SIZE per chunk */
+static uint16_t s_chunk_count = 0;
+static uint16_t s_next_chunk = 0;       /* Ring allocation position */
+static uint32_t s_next_serial = 1;
+static SemaphoreHandle_t s_mutex = NULL;
+
+/* CSV export */
+static volatile bool s_export_running = false;
+static volatile uint32_t s_export_rows = 0;
+static esp_err_t s_export_result = ESP_OK;
+static char s_export_path[96];
+static uint8_t s_export_id = 0;
+
+/* ── Number parsing ─────────────────────────────────────────────────── */
+
+static const float s_pow10[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f,
+    1e10f, 1e11f, 1e12f, 1e13f, 1e14f, 1e15f, 1e16f, 1e17f, 1e18f, 1e19f,
+    1e20f, 1e21f, 1e22f, 1e23f, 1e24f, 1e25f, 1e26f, 1e27f, 1e28f, 1e29f,
+    1e30f, 1e31f, 1e32f, 1e33f, 1e34f, 1e35f, 1e36f, 1e37f, 1e38f,
+};
+#define POW10_MAX  ((int)(sizeof(s_pow10) / sizeof(s_pow10[0])) - 1)
+
+/*
+ * Decimal number at p: [-+]digits[.digits][e[-+]digits]. Nine significant
+ * digits are kept (more than a float holds). Returns the characters used,
+ * 0 if there is no number.
+ */
+static size_t parse_number(const char *p, const char *end, float *value)
+{
+    const char *s = p;
+    bool neg = false;
+    if (s < end && (*s == '-' || *s == '+')) {
+        neg = (*s == '-');
+        s++;
+    }
+    uint32_t mant = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool any = false;
+    for (; s < end && *s >= '0' && *s <= '9'; s++) {
+        any = true;
+        if (digits < 9) {
+            mant = mant * 10 + (*s - '0');
+            digits += (mant != 0);
+        } else {
+            exp10++;
+        }
+    }
+    if (s < end && *s == '.') {
+        s++;
+        for (; s < end && *s >= '0' && *s <= '9'; s++) {
+            any = true;
+            if (digits < 9) {
+                mant = mant * 10 + (*s - '0');
+                digits += (mant != 0);
+                exp10--;
+            }
+        }
+    }
+    if (!any) {
+        return 0;
+    }
+    if (s + 1 < end && (*s == 'e' || *s == 'E')) {
+        const char *e = s + 1;
+        bool eneg = false;
+        if (*e == '-' || *e == '+') {
+            eneg = (*e == '-');
+            e++;
+        }
+        if (e < end && *e >= '0' && *e <= '9') {
+            int x = 0;
+            for (; e < end && *e >= '0' && *e <= '9'; e++) {
+                x = x < 1000 ? x * 10 + (*e - '0') : x;
+            }
+            exp10 += eneg ? -x : x;
+            s = e;
+        }
+    }
+
+    float v = (float)mant;
+    if (exp10 > 0) {
+        v *= s_pow10[exp10 < POW10_MAX ? exp10 : POW10_MAX];
+    } else if (exp10 < 0) {
+        v /= s_pow10[-exp10 < POW10_MAX ? -exp10 : POW10_MAX];
+    }
+    *value = neg ? -v : v;
+    return s - p;
+}
+
+static inline bool is_word_char(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+           (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+/* First value the extractor finds in text[0..len) */
+static bool extract(const extractor_t *x, const char *text, size_t len, float *value)
+{
+    const char *end = text + len;
+    const char *p = text;
+    while ((size_t)(end - p) >= x->prefix_len) {
+        const char *hit = memmem(p, end - p, x->prefix, x->prefix_len);
+        if (hit == NULL) {
+            return false;
+        }
+        p = hit + 1;
+        const char *q = hit + x->prefix_len;
+
+        if (x->is_key) {
+            /* A whole word followed by '=' or ':' */
+            if (hit > text && is_word_char(hit[-1])) {
+                continue;
+            }
+            while (q < end && *q == ' ') {
+                q++;
+            }
+            if (q >= end || (*q != '=' && *q != ':')) {
+                continue;
+            }
+            q++;
+            while (q < end && *q == ' ') {
+                q++;
+            }
+        }
+        size_t n = parse_number(q, end, value);
+        if (n == 0) {
+            continue;
+        }
+        q += n;
+        if (x->suffix_len > 0 &&
+            ((size_t)(end - q) < x->suffix_len || memcmp(q, x->suffix, x->suffix_len) != 0)) {
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+/* ── Bit I/O ─────────────────────────────────────────────────────────── */
+
+static void put_bits(uint8_t *data, uint16_t *pos, uint32_t value, uint8_t n)
+{
+    while (n > 0) {
+        uint32_t byte = *pos >> 3;
+        uint8_t room = 8 - (*pos & 7);
+        uint8_t take = n < room ? n : room;
+        uint8_t bits = (uint8_t)((value >> (n - take)) & ((1u << take) - 1));
+        if (room == 8) {
+            data[byte] = 0;
+        }
+        data[byte] |= bits << (room - take);
+        *pos += take;
+        n -= take;
+    }
+}
+
+static uint32_t get_bits(bit_reader_t *r, uint8_t n)
+{
+    uint32_t v = 0;
+    while (n > 0) {
+        if (r->pos >= r->end) {
+            return 0;
+        }
+        uint8_t room = 8 - (r->pos & 7);
+        uint8_t take = n < room ? n : room;
+        uint8_t byte = r->data[r->pos >> 3];
+        v = (v << take) | ((byte >> (room - take)) & ((1u << take) - 1));
+        r->pos += take;
+        n -= take;
+    }
+    return v;
+}
+
+static inline uint32_t float_bits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float bits_float(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/* ── Encoder (RX task, under s_mutex) ───────────────────────────────── */
+
+static void note_extremes(chunk_hdr_t *c, uint32_t ms, float v)
+{
+    if (v < c->min) {
+        c->min = v;
+        c->min_ms = ms;
+    }
+    if (v > c->max) {
+        c->max = v;
+        c->max_ms = ms;
+    }
+}
+
+/* Take the next pool chunk for a series, evicting its previous owner's oldest */
+static uint16_t new_chunk(uint8_t id, uint32_t ms, float v)
+{
+    uint16_t k = s_next_chunk;
+    s_next_chunk = (s_next_chunk + 1) % s_chunk_count;
+    chunk_hdr_t *c = &s_chunks[k];
+
+    if (c->serial != 0) {
+        series_t *owner = &s_series[c->series];
+        owner->head = c->next;
+        owner->dropped += c->count;
+        owner->samples -= c->count;
+        if (c->next == NO_CHUNK) {
+            owner->tail = NO_CHUNK;     /* Its only chunk: it starts over */
+        }
+    }
+
+    *c = (chunk_hdr_t){
+        .serial = s_next_serial++,
+        .series = id,
+        .next = NO_CHUNK,
+        .count = 1,
+        .first_ms = ms,
+        .last_ms = ms,
+        .first_value = float_bits(v),
+        .min = v,
+        .max = v,
+        .min_ms = ms,
+        .max_ms = ms,
+    };
+    return k;
+}
+
+static void append_sample(uint8_t id, uint32_t ms, float v)
+{
+    series_t *s = &s_series[id];
+    uint32_t vb = float_bits(v);
+    chunk_hdr_t *c = s->tail != NO_CHUNK ? &s_chunks[s->tail] : NULL;
+
+    if (c == NULL || c->bits + SAMPLE_MAX_BITS > CHUNK_BITS || c->count == UINT16_MAX ||
+        (int32_t)(ms - s->prev_ms) < 0) {
+        uint16_t k = new_chunk(id, ms, v);
+        if (s->tail != NO_CHUNK) {
+            s_chunks[s->tail].next = k;
+        } else {
+            s->head = k;
+        }
+        s->tail = k;
+        s->prev_ms = ms;
+        s->prev_delta = 0;
+        s->prev_value = vb;
+        s->lead = 0xFF;
+        s->samples++;
+        s->last_value = v;
+        return;
+    }
+
+    uint8_t *data = s_pool + (size_t)s->tail * FT_SERIES_CHUNK_SIZE;
+
+    /* Timestamp: delta of deltas in a few size classes */
+    int32_t delta = (int32_t)(ms - s->prev_ms);
+    int32_t dod = delta - s->prev_delta;
+    if (dod == 0) {
+        put_bits(data, &c->bits, 0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        put_bits(data, &c->bits, 0x2, 2);
+        put_bits(data, &c->bits, (uint32_t)(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        put_bits(data, &c->bits, 0x6, 3);
+        put_bits(data, &c->bits, (uint32_t)(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        put_bits(data, &c->bits, 0xE, 4);
+        put_bits(data, &c->bits, (uint32_t)(dod + 2047), 12);
+    } else {
+        put_bits(data, &c->bits, 0xF, 4);
+        put_bits(data, &c->bits, (uint32_t)dod, 32);
+    }
+
+    /* Value: XOR with the previous, meaningful bits only */
+    uint32_t x = vb ^ s->prev_value;
+    if (x == 0) {
+        put_bits(data, &c->bits, 0, 1);
+    } else {
+        uint8_t lead = (uint8_t)__builtin_clz(x);
+        uint8_t trail = (uint8_t)__builtin_ctz(x);
+        if (s->lead != 0xFF && lead >= s->lead && trail >= s->trail) {
+            put_bits(data, &c->bits, 0x2, 2);
+            put_bits(data, &c->bits, x >> s->trail, 32 - s->lead - s->trail);
+        } else {
+            uint8_t meaningful = 32 - lead - trail;
+            put_bits(data, &c->bits, 0x3, 2);
+            put_bits(data, &c->bits, lead, 5);
+            put_bits(data, &c->bits, meaningful - 1, 5);
+            put_bits(data, &c->bits, x >> trail, meaningful);
+            s->lead = lead;
+            s->trail = trail;
+        }
+    }
+
+    c->count++;
+    c->last_ms = ms;
+    note_extremes(c, ms, v);
+    s->prev_ms = ms;
+    s->prev_delta = delta;
+    s->prev_value = vb;
+    s->samples++;
+    s->last_value = v;
+}
+
+/* ── Decoder ─────────────────────────────────────────────────────────── */
+
+typedef struct {
+    bit_reader_t r;
+    uint16_t left;
+    uint32_t ms;
+    int32_t  delta;
+    uint32_t value;
+    uint8_t  lead;
+    uint8_t  trail;
+    bool     first;
+} chunk_decoder_t;
+
+static void decoder_init(chunk_decoder_t *d, const chunk_hdr_t *c, const uint8_t *data)
+{
+    *d = (chunk_decoder_t){
+        .r = { .data = data, .pos = 0, .end = c->bits },
+        .left = c->count,
+        .ms = c->first_ms,
+        .value = c->first_value,
+        .first = true,
+    };
+}
+
+static bool decoder_next(chunk_decoder_t *d, uint32_t *ms, float *value)
+{
+    if (d->left == 0) {
+        return false;
+    }
+    d->left--;
+    if (d->first) {
+        d->first = false;
+    } else {
+        int32_t dod;
+        if (get_bits(&d->r, 1) == 0) {
+            dod = 0;
+        } else if (get_bits(&d->r, 1) == 0) {
+            dod = (int32_t)get_bits(&d->r, 7) - 63;
+        } else if (get_bits(&d->r, 1) == 0) {
+            dod = (int32_t)get_bits(&d->r, 9) - 255;
+        } else if (get_bits(&d->r, 1) == 0) {
+            dod = (int32_t)get_bits(&d->r, 12) - 2047;
+        } else {
+            dod = (int32_t)get_bits(&d->r, 32);
+        }
+        d->delta += dod;
+        d->ms += d->delta;
+
+        if (get_bits(&d->r, 1) != 0) {
+            if (get_bits(&d->r, 1) != 0) {
+                d->lead = (uint8_t)get_bits(&d->r, 5);
+                uint8_t meaningful = (uint8_t)get_bits(&d->r, 5) + 1;
+                d->trail = 32 - d->lead - meaningful;
+            }
+            d->value ^= get_bits(&d->r, 32 - d->lead - d->trail) << d->trail;
+        }
+    }
+    *ms = d->ms;
+    *value = bits_float(d->value);
+    return true;
+}
+
+/* Copy chunk @p k out if it still belongs to series @p id and is newer
+ * than @p after_serial */
+static bool copy_chunk(uint8_t id, uint16_t k, uint32_t after_serial,
+                       chunk_hdr_t *hdr, uint8_t *data)
+{
+    bool ok = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    const chunk_hdr_t *c = &s_chunks[k];
+    if (c->serial != 0 && c->series == id && c->serial > after_serial) {
+        *hdr = *c;
+        if (data != NULL) {
+            memcpy(data, s_pool + (size_t)k * FT_SERIES_CHUNK_SIZE, (c->bits + 7) / 8);
+        }
+        ok = true;
+    }
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+/* Walk over a series' chunks, oldest first, without holding the lock */
+typedef struct {
+    uint8_t  id;
+    uint16_t next;
+    uint32_t last_serial;
+} chunk_walk_t;
+
+static void walk_init(chunk_walk_t *w, uint8_t id)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    w->next = s_series[id].head;
+    xSemaphoreGive(s_mutex);
+    w->id = id;
+    w->last_serial = 0;
+}
+
+/*
+ * Copy out the next chunk (its data too if @p data isn't NULL). If that
+ * chunk was reused meanwhile, so were all older ones: carry on from the
+ * series' current head.
+ */
+static bool walk_next(chunk_walk_t *w, uint16_t *k, chunk_hdr_t *hdr, uint8_t *data)
+{
+    for (int retry = 0; retry < 4 && w->next != NO_CHUNK; retry++) {
+        if (copy_chunk(w->id, w->next, w->last_serial, hdr, data)) {
+            *k = w->next;
+            w->next = hdr->next;
+            w->last_serial = hdr->serial;
+            return true;
+        }
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        w->next = s_series[w->id].head;
+        xSemaphoreGive(s_mutex);
+    }
+    return false;
+}
+
+/* ── Extractor file ─────────────────────────────────────────────────── */
+
+/* "[tag] pattern" -> tag and the pattern */
+static char *take_tag(char *text, extractor_t *x)
+{
+    x->tag_id = TAG_ID_NONE;
+    if (*text != '[') {
+        return text;
+    }
+    char *close = strchr(text, ']');
+    if (close == NULL) {
+        return text;
+    }
+    size_t len = close - text - 1;
+    x->tag_len = (uint8_t)(len < FT_LOG_TAG_MAX_LEN - 1 ? len : FT_LOG_TAG_MAX_LEN - 1);
+    memcpy(x->tag, text + 1, x->tag_len);
+    x->tag_id = tag_table_intern(x->tag, x->tag_len);
+    text = close + 1;
+    while (*text == ' ') {
+        text++;
+    }
+    return text;
+}
+
+static char *trim(char *s)
+{
+    while (*s == ' ' || *s == '\t') {
+        s++;
+    }
+    size_t n = strlen(s);
+    while (n > 0 && (s[n - 1] == ' ' || s[n - 1] == '\t')) {
+        s[--n] = '\0';
+    }
+    return s;
+}
+
+/* Parse "key", "[tag] key", "name = template" or "name = [tag] template" */
+static bool parse_extractor(char *line, extractor_t *x)
+{
+    memset(x, 0, sizeof(*x));
+    char *name = line;
+    char *spec = line;
+    char *eq = strstr(line, " = ");
+    if (eq != NULL) {
+        *eq = '\0';
+        name = trim(line);
+        spec = trim(eq + 3);
+        spec = take_tag(spec, x);
+    } else {
+        name = take_tag(trim(line), x);
+        spec = name;
+    }
+
+    char *star = strchr(spec, '*');
+    size_t plen = star != NULL ? (size_t)(star - spec) : strlen(spec);
+    size_t slen = star != NULL ? strlen(star + 1) : 0;
+    if (name[0] == '\0' || strlen(name) >= LOG_SERIES_NAME_MAX ||
+        plen == 0 || plen >= FT_SERIES_PATTERN_MAX_LEN || slen >= FT_SERIES_PATTERN_MAX_LEN ||
+        (eq != NULL && star == NULL) || (star != NULL && strchr(star + 1, '*') != NULL)) {
+        return false;
+    }
+    strcpy(x->name, name);
+    memcpy(x->prefix, spec, plen);
+    x->prefix_len = (uint8_t)plen;
+    if (star != NULL) {
+        memcpy(x->suffix, star + 1, slen);
+        x->suffix_len = (uint8_t)slen;
+    }
+    x->is_key = (star == NULL);
+    return true;
+}
+
+static esp_err_t load_file(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    char line[LOG_SERIES_NAME_MAX + 2 * FT_SERIES_PATTERN_MAX_LEN + 32];
+    while (s_extractor_count < FT_SERIES_MAX && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *text = trim(line);
+        if (*text == '#' || *text == '\0') {
+            continue;
+        }
+        if (!parse_extractor(text, &s_extractors[s_extractor_count])) {
+            ESP_LOGW(TAG, "Extractor skipped: %s", text);
+            continue;
+        }
+        s_extractor_count++;
+    }
+    fclose(f);
+    return ESP_OK;
+}
+
+/* ── CSV export ──────────────────────────────────────────────────────── */
+
+static bool write_csv_row(uint32_t ms, float value, void *ctx)
+{
+    fprintf((FILE *)ctx, "%lu,%g\n", (unsigned long)ms, (double)value);
+    s_export_rows++;
+    return true;
+}
+
+static void export_task(void *arg)
+{
+    (void)arg;
+    FILE *f = fopen(s_export_path, "w");
+    if (f == NULL) {
+        ESP_LOGW(TAG, "Failed to open %s", s_export_path);
+        s_export_result = ESP_FAIL;
+    } else {
+        fprintf(f, "uptime_ms,%s\n", s_extractors[s_export_id].name);
+        log_series_read(s_export_id, 0, write_csv_row, f);
+        s_export_result = fclose(f) == 0 ? ESP_OK : ESP_FAIL;
+        ESP_LOGI(TAG, "Exported %lu samples to %s", (unsigned long)s_export_rows,
+                 s_export_path);
+    }
+    s_export_running = false;
+    vTaskDelete(NULL);
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+esp_err_t log_series_init(void)
+{
+    for (int i = 0; i < FT_SERIES_MAX; i++) {
+        s_series[i].head = NO_CHUNK;
+        s_series[i].tail = NO_CHUNK;
+    }
+    if (load_file(FT_SERIES_FILE) != ESP_OK || s_extractor_count == 0) {
+        ESP_LOGI(TAG, "No extractors in %s, no series kept", FT_SERIES_FILE);
+        return ESP_OK;
+    }
+
+    s_chunk_count = FT_SERIES_POOL_SIZE / FT_SERIES_CHUNK_SIZE;
+    s_chunks = heap_caps_calloc(s_chunk_count, sizeof(chunk_hdr_t), MALLOC_CAP_SPIRAM);
+    s_pool = heap_caps_malloc((size_t)s_chunk_count * FT_SERIES_CHUNK_SIZE, MALLOC_CAP_SPIRAM);
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_chunks == NULL || s_pool == NULL || s_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate series pool");
+        heap_caps_free(s_chunks);
+        heap_caps_free(s_pool);
+        s_chunks = NULL;
+        s_pool = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "%u series, %u KB pool in %u-byte chunks", s_extractor_count,
+             FT_SERIES_POOL_SIZE / 1024, FT_SERIES_CHUNK_SIZE);
+    return ESP_OK;
+}
+
+void log_series_process(const log_span_t *span, int64_t now_us)
+{
+    if (s_extractor_count == 0 || s_pool == NULL) {
+        return;
+    }
+    const char *msg = span->raw + span->msg_off;
+    size_t len = log_span_msg_len(span);
+    uint32_t ms = (uint32_t)(now_us / 1000);
+
+    for (uint8_t i = 0; i < s_extractor_count; i++) {
+        const extractor_t *x = &s_extractors[i];
+        float v;
+        if ((x->tag_id != TAG_ID_NONE && x->tag_id != span->tag_id) ||
+            !extract(x, msg, len, &v) || isnan(v)) {
+            continue;
+        }
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        append_sample(i, ms, v);
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+void log_series_retag(void)
+{
+    for (uint8_t i = 0; i < s_extractor_count; i++) {
+        extractor_t *x = &s_extractors[i];
+        if (x->tag_len > 0) {
+            x->tag_id = tag_table_intern(x->tag, x->tag_len);
+        }
+    }
+}
+
+uint8_t log_series_count(void)
+{
+    return s_extractor_count;
+}
+
+bool log_series_get_info(uint8_t id, log_series_info_t *info)
+{
+    if (id >= s_extractor_count || s_pool == NULL) {
+        return false;
+    }
+    memset(info, 0, sizeof(*info));
+    strcpy(info->name, s_extractors[id].name);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    const series_t *s = &s_series[id];
+    info->samples = s->samples;
+    info->dropped = s->dropped;
+    info->last_value = s->last_value;
+    if (s->head != NO_CHUNK) {
+        info->first_ms = s_chunks[s->head].first_ms;
+        info->last_ms = s_chunks[s->tail].last_ms;
+        info->min = INFINITY;
+        info->max = -INFINITY;
+        for (uint16_t k = s->head; k != NO_CHUNK; k = s_chunks[k].next) {
+            const chunk_hdr_t *c = &s_chunks[k];
+            info->bytes += sizeof(chunk_hdr_t) + (c->next != NO_CHUNK ? FT_SERIES_CHUNK_SIZE
+                                                                      : (c->bits + 7) / 8);
+            info->min = c->min < info->min ? c->min : info->min;
+            info->max = c->max > info->max ? c->max : info->max;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return true;
+}
+
+static void bucket_add(log_series_bucket_t *b, uint32_t count, float min, uint32_t min_ms,
+                       float max, uint32_t max_ms)
+{
+    if (b->count == 0 || min < b->min) {
+        b->min = min;
+        b->min_ms = min_ms;
+    }
+    if (b->count == 0 || max > b->max) {
+        b->max = max;
+        b->max_ms = max_ms;
+    }
+    b->count += count;
+}
+
+uint32_t log_series_downsample(uint8_t id, uint32_t from_ms, uint32_t to_ms,
+                               log_series_bucket_t *out, uint32_t buckets)
+{
+    memset(out, 0, buckets * sizeof(*out));
+    if (id >= s_extractor_count || s_pool == NULL || buckets == 0 || to_ms <= from_ms) {
+        return 0;
+    }
+    uint64_t span = to_ms - from_ms;
+    static uint8_t data[FT_SERIES_CHUNK_SIZE];      /* UI task */
+    chunk_hdr_t hdr;
+    chunk_walk_t walk;
+    uint16_t k;
+    uint32_t total = 0;
+
+    walk_init(&walk, id);
+    while (walk_next(&walk, &k, &hdr, NULL)) {
+        if (hdr.last_ms < from_ms || hdr.first_ms >= to_ms) {
+            continue;
+        }
+        uint32_t b0 = UINT32_MAX;
+        if (hdr.first_ms >= from_ms) {
+            b0 = (uint32_t)((uint64_t)(hdr.first_ms - from_ms) * buckets / span);
+        }
+        uint32_t b1 = (uint32_t)((uint64_t)(hdr.last_ms - from_ms) * buckets / span);
+        if (b0 == b1 && hdr.last_ms < to_ms) {
+            /* Whole chunk in one bucket: its summary will do */
+            bucket_add(&out[b0], hdr.count, hdr.min, hdr.min_ms, hdr.max, hdr.max_ms);
+            total += hdr.count;
+            continue;
+        }
+
+        if (!copy_chunk(id, k, hdr.serial - 1, &hdr, data)) {
+            continue;   /* Reused since the header was read */
+        }
+        chunk_decoder_t d;
+        decoder_init(&d, &hdr, data);
+        uint32_t ms;
+        float v;
+        while (decoder_next(&d, &ms, &v)) {
+            if (ms < from_ms || ms >= to_ms) {
+                continue;
+            }
+            bucket_add(&out[(uint32_t)((uint64_t)(ms - from_ms) * buckets / span)], 1, v, ms, v, ms);
+            total++;
+        }
+    }
+    return total;
+}
+
+uint32_t log_series_read(uint8_t id, uint32_t from_ms, log_series_sample_cb_t cb, void *ctx)
+{
+    if (id >= s_extractor_count || s_pool == NULL) {
+        return 0;
+    }
+    uint8_t *data = heap_caps_malloc(FT_SERIES_CHUNK_SIZE, MALLOC_CAP_DEFAULT);
+    if (data == NULL) {
+        return 0;
+    }
+    chunk_hdr_t hdr;
+    chunk_walk_t walk;
+    uint16_t k;
+    uint32_t visited = 0;
+    bool stop = false;
+
+    walk_init(&walk, id);
+    while (!stop && walk_next(&walk, &k, &hdr, data)) {
+        if (hdr.last_ms < from_ms) {
+            continue;
+        }
+        chunk_decoder_t d;
+        decoder_init(&d, &hdr, data);
+        uint32_t ms;
+        float v;
+        while (decoder_next(&d, &ms, &v)) {
+            if (ms < from_ms) {
+                continue;
+            }
+            visited++;
+            if (!cb(ms, v, ctx)) {
+                stop = true;
+                break;
+            }
+        }
+    }
+    heap_caps_free(data);
+    return visited;
+}
+
+esp_err_t log_series_export_csv(uint8_t id)
+{
+    if (id >= s_extractor_count || s_pool == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_export_running || !sdcard_manager_is_mounted()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sdcard_manager_ensure_dir(FT_LOGS_DIR);
+    snprintf(s_export_path, sizeof(s_export_path), "%s/%.24s_%lu.csv", FT_LOGS_DIR,
+             s_extractors[id].name, (unsigned long)(esp_timer_get_time() / 1000000));
+    s_export_id = id;
+    s_export_rows = 0;
+    s_export_result = ESP_OK;
+    s_export_running = true;
+    if (xTaskCreate(export_task, "series_csv", 4096, NULL, 2, NULL) != pdPASS) {
+        s_export_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+bool log_series_export_status(char *path, size_t path_len, uint32_t *rows, esp_err_t *result)
+{
+    if (path != NULL) {
+        snprintf(path, path_len, "%s", s_export_path);
+    }
+    if (rows != NULL) {
+        *rows = s_export_rows;
+    }
+    if (result != NULL) {
+        *result = s_export_result;
+    }
+    return s_export_running;
+}
+
+void log_series_clear(void)
+{
+    if (s_pool == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (uint16_t k = 0; k < s_chunk_count; k++) {
+        s_chunks[k].serial = 0;
+    }
+    for (int i = 0; i < FT_SERIES_MAX; i++) {
+        uint32_t dropped = s_series[i].dropped;
+        memset(&s_series[i], 0, sizeof(s_series[i]));
+        s_series[i].head = NO_CHUNK;
+        s_series[i].tail = NO_CHUNK;
+        s_series[i].dropped = dropped;
+    }
+    s_next_chunk = 0;
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "log_parser.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Numeric series extracted from log lines.
+ *
+ * Extractors come from FT_SERIES_FILE, one per line ('#' comments):
+ *
+ *     flow                              key: "flow=12.34", "flow: 12.34"
+ *     [sensor] temp                     only lines tagged "sensor"
+ *     rssi = beacon timeout, rssi *     template: '*' is the number
+ *     rpm = [motor] speed * rpm         named template for one tag
+ *
+ * Each matching line adds one sample (tool uptime in ms, value as a
+ * 32-bit float) to its series. Samples are packed Gorilla-style into
+ * fixed-size chunks from a shared PSRAM pool: timestamps as
+ * delta-of-deltas, values XORed with the previous one and stored as the
+ * meaningful bits only. A steady reading at a steady rate takes a few
+ * bits per sample. When the pool is full the oldest chunk (of any series)
+ * is reused.
+ *
+ * Every chunk also keeps the min/max of its samples, so drawing hours of
+ * data only decodes the few chunks that straddle a bucket boundary.
+ *
+ * The RX task writes; any task may read. Readers copy one chunk at a time
+ * under a short lock.
+ */
+
+#define LOG_SERIES_NAME_MAX  (24)
+
+/**
+ * Series summary
+ */
+typedef struct {
+    char     name[LOG_SERIES_NAME_MAX];
+    uint32_t samples;           /* Held */
+    uint32_t bytes;             /* Pool bytes they take */
+    uint32_t dropped;           /* Evicted for space since boot */
+    uint32_t first_ms;          /* Oldest held sample (tool uptime) */
+    uint32_t last_ms;
+    float    last_value;
+    float    min;               /* Over the held samples */
+    float    max;
+} log_series_info_t;
+
+/**
+ * One downsampling bucket: its extremes and when they occurred
+ */
+typedef struct {
+    uint32_t count;             /* 0 = no samples in the bucket */
+    float    min;
+    float    max;
+    uint32_t min_ms;
+    uint32_t max_ms;
+} log_series_bucket_t;
+
+/**
+ * @brief Called for each sample by log_series_read()
+ * @return false to stop
+ */
+typedef bool (*log_series_sample_cb_t)(uint32_t ms, float value, void *ctx);
+
+/**
+ * @brief Allocate the pool and load FT_SERIES_FILE (no file: no series)
+ */
+esp_err_t log_series_init(void);
+
+/**
+ * @brief Run the extractors over one line (RX task)
+ * @param now_us  esp_timer time the line arrived
+ */
+void log_series_process(const log_span_t *span, int64_t now_us);
+
+/**
+ * @brief Intern the extractors' tags again after tag_table_reset() (RX task)
+ */
+void log_series_retag(void);
+
+/**
+ * @brief Number of series defined (valid IDs are 0..count-1)
+ */
+uint8_t log_series_count(void);
+
+bool log_series_get_info(uint8_t id, log_series_info_t *info);
+
+/**
+ * @brief Min/max per time bucket over [from_ms, to_ms)
+ *
+ * Chunks that fall inside one bucket are merged from their summaries
+ * without being decoded.
+ *
+ * @param out      One entry per bucket, oldest first
+ * @param buckets  Number of buckets
+ * @return Samples covered
+ */
+uint32_t log_series_downsample(uint8_t id, uint32_t from_ms, uint32_t to_ms,
+                               log_series_bucket_t *out, uint32_t buckets);
+
+/**
+ * @brief Decode every held sample at or after @p from_ms, oldest first
+ * @return Samples visited
+ */
+uint32_t log_series_read(uint8_t id, uint32_t from_ms, log_series_sample_cb_t cb, void *ctx);
+
+/**
+ * @brief Start writing a series to FT_LOGS_DIR as CSV in the background
+ * @return ESP_ERR_INVALID_STATE if the SD card isn't mounted or an export
+ *         is already running
+ */
+esp_err_t log_series_export_csv(uint8_t id);
+
+/**
+ * @brief Progress of the last export
+ * @param path    Receives the file name (may be NULL)
+ * @param rows    Receives the rows written so far (may be NULL)
+ * @param result  Receives how it ended (may be NULL)
+ * @return true while it is running
+ */
+bool log_series_export_status(char *path, size_t path_len, uint32_t *rows, esp_err_t *result);
+
+/**
+ * @brief Drop all samples (the extractors stay)
+ */
+void log_series_clear(void);
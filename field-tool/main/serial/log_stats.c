@@ -0,0 +1,275 @@
+#include "log_stats.h"
+#include "tag_table.h"
+#include "app_config.h"
+#include "esp_timer.h"
+#include <string.h>
+
+#define WINDOW_MS   (FT_LOG_STATS_TAG_WINDOW_S * 1000)
+
+typedef struct {
+    uint32_t lines;
+    uint32_t bytes;
+    uint16_t level_lines[LOG_STATS_LEVEL_COUNT];
+} second_bucket_t;
+
+/* Sliding-window counter: lines in the previous and current tag window */
+typedef struct {
+    uint32_t window;        /* Current window number (uptime / window length) */
+    uint32_t prev;
+    uint32_t cur;
+    uint32_t lines;
+    uint32_t peak;          /* Most lines in a complete window */
+} tag_counter_t;
+
+static second_bucket_t s_seconds[FT_LOG_STATS_SECONDS];
+static uint32_t s_cur_sec = 0;          /* Second s_seconds[s_cur_sec % N] is filling */
+static uint32_t s_first_sec = 0;
+static bool s_started = false;
+static uint32_t s_peak_per_s = 0;
+
+static uint32_t s_lines = 0;
+static uint64_t s_bytes = 0;
+static uint32_t s_level_lines[LOG_STATS_LEVEL_COUNT];
+
+static int64_t s_last_us = 0;           /* 0 = next line starts no gap */
+static uint32_t s_longest_gap_ms = 0;
+static uint32_t s_longest_gap_at_ms = 0;
+
+static tag_counter_t s_tags[FT_LOG_TAG_TABLE_SIZE + 1];    /* By tag ID, 0 = untagged */
+
+static log_stats_level_t level_index(char level)
+{
+    switch (level) {
+    case 'E': return LOG_STATS_LEVEL_E;
+    case 'W': return LOG_STATS_LEVEL_W;
+    case 'I': return LOG_STATS_LEVEL_I;
+    case 'D': return LOG_STATS_LEVEL_D;
+    case 'V': return LOG_STATS_LEVEL_V;
+    default:  return LOG_STATS_LEVEL_OTHER;
+    }
+}
+
+/* Move the filling bucket to @p sec, clearing the seconds skipped (at most
+ * one pass over the history however long the silence was) */
+static void advance_to(uint32_t sec)
+{
+    if (!s_started) {
+        s_started = true;
+        s_cur_sec = sec;
+        s_first_sec = sec;
+        return;
+    }
+    if (sec == s_cur_sec) {
+        return;
+    }
+    uint32_t done = s_seconds[s_cur_sec % FT_LOG_STATS_SECONDS].lines;
+    if (done > s_peak_per_s) {
+        s_peak_per_s = done;
+    }
+    uint32_t steps = sec - s_cur_sec;
+    if (steps > FT_LOG_STATS_SECONDS) {
+        steps = FT_LOG_STATS_SECONDS;
+    }
+    for (uint32_t i = 1; i <= steps; i++) {
+        memset(&s_seconds[(s_cur_sec + i) % FT_LOG_STATS_SECONDS], 0, sizeof(second_bucket_t));
+    }
+    s_cur_sec = sec;
+}
+
+/* Bucket of a complete second, or NULL if nothing was counted in it */
+static const second_bucket_t *complete_second(uint32_t sec, uint32_t now_sec)
+{
+    uint32_t cur = s_cur_sec;
+    if (!s_started || sec >= now_sec || sec > cur || cur - sec >= FT_LOG_STATS_SECONDS) {
+        return NULL;
+    }
+    return &s_seconds[sec % FT_LOG_STATS_SECONDS];
+}
+
+/* A tag's lines over the last window, weighting the previous window by
+ * the part of it still inside */
+static uint32_t tag_recent(const tag_counter_t *t, uint32_t now_ms)
+{
+    uint32_t window = now_ms / WINDOW_MS;
+    uint32_t left = WINDOW_MS - now_ms % WINDOW_MS;
+    if (t->window == window) {
+        return (uint32_t)((uint64_t)t->prev * left / WINDOW_MS) + t->cur;
+    }
+    if (t->window + 1 == window) {
+        return (uint32_t)((uint64_t)t->cur * left / WINDOW_MS);
+    }
+    return 0;
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+void log_stats_note_line(const log_span_t *span, size_t wire_len, int64_t now_us)
+{
+    uint32_t sec = (uint32_t)(now_us / 1000000);
+    advance_to(sec);
+
+    log_stats_level_t level = level_index(span->level);
+    second_bucket_t *b = &s_seconds[sec % FT_LOG_STATS_SECONDS];
+    b->lines++;
+    b->bytes += wire_len;
+    b->level_lines[level]++;
+    s_lines++;
+    s_bytes += wire_len;
+    s_level_lines[level]++;
+
+    if (s_last_us != 0) {
+        uint32_t gap_ms = (uint32_t)((now_us - s_last_us) / 1000);
+        if (gap_ms > s_longest_gap_ms) {
+            s_longest_gap_ms = gap_ms;
+            s_longest_gap_at_ms = (uint32_t)(now_us / 1000);
+        }
+    }
+    s_last_us = now_us;
+
+    uint16_t id = span->tag_id <= FT_LOG_TAG_TABLE_SIZE ? span->tag_id : TAG_ID_NONE;
+    tag_counter_t *t = &s_tags[id];
+    uint32_t window = (uint32_t)(now_us / 1000 / WINDOW_MS);
+    if (t->window != window) {
+        if (t->cur > t->peak) {
+            t->peak = t->cur;
+        }
+        t->prev = t->window + 1 == window ? t->cur : 0;
+        t->cur = 0;
+        t->window = window;
+    }
+    t->cur++;
+    t->lines++;
+}
+
+void log_stats_restart_gap(void)
+{
+    s_last_us = 0;
+}
+
+void log_stats_get(log_stats_t *stats)
+{
+    static const uint32_t spans[3] = { 1, 10, 60 };
+    int64_t now_us = esp_timer_get_time();
+    uint32_t now_sec = (uint32_t)(now_us / 1000000);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->lines = s_lines;
+    stats->bytes = s_bytes;
+    memcpy(stats->level_lines, s_level_lines, sizeof(s_level_lines));
+    stats->peak_lines_per_s = s_peak_per_s;
+    stats->longest_gap_ms = s_longest_gap_ms;
+    stats->longest_gap_at_ms = s_longest_gap_at_ms;
+    int64_t last_us = s_last_us;
+    stats->silent_ms = last_us != 0 ? (uint32_t)((now_us - last_us) / 1000) : 0;
+
+    /* Sum complete seconds back from now; early on, average over the
+     * seconds since the first line rather than the whole span */
+    uint32_t lines = 0;
+    uint32_t bytes = 0;
+    uint32_t k = 1;
+    for (int w = 0; w < 3; w++) {
+        for (; k <= spans[w] && k <= now_sec; k++) {
+            const second_bucket_t *b = complete_second(now_sec - k, now_sec);
+            if (b != NULL) {
+                lines += b->lines;
+                bytes += b->bytes;
+                if (b->lines > stats->peak_lines_per_s) {
+                    stats->peak_lines_per_s = b->lines;     /* Not folded in yet */
+                }
+            }
+        }
+        uint32_t span = spans[w];
+        if (s_started && now_sec - s_first_sec < span) {
+            span = now_sec - s_first_sec > 0 ? now_sec - s_first_sec : 1;
+        }
+        stats->lines_rate_x10[w] = (uint32_t)((uint64_t)lines * 10 / span);
+        stats->bytes_rate[w] = bytes / span;
+    }
+}
+
+uint32_t log_stats_history(uint32_t *lines, uint32_t *bytes, uint32_t *errors, uint32_t count)
+{
+    if (count > FT_LOG_STATS_SECONDS) {
+        count = FT_LOG_STATS_SECONDS;
+    }
+    uint32_t now_sec = (uint32_t)(esp_timer_get_time() / 1000000);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t back = count - i;
+        const second_bucket_t *b = back <= now_sec ? complete_second(now_sec - back, now_sec)
+                                                   : NULL;
+        if (lines != NULL) {
+            lines[i] = b != NULL ? b->lines : 0;
+        }
+        if (bytes != NULL) {
+            bytes[i] = b != NULL ? b->bytes : 0;
+        }
+        if (errors != NULL) {
+            errors[i] = b != NULL ? (uint32_t)b->level_lines[LOG_STATS_LEVEL_E] +
+                                    b->level_lines[LOG_STATS_LEVEL_W] : 0;
+        }
+    }
+    return count;
+}
+
+uint32_t log_stats_top_tags(log_stats_tag_t *out, uint32_t max)
+{
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    uint16_t last = tag_table_size();
+    if (last > FT_LOG_TAG_TABLE_SIZE) {
+        last = FT_LOG_TAG_TABLE_SIZE;
+    }
+
+    /* Insertion into a short sorted list; the table holds a few hundred tags at most */
+    uint32_t n = 0;
+    for (uint16_t id = 0; id <= last; id++) {
+        const tag_counter_t *t = &s_tags[id];
+        if (t->lines == 0) {
+            continue;
+        }
+        log_stats_tag_t e = {
+            .tag_id = id,
+            .lines = t->lines,
+            .rate_x10 = tag_recent(t, now_ms) * 10 / FT_LOG_STATS_TAG_WINDOW_S,
+            .peak_window = t->peak,
+        };
+        if (t->window < now_ms / WINDOW_MS && t->cur > e.peak_window) {
+            e.peak_window = t->cur;     /* Its last window has closed */
+        }
+
+        uint32_t pos = n < max ? n : max;
+        while (pos > 0 && (out[pos - 1].rate_x10 < e.rate_x10 ||
+                           (out[pos - 1].rate_x10 == e.rate_x10 &&
+                            out[pos - 1].lines < e.lines))) {
+            if (pos < max) {
+                out[pos] = out[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max) {
+            out[pos] = e;
+            if (n < max) {
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+void log_stats_reset_tags(void)
+{
+    memset(s_tags, 0, sizeof(s_tags));
+}
+
+void log_stats_reset(void)
+{
+    memset(s_seconds, 0, sizeof(s_seconds));
+    memset(s_tags, 0, sizeof(s_tags));
+    memset(s_level_lines, 0, sizeof(s_level_lines));
+    s_started = false;
+    s_peak_per_s = 0;
+    s_lines = 0;
+    s_bytes = 0;
+    s_last_us = 0;
+    s_longest_gap_ms = 0;
+    s_longest_gap_at_ms = 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "log_parser.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Streaming statistics of the received log.
+ *
+ * Updated at ingest for every line the target sends (before filtering or
+ * repeat folding) with constant work per line:
+ *   - one-second buckets of lines, bytes and lines per level, kept for
+ *     the last FT_LOG_STATS_SECONDS, from which the 1 s / 10 s / 60 s
+ *     rates and the dashboard sparklines are summed when read;
+ *   - per-tag sliding-window counters (the previous and current
+ *     FT_LOG_STATS_TAG_WINDOW_S window, weighted by how far into the
+ *     current one we are), giving each tag's recent rate and its peak;
+ *   - the longest silence between two lines.
+ *
+ * The RX task is the only writer; readers copy without locks and may see
+ * a line in flight, as with latency_stats.
+ */
+
+typedef enum {
+    LOG_STATS_LEVEL_E = 0,
+    LOG_STATS_LEVEL_W,
+    LOG_STATS_LEVEL_I,
+    LOG_STATS_LEVEL_D,
+    LOG_STATS_LEVEL_V,
+    LOG_STATS_LEVEL_OTHER,      /* Unparsed lines */
+    LOG_STATS_LEVEL_COUNT,
+} log_stats_level_t;
+
+/**
+ * Totals and windowed rates
+ */
+typedef struct {
+    uint32_t lines;                 /* Since boot or the last reset */
+    uint64_t bytes;                 /* Line bytes received, plus one per line ending */
+    uint32_t level_lines[LOG_STATS_LEVEL_COUNT];
+
+    /* Lines (bytes) per second averaged over the last 1, 10 and 60 s
+     * (complete seconds only; x10 for one decimal place) */
+    uint32_t lines_rate_x10[3];
+    uint32_t bytes_rate[3];
+    uint32_t peak_lines_per_s;      /* Busiest complete second */
+
+    uint32_t longest_gap_ms;        /* Longest silence between two lines */
+    uint32_t longest_gap_at_ms;     /* Uptime when it ended */
+    uint32_t silent_ms;             /* Since the last line */
+} log_stats_t;
+
+/**
+ * One tag's activity
+ */
+typedef struct {
+    uint16_t tag_id;
+    uint32_t lines;                 /* Since boot or the last reset */
+    uint32_t rate_x10;              /* Lines per second over the tag window, x10 */
+    uint32_t peak_window;           /* Most lines in one complete tag window */
+} log_stats_tag_t;
+
+/**
+ * @brief Count one received line (RX task)
+ * @param wire_len  Bytes the line took on the wire (with its line ending)
+ * @param now_us    esp_timer time it was framed
+ */
+void log_stats_note_line(const log_span_t *span, size_t wire_len, int64_t now_us);
+
+/**
+ * @brief Don't count the silence before the next line as a gap (new
+ *        connection, baud change)
+ */
+void log_stats_restart_gap(void);
+
+/**
+ * @brief Snapshot totals and rates
+ */
+void log_stats_get(log_stats_t *stats);
+
+/**
+ * @brief Per-second history, oldest first, ending with the last complete second
+ * @param lines   Receives lines per second (may be NULL)
+ * @param bytes   Receives bytes per second (may be NULL)
+ * @param errors  Receives error and warning lines per second (may be NULL)
+ * @param count   Entries wanted (at most FT_LOG_STATS_SECONDS)
+ * @return Entries filled
+ */
+uint32_t log_stats_history(uint32_t *lines, uint32_t *bytes, uint32_t *errors, uint32_t count);
+
+/**
+ * @brief The busiest tags right now, by recent rate then total
+ * @return Entries filled (tags that have been seen since the last reset)
+ */
+uint32_t log_stats_top_tags(log_stats_tag_t *out, uint32_t max);
+
+/**
+ * @brief Forget the per-tag counts (after tag_table_reset(), RX task)
+ */
+void log_stats_reset_tags(void);
+
+/**
+ * @brief Clear everything (a line racing the clear may survive it)
+ */
+void log_stats_reset(void);
@@ -1,80 +1,637 @@
 #include "log_storage.h"
+#include "log_index.h"
+#include "log_codec.h"
+#include "tag_table.h"
+#include "latency_stats.h"
 #include "sdcard/sdcard_manager.h"
+#include "wifi/wall_clock.h"
 #include "app_config.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <stdio.h>
-#include <time.h>
-#include <sys/time.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 static const char *TAG = "LOG_STORE";
 
-#define LOG_QUEUE_LEN  64
+/*
+ * Group commit: the RX task appends lines into the active buffer; the
+ * writer task swaps it for the spare when it is full or old enough and
+ * writes the whole thing with one write(). Two buffers means the RX task
+ * keeps appending while the card is busy, and only drops lines if the
+ * card falls a full buffer behind.
+ *
+ * Each buffer also collects the sidecar index blocks (log_index.h) for
+ * its lines, with offsets relative to the buffer. Blocks end at buffer
+ * boundaries, so the writer only has to rebase them onto the file once
+ * the text is safely on the card.
+ *
+ * In binary mode (log_codec.h) a buffer holds encoded line records
+ * instead, and the writer compresses it into one framed block just
+ * before writing. Block headers carry line numbers and time ranges, so
+ * binary files need no sidecar index. A buffer's format is fixed by its
+ * first line; the writer starts a new file when the format changes.
+ *
+ * Every write() covers whole FT_LOG_SD_ALIGN sectors at a sector-aligned
+ * file offset, so FATFS hands the card straight multi-sector writes from
+ * the (sector-aligned) buffers. Whatever is left past the last whole
+ * sector is carried into the next write: a text buffer's tail is moved
+ * to the front of the buffer that replaces it, and a sealed binary block's
+ * tail waits in s_tail and goes in front of the next block. On a sync,
+ * at the flush deadline and at close the tail is written as it is and the
+ * file position put back to the sector it starts, so the next write
+ * covers that sector again; nothing is padded.
+ */
 
-static QueueHandle_t s_log_queue;
-static FILE *s_log_file;
+#define MAX_BUF_BLOCKS  (FT_LOG_SD_BUF_SIZE / FT_LOG_INDEX_BLOCK_LINES + 1)
 
-static void open_log_file(void)
+typedef struct {
+    char    *data;
+    uint32_t fill;
+    uint32_t lines;
+    int64_t  first_us;      /* When the first line in this buffer arrived */
+    log_index_builder_t index;
+    log_index_block_t *blocks;  /* Completed index blocks (PSRAM) */
+    uint32_t block_count;
+    bool     binary;            /* data holds log_codec records */
+    log_codec_encoder_t enc;
+    uint32_t text_bytes;        /* Size of the buffered lines as text */
+    uint32_t carry;             /* Text: leading bytes carried from the previous buffer */
+} write_buf_t;
+
+static write_buf_t s_bufs[2];
+static write_buf_t *s_active;           /* RX task appends here */
+static write_buf_t *s_spare;            /* Free, or being written by the writer */
+static bool s_spare_busy = false;
+static bool s_sync_requested = false;
+static SemaphoreHandle_t s_buf_mutex;   /* Guards the fields above — held for memcpy only */
+static TaskHandle_t s_writer_task;
+
+static log_storage_config_t s_config = {
+    .flush_bytes = FT_LOG_SD_FLUSH_BYTES,
+    .flush_interval_ms = FT_LOG_SD_FLUSH_MS,
+    .sync_interval_ms = FT_LOG_SD_SYNC_MS,
+    .sync_on_error = true,
+    .sync_on_disconnect = true,
+    .binary = FT_LOG_SD_BINARY,
+};
+static log_storage_stats_t s_stats;
+static uint32_t s_gap_lines;            /* Dropped since the last line that made it */
+static uint32_t s_gap_bytes;
+static const char *s_gap_reason;        /* Why, for the marker */
+
+static int s_log_fd = -1;
+static int s_idx_fd = -1;               /* Sidecar index, -1 if unusable */
+static bool s_file_binary;              /* Format of the open file */
+static uint32_t s_file_bytes;           /* Bytes on the card so far, whole sectors */
+static uint32_t s_file_lines;
+static uint8_t *s_tail;                 /* Bytes past s_file_bytes (less than one sector) */
+static uint32_t s_tail_len;             /* Binary: the carry itself; text: a copy of it */
+static int64_t s_tail_since_us;         /* Oldest line in a tail not on the card yet, 0 if none */
+
+static uint8_t *s_pack;                 /* Tail + sealed binary block (PSRAM) */
+static void *s_lz_work;                 /* Compressor hash table */
+
+/* ── Index blocks ───────────────────────────────────────────────────── */
+
+static void index_add(write_buf_t *buf, const log_span_t *span, uint32_t bytes)
+{
+    if (log_index_builder_add(&buf->index, span, bytes, &buf->blocks[buf->block_count]) &&
+        buf->block_count < MAX_BUF_BLOCKS - 1) {
+        buf->block_count++;
+    }
+}
+
+/* Close the buffer's last block before it is handed to the writer */
+static void index_close(write_buf_t *buf)
+{
+    if (log_index_builder_finish(&buf->index, &buf->blocks[buf->block_count])) {
+        buf->block_count++;
+    }
+}
+
+static void buf_reset(write_buf_t *buf)
+{
+    buf->fill = 0;
+    buf->lines = 0;
+    buf->block_count = 0;
+    buf->text_bytes = 0;
+    buf->carry = 0;
+    log_index_builder_init(&buf->index, 0, 0);
+    log_codec_encoder_reset(&buf->enc);
+}
+
+/*
+ * Hand the full active buffer to the writer (s_buf_mutex held, spare
+ * free). A text buffer keeps only whole sectors; the rest moves to the
+ * front of the new active buffer. When a switch to binary is pending the
+ * file is about to close, so the buffer goes out whole instead.
+ */
+static void swap_buffers(void)
+{
+    index_close(s_active);
+    write_buf_t *full = s_active;
+    s_active = s_spare;
+    s_spare = full;
+    s_spare_busy = true;
+
+    if (!full->binary && !s_config.binary) {
+        uint32_t tail = full->fill % FT_LOG_SD_ALIGN;
+        full->fill -= tail;
+        memcpy(s_active->data, full->data + full->fill, tail);
+        s_active->fill = tail;
+        s_active->carry = tail;
+        log_index_builder_init(&s_active->index, 0, tail);
+    }
+}
+
+/* Give up on the index: the reader rebuilds it from the text */
+static void index_abandon(const char *reason)
+{
+    if (s_idx_fd >= 0) {
+        close(s_idx_fd);
+        s_idx_fd = -1;
+        ESP_LOGW(TAG, "Index disabled: %s", reason);
+    }
+}
+
+/* ── Lines ──────────────────────────────────────────────────────────── */
+
+/* Most bytes a line can take in a buffer of either format */
+static inline uint32_t line_bound(uint32_t raw_len)
+{
+    return LOG_CODEC_LINE_BOUND(raw_len);
+}
+
+/* Whether the span starts with exactly the header the codec rebuilds */
+static bool has_canonical_header(const log_span_t *span)
+{
+    return span->tag_id != 0 && span->tag_id < LOG_CODEC_MAX_TAGS &&
+           log_codec_header_matches(span->raw, span->msg_off, span->level, span->timestamp_ms,
+                                    span->raw + span->tag_off, span->tag_len);
+}
+
+/* Append one line to a buffer with room for line_bound(raw_len) bytes */
+static void append_line(write_buf_t *buf, const log_span_t *span)
+{
+    if (!buf->binary) {
+        memcpy(buf->data + buf->fill, span->raw, span->raw_len);
+        buf->data[buf->fill + span->raw_len] = '\n';
+        index_add(buf, span, span->raw_len + 1);
+        buf->fill += span->raw_len + 1;
+        buf->text_bytes += span->raw_len + 1;
+        buf->lines++;
+        return;
+    }
+
+    log_codec_line_t line = {
+        .level = span->level,
+        .text = span->raw,
+        .text_len = span->raw_len,
+    };
+    if (has_canonical_header(span)) {
+        log_codec_encoder_set_tag_gen(&buf->enc, tag_table_generation());
+        line.header = true;
+        line.timestamp_ms = span->timestamp_ms;
+        line.tag_id = span->tag_id;
+        line.tag = span->raw + span->tag_off;
+        line.tag_len = span->tag_len;
+        line.text = span->raw + span->msg_off;
+        line.text_len = span->raw_len - span->msg_off;
+    }
+    uint32_t before = buf->enc.text_bytes;
+    size_t n = log_codec_encode_line(&buf->enc, (uint8_t *)buf->data + buf->fill,
+                                     FT_LOG_SD_BUF_SIZE - buf->fill, &line);
+    if (n == 0 && line.header) {
+        /* Block ran out of tag numbers: keep the line, header and all */
+        line.header = false;
+        line.text = span->raw;
+        line.text_len = span->raw_len;
+        n = log_codec_encode_line(&buf->enc, (uint8_t *)buf->data + buf->fill,
+                                  FT_LOG_SD_BUF_SIZE - buf->fill, &line);
+    }
+    buf->fill += n;
+    buf->text_bytes += buf->enc.text_bytes - before;
+    buf->lines++;
+}
+
+/* ── File ───────────────────────────────────────────────────────────── */
+
+/*
+ * Put the bytes past the last whole sector on the card (writer task, no
+ * locks held), then seek back to that sector: the next write starts
+ * there and covers these bytes again.
+ */
+static void write_tail(void)
 {
-    if (s_log_file != NULL) {
+    if (!s_file_binary) {
+        xSemaphoreTake(s_buf_mutex, portMAX_DELAY);
+        s_tail_len = s_active->binary ? 0 : s_active->carry;
+        memcpy(s_tail, s_active->data, s_tail_len);
+        xSemaphoreGive(s_buf_mutex);
+    }
+    s_tail_since_us = 0;
+    if (s_tail_len == 0) {
+        return;
+    }
+    ssize_t written = write(s_log_fd, s_tail, s_tail_len);
+    if (written != (ssize_t)s_tail_len) {
+        s_stats.write_errors++;
+        ESP_LOGW(TAG, "SD tail write failed (%d of %lu bytes)", (int)written,
+                 (unsigned long)s_tail_len);
+    }
+    lseek(s_log_fd, s_file_bytes, SEEK_SET);
+}
+
+static void close_log_file(void)
+{
+    if (s_log_fd >= 0) {
+        write_tail();
+        fsync(s_log_fd);
+        close(s_log_fd);
+        s_log_fd = -1;
+    }
+    if (s_idx_fd >= 0) {
+        fsync(s_idx_fd);
+        close(s_idx_fd);
+        s_idx_fd = -1;
+    }
+}
+
+static void open_log_file(bool binary)
+{
+    if (s_log_fd >= 0) {
         return;
     }
     if (!sdcard_manager_is_mounted()) {
         return;
     }
 
-    /* Generate filename from uptime since we may not have RTC time */
+    /* Name the file by wall-clock time (UTC) if the clock is set, else by
+     * uptime. Uptime at this point is much the same every boot, so add a
+     * suffix rather than append to (and desync the index of) an earlier
+     * session's file. */
     char filename[128];
-    int64_t uptime_sec = esp_log_timestamp() / 1000;
-    snprintf(filename, sizeof(filename), "%s/log_%lld.txt", FT_LOGS_DIR, (long long)uptime_sec);
-
-    s_log_file = fopen(filename, "a");
-    if (s_log_file != NULL) {
-        ESP_LOGI(TAG, "Logging to: %s", filename);
+    char stamp[24];
+    int64_t wall_us = wall_clock_us(esp_timer_get_time());
+    if (wall_us != 0) {
+        wall_clock_format(stamp, sizeof(stamp), wall_us, true);
     } else {
+        snprintf(stamp, sizeof(stamp), "%lu", (unsigned long)(esp_log_timestamp() / 1000));
+    }
+    const char *ext = binary ? "ftl" : "txt";
+    struct stat st;
+    snprintf(filename, sizeof(filename), "%s/log_%s.%s", FT_LOGS_DIR, stamp, ext);
+    for (int n = 1; stat(filename, &st) == 0 && n < 1000; n++) {
+        snprintf(filename, sizeof(filename), "%s/log_%s_%d.%s", FT_LOGS_DIR, stamp, n, ext);
+    }
+
+    s_log_fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (s_log_fd < 0) {
         ESP_LOGW(TAG, "Failed to open log file: %s", filename);
+        return;
+    }
+    ESP_LOGI(TAG, "Logging to: %s", filename);
+    s_file_binary = binary;
+    s_file_bytes = 0;
+    s_file_lines = 0;
+    s_tail_len = 0;
+    s_tail_since_us = 0;
+
+    if (binary) {
+        /* Goes out in front of the first block */
+        log_codec_file_header_t hdr;
+        log_codec_file_header(&hdr);
+        memcpy(s_tail, &hdr, sizeof(hdr));
+        s_tail_len = sizeof(hdr);
+        return;
+    }
+
+    char idx_name[128];
+    log_index_path(filename, idx_name, sizeof(idx_name));
+    s_idx_fd = open(idx_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (s_idx_fd >= 0 && log_index_write_header(s_idx_fd) != ESP_OK) {
+        index_abandon("header write failed");
+    }
+}
+
+/* Append a written buffer's blocks to the index, rebased onto the file */
+static void write_index(write_buf_t *buf)
+{
+    if (s_idx_fd < 0 || buf->block_count == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < buf->block_count; i++) {
+        buf->blocks[i].offset += s_file_bytes;
+        buf->blocks[i].first_line += s_file_lines;
+    }
+    size_t len = buf->block_count * sizeof(log_index_block_t);
+    if (write(s_idx_fd, buf->blocks, len) != (ssize_t)len) {
+        index_abandon("write failed");
+    }
+}
+
+/* Write one buffer's whole sectors to the card (writer task, no locks held) */
+static void write_buffer(write_buf_t *buf)
+{
+    if (buf->lines == 0) {
+        return;
+    }
+    if (s_log_fd >= 0 && buf->binary != s_file_binary) {
+        close_log_file();
+    }
+    open_log_file(buf->binary);
+    if (s_log_fd < 0) {
+        return;
+    }
+
+    /* A text buffer was cut at a sector when it was swapped out */
+    const void *out = buf->data;
+    uint32_t out_len = buf->fill;
+    uint32_t sealed = 0;
+    int64_t start = esp_timer_get_time();
+    if (buf->binary) {
+        memcpy(s_pack, s_tail, s_tail_len);
+        sealed = log_codec_seal_block(&buf->enc, (const uint8_t *)buf->data, buf->fill,
+                                      s_file_lines, s_pack + s_tail_len, s_lz_work);
+        uint32_t total = s_tail_len + sealed;
+        out = s_pack;
+        out_len = total & ~(uint32_t)(FT_LOG_SD_ALIGN - 1);
+        s_tail_len = total - out_len;
+        memcpy(s_tail, s_pack + out_len, s_tail_len);
+    }
+    ssize_t written = out_len > 0 ? write(s_log_fd, out, out_len) : 0;
+    int64_t end = esp_timer_get_time();
+
+    if (written != (ssize_t)out_len) {
+        s_stats.write_errors++;
+        ESP_LOGW(TAG, "SD write failed (%d of %lu bytes)", (int)written, (unsigned long)out_len);
+        index_abandon("log offsets unknown after a failed write");
+
+        /* The buffer's lines are lost: count them and mark the spot in the next one */
+        xSemaphoreTake(s_buf_mutex, portMAX_DELAY);
+        s_stats.lines_dropped += buf->lines;
+        s_stats.bytes_dropped += buf->text_bytes;
+        s_gap_lines += buf->lines;
+        s_gap_bytes += buf->text_bytes;
+        s_gap_reason = "SD write failed";
+        xSemaphoreGive(s_buf_mutex);
+        return;
+    }
+
+    write_index(buf);
+    s_file_bytes += out_len;
+    s_file_lines += buf->lines;
+
+    uint32_t flush_us = (uint32_t)(end - start);
+    uint32_t commit_ms = (uint32_t)((end - buf->first_us) / 1000);
+    uint32_t stored = buf->binary ? sealed : buf->text_bytes;
+    latency_record(LAT_STAGE_SD_WRITE, flush_us, out_len);
+    latency_record(LAT_STAGE_SD_COMMIT, (uint32_t)(end - buf->first_us), stored);
+    s_stats.flushes++;
+    s_stats.lines_written += buf->lines;
+    s_stats.bytes_written += stored;
+    s_stats.text_bytes += buf->text_bytes;
+    s_stats.last_flush_us = flush_us;
+    if (flush_us > s_stats.max_flush_us) {
+        s_stats.max_flush_us = flush_us;
+    }
+    s_stats.last_commit_ms = commit_ms;
+    if (commit_ms > s_stats.max_commit_ms) {
+        s_stats.max_commit_ms = commit_ms;
     }
 }
 
 static void log_writer_task(void *arg)
 {
-    log_entry_t entry;
+    int64_t last_sync_us = esp_timer_get_time();
+    bool dirty = false;
 
-    open_log_file();
+    open_log_file(s_config.binary);
 
     while (true) {
-        if (xQueueReceive(s_log_queue, &entry, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            if (s_log_file != NULL) {
-                fprintf(s_log_file, "%s\n", entry.raw);
-                /* Flush periodically (every line for now — could batch later) */
-                fflush(s_log_file);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        int64_t now = esp_timer_get_time();
+
+        xSemaphoreTake(s_buf_mutex, portMAX_DELAY);
+        bool sync = s_sync_requested;
+        s_sync_requested = false;
+        uint32_t sync_interval_ms = s_config.sync_interval_ms;
+        int64_t flush_interval_us = (int64_t)s_config.flush_interval_ms * 1000;
+        xSemaphoreGive(s_buf_mutex);
+
+        /* Decide what to write under the lock, do the I/O outside it. A
+         * sync pass covers what was buffered when it was asked for: the
+         * pending buffer, then one more swap for the lines behind it.
+         * Lines that keep coming in wait for the next pass, so steady
+         * input can't hold the fsync off. */
+        bool cover = sync;
+        while (true) {
+            xSemaphoreTake(s_buf_mutex, portMAX_DELAY);
+            if (!s_spare_busy) {
+                if (s_active->lines > 0 &&
+                    (cover || s_active->fill >= s_config.flush_bytes ||
+                     now - s_active->first_us >= flush_interval_us)) {
+                    swap_buffers();
+                }
+                cover = false;
+            }
+            write_buf_t *to_write = s_spare_busy ? s_spare : NULL;
+            xSemaphoreGive(s_buf_mutex);
+
+            if (to_write == NULL) {
+                break;
             }
+
+            write_buffer(to_write);
+            dirty = true;
+
+            xSemaphoreTake(s_buf_mutex, portMAX_DELAY);
+            uint32_t tail = s_file_binary ? s_tail_len : s_active->carry;
+            buf_reset(s_spare);
+            s_spare_busy = false;
+            xSemaphoreGive(s_buf_mutex);
+
+            /* The tail's lines are due when the oldest of them is */
+            if (tail == 0) {
+                s_tail_since_us = 0;
+            } else if (s_tail_since_us == 0 || to_write->first_us < s_tail_since_us) {
+                s_tail_since_us = to_write->first_us;
+            }
+
+            if (!cover) {
+                break;
+            }
+        }
+
+        if (sync_interval_ms > 0 && now - last_sync_us >= (int64_t)sync_interval_ms * 1000) {
+            sync = true;
+        }
+        if (s_tail_since_us != 0 && s_log_fd >= 0 &&
+            (sync || now - s_tail_since_us >= flush_interval_us)) {
+            write_tail();
+            dirty = true;
+        }
+        if (sync && dirty && s_log_fd >= 0) {
+            fsync(s_log_fd);
+            if (s_idx_fd >= 0) {
+                fsync(s_idx_fd);
+            }
+            s_stats.syncs++;
+            dirty = false;
+            last_sync_us = esp_timer_get_time();
         }
     }
 }
 
 esp_err_t log_storage_init(void)
 {
-    s_log_queue = xQueueCreate(LOG_QUEUE_LEN, sizeof(log_entry_t));
-    if (s_log_queue == NULL) {
+    for (int i = 0; i < 2; i++) {
+        s_bufs[i].data = heap_caps_aligned_alloc(FT_LOG_SD_ALIGN, FT_LOG_SD_BUF_SIZE,
+                                                 MALLOC_CAP_SPIRAM);
+        s_bufs[i].blocks = heap_caps_malloc(MAX_BUF_BLOCKS * sizeof(log_index_block_t),
+                                            MALLOC_CAP_SPIRAM);
+        if (s_bufs[i].data == NULL || s_bufs[i].blocks == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        buf_reset(&s_bufs[i]);
+    }
+    s_active = &s_bufs[0];
+    s_spare = &s_bufs[1];
+
+    s_pack = heap_caps_aligned_alloc(FT_LOG_SD_ALIGN,
+                                     FT_LOG_SD_ALIGN + LOG_CODEC_BLOCK_BOUND(FT_LOG_SD_BUF_SIZE),
+                                     MALLOC_CAP_SPIRAM);
+    s_tail = heap_caps_aligned_alloc(FT_LOG_SD_ALIGN, FT_LOG_SD_ALIGN, MALLOC_CAP_SPIRAM);
+    s_lz_work = heap_caps_malloc(LOG_CODEC_WORK_SIZE, MALLOC_CAP_INTERNAL);
+    if (s_pack == NULL || s_tail == NULL || s_lz_work == NULL) {
         return ESP_ERR_NO_MEM;
     }
 
-    BaseType_t ret = xTaskCreatePinnedToCore(log_writer_task, "log_writer", 4096, NULL, 1, NULL, 1);
+    s_buf_mutex = xSemaphoreCreateMutex();
+    if (s_buf_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    BaseType_t ret = xTaskCreatePinnedToCore(log_writer_task, "log_writer", 4096, NULL, 1,
+                                             &s_writer_task, 1);
     if (ret != pdPASS) {
         return ESP_ERR_NO_MEM;
     }
 
-    ESP_LOGI(TAG, "Log storage initialized");
+    ESP_LOGI(TAG, "Log storage initialized (2 x %d KB buffers)", FT_LOG_SD_BUF_SIZE / 1024);
     return ESP_OK;
 }
 
-void log_storage_write(const log_entry_t *entry)
+void log_storage_write(const log_span_t *span)
+{
+    if (s_buf_mutex == NULL) {
+        return;
+    }
+
+    uint32_t len = span->raw_len + 1;  /* + newline */
+    uint32_t bound = line_bound(span->raw_len);
+    bool wake = false;
+
+    xSemaphoreTake(s_buf_mutex, portMAX_DELAY);
+
+    if (s_active->fill + bound > FT_LOG_SD_BUF_SIZE) {
+        if (s_spare_busy) {
+            /* Card is a full buffer behind — drop rather than block serial RX */
+            s_stats.lines_dropped++;
+            s_stats.bytes_dropped += len;
+            s_gap_lines++;
+            s_gap_bytes += len;
+            s_gap_reason = "SD card too slow";
+            xSemaphoreGive(s_buf_mutex);
+            return;
+        }
+        swap_buffers();
+        wake = true;
+    }
+
+    if (s_active->lines == 0) {
+        /* Carried text stays text; a switch to binary waits a buffer */
+        s_active->first_us = esp_timer_get_time();
+        s_active->binary = s_config.binary && s_active->carry == 0;
+    }
+
+    /* Leave a visible mark in the file where lines went missing */
+    if (s_gap_lines > 0) {
+        char marker[80];
+        int n = snprintf(marker, sizeof(marker),
+                         "--- %lu lines (%lu bytes) lost: %s ---\n",
+                         (unsigned long)s_gap_lines, (unsigned long)s_gap_bytes, s_gap_reason);
+        if (n > 0 && n < (int)sizeof(marker) &&
+            s_active->fill + line_bound(n - 1) + bound <= FT_LOG_SD_BUF_SIZE) {
+            log_span_t marker_span = { .raw = marker, .raw_len = n - 1, .level = ' ' };
+            append_line(s_active, &marker_span);
+            s_gap_lines = 0;
+            s_gap_bytes = 0;
+        }
+    }
+
+    append_line(s_active, span);
+
+    if (s_active->fill >= s_config.flush_bytes) {
+        wake = true;
+    }
+    if (span->level == 'E' && s_config.sync_on_error) {
+        s_sync_requested = true;
+        wake = true;
+    }
+
+    xSemaphoreGive(s_buf_mutex);
+
+    if (wake) {
+        xTaskNotifyGive(s_writer_task);
+    }
+}
+
+void log_storage_sync(void)
+{
+    if (s_buf_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_buf_mutex, portMAX_DELAY);
+    s_sync_requested = true;
+    xSemaphoreGive(s_buf_mutex);
+    xTaskNotifyGive(s_writer_task);
+}
+
+void log_storage_on_disconnect(void)
+{
+    if (s_config.sync_on_disconnect) {
+        log_storage_sync();
+    }
+}
+
+void log_storage_set_config(const log_storage_config_t *config)
 {
-    if (s_log_queue == NULL) {
+    if (s_buf_mutex == NULL) {
+        s_config = *config;
         return;
     }
-    /* Non-blocking: drop if queue is full (don't block serial RX) */
-    xQueueSend(s_log_queue, entry, 0);
+    xSemaphoreTake(s_buf_mutex, portMAX_DELAY);
+    s_config = *config;
+    if (s_config.flush_bytes > FT_LOG_SD_BUF_SIZE) {
+        s_config.flush_bytes = FT_LOG_SD_BUF_SIZE;
+    }
+    xSemaphoreGive(s_buf_mutex);
+}
+
+void log_storage_get_config(log_storage_config_t *config)
+{
+    *config = s_config;
+}
+
+void log_storage_get_stats(log_storage_stats_t *stats)
+{
+    *stats = s_stats;
 }
@@ -2,6 +2,38 @@
 
 #include "log_parser.h"
 #include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Flush/sync policy for the SD log writer
+ */
+typedef struct {
+    uint32_t flush_bytes;       /* Write out once this many bytes are buffered */
+    uint32_t flush_interval_ms; /* ...or once the oldest buffered line is this old */
+    uint32_t sync_interval_ms;  /* fsync at most this often (0 = only on events below) */
+    bool     sync_on_error;     /* fsync as soon as an 'E' line is buffered */
+    bool     sync_on_disconnect;/* fsync when the target disconnects */
+    bool     binary;            /* Compressed .ftl blocks (log_codec.h) instead of .txt */
+} log_storage_config_t;
+
+/**
+ * Writer counters (monotonic since boot)
+ */
+typedef struct {
+    uint32_t lines_written;
+    uint32_t bytes_written;     /* On the card (compressed in binary mode) */
+    uint32_t text_bytes;        /* What the written lines take as text */
+    uint32_t lines_dropped;     /* Both buffers full — SD card too slow */
+    uint32_t bytes_dropped;
+    uint32_t flushes;
+    uint32_t syncs;
+    uint32_t write_errors;
+    uint32_t last_flush_us;     /* Duration of the last write() */
+    uint32_t max_flush_us;
+    uint32_t last_commit_ms;    /* Oldest line's wait from buffering to on-card */
+    uint32_t max_commit_ms;
+} log_storage_stats_t;
 
 /**
  * @brief Initialize the log storage writer (creates background task)
@@ -10,7 +42,40 @@
 esp_err_t log_storage_init(void);
 
 /**
- * @brief Queue a log entry to be written to SD card
- * @param entry The parsed log entry
+ * @brief Buffer a log line to be written to SD card
+ *
+ * Copies only the raw bytes into the active write buffer and never
+ * blocks on the card. Drops (and counts) the line if both buffers are full.
+ *
+ * @param span The parsed log line
+ */
+void log_storage_write(const log_span_t *span);
+
+/**
+ * @brief Ask the writer to flush everything buffered and fsync now
+ *
+ * Returns immediately; the writer task does the work.
+ */
+void log_storage_sync(void);
+
+/**
+ * @brief Notify the writer that the target disconnected
+ *
+ * Syncs if the config asks for it.
+ */
+void log_storage_on_disconnect(void);
+
+/**
+ * @brief Replace the flush/sync policy
+ */
+void log_storage_set_config(const log_storage_config_t *config);
+
+/**
+ * @brief Get the current flush/sync policy
+ */
+void log_storage_get_config(log_storage_config_t *config);
+
+/**
+ * @brief Get a snapshot of the writer counters
  */
-void log_storage_write(const log_entry_t *entry);
+void log_storage_get_stats(log_storage_stats_t *stats);
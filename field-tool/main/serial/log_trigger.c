@@ -0,0 +1,511 @@
+#include "log_trigger.h"
+#include "serial_monitor.h"
+#include "sdcard/sdcard_manager.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+static const char *TAG = "LOG_TRIGGER";
+
+/* ── Automaton ──────────────────────────────────────────────────────── */
+
+/*
+ * Dense DFA: delta[state * n_classes + class] is the next state, with
+ * DELTA_HIT set when that state ends at least one pattern (itself or via
+ * its suffix chain). Bytes that appear in no pattern share class 0, so
+ * the table is only as wide as the patterns' alphabet.
+ */
+
+#define DELTA_HIT    (0x8000)
+#define DELTA_STATE  (0x7FFF)
+#define NO_STATE     (0xFFFF)
+#define NO_PATTERN   (-1)
+
+typedef struct {
+    log_trigger_info_t info;
+    uint8_t            len;
+    uint32_t           last_line;   /* Dedupe: line number of the latest hit */
+} trigger_t;
+
+typedef struct {
+    uint16_t   n_states;
+    uint16_t   n_classes;
+    uint16_t   n_patterns;
+    uint8_t    byte_class[256];
+    uint16_t  *delta;           /* n_states * n_classes */
+    int16_t   *out;             /* Pattern ending exactly at a state, or NO_PATTERN */
+    uint16_t  *dict;            /* Next state on the suffix chain with a pattern, 0 = none */
+    trigger_t *triggers;
+} automaton_t;
+
+/* ── State ──────────────────────────────────────────────────────────── */
+
+static automaton_t *s_active;                   /* RX task reads; swapped under s_mutex */
+static _Atomic(automaton_t *) s_pending;
+static SemaphoreHandle_t s_mutex;               /* Guards s_active for readers outside RX */
+
+static uint32_t s_line_no;                      /* RX task: lines scanned */
+static volatile uint32_t s_total_hits;
+static volatile int32_t s_last_index = NO_PATTERN;
+static volatile uint32_t s_pause_requests;
+
+typedef struct {
+    uint32_t seq;
+    uint16_t index;
+    char     text[FT_TRIGGER_PATTERN_MAX_LEN];
+} snapshot_req_t;
+
+static QueueHandle_t s_snapshot_queue;
+
+static const log_trigger_pattern_t s_default_patterns[] = {
+    { "Guru Meditation",   LOG_TRIGGER_PAUSE | LOG_TRIGGER_SNAPSHOT },
+    { "abort()",           LOG_TRIGGER_PAUSE | LOG_TRIGGER_SNAPSHOT },
+    { "Brownout",          LOG_TRIGGER_SNAPSHOT },
+    { "stack overflow",    LOG_TRIGGER_PAUSE | LOG_TRIGGER_SNAPSHOT },
+    { "assert failed",     LOG_TRIGGER_PAUSE | LOG_TRIGGER_SNAPSHOT },
+    { "rst:0x",            0 },
+};
+
+/* ── Build ──────────────────────────────────────────────────────────── */
+
+static void *alloc_table(size_t size)
+{
+    /* Tables can reach a few hundred KB with many patterns — prefer PSRAM */
+    void *p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    return p ? p : heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+}
+
+static void automaton_free(automaton_t *a)
+{
+    if (a == NULL) {
+        return;
+    }
+    heap_caps_free(a->delta);
+    heap_caps_free(a->out);
+    heap_caps_free(a->dict);
+    heap_caps_free(a->triggers);
+    heap_caps_free(a);
+}
+
+static automaton_t *automaton_build(const log_trigger_pattern_t *patterns, uint16_t count)
+{
+    automaton_t *a = alloc_table(sizeof(automaton_t));
+    if (a == NULL) {
+        return NULL;
+    }
+    memset(a, 0, sizeof(*a));
+
+    /* Byte classes: one per distinct byte used by any pattern, 0 for the rest */
+    size_t max_states = 1;
+    a->n_classes = 1;
+    for (uint16_t i = 0; i < count; i++) {
+        for (const uint8_t *p = (const uint8_t *)patterns[i].text; *p; p++) {
+            if (a->byte_class[*p] == 0) {
+                a->byte_class[*p] = a->n_classes++;
+            }
+            max_states++;
+        }
+    }
+
+    size_t row = a->n_classes;
+    a->delta = alloc_table(max_states * row * sizeof(uint16_t));
+    a->out = alloc_table(max_states * sizeof(int16_t));
+    a->dict = alloc_table(max_states * sizeof(uint16_t));
+    a->triggers = alloc_table((count ? count : 1) * sizeof(trigger_t));
+    uint16_t *fail = alloc_table(max_states * sizeof(uint16_t));
+    uint16_t *queue = alloc_table(max_states * sizeof(uint16_t));
+    if (!a->delta || !a->out || !a->dict || !a->triggers || !fail || !queue) {
+        heap_caps_free(fail);
+        heap_caps_free(queue);
+        automaton_free(a);
+        return NULL;
+    }
+    memset(a->delta, 0xFF, max_states * row * sizeof(uint16_t));
+    memset(a->triggers, 0, (count ? count : 1) * sizeof(trigger_t));
+
+    /* Trie */
+    a->n_states = 1;
+    a->out[0] = NO_PATTERN;
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t s = 0;
+        for (const uint8_t *p = (const uint8_t *)patterns[i].text; *p; p++) {
+            uint16_t *next = &a->delta[s * row + a->byte_class[*p]];
+            if (*next == NO_STATE) {
+                *next = a->n_states;
+                a->out[a->n_states] = NO_PATTERN;
+                a->n_states++;
+            }
+            s = *next;
+        }
+        if (a->out[s] != NO_PATTERN) {
+            ESP_LOGW(TAG, "Duplicate pattern ignored: %s", patterns[i].text);
+            continue;
+        }
+        trigger_t *t = &a->triggers[a->n_patterns];
+        t->len = strlen(patterns[i].text);
+        memcpy(t->info.text, patterns[i].text, t->len + 1);
+        t->info.actions = patterns[i].actions;
+        t->last_line = UINT32_MAX;
+        a->out[s] = a->n_patterns++;
+    }
+
+    /* Failure links breadth-first; missing edges become the failure
+     * state's edge, turning the trie into a DFA */
+    size_t head = 0, tail = 0;
+    a->dict[0] = 0;
+    for (size_t c = 0; c < row; c++) {
+        uint16_t t = a->delta[c];
+        if (t == NO_STATE) {
+            a->delta[c] = 0;
+        } else {
+            fail[t] = 0;
+            a->dict[t] = 0;
+            queue[tail++] = t;
+        }
+    }
+    while (head < tail) {
+        uint16_t s = queue[head++];
+        for (size_t c = 0; c < row; c++) {
+            uint16_t t = a->delta[s * row + c];
+            uint16_t f = a->delta[fail[s] * row + c];   /* Shallower, already complete */
+            if (t == NO_STATE) {
+                a->delta[s * row + c] = f;
+            } else {
+                fail[t] = f;
+                a->dict[t] = (a->out[f] != NO_PATTERN) ? f : a->dict[f];
+                queue[tail++] = t;
+            }
+        }
+    }
+
+    /* Mark edges into states that end a pattern */
+    for (size_t i = 0; i < (size_t)a->n_states * row; i++) {
+        uint16_t t = a->delta[i];
+        if (a->out[t] != NO_PATTERN || a->dict[t] != 0) {
+            a->delta[i] = t | DELTA_HIT;
+        }
+    }
+
+    heap_caps_free(fail);
+    heap_caps_free(queue);
+    return a;
+}
+
+/* ── Matching (RX task) ─────────────────────────────────────────────── */
+
+static void fire(automaton_t *a, int16_t index, uint32_t seq)
+{
+    trigger_t *t = &a->triggers[index];
+    if (t->last_line == s_line_no) {
+        return;     /* Already counted on this line */
+    }
+    t->last_line = s_line_no;
+
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    if (t->info.count == 0) {
+        t->info.first_ms = now_ms;
+    }
+    t->info.count++;
+    t->info.last_ms = now_ms;
+    t->info.last_seq = seq;
+    s_total_hits++;
+    s_last_index = index;
+
+    if (t->info.actions & LOG_TRIGGER_PAUSE) {
+        s_pause_requests++;
+    }
+    if ((t->info.actions & LOG_TRIGGER_SNAPSHOT) && s_snapshot_queue) {
+        snapshot_req_t req = { .seq = seq, .index = index };
+        memcpy(req.text, t->info.text, t->len + 1);
+        if (xQueueSend(s_snapshot_queue, &req, 0) != pdTRUE) {
+            ESP_LOGW(TAG, "Snapshot queue full, skipped: %s", t->info.text);
+        }
+    }
+    ESP_LOGW(TAG, "Trigger \"%s\" (#%lu)", t->info.text, (unsigned long)t->info.count);
+}
+
+static void adopt_pending(void)
+{
+    if (atomic_load_explicit(&s_pending, memory_order_relaxed) == NULL) {
+        return;
+    }
+    /* Never block ingest — try again at the next line if a reader holds it */
+    if (xSemaphoreTake(s_mutex, 0) != pdTRUE) {
+        return;
+    }
+    automaton_t *old = s_active;
+    s_active = atomic_exchange_explicit(&s_pending, NULL, memory_order_acquire);
+    s_total_hits = 0;
+    s_last_index = NO_PATTERN;
+    xSemaphoreGive(s_mutex);
+    automaton_free(old);
+}
+
+void log_trigger_process(const log_span_t *span, uint32_t seq)
+{
+    adopt_pending();
+
+    automaton_t *a = s_active;
+    if (a == NULL || a->n_patterns == 0) {
+        return;
+    }
+
+    s_line_no++;
+    const uint16_t *delta = a->delta;
+    const uint8_t *cls = a->byte_class;
+    const uint8_t *p = (const uint8_t *)span->raw;
+    const uint8_t *end = p + span->raw_len;
+    uint32_t row = a->n_classes;
+    uint32_t s = 0;
+
+    /* Patterns never span lines, so every line starts from the root */
+    while (p < end) {
+        uint16_t t = delta[s * row + cls[*p++]];
+        s = t & DELTA_STATE;
+        if (t & DELTA_HIT) {
+            for (uint16_t k = s; k != 0; k = a->dict[k]) {
+                if (a->out[k] != NO_PATTERN) {
+                    fire(a, a->out[k], seq);
+                }
+            }
+        }
+    }
+}
+
+/* ── Snapshot writer ────────────────────────────────────────────────── */
+
+static void write_snapshot(const snapshot_req_t *req)
+{
+    if (!sdcard_manager_is_mounted()) {
+        ESP_LOGW(TAG, "No SD card, snapshot skipped");
+        return;
+    }
+    sdcard_manager_ensure_dir(FT_LOGS_DIR);
+
+    /* Uptime repeats across boots and several triggers can fire within a
+     * second, so add a suffix rather than overwrite an earlier snapshot */
+    char filename[96];
+    unsigned long uptime_s = (unsigned long)(esp_timer_get_time() / 1000000);
+    struct stat st;
+    snprintf(filename, sizeof(filename), "%s/trigger_%lu.txt", FT_LOGS_DIR, uptime_s);
+    for (int n = 1; stat(filename, &st) == 0 && n < 1000; n++) {
+        snprintf(filename, sizeof(filename), "%s/trigger_%lu_%d.txt", FT_LOGS_DIR, uptime_s, n);
+    }
+    FILE *f = fopen(filename, "w");
+    if (f == NULL) {
+        ESP_LOGW(TAG, "Failed to open %s", filename);
+        return;
+    }
+
+    fprintf(f, "# Trigger: %s\n# Line: %lu\n"
+               "# Context: lines kept by the display and network filters\n",
+            req->text, (unsigned long)req->seq);
+
+    /* Both history tiers, so context the ring has already compacted into
+     * the cold tier still makes it. They hold only lines routed to the
+     * display or the network, so the context follows those filters: with
+     * the display at "Error", the lines before a crash are only the
+     * errors among them. */
+    uint32_t seq = req->seq - FT_TRIGGER_SNAPSHOT_PRE;
+    uint32_t first = serial_monitor_first_seq();
+    if ((int32_t)(first - seq) > 0) {
+        seq = first;
+    }
+    uint32_t end = log_ring_next_seq(serial_monitor_get_ring());
+    char buf[FT_LOG_LINE_MAX_LEN];
+    log_span_t span;
+    uint32_t lines = 0, missing = 0;
+    for (; (int32_t)(seq - end) < 0; seq++) {
+        if (serial_monitor_read_line(seq, buf, sizeof(buf), &span) != LOG_RING_READ_OK) {
+            missing++;          /* Evicted before it was compacted */
+            continue;
+        }
+        fwrite(span.raw, 1, span.raw_len, f);
+        fputc('\n', f);
+        lines++;
+    }
+    if (missing > 0) {
+        fprintf(f, "# %lu lines no longer held\n", (unsigned long)missing);
+    }
+    fclose(f);
+    ESP_LOGI(TAG, "Snapshot %s: %lu lines", filename, (unsigned long)lines);
+}
+
+static void snapshot_task(void *arg)
+{
+    snapshot_req_t req;
+    while (true) {
+        if (xQueueReceive(s_snapshot_queue, &req, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        /* Let the lines after the trigger (backtrace, reboot) arrive first */
+        vTaskDelay(pdMS_TO_TICKS(FT_TRIGGER_SNAPSHOT_POST_MS));
+        write_snapshot(&req);
+    }
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+esp_err_t log_trigger_set_patterns(const log_trigger_pattern_t *patterns, uint16_t count)
+{
+    if (count > FT_TRIGGER_MAX_PATTERNS || (count > 0 && patterns == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        size_t len = patterns[i].text ? strlen(patterns[i].text) : 0;
+        if (len == 0 || len >= FT_TRIGGER_PATTERN_MAX_LEN) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    int64_t start = esp_timer_get_time();
+    automaton_t *a = automaton_build(patterns, count);
+    if (a == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "%u patterns -> %u states x %u classes (%u KB) in %lld us",
+             a->n_patterns, a->n_states, a->n_classes,
+             (unsigned)((size_t)a->n_states * a->n_classes * 2 / 1024),
+             (long long)(esp_timer_get_time() - start));
+
+    automaton_free(atomic_exchange_explicit(&s_pending, a, memory_order_acq_rel));
+    return ESP_OK;
+}
+
+esp_err_t log_trigger_load_file(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    log_trigger_pattern_t *patterns = heap_caps_malloc(
+        FT_TRIGGER_MAX_PATTERNS * sizeof(log_trigger_pattern_t), MALLOC_CAP_DEFAULT);
+    char (*texts)[FT_TRIGGER_PATTERN_MAX_LEN] = alloc_table(
+        FT_TRIGGER_MAX_PATTERNS * FT_TRIGGER_PATTERN_MAX_LEN);
+    if (patterns == NULL || texts == NULL) {
+        heap_caps_free(patterns);
+        heap_caps_free(texts);
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint16_t count = 0;
+    char line[FT_TRIGGER_PATTERN_MAX_LEN + 32];
+    while (count < FT_TRIGGER_MAX_PATTERNS && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char *text = line;
+        uint8_t actions = 0;
+
+        if (*text == '#' || *text == '\0') {
+            continue;
+        }
+        if (*text == '[') {
+            char *close = strchr(text, ']');
+            if (close == NULL) {
+                ESP_LOGW(TAG, "Bad action list: %s", line);
+                continue;
+            }
+            *close = '\0';
+            if (strstr(text, "pause")) {
+                actions |= LOG_TRIGGER_PAUSE;
+            }
+            if (strstr(text, "snapshot")) {
+                actions |= LOG_TRIGGER_SNAPSHOT;
+            }
+            text = close + 1;
+            while (*text == ' ') {
+                text++;
+            }
+        }
+
+        size_t len = strlen(text);
+        if (len == 0 || len >= FT_TRIGGER_PATTERN_MAX_LEN) {
+            ESP_LOGW(TAG, "Pattern skipped (empty or too long): %s", text);
+            continue;
+        }
+        memcpy(texts[count], text, len + 1);
+        patterns[count].text = texts[count];
+        patterns[count].actions = actions;
+        count++;
+    }
+    fclose(f);
+
+    esp_err_t err = log_trigger_set_patterns(patterns, count);
+    heap_caps_free(patterns);
+    heap_caps_free(texts);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Loaded %u patterns from %s", count, path);
+    }
+    return err;
+}
+
+esp_err_t log_trigger_init(void)
+{
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        s_snapshot_queue = xQueueCreate(2, sizeof(snapshot_req_t));
+        if (s_mutex == NULL || s_snapshot_queue == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        xTaskCreate(snapshot_task, "trig_snap", 4096, NULL, 3, NULL);
+    }
+
+    if (log_trigger_load_file(FT_TRIGGERS_FILE) == ESP_OK) {
+        return ESP_OK;
+    }
+    ESP_LOGI(TAG, "No %s, using built-in patterns", FT_TRIGGERS_FILE);
+    return log_trigger_set_patterns(s_default_patterns,
+                                    sizeof(s_default_patterns) / sizeof(s_default_patterns[0]));
+}
+
+uint16_t log_trigger_pattern_count(void)
+{
+    if (s_mutex == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint16_t n = s_active ? s_active->n_patterns : 0;
+    xSemaphoreGive(s_mutex);
+    return n;
+}
+
+bool log_trigger_get(uint16_t index, log_trigger_info_t *info)
+{
+    if (s_mutex == NULL || info == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool ok = s_active && index < s_active->n_patterns;
+    if (ok) {
+        *info = s_active->triggers[index].info;
+    }
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+bool log_trigger_get_last(log_trigger_info_t *info)
+{
+    int32_t index = s_last_index;
+    return index != NO_PATTERN && log_trigger_get((uint16_t)index, info);
+}
+
+uint32_t log_trigger_total_hits(void)
+{
+    return s_total_hits;
+}
+
+uint32_t log_trigger_pause_requests(void)
+{
+    return s_pause_requests;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "log_parser.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Multi-pattern trigger engine.
+ *
+ * All patterns are compiled into one Aho-Corasick automaton (a dense DFA
+ * over byte classes), so each incoming line is scanned once, one table
+ * lookup per byte, no matter how many patterns are loaded. A pattern
+ * counts at most once per line.
+ *
+ * Patterns come from FT_TRIGGERS_FILE, one per line. Blank lines and
+ * lines starting with '#' are ignored. A pattern may start with an action
+ * list in brackets:
+ *
+ *     [pause,snapshot] Guru Meditation
+ *     [snapshot] Brownout
+ *     rst:0x
+ *
+ * Without the file a built-in crash/reset list is used.
+ *
+ * Patterns see every line, whatever the filters say. A snapshot, though,
+ * is read back from the line history (ring and cold tier), which keeps
+ * only the lines routed to the display or the network: its context
+ * follows those filters.
+ */
+
+#define LOG_TRIGGER_PAUSE     (1 << 0)  /* Ask the serial monitor UI to pause */
+#define LOG_TRIGGER_SNAPSHOT  (1 << 1)  /* Save the surrounding history lines to SD */
+
+/**
+ * Pattern definition for log_trigger_set_patterns()
+ */
+typedef struct {
+    const char *text;       /* Matched literally and case-sensitively */
+    uint8_t     actions;    /* LOG_TRIGGER_* */
+} log_trigger_pattern_t;
+
+/**
+ * Pattern with its hit statistics
+ */
+typedef struct {
+    char     text[FT_TRIGGER_PATTERN_MAX_LEN];
+    uint8_t  actions;
+    uint32_t count;         /* Lines that matched */
+    uint32_t first_ms;      /* Tool uptime of the first hit */
+    uint32_t last_ms;       /* Tool uptime of the latest hit */
+    uint32_t last_seq;      /* Ring sequence number of the latest hit */
+} log_trigger_info_t;
+
+/**
+ * @brief Load patterns (FT_TRIGGERS_FILE or the built-in list) and start
+ *        the snapshot writer task
+ */
+esp_err_t log_trigger_init(void);
+
+/**
+ * @brief Compile a pattern file and install it
+ * @return ESP_ERR_NOT_FOUND if the file can't be opened
+ */
+esp_err_t log_trigger_load_file(const char *path);
+
+/**
+ * @brief Compile patterns and install them (resets all statistics)
+ *
+ * Safe to call from any task; the RX task switches over at the next line.
+ * Duplicates are dropped.
+ *
+ * @return ESP_ERR_INVALID_ARG if a pattern is empty or longer than
+ *         FT_TRIGGER_PATTERN_MAX_LEN - 1, or there are more than
+ *         FT_TRIGGER_MAX_PATTERNS
+ */
+esp_err_t log_trigger_set_patterns(const log_trigger_pattern_t *patterns, uint16_t count);
+
+/**
+ * @brief Scan one line and fire matching triggers
+ *
+ * RX task only.
+ *
+ * @param span  The line
+ * @param seq   Ring sequence number the line has (or would have had)
+ */
+void log_trigger_process(const log_span_t *span, uint32_t seq);
+
+/**
+ * @brief Number of installed patterns
+ */
+uint16_t log_trigger_pattern_count(void);
+
+/**
+ * @brief Get a pattern and its statistics
+ * @return false if index is out of range
+ */
+bool log_trigger_get(uint16_t index, log_trigger_info_t *info);
+
+/**
+ * @brief Get the pattern that fired most recently
+ * @return false if nothing has fired since the patterns were installed
+ */
+bool log_trigger_get_last(log_trigger_info_t *info);
+
+/**
+ * @brief Total trigger hits since the patterns were installed
+ */
+uint32_t log_trigger_total_hits(void);
+
+/**
+ * @brief Number of pause requests since boot
+ *
+ * Goes up by one each time a LOG_TRIGGER_PAUSE pattern fires; the UI
+ * pauses when it sees the value change.
+ */
+uint32_t log_trigger_pause_requests(void);
@@ -1,6 +1,20 @@
 #include "serial_monitor.h"
 #include "log_parser.h"
+#include "log_ring.h"
 #include "log_storage.h"
+#include "line_framer.h"
+#include "tag_table.h"
+#include "log_filter.h"
+#include "log_trigger.h"
+#include "baud_detect.h"
+#include "latency_stats.h"
+#include "log_search.h"
+#include "log_cold.h"
+#include "log_dedup.h"
+#include "log_stats.h"
+#include "log_series.h"
+#include "clock_fit.h"
+#include "boot_profile.h"
 #include "app_config.h"
 #include "flasher_port.h"
 
@@ -15,8 +29,11 @@
 #include "bsp/esp-bsp.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 
 #include <string.h>
+#include <stdio.h>
+#include <stdatomic.h>
 
 static const char *TAG = "SERIAL_MON";
 
@@ -25,34 +42,71 @@ static const char *TAG = "SERIAL_MON";
 static volatile bool s_device_connected = false;
 static volatile bool s_initialized = false;
 static volatile bool s_flasher_mode = false;
+static volatile serial_monitor_bridge_cb_t s_bridge_cb = NULL;  /* Raw bytes to the network bridge */
+static void *volatile s_bridge_ctx = NULL;
 static volatile uint32_t s_total_lines = 0;
 
-/* Ring buffer in PSRAM */
-static log_entry_t *s_ring_buf = NULL;
-static volatile uint32_t s_ring_head = 0;  /* Next write position */
-static volatile uint32_t s_ring_count = 0; /* Number of valid entries */
-static SemaphoreHandle_t s_ring_mutex = NULL;
+/* Tag table resets (RX task), asked for by a clear or a new baud rate */
+static volatile bool s_tags_reset_pending = false;
+static uint32_t s_tags_reset_seq;               /* Ring seq at the last reset */
+static uint32_t s_tags_baud;                    /* Rate the interned tags came in at */
 
-/* USB data stream buffer */
+/* Ring buffer in PSRAM (packed line arena + slot table).
+ * Lock-free: serial_rx_task is the only writer, readers copy out. */
+static log_ring_t s_ring;
+
+/* USB data stream buffer (PSRAM, FT_SERIAL_RX_BUF_SIZE) */
 static StreamBufferHandle_t s_rx_stream = NULL;
-#define RX_STREAM_SIZE  (4096)
+static uint32_t s_rx_stream_size = 0;
+#define RX_STREAM_FALLBACK_SIZE  (4096)     /* Internal RAM if PSRAM is short */
+#define RX_CHUNK_SIZE   (2048)
+#define USB_TX_CHUNK    (512)      /* Device OUT buffer; bridge writes are split to fit */
+
+/* Loss accounting for the USB callback -> RX task hop. Bytes are counted
+ * in and out of the stream buffer so a drop can be placed exactly: the
+ * "N bytes lost" marker goes where the gap is in the byte stream. */
+static _Atomic uint32_t s_rx_in_bytes;          /* USB callback: accepted into the buffer */
+static uint32_t s_rx_out_bytes;                 /* RX task: taken out of the buffer */
+static _Atomic uint32_t s_rx_lost_pending;      /* Dropped, not yet marked */
+static volatile uint32_t s_rx_lost_pos;         /* s_rx_in_bytes at the first of them */
+static volatile uint32_t s_rx_lost_bytes;
+static volatile uint32_t s_rx_loss_events;
+static volatile uint32_t s_rx_buf_peak;
+static line_framer_t s_framer;                  /* RX task */
+
+/* Arrival time of each USB transfer, keyed by the s_rx_in_bytes offset
+ * just past it, so the RX task can time how long bytes sat in the buffer */
+#define RX_ARRIVAL_COUNT  (32)
+typedef struct {
+    uint32_t end;
+    uint32_t us;
+} rx_arrival_t;
+static rx_arrival_t s_rx_arrivals[RX_ARRIVAL_COUNT];
+static _Atomic uint32_t s_rx_arrival_head;      /* USB callback */
+static _Atomic uint32_t s_rx_arrival_tail;      /* RX task */
+static int64_t s_chunk_us;                      /* RX task: current chunk dequeued */
+
+/* RX task: the bytes being framed and their stream offset, so each line
+ * can look up the transfer that delivered its end */
+static const char *s_feed_data;                 /* NULL while replaying held bytes */
+static size_t s_feed_len;
+static uint32_t s_feed_start;
+static uint32_t s_feed_arrival;                 /* First transfer a later line can be in */
 
 /* Device handle */
 static cdc_acm_dev_hdl_t s_cdc_dev = NULL;
 static SemaphoreHandle_t s_device_disconnected_sem = NULL;
+static SemaphoreHandle_t s_dev_mutex = NULL;    /* Line coding vs. close */
 
-/* ── Ring buffer operations ──────────────────────────────────────────── */
+/* Baud rate: the UI sets s_baud_request (0 = auto); serial_rx_task owns
+ * the hunt and applies every change after the initial connect */
+static const uint32_t s_baud_candidates[] = FT_UART_BAUD_CANDIDATES;
+#define BAUD_CANDIDATE_COUNT  (sizeof(s_baud_candidates) / sizeof(s_baud_candidates[0]))
 
-static void ring_push(const log_entry_t *entry)
-{
-    xSemaphoreTake(s_ring_mutex, portMAX_DELAY);
-    memcpy(&s_ring_buf[s_ring_head], entry, sizeof(log_entry_t));
-    s_ring_head = (s_ring_head + 1) % FT_LOG_RING_SIZE;
-    if (s_ring_count < FT_LOG_RING_SIZE) {
-        s_ring_count++;
-    }
-    xSemaphoreGive(s_ring_mutex);
-}
+static volatile uint32_t s_baud_request = FT_UART_AUTO_BAUD ? 0 : FT_UART_BAUD_RATE;
+static volatile uint32_t s_baud_current = FT_UART_BAUD_RATE;    /* Rate set on the device */
+static volatile bool s_baud_changed = false;    /* Re-apply / restart the hunt */
+static volatile serial_baud_state_t s_baud_state = SERIAL_BAUD_FIXED;
 
 /* ── USB callbacks ──────────────────────────────────────────────────── */
 
@@ -61,8 +115,36 @@ static bool usb_rx_callback(const uint8_t *data, size_t data_len, void *arg)
     if (s_flasher_mode) {
         /* Route data to flasher's RX buffer during flash operations */
         flasher_port_feed_rx(data, data_len);
+    } else if (s_bridge_cb != NULL) {
+        s_bridge_cb(data, data_len, s_bridge_ctx);
     } else if (s_rx_stream != NULL) {
-        xStreamBufferSendFromISR(s_rx_stream, data, data_len, NULL);
+        size_t sent = xStreamBufferSendFromISR(s_rx_stream, data, data_len, NULL);
+        uint32_t in = atomic_load_explicit(&s_rx_in_bytes, memory_order_relaxed) + sent;
+        atomic_store_explicit(&s_rx_in_bytes, in, memory_order_relaxed);
+        if (sent > 0) {
+            uint32_t head = atomic_load_explicit(&s_rx_arrival_head, memory_order_relaxed);
+            if (head - atomic_load_explicit(&s_rx_arrival_tail, memory_order_acquire) <
+                RX_ARRIVAL_COUNT) {
+                s_rx_arrivals[head % RX_ARRIVAL_COUNT] = (rx_arrival_t){
+                    .end = in,
+                    .us = (uint32_t)esp_timer_get_time(),
+                };
+                atomic_store_explicit(&s_rx_arrival_head, head + 1, memory_order_release);
+            } else {
+                /* Table full: fold into the newest entry (keeps its older time) */
+                s_rx_arrivals[(head - 1) % RX_ARRIVAL_COUNT].end = in;
+            }
+        }
+        if (sent < data_len) {
+            /* RX task fell a whole buffer behind — count it and mark the spot */
+            uint32_t lost = data_len - sent;
+            if (atomic_load_explicit(&s_rx_lost_pending, memory_order_relaxed) == 0) {
+                s_rx_lost_pos = in;
+            }
+            atomic_fetch_add_explicit(&s_rx_lost_pending, lost, memory_order_release);
+            s_rx_lost_bytes += lost;
+            s_rx_loss_events++;
+        }
     }
     return true;
 }
@@ -73,6 +155,7 @@ static void usb_event_callback(const cdc_acm_host_dev_event_data_t *event, void
     case CDC_ACM_HOST_DEVICE_DISCONNECTED:
         ESP_LOGW(TAG, "USB device disconnected");
         s_device_connected = false;
+        log_storage_on_disconnect();
         if (s_device_disconnected_sem) {
             xSemaphoreGive(s_device_disconnected_sem);
         }
@@ -100,49 +183,455 @@ static void usb_host_task(void *arg)
     }
 }
 
-/* ── Line processing task ───────────────────────────────────────────── */
+/* ── Line ingest ────────────────────────────────────────────────────── */
 
-static void serial_rx_task(void *arg)
+/* Hand a routed line to every sink that takes it */
+static void deliver(log_span_t *span)
 {
-    char line_buf[512];
-    size_t line_pos = 0;
-    uint8_t byte_buf[256];
-    log_entry_t entry;
+    if (span->rx_us == 0) {
+        span->rx_us = esp_timer_get_time();     /* Made here (markers, summaries) */
+    }
 
-    while (true) {
-        /* Read from stream buffer (blocks until data or timeout) */
-        size_t bytes_read = xStreamBufferReceive(s_rx_stream, byte_buf, sizeof(byte_buf),
-                                                  pdMS_TO_TICKS(100));
-        if (bytes_read == 0) {
-            continue;
+    /* Echo to debug log */
+    if (span->sinks & LOG_SINK_BIT(LOG_SINK_CONSOLE)) {
+        ESP_LOGI(TAG, ">> %.*s", (int)span->raw_len, span->raw);
+    }
+
+    /* Push to ring buffer (the UI and the network server both read it) */
+    if (span->sinks & (LOG_SINK_BIT(LOG_SINK_DISPLAY) | LOG_SINK_BIT(LOG_SINK_NETWORK))) {
+        uint32_t seq = log_ring_next_seq(&s_ring);
+        log_search_note_line(seq, span);    /* Before the push, so searches never miss it */
+        log_ring_push(&s_ring, span);
+        latency_note_push(seq, esp_timer_get_time());
+    }
+
+    /* Write to SD card (batched by the writer task) */
+    if (span->sinks & LOG_SINK_BIT(LOG_SINK_SD)) {
+        log_storage_write(span);
+    }
+}
+
+/* Hand one parsed line to the triggers and every sink that takes it */
+static void ingest(log_span_t *span)
+{
+    /* Crash/alarm patterns see every line, whatever the filters say */
+    log_trigger_process(span, log_ring_next_seq(&s_ring));
+
+    /* Route once with the precompiled per-sink rules */
+    span->sinks = log_filter_route(span);
+
+    /* Repeats of the previous line are counted, not stored */
+    if (!log_dedup_offer(span, esp_timer_get_time())) {
+        deliver(span);
+    }
+
+    s_total_lines++;
+}
+
+/* When the USB transfer holding the byte after the line (its CR/LF)
+ * arrived. A line carried over from the last chunk ended in this chunk's
+ * first transfer. */
+static int64_t line_rx_us(const char *line, size_t len)
+{
+    if (s_feed_data == NULL) {
+        return s_chunk_us;
+    }
+    uint32_t end = s_feed_start;
+    if (line >= s_feed_data && line < s_feed_data + s_feed_len) {
+        end = s_feed_start + (uint32_t)(line - s_feed_data + len);
+    }
+    uint32_t head = atomic_load_explicit(&s_rx_arrival_head, memory_order_acquire);
+    for (uint32_t i = s_feed_arrival; i != head; i++) {
+        const rx_arrival_t *a = &s_rx_arrivals[i % RX_ARRIVAL_COUNT];
+        if ((int32_t)(a->end - end) > 0) {
+            s_feed_arrival = i;     /* Lines come in stream order */
+            return s_chunk_us - (uint32_t)((uint32_t)s_chunk_us - a->us);
         }
+    }
+    return s_chunk_us;
+}
 
-        /* Process byte-by-byte, splitting on newlines */
-        for (size_t i = 0; i < bytes_read; i++) {
-            char c = (char)byte_buf[i];
+/* ── Tags ───────────────────────────────────────────────────────────── */
+
+/*
+ * Whether a parsed line's tag is worth a table entry: a timestamp of
+ * digits (or a time of day) and a printable ASCII tag. At a wrong baud
+ * rate noise now and then parses as a header, and each such tag would
+ * otherwise take an entry until the next reset.
+ */
+static bool tag_well_formed(const log_span_t *span)
+{
+    if (span->tag_len == 0) {
+        return false;
+    }
+    const char *ts = span->raw + 3;                         /* After "L (" */
+    const char *ts_end = span->raw + span->tag_off - 2;     /* At ") " */
+    if (ts >= ts_end) {
+        return false;
+    }
+    for (const char *p = ts; p < ts_end; p++) {
+        if ((*p < '0' || *p > '9') && *p != ':' && *p != '.') {
+            return false;
+        }
+    }
+    const char *tag = span->raw + span->tag_off;
+    for (uint8_t i = 0; i < span->tag_len; i++) {
+        if (tag[i] < ' ' || tag[i] > '~') {
+            return false;
+        }
+    }
+    return true;
+}
 
-            if (c == '\n' || c == '\r') {
-                if (line_pos > 0) {
-                    line_buf[line_pos] = '\0';
+/* Tags seen at another rate came from noise or from another target */
+static void tags_note_rate(uint32_t baud)
+{
+    if (baud != s_tags_baud) {
+        s_tags_baud = baud;
+        s_tags_reset_pending = true;
+    }
+}
 
-                    /* Echo to debug log */
-                    ESP_LOGI(TAG, ">> %s", line_buf);
+/*
+ * Start a new tag generation (RX task) once it is safe: the ring can only
+ * name the tags of lines from the current and the previous generation,
+ * so a reset waits until the lines from before the last one are gone.
+ */
+static void tags_reset_if_due(void)
+{
+    if (!s_tags_reset_pending ||
+        (int32_t)(log_ring_first_seq(&s_ring) - s_tags_reset_seq) < 0) {
+        return;
+    }
+    s_tags_reset_pending = false;
+    s_tags_reset_seq = log_ring_next_seq(&s_ring);
+    tag_table_reset();
+    log_filter_retag();
+    log_series_retag();
+    log_stats_reset_tags();
+    ESP_LOGI(TAG, "Tag table reset");
+}
 
-                    /* Parse the line */
-                    log_parser_parse(line_buf, &entry);
+/* ── Lines ──────────────────────────────────────────────────────────── */
 
-                    /* Push to ring buffer */
-                    ring_push(&entry);
+/* Called by the framer for each complete line (serial_rx_task context) */
+static void on_line(char *line, size_t len, void *ctx)
+{
+    log_span_t span;
+    int64_t framed_us = esp_timer_get_time();
+    latency_record(LAT_STAGE_FRAME, (uint32_t)(framed_us - s_chunk_us), len);
+    int64_t rx_us = line_rx_us(line, len);
 
-                    /* Write to SD card */
-                    log_storage_write(&entry);
+    /* Parse the line (offsets only, no copies; strips color escapes) */
+    bool parsed = log_parser_parse_span(line, len, &span);
+    if (span.raw_len == 0) {
+        return;     /* Line held nothing but escape sequences */
+    }
+    span.rx_us = rx_us;
+    clock_fit_note_line(&span);
+    boot_profile_note_line(&span, len + 1);
 
-                    s_total_lines++;
-                    line_pos = 0;
-                }
-            } else if (line_pos < sizeof(line_buf) - 1) {
-                line_buf[line_pos++] = c;
+    /* Intern the tag — everything downstream works with the ID */
+    if (parsed && tag_well_formed(&span)) {
+        span.tag_id = tag_table_intern(span.raw + span.tag_off, span.tag_len);
+    }
+    tag_table_count_line(span.tag_id);
+    log_stats_note_line(&span, len + 1, framed_us);
+    log_series_process(&span, framed_us);
+    int64_t parsed_us = esp_timer_get_time();
+    latency_record(LAT_STAGE_PARSE, (uint32_t)(parsed_us - framed_us), len);
+
+    ingest(&span);
+    latency_record(LAT_STAGE_RING_PUSH, (uint32_t)(esp_timer_get_time() - parsed_us), len);
+}
+
+/* Insert an explicit "N bytes lost" line where the stream has a gap */
+static void emit_loss_marker(uint32_t bytes, const char *where)
+{
+    char text[96];
+    int n = snprintf(text, sizeof(text), "--- %lu bytes lost (%s) ---",
+                     (unsigned long)bytes, where);
+    log_span_t span = {
+        .raw = text,
+        .raw_len = (uint16_t)(n < (int)sizeof(text) ? n : (int)sizeof(text) - 1),
+        .level = 'E',
+    };
+    ingest(&span);
+}
+
+/* Feed a received chunk, splitting it at a pending USB drop */
+static void feed_chunk(char *data, size_t len, uint32_t chunk_start)
+{
+    s_feed_data = data;
+    s_feed_len = len;
+    s_feed_start = chunk_start;
+    s_feed_arrival = atomic_load_explicit(&s_rx_arrival_tail, memory_order_relaxed);
+
+    if (atomic_load_explicit(&s_rx_lost_pending, memory_order_acquire) != 0) {
+        int32_t at = (int32_t)(s_rx_lost_pos - chunk_start);
+        if (at < 0) {
+            at = 0;     /* Gap fell inside bytes consumed elsewhere (auto-baud probe) */
+        }
+        if ((size_t)at <= len) {
+            line_framer_feed(&s_framer, data, at);
+            line_framer_flush(&s_framer);   /* The line around the gap is incomplete */
+            emit_loss_marker(atomic_exchange_explicit(&s_rx_lost_pending, 0,
+                                                      memory_order_acquire),
+                             "USB RX buffer full");
+            data += at;
+            len -= at;
+        }
+    }
+
+    /* Complete lines are parsed in place; only a trailing partial line is copied */
+    line_framer_feed(&s_framer, data, len);
+    s_feed_data = NULL;
+}
+
+/* Empty the RX buffer (RX task only) and resync the loss counters. Only
+ * the buffered bytes are discarded: a USB drop not marked yet still is. */
+static void rx_stream_reset(void)
+{
+    uint32_t lost = atomic_exchange_explicit(&s_rx_lost_pending, 0, memory_order_acquire);
+    if (lost != 0) {
+        emit_loss_marker(lost, "USB RX buffer full");
+    }
+    xStreamBufferReset(s_rx_stream);
+    s_rx_out_bytes = atomic_load_explicit(&s_rx_in_bytes, memory_order_relaxed);
+    atomic_store_explicit(&s_rx_arrival_tail,
+                          atomic_load_explicit(&s_rx_arrival_head, memory_order_acquire),
+                          memory_order_release);
+}
+
+/* Time a dequeued chunk spent in the RX buffer (RX task only) */
+static void record_rx_wait(uint32_t chunk_start, uint32_t len, int64_t now_us)
+{
+    /* Retire transfers that ended before this chunk; the next one holds its first byte */
+    uint32_t head = atomic_load_explicit(&s_rx_arrival_head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&s_rx_arrival_tail, memory_order_relaxed);
+    while (tail != head &&
+           (int32_t)(s_rx_arrivals[tail % RX_ARRIVAL_COUNT].end - chunk_start) <= 0) {
+        tail++;
+    }
+    atomic_store_explicit(&s_rx_arrival_tail, tail, memory_order_release);
+    if (tail != head) {
+        latency_record(LAT_STAGE_USB_RX,
+                       (uint32_t)now_us - s_rx_arrivals[tail % RX_ARRIVAL_COUNT].us, len);
+    }
+}
+
+/* ── Baud rate ──────────────────────────────────────────────────────── */
+
+static esp_err_t apply_baud(uint32_t baud)
+{
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_dev_mutex, portMAX_DELAY);
+    if (s_cdc_dev != NULL && s_device_connected && !s_flasher_mode && s_bridge_cb == NULL) {
+        cdc_acm_line_coding_t line_coding = {
+            .dwDTERate = baud,
+            .bCharFormat = 0,   /* 1 stop bit */
+            .bParityType = 0,   /* No parity */
+            .bDataBits = 8,
+        };
+        err = cdc_acm_host_line_coding_set(s_cdc_dev, &line_coding);
+    }
+    xSemaphoreGive(s_dev_mutex);
+
+    if (err == ESP_OK) {
+        s_baud_current = baud;
+    }
+    return err;
+}
+
+/*
+ * Auto-baud (serial_rx_task only). While hunting, received bytes are
+ * scored and held back in s_probe; once a candidate locks, they are
+ * replayed into the framer so the lines that proved the rate are kept.
+ * While locked the stream keeps being scored, so a target that reboots
+ * from its ROM rate into a different app rate is re-hunted.
+ */
+static baud_detect_t s_detect;
+static uint8_t s_probe[RX_CHUNK_SIZE];
+static size_t s_probe_len;
+static uint32_t s_cand_index;
+static uint32_t s_cand_tried;
+static uint32_t s_best_baud;
+static uint32_t s_best_score;
+static int64_t s_window_start_us;
+static uint32_t s_bad_windows;          /* Garbage windows in a row while locked */
+
+static void try_candidate(uint32_t index)
+{
+    s_cand_index = index % BAUD_CANDIDATE_COUNT;
+    apply_baud(s_baud_candidates[s_cand_index]);
+    rx_stream_reset();      /* Drop bytes received at the old rate */
+    baud_detect_reset(&s_detect);
+    s_probe_len = 0;
+    s_window_start_us = esp_timer_get_time();
+}
+
+static void hunt_start(uint32_t first_index)
+{
+    ESP_LOGI(TAG, "Auto-baud: hunting");
+    s_baud_state = SERIAL_BAUD_HUNTING;
+    s_cand_tried = 0;
+    s_best_baud = 0;
+    s_best_score = 0;
+    try_candidate(first_index);
+}
+
+static void hunt_lock(line_framer_t *framer, uint32_t baud)
+{
+    if (baud != s_baud_current) {
+        apply_baud(baud);
+        s_probe_len = 0;    /* Held bytes were at another rate */
+    }
+    ESP_LOGI(TAG, "Auto-baud: locked at %lu baud", (unsigned long)baud);
+    s_baud_state = SERIAL_BAUD_LOCKED;
+    tags_note_rate(baud);
+    line_framer_reset(framer);
+    line_framer_feed(framer, (char *)s_probe, s_probe_len);
+    s_probe_len = 0;
+    baud_detect_reset(&s_detect);
+    s_bad_windows = 0;
+}
+
+/*
+ * While locked: score windows of FT_BAUD_RECHECK_BYTES and ask for a
+ * re-hunt after FT_BAUD_REHUNT_WINDOWS garbage windows in a row. A burst
+ * of noise (a reset, a bumped cable) doesn't lose the rate, and the
+ * chunk goes on to the framer either way, so no bytes are dropped.
+ * Scored before the framer parses (and strips) the chunk in place.
+ */
+static bool auto_baud_recheck(const char *data, size_t len)
+{
+    baud_detect_feed(&s_detect, (const uint8_t *)data, len);
+    if (s_detect.total < FT_BAUD_RECHECK_BYTES) {
+        return false;
+    }
+    /* Only the garbage test applies here (no byte count is enough for
+     * GOOD) — long lines without prefixes must not count as garbage */
+    bool bad = baud_detect_verdict(&s_detect, UINT32_MAX) == BAUD_VERDICT_BAD;
+    baud_detect_reset(&s_detect);
+    s_bad_windows = bad ? s_bad_windows + 1 : 0;
+    return s_bad_windows >= FT_BAUD_REHUNT_WINDOWS;
+}
+
+/*
+ * While hunting: hold the chunk in the probe buffer and judge the current
+ * candidate. The chunk never goes on to the framer from here; the held
+ * bytes are fed to it when a rate locks (hunt_lock()).
+ */
+static void auto_baud_process(line_framer_t *framer, const char *data, size_t len)
+{
+    size_t room = sizeof(s_probe) - s_probe_len;
+    memcpy(s_probe + s_probe_len, data, len < room ? len : room);
+    s_probe_len += len < room ? len : room;
+    baud_detect_feed(&s_detect, (const uint8_t *)data, len);
+
+    baud_verdict_t verdict = baud_detect_verdict(&s_detect, FT_BAUD_PROBE_BYTES);
+    if (verdict == BAUD_VERDICT_GOOD) {
+        hunt_lock(framer, s_baud_candidates[s_cand_index]);
+        return;
+    }
+    if (verdict == BAUD_VERDICT_UNSURE) {
+        int64_t elapsed_ms = (esp_timer_get_time() - s_window_start_us) / 1000;
+        if (elapsed_ms < FT_BAUD_PROBE_MS) {
+            return;
+        }
+        if (s_detect.total == 0) {
+            /* Target is silent — nothing to judge, keep listening here */
+            s_window_start_us = esp_timer_get_time();
+            return;
+        }
+    }
+
+    /* This candidate is out; remember the best in case none is clean */
+    uint32_t score = baud_detect_score(&s_detect);
+    if (score > s_best_score) {
+        s_best_score = score;
+        s_best_baud = s_baud_candidates[s_cand_index];
+    }
+    if (++s_cand_tried >= BAUD_CANDIDATE_COUNT) {
+        if (s_best_baud != 0) {
+            ESP_LOGW(TAG, "Auto-baud: no clean rate, using best guess");
+            hunt_lock(framer, s_best_baud);
+        } else {
+            hunt_start(0);
+        }
+        return;
+    }
+    try_candidate(s_cand_index + 1);
+}
+
+/* ── Line processing task ───────────────────────────────────────────── */
+
+static void serial_rx_task(void *arg)
+{
+    /* Task-owned, static to keep the chunk off the task stack */
+    static char s_chunk[RX_CHUNK_SIZE];
+
+    line_framer_init(&s_framer, on_line, NULL);
+
+    while (true) {
+        /* Track how close the buffer came to overflowing */
+        uint32_t fill = xStreamBufferBytesAvailable(s_rx_stream);
+        if (fill > s_rx_buf_peak) {
+            s_rx_buf_peak = fill;
+        }
+
+        /* Read as much as is buffered (blocks until data or timeout) */
+        size_t bytes_read = xStreamBufferReceive(s_rx_stream, s_chunk, sizeof(s_chunk),
+                                                  pdMS_TO_TICKS(100));
+        uint32_t chunk_start = s_rx_out_bytes;
+        s_rx_out_bytes += bytes_read;
+        if (bytes_read > 0) {
+            s_chunk_us = esp_timer_get_time();
+            record_rx_wait(chunk_start, bytes_read, s_chunk_us);
+        }
+        log_dedup_poll(esp_timer_get_time());   /* Summarize a run that went quiet */
+        tags_reset_if_due();
+        if (!s_device_connected || s_flasher_mode || s_bridge_cb != NULL) {
+            continue;
+        }
+
+        /* Baud change from the UI, a new connection, or after flashing */
+        if (s_baud_changed) {
+            s_baud_changed = false;
+            line_framer_reset(&s_framer);
+            log_stats_restart_gap();        /* The silence was ours, not the target's */
+            clock_fit_restart();            /* May be another target, or a reflashed one */
+            if (s_baud_request == 0) {
+                hunt_start(s_cand_index);   /* Last good rate first */
+                continue;
             }
+            s_baud_state = SERIAL_BAUD_FIXED;
+            apply_baud(s_baud_request);
+            tags_note_rate(s_baud_request);
+            rx_stream_reset();
+            continue;
+        }
+
+        bool rehunt = false;
+        if (s_baud_request == 0) {
+            if (s_baud_state == SERIAL_BAUD_LOCKED) {
+                rehunt = auto_baud_recheck(s_chunk, bytes_read);
+            } else {
+                auto_baud_process(&s_framer, s_chunk, bytes_read);
+                continue;
+            }
+        }
+        if (bytes_read == 0 &&
+            atomic_load_explicit(&s_rx_lost_pending, memory_order_relaxed) == 0) {
+            continue;
+        }
+
+        feed_chunk(s_chunk, bytes_read, chunk_start);
+        if (rehunt) {
+            ESP_LOGW(TAG, "Auto-baud: garbage at %lu baud, re-hunting",
+                     (unsigned long)s_baud_current);
+            line_framer_flush(&s_framer);   /* The partial line is at the old rate */
+            hunt_start(s_cand_index == 0 ? 1 : 0);  /* Most likely rates first */
         }
     }
 }
@@ -153,7 +642,7 @@ static void connection_task(void *arg)
 {
     const cdc_acm_host_device_config_t dev_config = {
         .connection_timeout_ms = 5000,
-        .out_buffer_size = 512,
+        .out_buffer_size = USB_TX_CHUNK,
         .in_buffer_size = 512,
         .event_cb = usb_event_callback,
         .data_cb = usb_rx_callback,
@@ -173,10 +662,12 @@ static void connection_task(void *arg)
             if (s_flasher_mode) continue;
             if (got == pdFALSE) continue;  /* Timeout — device still connected */
             /* Device actually disconnected */
+            xSemaphoreTake(s_dev_mutex, portMAX_DELAY);
             if (s_cdc_dev != NULL) {
                 cdc_acm_host_close(s_cdc_dev);
                 s_cdc_dev = NULL;
             }
+            xSemaphoreGive(s_dev_mutex);
             ESP_LOGI(TAG, "Device closed. Waiting for new connection...");
             vTaskDelay(pdMS_TO_TICKS(500));
             continue;
@@ -193,20 +684,16 @@ static void connection_task(void *arg)
 
         ESP_LOGI(TAG, "CH340 device connected!");
 
-        /* Configure 115200 8N1 */
-        cdc_acm_line_coding_t line_coding = {
-            .dwDTERate = FT_UART_BAUD_RATE,
-            .bCharFormat = 0,   /* 1 stop bit */
-            .bParityType = 0,   /* No parity */
-            .bDataBits = 8,
-        };
-        cdc_acm_host_line_coding_set(s_cdc_dev, &line_coding);
-
         /* Enable DTR + RTS */
         cdc_acm_host_set_control_line_state(s_cdc_dev, true, true);
 
+        /* Start at the last rate used (8N1); serial_rx_task takes over from
+         * here — a fixed rate is re-applied, auto-baud starts hunting */
         s_device_connected = true;
-        ESP_LOGI(TAG, "Serial monitor active at %d baud", FT_UART_BAUD_RATE);
+        apply_baud(s_baud_request ? s_baud_request : s_baud_current);
+        s_baud_changed = true;
+        ESP_LOGI(TAG, "Serial monitor active at %lu baud%s", (unsigned long)s_baud_current,
+                 s_baud_request ? "" : " (auto-baud)");
     }
 }
 
@@ -219,19 +706,44 @@ esp_err_t serial_monitor_init(void)
     }
 
     /* Allocate ring buffer in PSRAM */
-    s_ring_buf = heap_caps_calloc(FT_LOG_RING_SIZE, sizeof(log_entry_t), MALLOC_CAP_SPIRAM);
-    if (s_ring_buf == NULL) {
+    char *arena = heap_caps_malloc(FT_LOG_ARENA_SIZE, MALLOC_CAP_SPIRAM);
+    log_ring_slot_t *slots = heap_caps_calloc(FT_LOG_RING_SIZE, sizeof(log_ring_slot_t),
+                                              MALLOC_CAP_SPIRAM);
+    if (arena == NULL || slots == NULL) {
         ESP_LOGE(TAG, "Failed to allocate ring buffer in PSRAM");
+        heap_caps_free(arena);
+        heap_caps_free(slots);
         return ESP_ERR_NO_MEM;
     }
-    ESP_LOGI(TAG, "Ring buffer: %d entries (%d KB) in PSRAM",
-             FT_LOG_RING_SIZE, (int)(FT_LOG_RING_SIZE * sizeof(log_entry_t) / 1024));
+    log_ring_init(&s_ring, arena, FT_LOG_ARENA_SIZE, slots, FT_LOG_RING_SIZE);
+
+    if (tag_table_init() != ESP_OK || log_filter_init() != ESP_OK ||
+        log_search_init() != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    log_dedup_init(deliver);
+    clock_fit_init(ingest);
+    if (log_cold_init(&s_ring) != ESP_OK) {
+        ESP_LOGW(TAG, "No PSRAM for the cold history tier, scrollback is the ring only");
+    }
+    ESP_LOGI(TAG, "Ring buffer: up to %d lines, %d KB arena + %d KB slots in PSRAM",
+             FT_LOG_RING_SIZE, FT_LOG_ARENA_SIZE / 1024,
+             (int)(FT_LOG_RING_SIZE * sizeof(log_ring_slot_t) / 1024));
 
-    s_ring_mutex = xSemaphoreCreateMutex();
     s_device_disconnected_sem = xSemaphoreCreateBinary();
-    s_rx_stream = xStreamBufferCreate(RX_STREAM_SIZE, 1);
+    s_dev_mutex = xSemaphoreCreateMutex();
+    /* Large RX buffer in PSRAM so the RX task can stall for seconds at
+     * high baud (SD stall, UI load) without the USB callback dropping */
+    s_rx_stream_size = FT_SERIAL_RX_BUF_SIZE;
+    s_rx_stream = xStreamBufferCreateWithCaps(s_rx_stream_size, 1, MALLOC_CAP_SPIRAM);
+    if (s_rx_stream == NULL) {
+        ESP_LOGW(TAG, "No PSRAM for a %lu KB RX buffer, using %d bytes",
+                 (unsigned long)(s_rx_stream_size / 1024), RX_STREAM_FALLBACK_SIZE);
+        s_rx_stream_size = RX_STREAM_FALLBACK_SIZE;
+        s_rx_stream = xStreamBufferCreate(s_rx_stream_size, 1);
+    }
 
-    if (!s_ring_mutex || !s_device_disconnected_sem || !s_rx_stream) {
+    if (!s_device_disconnected_sem || !s_dev_mutex || !s_rx_stream) {
         return ESP_ERR_NO_MEM;
     }
 
@@ -257,6 +769,11 @@ esp_err_t serial_monitor_init(void)
     /* Initialize log storage (SD card writer) */
     log_storage_init();
 
+    /* Trigger patterns, series extractors and boot milestones (from SD if present) */
+    log_trigger_init();
+    log_series_init();
+    boot_profile_init();
+
     /* Create tasks */
     xTaskCreatePinnedToCore(usb_host_task, "usb_host", 4096, NULL, 20, NULL, 0);
     xTaskCreatePinnedToCore(serial_rx_task, "serial_rx", 4096, NULL, 5, NULL, 1);
@@ -274,59 +791,96 @@ bool serial_monitor_is_connected(void)
 
 uint32_t serial_monitor_get_count(void)
 {
-    return s_ring_count;
+    return log_ring_count(&s_ring);
+}
+
+const log_ring_t *serial_monitor_get_ring(void)
+{
+    return &s_ring;
 }
 
 bool serial_monitor_get_entry(uint32_t index, log_entry_t *entry)
 {
-    if (index >= s_ring_count || entry == NULL) {
+    if (entry == NULL) {
         return false;
     }
 
-    xSemaphoreTake(s_ring_mutex, portMAX_DELAY);
-    /* Calculate actual position: oldest entry is at (head - count) mod size */
-    uint32_t start = (s_ring_head + FT_LOG_RING_SIZE - s_ring_count) % FT_LOG_RING_SIZE;
-    uint32_t pos = (start + index) % FT_LOG_RING_SIZE;
-    memcpy(entry, &s_ring_buf[pos], sizeof(log_entry_t));
-    xSemaphoreGive(s_ring_mutex);
+    char buf[FT_LOG_LINE_MAX_LEN];
+    log_span_t span;
+    uint32_t seq = log_ring_first_seq(&s_ring) + index;
+    if (index >= log_ring_count(&s_ring) ||
+        log_ring_read(&s_ring, seq, buf, sizeof(buf), &span) != LOG_RING_READ_OK) {
+        return false;
+    }
 
+    log_parser_span_to_entry(&span, entry);
     return true;
 }
 
 uint32_t serial_monitor_get_recent(log_entry_t *entries, uint32_t max_entries, uint32_t start_from)
 {
-    if (entries == NULL || s_ring_count == 0) {
+    if (entries == NULL) {
         return 0;
     }
 
-    xSemaphoreTake(s_ring_mutex, portMAX_DELAY);
-    uint32_t available = s_ring_count;
-    if (start_from >= available) {
-        xSemaphoreGive(s_ring_mutex);
+    uint32_t copied = 0;
+    while (copied < max_entries &&
+           serial_monitor_get_entry(start_from + copied, &entries[copied])) {
+        copied++;
+    }
+    return copied;
+}
+
+uint32_t serial_monitor_read_spans(uint32_t start_from, uint32_t max_lines,
+                                   serial_monitor_span_cb_t cb, void *ctx)
+{
+    if (cb == NULL) {
         return 0;
     }
 
-    uint32_t to_copy = available - start_from;
-    if (to_copy > max_entries) {
-        to_copy = max_entries;
+    char buf[FT_LOG_LINE_MAX_LEN];
+    log_span_t span;
+    uint32_t first = log_ring_first_seq(&s_ring);
+    uint32_t visited = 0;
+    while (visited < max_lines) {
+        log_ring_read_t r = log_ring_read(&s_ring, first + start_from + visited,
+                                          buf, sizeof(buf), &span);
+        if (r != LOG_RING_READ_OK) {
+            break;
+        }
+        visited++;
+        if (!cb(start_from + visited - 1, &span, ctx)) {
+            break;
+        }
     }
 
-    uint32_t ring_start = (s_ring_head + FT_LOG_RING_SIZE - available) % FT_LOG_RING_SIZE;
-    for (uint32_t i = 0; i < to_copy; i++) {
-        uint32_t pos = (ring_start + start_from + i) % FT_LOG_RING_SIZE;
-        memcpy(&entries[i], &s_ring_buf[pos], sizeof(log_entry_t));
+    return visited;
+}
+
+log_ring_read_t serial_monitor_read_line(uint32_t seq, char *buf, size_t buf_size,
+                                         log_span_t *span)
+{
+    log_ring_read_t r = log_ring_read(&s_ring, seq, buf, buf_size, span);
+    if (r == LOG_RING_READ_OVERWRITTEN) {
+        r = log_cold_read(seq, buf, buf_size, span);
+        if (r == LOG_RING_READ_PENDING) {
+            r = LOG_RING_READ_OVERWRITTEN;  /* Evicted before it was compacted */
+        }
     }
-    xSemaphoreGive(s_ring_mutex);
+    return r;
+}
 
-    return to_copy;
+uint32_t serial_monitor_first_seq(void)
+{
+    uint32_t seq;
+    return log_cold_first_seq(&seq) ? seq : log_ring_first_seq(&s_ring);
 }
 
 void serial_monitor_clear(void)
 {
-    xSemaphoreTake(s_ring_mutex, portMAX_DELAY);
-    s_ring_head = 0;
-    s_ring_count = 0;
-    xSemaphoreGive(s_ring_mutex);
+    log_cold_clear();
+    log_ring_clear(&s_ring);
+    s_tags_reset_pending = true;    /* Nothing refers to the old tags now */
 }
 
 uint32_t serial_monitor_get_total_lines(void)
@@ -358,6 +912,7 @@ void serial_monitor_resume(void)
         xStreamBufferReset(s_rx_stream);
     }
     s_flasher_mode = false;
+    s_baud_changed = true;      /* The flasher may have changed the rate */
     /* connection_task continues with the existing device */
 }
 
@@ -365,3 +920,145 @@ void *serial_monitor_get_device(void)
 {
     return (void *)s_cdc_dev;
 }
+
+esp_err_t serial_monitor_reset_target(int64_t *released_us)
+{
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_dev_mutex, portMAX_DELAY);
+    if (s_cdc_dev != NULL && s_device_connected && !s_flasher_mode && s_bridge_cb == NULL) {
+        err = flasher_port_pulse_reset(s_cdc_dev, FT_TARGET_RESET_HOLD_MS, released_us);
+    }
+    xSemaphoreGive(s_dev_mutex);
+    return err;
+}
+
+/* ── Network bridge ─────────────────────────────────────────────────── */
+
+static bool bridge_ready(void)
+{
+    return s_cdc_dev != NULL && s_device_connected && !s_flasher_mode && s_bridge_cb != NULL;
+}
+
+esp_err_t serial_monitor_bridge_begin(serial_monitor_bridge_cb_t cb, void *ctx)
+{
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_dev_mutex, portMAX_DELAY);
+    if (s_cdc_dev != NULL && s_device_connected && !s_flasher_mode && s_bridge_cb == NULL) {
+        s_bridge_ctx = ctx;
+        s_bridge_cb = cb;       /* From here on the USB callback bypasses the RX stream */
+        err = ESP_OK;
+    }
+    xSemaphoreGive(s_dev_mutex);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Target handed to the network bridge");
+    }
+    return err;
+}
+
+void serial_monitor_bridge_end(void)
+{
+    xSemaphoreTake(s_dev_mutex, portMAX_DELAY);
+    if (s_bridge_cb != NULL && s_cdc_dev != NULL && s_device_connected) {
+        cdc_acm_host_set_control_line_state(s_cdc_dev, true, true);     /* Both released */
+    }
+    s_bridge_cb = NULL;
+    xSemaphoreGive(s_dev_mutex);
+
+    s_baud_changed = true;      /* RX task: back to 8N1 at the monitor's rate, framer restarted */
+    ESP_LOGI(TAG, "Target returned to the monitor");
+}
+
+esp_err_t serial_monitor_bridge_write(const uint8_t *data, size_t len)
+{
+    esp_err_t err = ESP_OK;
+    while (len > 0 && err == ESP_OK) {
+        size_t n = len < USB_TX_CHUNK ? len : USB_TX_CHUNK;
+        xSemaphoreTake(s_dev_mutex, portMAX_DELAY);
+        err = bridge_ready() ? cdc_acm_host_data_tx_blocking(s_cdc_dev, data, n, 1000)
+                             : ESP_ERR_INVALID_STATE;
+        xSemaphoreGive(s_dev_mutex);
+        data += n;
+        len -= n;
+    }
+    return err;
+}
+
+esp_err_t serial_monitor_bridge_set_line(uint32_t baud, uint8_t data_bits, uint8_t parity,
+                                         uint8_t stop_bits)
+{
+    if (baud < 300 || baud > 3000000 || data_bits < 5 || data_bits > 8 ||
+        parity > 4 || stop_bits > 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_dev_mutex, portMAX_DELAY);
+    if (bridge_ready()) {
+        cdc_acm_line_coding_t line_coding = {
+            .dwDTERate = baud,
+            .bCharFormat = stop_bits,
+            .bParityType = parity,
+            .bDataBits = data_bits,
+        };
+        err = cdc_acm_host_line_coding_set(s_cdc_dev, &line_coding);
+    }
+    xSemaphoreGive(s_dev_mutex);
+    return err;
+}
+
+esp_err_t serial_monitor_bridge_set_control(bool dtr, bool rts)
+{
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    xSemaphoreTake(s_dev_mutex, portMAX_DELAY);
+    if (bridge_ready()) {
+        /* The CH34x driver's lines are inverted (false = active), see flasher_port.c */
+        err = cdc_acm_host_set_control_line_state(s_cdc_dev, !dtr, !rts);
+    }
+    xSemaphoreGive(s_dev_mutex);
+    return err;
+}
+
+esp_err_t serial_monitor_set_baud(uint32_t baud)
+{
+    if (baud != 0 && (baud < 300 || baud > 3000000)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_baud_request = baud;
+    s_baud_changed = true;
+    ESP_LOGI(TAG, "Baud rate: %s%lu", baud ? "" : "auto, from ",
+             (unsigned long)(baud ? baud : s_baud_current));
+    return ESP_OK;
+}
+
+uint32_t serial_monitor_get_baud(void)
+{
+    return s_baud_current;
+}
+
+bool serial_monitor_is_auto_baud(void)
+{
+    return s_baud_request == 0;
+}
+
+serial_baud_state_t serial_monitor_get_baud_state(void)
+{
+    return s_baud_request == 0 ? s_baud_state : SERIAL_BAUD_FIXED;
+}
+
+void serial_monitor_get_loss_stats(serial_loss_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    log_storage_stats_t sd;
+    log_storage_get_stats(&sd);
+
+    stats->usb_lost_bytes = s_rx_lost_bytes;
+    stats->usb_loss_events = s_rx_loss_events;
+    stats->rx_buf_size = s_rx_stream_size;
+    stats->rx_buf_peak = s_rx_buf_peak;
+    stats->truncated_lines = s_framer.truncated;
+    stats->truncated_bytes = s_framer.truncated_bytes;
+    stats->sd_lost_lines = sd.lines_dropped;
+    stats->sd_lost_bytes = sd.bytes_dropped;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "log_parser.h"
+#include "log_ring.h"
 #include "esp_err.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -15,6 +16,26 @@
  */
 esp_err_t serial_monitor_init(void);
 
+typedef enum {
+    SERIAL_BAUD_FIXED = 0,      /* Rate chosen by the user */
+    SERIAL_BAUD_HUNTING,        /* Auto-baud trying candidate rates */
+    SERIAL_BAUD_LOCKED,         /* Auto-baud found a clean rate */
+} serial_baud_state_t;
+
+/**
+ * Data-loss counters per hop (monotonic since boot)
+ */
+typedef struct {
+    uint32_t usb_lost_bytes;    /* USB callback found the RX buffer full */
+    uint32_t usb_loss_events;
+    uint32_t rx_buf_size;       /* RX buffer capacity */
+    uint32_t rx_buf_peak;       /* Highest RX buffer fill seen */
+    uint32_t truncated_lines;   /* Framer cut lines at FT_LOG_LINE_MAX_LEN */
+    uint32_t truncated_bytes;
+    uint32_t sd_lost_lines;     /* SD writer fell a full buffer behind */
+    uint32_t sd_lost_bytes;
+} serial_loss_stats_t;
+
 /**
  * @brief Check if a USB serial device is currently connected
  */
@@ -25,6 +46,29 @@ bool serial_monitor_is_connected(void);
  */
 uint32_t serial_monitor_get_count(void);
 
+/**
+ * @brief Get the log ring for lock-free reads
+ *
+ * Readers use log_ring_read() / log_ring_cursor_next() on it directly and
+ * never block the RX task. Only the serial monitor writes to it.
+ */
+const log_ring_t *serial_monitor_get_ring(void);
+
+/**
+ * @brief Read a line by sequence number from either history tier
+ *
+ * Tries the ring first and falls back to the compressed cold tier
+ * (log_cold.h) for lines the ring has evicted, so the UI can scroll and
+ * jump far past the ring. Same contract as log_ring_read().
+ */
+log_ring_read_t serial_monitor_read_line(uint32_t seq, char *buf, size_t buf_size,
+                                         log_span_t *span);
+
+/**
+ * @brief Oldest line serial_monitor_read_line() can still return
+ */
+uint32_t serial_monitor_first_seq(void);
+
 /**
  * @brief Read a log entry from the ring buffer by index (0 = oldest)
  * @param index  Ring buffer index (0..count-1)
@@ -42,6 +86,31 @@ bool serial_monitor_get_entry(uint32_t index, log_entry_t *entry);
  */
 uint32_t serial_monitor_get_recent(log_entry_t *entries, uint32_t max_entries, uint32_t start_from);
 
+/**
+ * @brief Callback for serial_monitor_read_spans()
+ * @param index  Ring buffer index of the line (0 = oldest)
+ * @param span   A snapshot of the line in a stack buffer, only valid inside the callback
+ * @param ctx    User context
+ * @return false to stop early
+ */
+typedef bool (*serial_monitor_span_cb_t)(uint32_t index, const log_span_t *span, void *ctx);
+
+/**
+ * @brief Visit entries without materializing log_entry_t copies
+ *
+ * Each line is snapshotted into a stack buffer and handed to the callback
+ * as a span, which is only valid inside the callback. Stops early if a
+ * line is overwritten while visiting.
+ *
+ * @param start_from  Index of the first line to visit (0 = oldest)
+ * @param max_lines   Maximum number of lines to visit
+ * @param cb          Called once per line, oldest first
+ * @param ctx         Passed through to the callback
+ * @return Number of lines visited
+ */
+uint32_t serial_monitor_read_spans(uint32_t start_from, uint32_t max_lines,
+                                   serial_monitor_span_cb_t cb, void *ctx);
+
 /**
  * @brief Clear all entries from the ring buffer
  */
@@ -72,3 +141,91 @@ void serial_monitor_resume(void);
  * Only valid after serial_monitor_pause() and before resume().
  */
 void *serial_monitor_get_device(void);
+
+/**
+ * @brief Reset the target through DTR/RTS and let it boot normally
+ *
+ * The monitor keeps running, so the boot output is captured as usual.
+ *
+ * @param released_us  Receives the esp_timer time the reset was released (may be NULL)
+ * @return ESP_ERR_INVALID_STATE if no target is connected, flashing is in progress
+ *         or the serial bridge has the port
+ */
+esp_err_t serial_monitor_reset_target(int64_t *released_us);
+
+/**
+ * @brief Callback for raw target bytes while bridged
+ *
+ * Runs in the USB host context: copy the bytes out and return.
+ */
+typedef void (*serial_monitor_bridge_cb_t)(const uint8_t *data, size_t len, void *ctx);
+
+/**
+ * @brief Hand the target's raw byte stream to a network bridge
+ *
+ * Until serial_monitor_bridge_end(), received bytes go to @p cb instead of
+ * the line pipeline, and the bridge owns the line coding and DTR/RTS.
+ *
+ * @return ESP_ERR_INVALID_STATE if no target is connected, flashing is in
+ *         progress or another bridge is active
+ */
+esp_err_t serial_monitor_bridge_begin(serial_monitor_bridge_cb_t cb, void *ctx);
+
+/**
+ * @brief Return the target to the monitor (DTR/RTS released, 8N1 at the monitor's rate)
+ */
+void serial_monitor_bridge_end(void);
+
+/**
+ * @brief Send bytes to the target (blocks until queued on USB)
+ */
+esp_err_t serial_monitor_bridge_write(const uint8_t *data, size_t len);
+
+/**
+ * @brief Set the line coding while bridged
+ *
+ * @param parity     CDC encoding: 0 none, 1 odd, 2 even, 3 mark, 4 space
+ * @param stop_bits  CDC encoding: 0 = 1, 1 = 1.5, 2 = 2
+ * @return ESP_ERR_INVALID_ARG for a rate outside 300..3000000
+ */
+esp_err_t serial_monitor_bridge_set_line(uint32_t baud, uint8_t data_bits, uint8_t parity,
+                                         uint8_t stop_bits);
+
+/**
+ * @brief Drive DTR and RTS while bridged (true = asserted, as on a PC serial port)
+ */
+esp_err_t serial_monitor_bridge_set_control(bool dtr, bool rts);
+
+/**
+ * @brief Select the target baud rate for this session
+ *
+ * Takes effect within one RX poll (~100 ms), also while disconnected
+ * (applied on the next connect).
+ *
+ * @param baud  Rate in bit/s, or 0 for auto-baud
+ * @return ESP_ERR_INVALID_ARG for a rate outside 300..3000000
+ */
+esp_err_t serial_monitor_set_baud(uint32_t baud);
+
+/**
+ * @brief Get the rate currently set on the device
+ */
+uint32_t serial_monitor_get_baud(void);
+
+/**
+ * @brief Check if auto-baud is selected
+ */
+bool serial_monitor_is_auto_baud(void);
+
+/**
+ * @brief Get the auto-baud state (SERIAL_BAUD_FIXED when a rate was chosen)
+ */
+serial_baud_state_t serial_monitor_get_baud_state(void);
+
+/**
+ * @brief Get data-loss counters for every hop from USB to SD
+ *
+ * Each loss also leaves an explicit "--- N bytes lost ---" line in the
+ * log at the point of the gap (USB) or in the SD file (SD writer).
+ */
+void serial_monitor_get_loss_stats(serial_loss_stats_t *stats);
@@ -0,0 +1,237 @@
+#include "tag_table.h"
+#include "app_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdatomic.h>
+
+/*
+ * Open-addressing hash of tag name -> ID. A bucket holds 0 until its ID
+ * is published; the entry it points at is fully written before that, so
+ * readers that see the ID see the name too.
+ *
+ * A reset copies the names out to s_prev and empties the table, with
+ * s_reset_seq odd while it runs (seqlock style): tag_table_copy_name()
+ * readers retry if a reset overlapped their copy. The generation is
+ * s_reset_seq / 2.
+ */
+
+#define HASH_BUCKETS  (FT_LOG_TAG_TABLE_SIZE * 2)    /* Power of two, load <= 50% */
+
+typedef struct {
+    char             name[FT_LOG_TAG_MAX_LEN];
+    uint8_t          len;
+    uint32_t         hash;
+    _Atomic uint32_t lines;
+} tag_entry_t;
+
+static tag_entry_t s_entries[FT_LOG_TAG_TABLE_SIZE + 1];   /* [0] = TAG_ID_NONE */
+static _Atomic uint16_t s_buckets[HASH_BUCKETS];
+static _Atomic uint16_t s_size;
+static SemaphoreHandle_t s_insert_mutex;    /* Inserts and resets */
+
+typedef struct {
+    char    name[FT_LOG_TAG_MAX_LEN];
+    uint8_t len;
+} tag_name_t;
+
+static tag_name_t s_prev[FT_LOG_TAG_TABLE_SIZE + 1];    /* Previous generation's names */
+static uint16_t s_prev_size;
+static _Atomic uint32_t s_reset_seq;
+static _Atomic uint32_t s_dropped;
+
+/* FNV-1a */
+static uint32_t hash_name(const char *name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return h;
+}
+
+static size_t clamp_len(size_t len)
+{
+    return len < FT_LOG_TAG_MAX_LEN ? len : FT_LOG_TAG_MAX_LEN - 1;
+}
+
+/* Find the bucket holding this name, or the empty bucket where it would go */
+static uint32_t probe(const char *name, size_t len, uint32_t hash, uint16_t *id_out)
+{
+    uint32_t b = hash & (HASH_BUCKETS - 1);
+    while (true) {
+        uint16_t id = atomic_load_explicit(&s_buckets[b], memory_order_acquire);
+        if (id == TAG_ID_NONE) {
+            *id_out = TAG_ID_NONE;
+            return b;
+        }
+        const tag_entry_t *e = &s_entries[id];
+        if (e->hash == hash && e->len == len && memcmp(e->name, name, len) == 0) {
+            *id_out = id;
+            return b;
+        }
+        b = (b + 1) & (HASH_BUCKETS - 1);
+    }
+}
+
+esp_err_t tag_table_init(void)
+{
+    if (s_insert_mutex == NULL) {
+        s_insert_mutex = xSemaphoreCreateMutex();
+    }
+    return s_insert_mutex ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void tag_table_reset(void)
+{
+    if (s_insert_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_insert_mutex, portMAX_DELAY);
+    atomic_fetch_add_explicit(&s_reset_seq, 1, memory_order_relaxed);     /* Odd: in progress */
+    atomic_thread_fence(memory_order_release);
+
+    uint16_t size = atomic_load_explicit(&s_size, memory_order_relaxed);
+    for (uint16_t id = 1; id <= size; id++) {
+        memcpy(s_prev[id].name, s_entries[id].name, s_entries[id].len);
+        s_prev[id].len = s_entries[id].len;
+    }
+    s_prev_size = size;
+    atomic_store_explicit(&s_size, 0, memory_order_relaxed);
+    for (uint32_t b = 0; b < HASH_BUCKETS; b++) {
+        atomic_store_explicit(&s_buckets[b], TAG_ID_NONE, memory_order_relaxed);
+    }
+
+    atomic_fetch_add_explicit(&s_reset_seq, 1, memory_order_release);     /* Even: done */
+    xSemaphoreGive(s_insert_mutex);
+}
+
+uint8_t tag_table_generation(void)
+{
+    return (uint8_t)(atomic_load_explicit(&s_reset_seq, memory_order_acquire) / 2);
+}
+
+uint16_t tag_table_find(const char *name, size_t len)
+{
+    len = clamp_len(len);
+    if (len == 0) {
+        return TAG_ID_NONE;
+    }
+    uint16_t id;
+    probe(name, len, hash_name(name, len), &id);
+    return id;
+}
+
+uint16_t tag_table_intern(const char *name, size_t len)
+{
+    len = clamp_len(len);
+    if (len == 0) {
+        return TAG_ID_NONE;
+    }
+
+    /* Fast path: already known (every line after a tag's first) */
+    uint32_t hash = hash_name(name, len);
+    uint16_t id;
+    probe(name, len, hash, &id);
+    if (id != TAG_ID_NONE || s_insert_mutex == NULL) {
+        return id;
+    }
+
+    xSemaphoreTake(s_insert_mutex, portMAX_DELAY);
+    uint32_t b = probe(name, len, hash, &id);   /* Another task may have added it */
+    uint16_t size = atomic_load_explicit(&s_size, memory_order_relaxed);
+    if (id == TAG_ID_NONE && size < FT_LOG_TAG_TABLE_SIZE) {
+        id = size + 1;
+        tag_entry_t *e = &s_entries[id];
+        memcpy(e->name, name, len);
+        e->name[len] = '\0';
+        e->len = (uint8_t)len;
+        e->hash = hash;
+        atomic_store_explicit(&e->lines, 0, memory_order_relaxed);
+        atomic_store_explicit(&s_size, id, memory_order_release);
+        atomic_store_explicit(&s_buckets[b], id, memory_order_release);
+    } else if (id == TAG_ID_NONE) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+    }
+    xSemaphoreGive(s_insert_mutex);
+    return id;
+}
+
+const char *tag_table_name(uint16_t id)
+{
+    if (id > atomic_load_explicit(&s_size, memory_order_acquire)) {
+        id = TAG_ID_NONE;
+    }
+    return s_entries[id].name;
+}
+
+uint8_t tag_table_name_len(uint16_t id)
+{
+    if (id > atomic_load_explicit(&s_size, memory_order_acquire)) {
+        return 0;
+    }
+    return s_entries[id].len;
+}
+
+uint8_t tag_table_copy_name(uint16_t id, uint8_t gen, char *out)
+{
+    while (true) {
+        uint32_t seq = atomic_load_explicit(&s_reset_seq, memory_order_acquire);
+        if (seq & 1) {
+            /* Reset in progress: wait for it on the mutex it holds */
+            xSemaphoreTake(s_insert_mutex, portMAX_DELAY);
+            xSemaphoreGive(s_insert_mutex);
+            continue;
+        }
+
+        uint8_t now = (uint8_t)(seq / 2);
+        uint8_t len = 0;
+        if (gen == now && id <= atomic_load_explicit(&s_size, memory_order_acquire)) {
+            len = s_entries[id].len;
+            memcpy(out, s_entries[id].name, len);
+        } else if (gen == (uint8_t)(now - 1) && id <= s_prev_size) {
+            len = s_prev[id].len;
+            memcpy(out, s_prev[id].name, len);
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s_reset_seq, memory_order_relaxed) == seq) {
+            return len;
+        }
+    }
+}
+
+void tag_table_count_line(uint16_t id)
+{
+    atomic_fetch_add_explicit(&s_entries[id].lines, 1, memory_order_relaxed);
+}
+
+uint32_t tag_table_line_count(uint16_t id)
+{
+    if (id > atomic_load_explicit(&s_size, memory_order_acquire)) {
+        return 0;
+    }
+    return atomic_load_explicit(&s_entries[id].lines, memory_order_relaxed);
+}
+
+uint16_t tag_table_size(void)
+{
+    return atomic_load_explicit(&s_size, memory_order_acquire);
+}
+
+uint32_t tag_table_dropped(void)
+{
+    return atomic_load_explicit(&s_dropped, memory_order_relaxed);
+}
+
+uint16_t tag_table_list(tag_info_t *out, uint16_t max)
+{
+    uint16_t size = tag_table_size();
+    uint16_t n = 0;
+    for (uint16_t id = 1; id <= size && n < max; id++, n++) {
+        out[n].id = id;
+        out[n].name = s_entries[id].name;
+        out[n].lines = atomic_load_explicit(&s_entries[id].lines, memory_order_relaxed);
+    }
+    return n;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/**
+ * Tag interning dictionary.
+ *
+ * Maps each distinct log tag seen at ingest to a small integer ID, so the
+ * ring, filters and statistics compare and index by ID instead of
+ * comparing strings. IDs are assigned in order of first appearance,
+ * starting at 1. Names and IDs are immutable once assigned, so lookups
+ * and name reads are lock-free; only inserting a new tag takes a lock.
+ *
+ * A reset (when the log is cleared or the baud rate changes, so tags
+ * interned from another target or from noise don't fill the table for
+ * good) starts a new generation and hands out IDs from 1 again. Holders
+ * of IDs re-intern after a reset; the names of the generation before
+ * stay readable through tag_table_copy_name() for lines stored with it.
+ */
+
+#define TAG_ID_NONE  (0)    /* Line has no tag, or the table is full */
+
+/**
+ * Tag with its live line count
+ */
+typedef struct {
+    uint16_t    id;
+    const char *name;       /* Null-terminated, valid for the whole session */
+    uint32_t    lines;      /* Lines ingested with this tag */
+} tag_info_t;
+
+/**
+ * @brief Initialize the tag table (call once before use)
+ */
+esp_err_t tag_table_init(void);
+
+/**
+ * @brief Forget every tag and start a new generation
+ *
+ * Call from the RX task, then have the ID holders re-intern.
+ */
+void tag_table_reset(void);
+
+/**
+ * @brief Current generation (wraps; only equality with the current or
+ *        the previous one is meaningful)
+ */
+uint8_t tag_table_generation(void);
+
+/**
+ * @brief Get the ID of a tag, adding it if new
+ * @param name  Tag text (need not be null-terminated)
+ * @param len   Tag length (truncated to FT_LOG_TAG_MAX_LEN - 1)
+ * @return Tag ID, or TAG_ID_NONE if len is 0 or the table is full
+ *         (counted in tag_table_dropped())
+ */
+uint16_t tag_table_intern(const char *name, size_t len);
+
+/**
+ * @brief Look up a tag without adding it
+ * @return Tag ID, or TAG_ID_NONE if the tag has not been seen
+ */
+uint16_t tag_table_find(const char *name, size_t len);
+
+/**
+ * @brief Get a tag's name ("" for TAG_ID_NONE or an unknown ID)
+ */
+const char *tag_table_name(uint16_t id);
+
+/**
+ * @brief Get a tag's name length
+ */
+uint8_t tag_table_name_len(uint16_t id);
+
+/**
+ * @brief Copy the name an ID had in a generation
+ * @param gen  Current or previous generation
+ * @param out  At least FT_LOG_TAG_MAX_LEN bytes, not null-terminated
+ * @return Name length, 0 if the ID or the generation is unknown
+ */
+uint8_t tag_table_copy_name(uint16_t id, uint8_t gen, char *out);
+
+/**
+ * @brief Count one ingested line for a tag
+ */
+void tag_table_count_line(uint16_t id);
+
+/**
+ * @brief Lines ingested with a tag since the last reset
+ */
+uint32_t tag_table_line_count(uint16_t id);
+
+/**
+ * @brief Number of tags known (valid IDs are 1..size)
+ */
+uint16_t tag_table_size(void);
+
+/**
+ * @brief Tags turned away because the table was full, since boot
+ */
+uint32_t tag_table_dropped(void);
+
+/**
+ * @brief List known tags with their live counts, in ID order
+ * @param out  Output array
+ * @param max  Size of @p out
+ * @return Number of entries filled
+ */
+uint16_t tag_table_list(tag_info_t *out, uint16_t max);
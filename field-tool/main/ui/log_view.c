@@ -0,0 +1,248 @@
+#include "log_view.h"
+#include "ui_styles.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include <string.h>
+
+static const char *TAG = "LOG_VIEW";
+
+#define FIRST_GLYPH   (0x20)
+#define GLYPH_COUNT   (0x7F - FIRST_GLYPH)      /* Printable ASCII */
+#define BG_COLOR      lv_color_hex(0x0D0D1A)
+#define MAX_COLS      (256)
+
+/* ── State ──────────────────────────────────────────────────────────── */
+
+static lv_obj_t *s_canvas = NULL;
+static uint16_t *s_buf = NULL;          /* RGB565, s_width x s_height (PSRAM) */
+static int32_t s_width = 0;
+static int32_t s_height = 0;
+
+static uint8_t *s_atlas = NULL;         /* Coverage 0-3 per pixel, glyph after glyph */
+static int32_t s_cell_w = 0;
+static int32_t s_cell_h = 0;
+static uint32_t s_rows = 0;
+static uint32_t s_cols = 0;
+
+static uint16_t s_bg = 0;
+static bool s_dirty = false;
+
+/* ── Glyph atlas ────────────────────────────────────────────────────── */
+
+/*
+ * Let LVGL rasterize each glyph once, white on black, into a scratch
+ * canvas, then keep the coverage quantized to 2 bits. Going through the
+ * normal draw path works for any font format LVGL supports.
+ */
+static bool build_atlas(lv_obj_t *parent, const lv_font_t *font)
+{
+    s_cell_w = lv_font_get_glyph_width(font, 'M', 0);
+    s_cell_h = lv_font_get_line_height(font);
+    if (s_cell_w <= 0 || s_cell_h <= 0) {
+        return false;
+    }
+
+    int32_t scratch_w = GLYPH_COUNT * s_cell_w;
+    uint16_t *scratch = heap_caps_calloc(scratch_w * s_cell_h, sizeof(uint16_t),
+                                         MALLOC_CAP_SPIRAM);
+    s_atlas = heap_caps_malloc(GLYPH_COUNT * s_cell_w * s_cell_h,
+                               MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (scratch == NULL || s_atlas == NULL) {
+        heap_caps_free(scratch);
+        return false;
+    }
+
+    lv_obj_t *canvas = lv_canvas_create(parent);
+    lv_canvas_set_buffer(canvas, scratch, scratch_w, s_cell_h, LV_COLOR_FORMAT_RGB565);
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_COVER);
+
+    lv_layer_t layer;
+    lv_canvas_init_layer(canvas, &layer);
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = font;
+    dsc.color = lv_color_white();
+    char text[2] = { 0, 0 };
+    dsc.text = text;
+    dsc.text_local = 1;     /* The label draw copies the text */
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        text[0] = (char)(FIRST_GLYPH + i);
+        lv_area_t area = {
+            .x1 = i * s_cell_w,
+            .y1 = 0,
+            .x2 = (i + 1) * s_cell_w - 1,
+            .y2 = s_cell_h - 1,
+        };
+        lv_draw_label(&layer, &dsc, &area);
+    }
+    lv_canvas_finish_layer(canvas, &layer);
+
+    /* Green has the most bits in RGB565: 0-63 -> coverage 0-3 */
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        uint8_t *glyph = s_atlas + i * s_cell_w * s_cell_h;
+        for (int y = 0; y < s_cell_h; y++) {
+            for (int x = 0; x < s_cell_w; x++) {
+                uint16_t px = scratch[y * scratch_w + i * s_cell_w + x];
+                uint32_t green = (px >> 5) & 0x3F;
+                glyph[y * s_cell_w + x] = (uint8_t)((green * 3 + 31) / 63);
+            }
+        }
+    }
+
+    lv_obj_delete(canvas);
+    heap_caps_free(scratch);
+    return true;
+}
+
+static inline const uint8_t *glyph_for(char c)
+{
+    uint8_t u = (uint8_t)c;
+    if (u == '\t') {
+        u = ' ';
+    } else if (u < FIRST_GLYPH || u >= FIRST_GLYPH + GLYPH_COUNT) {
+        u = '?';
+    }
+    return s_atlas + (u - FIRST_GLYPH) * s_cell_w * s_cell_h;
+}
+
+/* ── Drawing ────────────────────────────────────────────────────────── */
+
+static void fill_rows(uint32_t first, uint32_t count)
+{
+    uint16_t *p = s_buf + first * s_cell_h * s_width;
+    size_t n = (size_t)count * s_cell_h * s_width;
+    for (size_t i = 0; i < n; i++) {
+        p[i] = s_bg;
+    }
+}
+
+void log_view_draw_row(uint32_t row, const char *text, size_t len, lv_color_t color)
+{
+    if (row >= s_rows) {
+        return;
+    }
+
+    /* Background-to-color ramp for coverage 0..3 */
+    lv_color_t bg = BG_COLOR;
+    uint16_t pal[4];
+    for (int i = 0; i < 4; i++) {
+        pal[i] = lv_color_to_u16(lv_color_mix(color, bg, (uint8_t)(i * 255 / 3)));
+    }
+
+    size_t cols = len < s_cols ? len : s_cols;
+    const uint8_t *glyphs[MAX_COLS];
+    for (size_t c = 0; c < cols; c++) {
+        glyphs[c] = glyph_for(text[c]);
+    }
+
+    uint16_t *dst_row = s_buf + row * s_cell_h * s_width;
+    for (int32_t y = 0; y < s_cell_h; y++) {
+        uint16_t *dst = dst_row + y * s_width;
+        uint16_t *end = dst + s_width;
+        int32_t glyph_off = y * s_cell_w;
+        for (size_t c = 0; c < cols; c++) {
+            const uint8_t *g = glyphs[c] + glyph_off;
+            for (int32_t x = 0; x < s_cell_w; x++) {
+                *dst++ = pal[g[x]];
+            }
+        }
+        while (dst < end) {
+            *dst++ = s_bg;
+        }
+    }
+    s_dirty = true;
+}
+
+void log_view_clear_row(uint32_t row)
+{
+    if (row < s_rows) {
+        fill_rows(row, 1);
+        s_dirty = true;
+    }
+}
+
+void log_view_scroll(int32_t rows)
+{
+    if (rows == 0 || s_buf == NULL) {
+        return;
+    }
+    uint32_t n = rows > 0 ? (uint32_t)rows : (uint32_t)-rows;
+    if (n >= s_rows) {
+        fill_rows(0, s_rows);
+    } else {
+        size_t row_px = (size_t)s_cell_h * s_width;
+        size_t keep = (s_rows - n) * row_px * sizeof(uint16_t);
+        if (rows > 0) {
+            memmove(s_buf, s_buf + n * row_px, keep);
+            fill_rows(s_rows - n, n);
+        } else {
+            memmove(s_buf + n * row_px, s_buf, keep);
+            fill_rows(0, n);
+        }
+    }
+    s_dirty = true;
+}
+
+bool log_view_flush(void)
+{
+    if (!s_dirty || s_canvas == NULL) {
+        return false;
+    }
+    s_dirty = false;
+    lv_obj_invalidate(s_canvas);
+    return true;
+}
+
+/* ── Accessors ──────────────────────────────────────────────────────── */
+
+uint32_t log_view_rows(void)
+{
+    return s_rows;
+}
+
+uint32_t log_view_cols(void)
+{
+    return s_cols;
+}
+
+int32_t log_view_row_height(void)
+{
+    return s_cell_h;
+}
+
+/* ── Creation ───────────────────────────────────────────────────────── */
+
+lv_obj_t *log_view_create(lv_obj_t *parent, int32_t width, int32_t height)
+{
+    if (!build_atlas(parent, &FT_LOG_VIEW_FONT)) {
+        ESP_LOGE(TAG, "Failed to build glyph atlas");
+        return NULL;
+    }
+
+    s_rows = height / s_cell_h;
+    s_cols = width / s_cell_w;
+    if (s_cols > MAX_COLS) {
+        s_cols = MAX_COLS;
+    }
+    s_width = width;
+    s_height = s_rows * s_cell_h;
+    s_buf = heap_caps_malloc((size_t)s_width * s_height * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    if (s_buf == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %ldx%ld canvas", (long)s_width, (long)s_height);
+        return NULL;
+    }
+
+    s_bg = lv_color_to_u16(BG_COLOR);
+    fill_rows(0, s_rows);
+
+    s_canvas = lv_canvas_create(parent);
+    lv_canvas_set_buffer(s_canvas, s_buf, s_width, s_height, LV_COLOR_FORMAT_RGB565);
+    lv_obj_remove_flag(s_canvas, LV_OBJ_FLAG_CLICKABLE);
+
+    ESP_LOGI(TAG, "Log view %lux%lu chars, %ldx%ld px cells, atlas %lu bytes",
+             (unsigned long)s_cols, (unsigned long)s_rows, (long)s_cell_w, (long)s_cell_h,
+             (unsigned long)(GLYPH_COUNT * s_cell_w * s_cell_h));
+    return s_canvas;
+}
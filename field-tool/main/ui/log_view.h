@@ -0,0 +1,63 @@
+#pragma once
+
+#include "lvgl.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Monospace log view drawn straight into a canvas buffer.
+ *
+ * The glyphs of FT_LOG_VIEW_FONT are rasterized once into an atlas in
+ * internal RAM (2-bit coverage per pixel). A row is drawn by looking
+ * every pixel up in a 4-entry palette blended from the background to the
+ * line's color, so there is no per-pixel blending and no label layout.
+ * Scrolling moves the drawn rows with one memmove; only the rows it
+ * exposes have to be drawn again.
+ *
+ * One instance (the serial monitor's); call from the LVGL task only.
+ */
+
+/**
+ * @brief Create the view (canvas buffer in PSRAM, atlas in internal RAM)
+ * @return The canvas object, or NULL if memory ran out
+ */
+lv_obj_t *log_view_create(lv_obj_t *parent, int32_t width, int32_t height);
+
+/**
+ * @brief Whole text rows that fit in the view
+ */
+uint32_t log_view_rows(void);
+
+/**
+ * @brief Characters per row (longer lines are clipped)
+ */
+uint32_t log_view_cols(void);
+
+/**
+ * @brief Height of one row in pixels
+ */
+int32_t log_view_row_height(void);
+
+/**
+ * @brief Draw one row of text (non-printable bytes show as '?')
+ */
+void log_view_draw_row(uint32_t row, const char *text, size_t len, lv_color_t color);
+
+/**
+ * @brief Blank one row
+ */
+void log_view_clear_row(uint32_t row);
+
+/**
+ * @brief Move the drawn rows up (rows > 0) or down (rows < 0)
+ *
+ * The rows scrolled in are blanked; the caller draws them.
+ */
+void log_view_scroll(int32_t rows);
+
+/**
+ * @brief Invalidate the canvas if anything was drawn since the last call
+ * @return true if the view changed
+ */
+bool log_view_flush(void);
@@ -0,0 +1,236 @@
+#include "ui_boot_profile.h"
+#include "ui_manager.h"
+#include "ui_styles.h"
+#include "serial/boot_profile.h"
+#include "app_config.h"
+#include "esp_log.h"
+
+#include <stdio.h>
+
+static const char *TAG = "UI_BOOT";
+
+/* ── UI state ────────────────────────────────────────────────────────── */
+
+static lv_obj_t *milestone_table = NULL;
+static lv_obj_t *status_label = NULL;
+static lv_obj_t *runs_label = NULL;
+static lv_obj_t *start_label = NULL;
+
+static const uint32_t s_run_choices[] = { 5, 10, 20, 50 };
+static uint8_t s_run_choice = 1;
+
+#define REFRESH_MS  (500)
+
+enum {
+    COL_NAME = 0,
+    COL_SEEN,
+    COL_MIN,
+    COL_MEDIAN,
+    COL_P95,
+    COL_MAX,
+    COL_TOTAL,
+};
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+/* Microseconds as "123.456 ms" */
+static void format_us(char *out, size_t len, uint32_t us)
+{
+    snprintf(out, len, "%lu.%03lu ms", (unsigned long)(us / 1000), (unsigned long)(us % 1000));
+}
+
+/* ── Refresh timer ───────────────────────────────────────────────────── */
+
+static void refresh_profile(void)
+{
+    boot_profile_status_t st;
+    boot_profile_get_status(&st);
+
+    uint8_t count = boot_profile_milestone_count();
+    lv_table_set_row_count(milestone_table, count + 1);
+    char cell[24];
+    for (uint8_t m = 0; m < count; m++) {
+        boot_profile_milestone_t ms;
+        if (!boot_profile_get_milestone(m, &ms)) {
+            continue;
+        }
+        uint32_t row = m + 1;
+        lv_table_set_cell_value(milestone_table, row, COL_NAME, ms.name);
+        lv_table_set_cell_value_fmt(milestone_table, row, COL_SEEN, "%lu/%lu",
+                                    (unsigned long)ms.seen, (unsigned long)st.runs_done);
+        const uint32_t values[] = { ms.min_us, ms.median_us, ms.p95_us, ms.max_us };
+        for (int c = COL_MIN; c <= COL_MAX; c++) {
+            if (ms.seen > 0) {
+                format_us(cell, sizeof(cell), values[c - COL_MIN]);
+            } else {
+                snprintf(cell, sizeof(cell), "-");
+            }
+            lv_table_set_cell_value(milestone_table, row, c, cell);
+        }
+    }
+
+    lv_label_set_text(start_label, st.state == BOOT_PROFILE_RUNNING ? "Stop" : "Start");
+
+    const char *version = st.version[0] != '\0' ? st.version : "?";
+    lv_color_t color = UI_COLOR_TEXT_DIM;
+    switch (st.state) {
+    case BOOT_PROFILE_RUNNING: {
+        boot_profile_milestone_t ms = { .name = "" };
+        boot_profile_get_milestone(st.waiting_for, &ms);
+        lv_label_set_text_fmt(status_label, "Boot %lu of %lu, waiting for %s | App version %s",
+                              (unsigned long)(st.runs_done + 1), (unsigned long)st.runs_total,
+                              ms.name[0] != '\0' ? ms.name : "settle", version);
+        break;
+    }
+    case BOOT_PROFILE_DONE:
+        if (st.result == ESP_OK) {
+            lv_label_set_text_fmt(status_label, "%lu boots timed | App version %s | Saved %s",
+                                  (unsigned long)st.runs_done, version, st.path);
+        } else {
+            lv_label_set_text_fmt(status_label, "%lu boots timed | App version %s | Not saved: %s",
+                                  (unsigned long)st.runs_done, version, esp_err_to_name(st.result));
+            color = UI_COLOR_LOG_WARN;
+        }
+        break;
+    case BOOT_PROFILE_FAILED:
+        lv_label_set_text_fmt(status_label, "Couldn't reset the target: %s",
+                              esp_err_to_name(st.result));
+        color = UI_COLOR_LOG_ERROR;
+        break;
+    default:
+        lv_label_set_text(status_label, "Resets the target through DTR/RTS and times each milestone"
+                                        " from the reset release");
+        break;
+    }
+    lv_obj_set_style_text_color(status_label, color, 0);
+}
+
+static void refresh_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    if (milestone_table == NULL || ui_manager_get_current_screen() != UI_SCREEN_BOOT_PROFILE) {
+        return;
+    }
+    refresh_profile();
+}
+
+/* ── Button handlers ─────────────────────────────────────────────────── */
+
+static void on_back_clicked(lv_event_t *e)
+{
+    (void)e;
+    ui_manager_show_screen(UI_SCREEN_SETTINGS);
+}
+
+static void on_runs_clicked(lv_event_t *e)
+{
+    (void)e;
+    s_run_choice = (s_run_choice + 1) % (sizeof(s_run_choices) / sizeof(s_run_choices[0]));
+    lv_label_set_text_fmt(runs_label, "%lu runs", (unsigned long)s_run_choices[s_run_choice]);
+}
+
+static void on_start_clicked(lv_event_t *e)
+{
+    (void)e;
+    boot_profile_status_t st;
+    boot_profile_get_status(&st);
+    if (st.state == BOOT_PROFILE_RUNNING) {
+        boot_profile_stop();
+        ESP_LOGI(TAG, "Stopping after this boot");
+        return;
+    }
+    esp_err_t err = boot_profile_start(s_run_choices[s_run_choice]);
+    if (err != ESP_OK) {
+        lv_label_set_text_fmt(status_label, "Can't start: %s%s", esp_err_to_name(err),
+                              err == ESP_ERR_INVALID_STATE ? " (no target connected?)" : "");
+        lv_obj_set_style_text_color(status_label, UI_COLOR_LOG_WARN, 0);
+        return;
+    }
+    refresh_profile();
+}
+
+static lv_obj_t *create_header_button(lv_obj_t *parent, const char *text, lv_coord_t w,
+                                      lv_color_t color, lv_event_cb_t cb)
+{
+    lv_obj_t *btn = lv_btn_create(parent);
+    lv_obj_set_size(btn, w, 36);
+    lv_obj_set_style_bg_color(btn, color, 0);
+    lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl = lv_label_create(btn);
+    lv_label_set_text(lbl, text);
+    lv_obj_center(lbl);
+    return lbl;
+}
+
+/* ── Screen creation ─────────────────────────────────────────────────── */
+
+lv_obj_t *ui_boot_profile_create(void)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, UI_COLOR_BG, 0);
+
+    /* ── Header bar ──────────────────────────────────────────────────── */
+    lv_obj_t *header = lv_obj_create(scr);
+    lv_obj_set_size(header, lv_pct(100), UI_TAB_BAR_H);
+    lv_obj_align(header, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_style_bg_color(header, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(header, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(header, 0, 0);
+    lv_obj_set_style_radius(header, 0, 0);
+    lv_obj_set_style_pad_hor(header, UI_PAD_MEDIUM, 0);
+    lv_obj_set_flex_flow(header, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(header, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(header, UI_PAD_SMALL, 0);
+
+    create_header_button(header, "< Back", 80, UI_COLOR_ACCENT, on_back_clicked);
+
+    lv_obj_t *title = lv_label_create(header);
+    lv_label_set_text(title, "Boot Profiler");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_color(title, UI_COLOR_TEXT, 0);
+    lv_obj_set_flex_grow(title, 1);
+
+    runs_label = create_header_button(header, "", 100, UI_COLOR_ACCENT, on_runs_clicked);
+    lv_label_set_text_fmt(runs_label, "%lu runs", (unsigned long)s_run_choices[s_run_choice]);
+    start_label = create_header_button(header, "Start", 90, UI_COLOR_HIGHLIGHT, on_start_clicked);
+
+    /* ── Milestone table ─────────────────────────────────────────────── */
+    static const char *const headings[COL_TOTAL] = {
+        "Milestone", "Seen", "Min", "Median", "p95", "Max",
+    };
+    static const lv_coord_t widths[COL_TOTAL] = { 260, 100, 150, 150, 150, 150 };
+
+    int32_t table_y = UI_TAB_BAR_H + UI_PAD_SMALL;
+    milestone_table = lv_table_create(scr);
+    lv_table_set_column_count(milestone_table, COL_TOTAL);
+    lv_table_set_row_count(milestone_table, 1);
+    for (int c = 0; c < COL_TOTAL; c++) {
+        lv_table_set_column_width(milestone_table, c, widths[c]);
+        lv_table_set_cell_value(milestone_table, 0, c, headings[c]);
+    }
+    lv_obj_set_size(milestone_table, 1000, 600 - table_y - 28 - UI_PAD_SMALL);
+    lv_obj_align(milestone_table, LV_ALIGN_TOP_MID, 0, table_y);
+    lv_obj_set_style_bg_color(milestone_table, UI_COLOR_PANEL, LV_PART_ITEMS);
+    lv_obj_set_style_text_color(milestone_table, UI_COLOR_TEXT, LV_PART_ITEMS);
+    lv_obj_set_style_text_font(milestone_table, &lv_font_montserrat_14, LV_PART_ITEMS);
+    lv_obj_set_style_pad_ver(milestone_table, 4, LV_PART_ITEMS);
+    lv_obj_set_style_bg_color(milestone_table, UI_COLOR_BG, 0);
+    lv_obj_set_style_border_width(milestone_table, 0, 0);
+
+    /* ── Status bar (bottom): progress, version, saved file ──────────── */
+    status_label = lv_label_create(scr);
+    lv_label_set_text(status_label, "");
+    lv_obj_set_style_text_font(status_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT_DIM, 0);
+    lv_obj_set_size(status_label, 1024, 28);
+    lv_obj_set_style_pad_hor(status_label, UI_PAD_MEDIUM, 0);
+    lv_obj_set_style_pad_ver(status_label, 4, 0);
+    lv_obj_align(status_label, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_obj_set_style_bg_color(status_label, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(status_label, LV_OPA_COVER, 0);
+
+    refresh_profile();
+    lv_timer_create(refresh_timer_cb, REFRESH_MS, NULL);
+
+    return scr;
+}
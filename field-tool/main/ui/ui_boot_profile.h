@@ -0,0 +1,9 @@
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Create the boot profiler screen (reset N times, time each milestone)
+ * @return Pointer to the screen object
+ */
+lv_obj_t *ui_boot_profile_create(void);
@@ -0,0 +1,355 @@
+#include "ui_chart.h"
+#include "ui_manager.h"
+#include "ui_styles.h"
+#include "serial/log_series.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "UI_CHART";
+
+/* ── UI state ────────────────────────────────────────────────────────── */
+
+#define REFRESH_MS  (1000)
+#define BUCKETS     (400)           /* Two chart points (min, max) per bucket */
+#define Y_STEPS     (1000)          /* Chart units between the visible min and max */
+
+static lv_obj_t *series_dropdown = NULL;
+static lv_obj_t *span_label = NULL;
+static lv_obj_t *chart = NULL;
+static lv_chart_series_t *chart_series = NULL;
+static lv_obj_t *y_max_label = NULL;
+static lv_obj_t *y_min_label = NULL;
+static lv_obj_t *x_label = NULL;
+static lv_obj_t *status_label = NULL;
+
+static uint8_t s_series_count = 0;  /* Options loaded into the dropdown */
+static uint8_t s_span = 0;
+static bool s_export_seen = false;  /* An export was started from this screen */
+
+static const struct {
+    const char *name;
+    uint32_t ms;                    /* 0 = everything held */
+} s_spans[] = {
+    { "1 min", 60 * 1000 },
+    { "10 min", 10 * 60 * 1000 },
+    { "1 h", 60 * 60 * 1000 },
+    { "All", 0 },
+};
+#define SPAN_COUNT  (sizeof(s_spans) / sizeof(s_spans[0]))
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+static void load_series_names(void)
+{
+    uint8_t count = log_series_count();
+    if (count == s_series_count) {
+        return;
+    }
+    static char options[FT_SERIES_MAX * (LOG_SERIES_NAME_MAX + 1)];
+    size_t pos = 0;
+    options[0] = '\0';
+    for (uint8_t i = 0; i < count; i++) {
+        log_series_info_t info;
+        if (log_series_get_info(i, &info)) {
+            pos += snprintf(options + pos, sizeof(options) - pos, "%s%s", i ? "\n" : "", info.name);
+        }
+    }
+    lv_dropdown_set_options(series_dropdown, count ? options : "(no series)");
+    s_series_count = count;
+}
+
+/* Milliseconds as "45 s", "12 min" or "3 h 20 min" */
+static void format_span(char *out, size_t len, uint32_t ms)
+{
+    if (ms < 120 * 1000) {
+        snprintf(out, len, "%lu s", (unsigned long)(ms / 1000));
+    } else if (ms < 120 * 60 * 1000) {
+        snprintf(out, len, "%lu min", (unsigned long)(ms / 60000));
+    } else {
+        snprintf(out, len, "%lu h %lu min", (unsigned long)(ms / 3600000),
+                 (unsigned long)(ms % 3600000 / 60000));
+    }
+}
+
+/* ── Refresh ─────────────────────────────────────────────────────────── */
+
+static void refresh_chart(void)
+{
+    load_series_names();
+    if (s_series_count == 0) {
+        lv_chart_set_all_value(chart, chart_series, LV_CHART_POINT_NONE);
+        lv_chart_refresh(chart);
+        lv_label_set_text(y_max_label, "");
+        lv_label_set_text(y_min_label, "");
+        lv_label_set_text(x_label, "");
+        lv_label_set_text(status_label, "No series defined. Add extractors to " FT_SERIES_FILE
+                                        " (e.g. \"flow\" or \"rssi = [wifi] rssi *\") and restart.");
+        return;
+    }
+
+    uint8_t id = (uint8_t)lv_dropdown_get_selected(series_dropdown);
+    log_series_info_t info;
+    if (!log_series_get_info(id, &info)) {
+        return;
+    }
+
+    /* Window ending now for the fixed spans, or everything held */
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    uint32_t from_ms;
+    uint32_t to_ms;
+    if (s_spans[s_span].ms != 0) {
+        to_ms = now_ms + 1;
+        from_ms = to_ms > s_spans[s_span].ms ? to_ms - s_spans[s_span].ms : 0;
+    } else {
+        from_ms = info.samples ? info.first_ms : 0;
+        to_ms = info.samples ? info.last_ms + 1 : now_ms + 1;
+        if (to_ms - from_ms < BUCKETS) {
+            to_ms = from_ms + BUCKETS;
+        }
+    }
+
+    static log_series_bucket_t buckets[BUCKETS];
+    uint32_t shown = log_series_downsample(id, from_ms, to_ms, buckets, BUCKETS);
+
+    float lo = 0.0f;
+    float hi = 0.0f;
+    bool any = false;
+    for (uint32_t i = 0; i < BUCKETS; i++) {
+        if (buckets[i].count == 0) {
+            continue;
+        }
+        if (!any || buckets[i].min < lo) {
+            lo = buckets[i].min;
+        }
+        if (!any || buckets[i].max > hi) {
+            hi = buckets[i].max;
+        }
+        any = true;
+    }
+    if (hi - lo < 1e-6f) {
+        lo -= 1.0f;
+        hi += 1.0f;
+    }
+    float scale = Y_STEPS / (hi - lo);
+
+    /* Each bucket draws its min and max in the order they occurred, so
+     * spikes survive any zoom level */
+    for (uint32_t i = 0; i < BUCKETS; i++) {
+        const log_series_bucket_t *b = &buckets[i];
+        int32_t a = LV_CHART_POINT_NONE;
+        int32_t z = LV_CHART_POINT_NONE;
+        if (b->count != 0) {
+            int32_t vmin = (int32_t)((b->min - lo) * scale);
+            int32_t vmax = (int32_t)((b->max - lo) * scale);
+            a = b->min_ms <= b->max_ms ? vmin : vmax;
+            z = b->min_ms <= b->max_ms ? vmax : vmin;
+        }
+        lv_chart_set_value_by_id(chart, chart_series, 2 * i, a);
+        lv_chart_set_value_by_id(chart, chart_series, 2 * i + 1, z);
+    }
+    lv_chart_refresh(chart);
+
+    char span[24];
+    format_span(span, sizeof(span), to_ms - from_ms);
+    lv_label_set_text_fmt(y_max_label, "%g", (double)hi);
+    lv_label_set_text_fmt(y_min_label, "%g", (double)lo);
+    lv_label_set_text_fmt(x_label, "%s, %lu samples", span, (unsigned long)shown);
+
+    /* Status: value, range, storage, export progress */
+    char text[200];
+    int len = 0;
+    if (info.samples == 0) {
+        len = snprintf(text, sizeof(text), "%s: no samples yet", info.name);
+    } else {
+        char held[24];
+        format_span(held, sizeof(held), info.last_ms - info.first_ms);
+        len = snprintf(text, sizeof(text),
+                       "%s = %g | min %g max %g | %lu samples over %s | %lu KB, %lu.%lu bits/sample",
+                       info.name, (double)info.last_value, (double)info.min, (double)info.max,
+                       (unsigned long)info.samples, held, (unsigned long)(info.bytes / 1024),
+                       (unsigned long)((uint64_t)info.bytes * 8 / info.samples),
+                       (unsigned long)((uint64_t)info.bytes * 80 / info.samples % 10));
+        if (info.dropped != 0 && len < (int)sizeof(text)) {
+            len += snprintf(text + len, sizeof(text) - len, " | %lu dropped",
+                            (unsigned long)info.dropped);
+        }
+    }
+    lv_color_t color = UI_COLOR_TEXT_DIM;
+    if (s_export_seen && len < (int)sizeof(text)) {
+        char path[64];
+        uint32_t rows = 0;
+        esp_err_t result = ESP_OK;
+        bool running = log_series_export_status(path, sizeof(path), &rows, &result);
+        if (running) {
+            snprintf(text + len, sizeof(text) - len, " | Exporting %lu rows", (unsigned long)rows);
+        } else if (result == ESP_OK) {
+            snprintf(text + len, sizeof(text) - len, " | Saved %s", path);
+            color = UI_COLOR_SUCCESS;
+        } else {
+            snprintf(text + len, sizeof(text) - len, " | Export failed: %s", esp_err_to_name(result));
+            color = UI_COLOR_HIGHLIGHT;
+        }
+    }
+    lv_label_set_text(status_label, text);
+    lv_obj_set_style_text_color(status_label, color, 0);
+}
+
+static void refresh_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    if (chart == NULL || ui_manager_get_current_screen() != UI_SCREEN_CHART) {
+        return;
+    }
+    refresh_chart();
+}
+
+/* ── Button handlers ─────────────────────────────────────────────────── */
+
+static void on_back_clicked(lv_event_t *e)
+{
+    (void)e;
+    ui_manager_show_screen(UI_SCREEN_STATS);
+}
+
+static void on_series_changed(lv_event_t *e)
+{
+    (void)e;
+    s_export_seen = false;
+    refresh_chart();
+}
+
+static void on_span_clicked(lv_event_t *e)
+{
+    (void)e;
+    s_span = (uint8_t)((s_span + 1) % SPAN_COUNT);
+    lv_label_set_text(span_label, s_spans[s_span].name);
+    refresh_chart();
+}
+
+static void on_export_clicked(lv_event_t *e)
+{
+    (void)e;
+    if (s_series_count == 0) {
+        return;
+    }
+    uint8_t id = (uint8_t)lv_dropdown_get_selected(series_dropdown);
+    esp_err_t err = log_series_export_csv(id);
+    if (err != ESP_OK) {
+        lv_label_set_text(status_label, "Can't export: no SD card, or an export is running");
+        lv_obj_set_style_text_color(status_label, UI_COLOR_HIGHLIGHT, 0);
+        return;
+    }
+    s_export_seen = true;
+    refresh_chart();
+}
+
+static void on_clear_clicked(lv_event_t *e)
+{
+    (void)e;
+    log_series_clear();
+    refresh_chart();
+    ESP_LOGI(TAG, "Series cleared");
+}
+
+static lv_obj_t *create_header_button(lv_obj_t *parent, const char *text, lv_coord_t w,
+                                      lv_color_t color, lv_event_cb_t cb)
+{
+    lv_obj_t *btn = lv_btn_create(parent);
+    lv_obj_set_size(btn, w, 36);
+    lv_obj_set_style_bg_color(btn, color, 0);
+    lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl = lv_label_create(btn);
+    lv_label_set_text(lbl, text);
+    lv_obj_center(lbl);
+    return lbl;
+}
+
+static lv_obj_t *create_axis_label(lv_obj_t *parent, lv_align_t align, int32_t x, int32_t y)
+{
+    lv_obj_t *lbl = lv_label_create(parent);
+    lv_label_set_text(lbl, "");
+    lv_obj_set_style_text_font(lbl, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(lbl, UI_COLOR_TEXT_DIM, 0);
+    lv_obj_align(lbl, align, x, y);
+    return lbl;
+}
+
+/* ── Screen creation ─────────────────────────────────────────────────── */
+
+lv_obj_t *ui_chart_create(void)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, UI_COLOR_BG, 0);
+
+    /* ── Header bar ──────────────────────────────────────────────────── */
+    lv_obj_t *header = lv_obj_create(scr);
+    lv_obj_set_size(header, lv_pct(100), UI_TAB_BAR_H);
+    lv_obj_align(header, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_style_bg_color(header, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(header, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(header, 0, 0);
+    lv_obj_set_style_radius(header, 0, 0);
+    lv_obj_set_style_pad_hor(header, UI_PAD_MEDIUM, 0);
+    lv_obj_set_flex_flow(header, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(header, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(header, UI_PAD_SMALL, 0);
+
+    create_header_button(header, "< Back", 80, UI_COLOR_ACCENT, on_back_clicked);
+
+    lv_obj_t *title = lv_label_create(header);
+    lv_label_set_text(title, "Series");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_color(title, UI_COLOR_TEXT, 0);
+    lv_obj_set_flex_grow(title, 1);
+
+    series_dropdown = lv_dropdown_create(header);
+    lv_obj_set_width(series_dropdown, 260);
+    lv_dropdown_set_options(series_dropdown, "(no series)");
+    lv_obj_add_event_cb(series_dropdown, on_series_changed, LV_EVENT_VALUE_CHANGED, NULL);
+
+    span_label = create_header_button(header, s_spans[0].name, 90, UI_COLOR_ACCENT, on_span_clicked);
+    create_header_button(header, "CSV", 70, UI_COLOR_ACCENT, on_export_clicked);
+    create_header_button(header, "Clear", 80, UI_COLOR_HIGHLIGHT, on_clear_clicked);
+
+    /* ── Chart: min/max envelope per bucket ──────────────────────────── */
+    int32_t chart_y = UI_TAB_BAR_H + 24;
+    int32_t chart_h = 600 - chart_y - 24 - 28 - UI_PAD_SMALL;
+    chart = lv_chart_create(scr);
+    lv_obj_set_size(chart, 1024 - 2 * UI_PAD_MEDIUM, chart_h);
+    lv_obj_align(chart, LV_ALIGN_TOP_MID, 0, chart_y);
+    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_point_count(chart, 2 * BUCKETS);
+    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, Y_STEPS);
+    lv_chart_set_div_line_count(chart, 5, 0);
+    lv_obj_set_style_bg_color(chart, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_border_width(chart, 0, 0);
+    lv_obj_set_style_line_width(chart, 2, LV_PART_ITEMS);
+    lv_obj_set_style_size(chart, 0, 0, LV_PART_INDICATOR);
+    chart_series = lv_chart_add_series(chart, UI_COLOR_TILE_SERIAL, LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_all_value(chart, chart_series, LV_CHART_POINT_NONE);
+
+    y_max_label = create_axis_label(scr, LV_ALIGN_TOP_LEFT, UI_PAD_MEDIUM, UI_TAB_BAR_H + 4);
+    y_min_label = create_axis_label(scr, LV_ALIGN_TOP_LEFT, UI_PAD_MEDIUM, chart_y + chart_h + 4);
+    x_label = create_axis_label(scr, LV_ALIGN_TOP_RIGHT, -UI_PAD_MEDIUM, chart_y + chart_h + 4);
+
+    /* ── Status bar (bottom): value, range, storage ──────────────────── */
+    status_label = lv_label_create(scr);
+    lv_label_set_text(status_label, "");
+    lv_obj_set_style_text_font(status_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT_DIM, 0);
+    lv_obj_set_size(status_label, 1024, 28);
+    lv_obj_set_style_pad_hor(status_label, UI_PAD_MEDIUM, 0);
+    lv_obj_set_style_pad_ver(status_label, 4, 0);
+    lv_obj_align(status_label, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_obj_set_style_bg_color(status_label, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(status_label, LV_OPA_COVER, 0);
+
+    refresh_chart();
+    lv_timer_create(refresh_timer_cb, REFRESH_MS, NULL);
+
+    return scr;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Create the series chart screen (values extracted from log lines)
+ * @return Pointer to the screen object
+ */
+lv_obj_t *ui_chart_create(void);
@@ -0,0 +1,305 @@
+#include "ui_diagnostics.h"
+#include "ui_manager.h"
+#include "ui_styles.h"
+#include "serial/latency_stats.h"
+#include "serial/serial_monitor.h"
+#include "serial/clock_fit.h"
+#include "serial/tag_table.h"
+#include "wifi/wall_clock.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "UI_DIAG";
+
+/* ── UI state ────────────────────────────────────────────────────────── */
+
+static lv_obj_t *stage_table = NULL;
+static lv_obj_t *status_label = NULL;
+static lv_obj_t *clock_label = NULL;
+static lv_obj_t *btn_enable_label = NULL;
+
+/* Previous refresh, for per-second rates */
+static uint32_t s_prev_count[LAT_STAGE_COUNT];
+static uint64_t s_prev_bytes[LAT_STAGE_COUNT];
+static int64_t s_prev_us = 0;
+
+#define REFRESH_MS  (1000)
+
+enum {
+    COL_STAGE = 0,
+    COL_COUNT,
+    COL_RATE,
+    COL_KBPS,
+    COL_P50,
+    COL_P90,
+    COL_P99,
+    COL_MAX,
+    COL_TOTAL,
+};
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+/* Microseconds as "850 us", "12.4 ms" or "3.20 s" */
+static void format_us(char *out, size_t len, uint32_t us)
+{
+    if (us < 1000) {
+        snprintf(out, len, "%lu us", (unsigned long)us);
+    } else if (us < 1000000) {
+        snprintf(out, len, "%lu.%lu ms", (unsigned long)(us / 1000),
+                 (unsigned long)(us % 1000 / 100));
+    } else {
+        snprintf(out, len, "%lu.%02lu s", (unsigned long)(us / 1000000),
+                 (unsigned long)(us % 1000000 / 10000));
+    }
+}
+
+static void update_enable_label(void)
+{
+    if (btn_enable_label) {
+        lv_label_set_text(btn_enable_label, latency_stats_is_enabled() ? "Stop" : "Record");
+    }
+}
+
+/* ── Refresh timer ───────────────────────────────────────────────────── */
+
+static void refresh_table(void)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t elapsed_ms = s_prev_us ? (uint32_t)((now - s_prev_us) / 1000) : 0;
+    s_prev_us = now;
+
+    char cell[24];
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        lat_stage_stats_t st;
+        latency_get(s, &st);
+        uint32_t row = s + 1;
+
+        /* Rates since the last refresh (counters may have been reset) */
+        uint32_t events = st.count >= s_prev_count[s] ? st.count - s_prev_count[s] : st.count;
+        uint64_t bytes = st.bytes >= s_prev_bytes[s] ? st.bytes - s_prev_bytes[s] : st.bytes;
+        s_prev_count[s] = st.count;
+        s_prev_bytes[s] = st.bytes;
+
+        lv_table_set_cell_value_fmt(stage_table, row, COL_COUNT, "%lu", (unsigned long)st.count);
+        if (elapsed_ms > 0) {
+            lv_table_set_cell_value_fmt(stage_table, row, COL_RATE, "%lu",
+                                        (unsigned long)(events * 1000ULL / elapsed_ms));
+            lv_table_set_cell_value_fmt(stage_table, row, COL_KBPS, "%lu",
+                                        (unsigned long)(bytes * 1000ULL / elapsed_ms / 1024));
+        }
+
+        if (st.count == 0) {
+            for (int c = COL_P50; c <= COL_MAX; c++) {
+                lv_table_set_cell_value(stage_table, row, c, "-");
+            }
+            continue;
+        }
+        format_us(cell, sizeof(cell), st.p50_us);
+        lv_table_set_cell_value(stage_table, row, COL_P50, cell);
+        format_us(cell, sizeof(cell), st.p90_us);
+        lv_table_set_cell_value(stage_table, row, COL_P90, cell);
+        format_us(cell, sizeof(cell), st.p99_us);
+        lv_table_set_cell_value(stage_table, row, COL_P99, cell);
+        format_us(cell, sizeof(cell), st.max_us);
+        lv_table_set_cell_value(stage_table, row, COL_MAX, cell);
+    }
+}
+
+/* Tool wall clock, the target clock fit and the tag table */
+static void refresh_clock(void)
+{
+    char text[256];
+    int len;
+    wall_clock_source_t source = wall_clock_source();
+    if (source != WALL_CLOCK_NONE) {
+        char now[32];
+        wall_clock_format(now, sizeof(now), wall_clock_us(esp_timer_get_time()), false);
+        now[19] = '\0';    /* Whole seconds */
+        len = snprintf(text, sizeof(text), "Clock %s UTC (%s)", now, wall_clock_source_name(source));
+    } else {
+        len = snprintf(text, sizeof(text), "Clock not set (uptime only)");
+    }
+
+    clock_fit_t fit;
+    clock_fit_get(&fit);
+    if (len < (int)sizeof(text)) {
+        if (fit.session == 0) {
+            snprintf(text + len, sizeof(text) - len, " | No timestamped lines yet");
+        } else if (!fit.valid) {
+            snprintf(text + len, sizeof(text) - len, " | Target boot %lu: fitting (%lu lines)",
+                     (unsigned long)fit.session, (unsigned long)fit.lines);
+        } else {
+            char jitter[24];
+            char max[24];
+            format_us(jitter, sizeof(jitter), fit.jitter_us);
+            format_us(max, sizeof(max), fit.jitter_max_us);
+            int drift_x10 = (int)(fit.drift_ppm * 10.0f + (fit.drift_ppm < 0 ? -0.5f : 0.5f));
+            int mag = drift_x10 < 0 ? -drift_x10 : drift_x10;
+            snprintf(text + len, sizeof(text) - len,
+                     " | Target boot %lu: drift %c%d.%d ppm over %lu s, receive jitter %s rms (max %s)",
+                     (unsigned long)fit.session, drift_x10 < 0 ? '-' : '+', mag / 10, mag % 10,
+                     (unsigned long)(fit.span_ms / 1000), jitter, max);
+        }
+    }
+    len = strlen(text);
+    if (len < (int)sizeof(text)) {
+        snprintf(text + len, sizeof(text) - len, " | Tags %u/%u, %lu dropped",
+                 (unsigned)tag_table_size(), (unsigned)FT_LOG_TAG_TABLE_SIZE,
+                 (unsigned long)tag_table_dropped());
+    }
+    lv_label_set_text(clock_label, text);
+}
+
+static void refresh_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    if (stage_table == NULL || ui_manager_get_current_screen() != UI_SCREEN_DIAGNOSTICS) {
+        s_prev_us = 0;      /* Rates restart when the screen is shown again */
+        return;
+    }
+    refresh_table();
+    refresh_clock();
+}
+
+/* ── Button handlers ─────────────────────────────────────────────────── */
+
+static void on_back_clicked(lv_event_t *e)
+{
+    (void)e;
+    ui_manager_show_screen(UI_SCREEN_SETTINGS);
+}
+
+static void on_enable_clicked(lv_event_t *e)
+{
+    (void)e;
+    latency_stats_set_enabled(!latency_stats_is_enabled());
+    update_enable_label();
+    ESP_LOGI(TAG, "Latency recording %s", latency_stats_is_enabled() ? "on" : "off");
+}
+
+static void on_reset_clicked(lv_event_t *e)
+{
+    (void)e;
+    latency_reset();
+    s_prev_us = 0;
+    refresh_table();
+    lv_label_set_text(status_label, "Histograms cleared");
+}
+
+static void on_save_clicked(lv_event_t *e)
+{
+    (void)e;
+    char path[96];
+    esp_err_t ret = latency_save_csv(path, sizeof(path));
+    if (ret == ESP_OK) {
+        lv_label_set_text_fmt(status_label, "Saved %s", path);
+        lv_obj_set_style_text_color(status_label, UI_COLOR_SUCCESS, 0);
+    } else {
+        lv_label_set_text(status_label, ret == ESP_ERR_INVALID_STATE ?
+                          "No SD card" : "Save failed");
+        lv_obj_set_style_text_color(status_label, UI_COLOR_HIGHLIGHT, 0);
+    }
+}
+
+static lv_obj_t *create_header_button(lv_obj_t *parent, const char *text, lv_coord_t w,
+                                      lv_color_t color, lv_event_cb_t cb)
+{
+    lv_obj_t *btn = lv_btn_create(parent);
+    lv_obj_set_size(btn, w, 36);
+    lv_obj_set_style_bg_color(btn, color, 0);
+    lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl = lv_label_create(btn);
+    lv_label_set_text(lbl, text);
+    lv_obj_center(lbl);
+    return lbl;
+}
+
+/* ── Screen creation ─────────────────────────────────────────────────── */
+
+lv_obj_t *ui_diagnostics_create(void)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, UI_COLOR_BG, 0);
+
+    /* ── Header bar ──────────────────────────────────────────────────── */
+    lv_obj_t *header = lv_obj_create(scr);
+    lv_obj_set_size(header, lv_pct(100), UI_TAB_BAR_H);
+    lv_obj_align(header, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_style_bg_color(header, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(header, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(header, 0, 0);
+    lv_obj_set_style_radius(header, 0, 0);
+    lv_obj_set_style_pad_hor(header, UI_PAD_MEDIUM, 0);
+    lv_obj_set_flex_flow(header, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(header, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(header, UI_PAD_SMALL, 0);
+
+    create_header_button(header, "< Back", 80, UI_COLOR_ACCENT, on_back_clicked);
+
+    lv_obj_t *title = lv_label_create(header);
+    lv_label_set_text(title, "Pipeline Latency");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_color(title, UI_COLOR_TEXT, 0);
+    lv_obj_set_flex_grow(title, 1);
+
+    btn_enable_label = create_header_button(header, "", 90, UI_COLOR_ACCENT, on_enable_clicked);
+    update_enable_label();
+    create_header_button(header, "Save CSV", 110, UI_COLOR_ACCENT, on_save_clicked);
+    create_header_button(header, "Reset", 80, UI_COLOR_HIGHLIGHT, on_reset_clicked);
+
+    /* ── Stage table ─────────────────────────────────────────────────── */
+    static const char *const headings[COL_TOTAL] = {
+        "Stage", "Count", "Per s", "KB/s", "p50", "p90", "p99", "Max",
+    };
+    static const lv_coord_t widths[COL_TOTAL] = { 150, 120, 100, 100, 130, 130, 130, 130 };
+
+    stage_table = lv_table_create(scr);
+    lv_table_set_column_count(stage_table, COL_TOTAL);
+    lv_table_set_row_count(stage_table, LAT_STAGE_COUNT + 1);
+    for (int c = 0; c < COL_TOTAL; c++) {
+        lv_table_set_column_width(stage_table, c, widths[c]);
+        lv_table_set_cell_value(stage_table, 0, c, headings[c]);
+    }
+    for (int s = 0; s < LAT_STAGE_COUNT; s++) {
+        lv_table_set_cell_value(stage_table, s + 1, COL_STAGE, latency_stage_name(s));
+    }
+    lv_obj_set_size(stage_table, 1000, 600 - UI_TAB_BAR_H - 2 * 28 - UI_PAD_MEDIUM);
+    lv_obj_align(stage_table, LV_ALIGN_TOP_MID, 0, UI_TAB_BAR_H + UI_PAD_SMALL);
+    lv_obj_set_style_bg_color(stage_table, UI_COLOR_PANEL, LV_PART_ITEMS);
+    lv_obj_set_style_text_color(stage_table, UI_COLOR_TEXT, LV_PART_ITEMS);
+    lv_obj_set_style_text_font(stage_table, &lv_font_montserrat_16, LV_PART_ITEMS);
+    lv_obj_set_style_bg_color(stage_table, UI_COLOR_BG, 0);
+    lv_obj_set_style_border_width(stage_table, 0, 0);
+
+    /* ── Clock row: wall clock and target clock fit ──────────────────── */
+    clock_label = lv_label_create(scr);
+    lv_label_set_text(clock_label, "");
+    lv_obj_set_style_text_font(clock_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(clock_label, UI_COLOR_TEXT, 0);
+    lv_obj_set_size(clock_label, 1024, 28);
+    lv_obj_set_style_pad_hor(clock_label, UI_PAD_MEDIUM, 0);
+    lv_obj_set_style_pad_ver(clock_label, 4, 0);
+    lv_obj_align(clock_label, LV_ALIGN_BOTTOM_LEFT, 0, -28);
+
+    /* ── Status bar (bottom) ─────────────────────────────────────────── */
+    status_label = lv_label_create(scr);
+    lv_label_set_text(status_label, "USB callback -> RX task -> framer -> parser -> ring -> UI / SD");
+    lv_obj_set_style_text_font(status_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT_DIM, 0);
+    lv_obj_set_size(status_label, 1024, 28);
+    lv_obj_set_style_pad_hor(status_label, UI_PAD_MEDIUM, 0);
+    lv_obj_set_style_pad_ver(status_label, 4, 0);
+    lv_obj_align(status_label, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_obj_set_style_bg_color(status_label, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(status_label, LV_OPA_COVER, 0);
+
+    refresh_table();
+    refresh_clock();
+    lv_timer_create(refresh_timer_cb, REFRESH_MS, NULL);
+
+    return scr;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Create the diagnostics screen (pipeline latency and throughput)
+ * @return Pointer to the screen object
+ */
+lv_obj_t *ui_diagnostics_create(void);
@@ -0,0 +1,445 @@
+#include "ui_history.h"
+#include "ui_manager.h"
+#include "ui_styles.h"
+#include "serial/log_history.h"
+#include "sdcard/sdcard_manager.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include <dirent.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "UI_HIST";
+
+#define PAGE_ROWS   (26)
+#define MAX_FILES   (64)
+#define POLL_MS     (200)
+
+/* ── UI state ────────────────────────────────────────────────────────── */
+
+static lv_obj_t *file_dropdown = NULL;
+static lv_obj_t *ta_input = NULL;
+static lv_obj_t *keyboard = NULL;
+static lv_obj_t *status_label = NULL;
+static lv_obj_t *row_labels[PAGE_ROWS];
+
+static char s_files[MAX_FILES][32];
+static uint32_t s_file_count = 0;
+static uint32_t s_top = 0;                      /* First line on the page */
+static uint32_t s_search_from = 0;              /* Where the next Find/Next starts */
+static log_history_state_t s_shown_state = LOG_HISTORY_CLOSED;
+static log_history_line_t *s_page = NULL;       /* PAGE_ROWS lines (PSRAM) */
+
+/* ── Color for log level ─────────────────────────────────────────────── */
+
+static lv_color_t level_color(char level)
+{
+    switch (level) {
+    case 'I': return UI_COLOR_LOG_INFO;
+    case 'W': return UI_COLOR_LOG_WARN;
+    case 'E': return UI_COLOR_LOG_ERROR;
+    case 'D': return UI_COLOR_LOG_DEBUG;
+    case 'V': return UI_COLOR_LOG_DEBUG;
+    default:  return UI_COLOR_LOG_DEFAULT;
+    }
+}
+
+/* ── Page ────────────────────────────────────────────────────────────── */
+
+static void set_status(lv_color_t color, const char *fmt, ...)
+{
+    char buf[160];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    lv_label_set_text(status_label, buf);
+    lv_obj_set_style_text_color(status_label, color, 0);
+}
+
+static void show_page(uint32_t top)
+{
+    log_history_info_t info;
+    log_history_get_info(&info);
+    if (info.lines > PAGE_ROWS && top > info.lines - PAGE_ROWS) {
+        top = info.lines - PAGE_ROWS;
+    } else if (info.lines <= PAGE_ROWS) {
+        top = 0;
+    }
+    s_top = top;
+    s_search_from = top;
+
+    size_t n = log_history_read(top, s_page, PAGE_ROWS);
+    char row[FT_LOG_LINE_MAX_LEN + 16];
+    for (size_t i = 0; i < PAGE_ROWS; i++) {
+        if (i < n) {
+            snprintf(row, sizeof(row), "%7lu %s", (unsigned long)s_page[i].line + 1,
+                     s_page[i].text);
+            lv_label_set_text(row_labels[i], row);
+            lv_obj_set_style_text_color(row_labels[i], level_color(s_page[i].level), 0);
+        } else {
+            lv_label_set_text(row_labels[i], "");
+        }
+    }
+}
+
+static void show_summary(void)
+{
+    log_history_info_t info;
+    log_history_get_info(&info);
+    uint32_t last = s_top + PAGE_ROWS < info.lines ? s_top + PAGE_ROWS : info.lines;
+    set_status(UI_COLOR_TEXT_DIM, "Lines %lu-%lu of %lu | %lu blocks%s",
+               (unsigned long)(info.lines ? s_top + 1 : 0), (unsigned long)last,
+               (unsigned long)info.lines, (unsigned long)info.blocks,
+               info.rebuilt ? " | index rebuilt" : "");
+}
+
+/* ── File list ───────────────────────────────────────────────────────── */
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp((const char *)b, (const char *)a);    /* Newest uptime first */
+}
+
+static void refresh_files(void)
+{
+    s_file_count = 0;
+    DIR *dir = sdcard_manager_is_mounted() ? opendir(FT_LOGS_DIR) : NULL;
+    if (dir != NULL) {
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL && s_file_count < MAX_FILES) {
+            /* Text logs only, by name: trigger_*.txt snapshots have no index
+             * and binary .ftl logs aren't readable here */
+            size_t len = strlen(ent->d_name);
+            if (strncmp(ent->d_name, "log_", 4) == 0 && len > 4 && len < sizeof(s_files[0]) &&
+                strcmp(ent->d_name + len - 4, ".txt") == 0) {
+                memcpy(s_files[s_file_count++], ent->d_name, len + 1);
+            }
+        }
+        closedir(dir);
+    }
+    qsort(s_files, s_file_count, sizeof(s_files[0]), compare_names);
+
+    static char options[MAX_FILES * 33];
+    size_t pos = 0;
+    options[0] = '\0';
+    for (uint32_t i = 0; i < s_file_count; i++) {
+        pos += snprintf(options + pos, sizeof(options) - pos, "%s%s", i ? "\n" : "", s_files[i]);
+    }
+    lv_dropdown_set_options(file_dropdown, s_file_count ? options : "(no logs)");
+}
+
+static void open_selected(void)
+{
+    uint32_t sel = lv_dropdown_get_selected(file_dropdown);
+    if (sel >= s_file_count) {
+        return;
+    }
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", FT_LOGS_DIR, s_files[sel]);
+    if (log_history_open(path) != ESP_OK) {
+        set_status(UI_COLOR_HIGHLIGHT, "Still loading another log");
+        return;
+    }
+    ESP_LOGI(TAG, "Opening %s", path);
+}
+
+/* ── Loader polling ──────────────────────────────────────────────────── */
+
+static void poll_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    log_history_state_t state = log_history_get_state();
+    if (state == s_shown_state) {
+        return;
+    }
+    s_shown_state = state;
+
+    switch (state) {
+    case LOG_HISTORY_LOADING:
+        set_status(UI_COLOR_TEXT_DIM, "Loading index...");
+        break;
+    case LOG_HISTORY_REBUILDING:
+        set_status(UI_COLOR_LOG_WARN, "No usable index, rebuilding (reads the whole file)...");
+        break;
+    case LOG_HISTORY_READY:
+        show_page(0);
+        show_summary();
+        break;
+    case LOG_HISTORY_FAILED:
+        set_status(UI_COLOR_HIGHLIGHT, "Cannot read this log");
+        break;
+    default:
+        break;
+    }
+}
+
+/* ── Navigation ──────────────────────────────────────────────────────── */
+
+static bool get_number(uint32_t *value)
+{
+    const char *text = lv_textarea_get_text(ta_input);
+    char *end;
+    unsigned long v = strtoul(text, &end, 10);
+    if (end == text) {
+        set_status(UI_COLOR_HIGHLIGHT, "Enter a number first");
+        return false;
+    }
+    *value = (uint32_t)v;
+    return true;
+}
+
+static bool history_ready(void)
+{
+    if (log_history_get_state() != LOG_HISTORY_READY) {
+        set_status(UI_COLOR_HIGHLIGHT, "Open a log first");
+        return false;
+    }
+    return true;
+}
+
+static void on_line_clicked(lv_event_t *e)
+{
+    (void)e;
+    uint32_t line;
+    if (history_ready() && get_number(&line)) {
+        show_page(line > 0 ? line - 1 : 0);
+        show_summary();
+    }
+}
+
+static void on_time_clicked(lv_event_t *e)
+{
+    (void)e;
+    uint32_t ms, line;
+    if (!history_ready() || !get_number(&ms)) {
+        return;
+    }
+    if (!log_history_find_time(ms, &line)) {
+        set_status(UI_COLOR_HIGHLIGHT, "Nothing logged at or after %lu ms", (unsigned long)ms);
+        return;
+    }
+    show_page(line);
+    show_summary();
+}
+
+/* Search from the page top, or past the last match so repeated presses step on */
+static void find_next(const log_history_filter_t *filter, const char *what)
+{
+    uint32_t line, skipped;
+    if (!history_ready()) {
+        return;
+    }
+    if (!log_history_find_next(s_search_from, filter, &line, &skipped)) {
+        set_status(UI_COLOR_HIGHLIGHT, "No more %s (%lu blocks skipped)", what,
+                   (unsigned long)skipped);
+        return;
+    }
+    show_page(line);
+    s_search_from = line + 1;
+    set_status(UI_COLOR_TEXT_DIM, "%s at line %lu | %lu blocks skipped via index", what,
+               (unsigned long)line + 1, (unsigned long)skipped);
+}
+
+static void on_next_error_clicked(lv_event_t *e)
+{
+    (void)e;
+    log_history_filter_t filter = { .levels = LOG_INDEX_LEVEL_E };
+    find_next(&filter, "Error");
+}
+
+static void on_next_warn_clicked(lv_event_t *e)
+{
+    (void)e;
+    log_history_filter_t filter = { .levels = LOG_INDEX_LEVEL_W | LOG_INDEX_LEVEL_E };
+    find_next(&filter, "Warning/error");
+}
+
+static void on_find_clicked(lv_event_t *e)
+{
+    (void)e;
+    const char *text = lv_textarea_get_text(ta_input);
+    if (text[0] == '\0') {
+        set_status(UI_COLOR_HIGHLIGHT, "Enter text to find");
+        return;
+    }
+    log_history_filter_t filter = { .text = text };
+    find_next(&filter, "Match");
+}
+
+static void on_page_clicked(lv_event_t *e)
+{
+    if (!history_ready()) {
+        return;
+    }
+    int32_t dir = (int32_t)(intptr_t)lv_event_get_user_data(e);
+    uint32_t top = dir < 0 ? (s_top > PAGE_ROWS ? s_top - PAGE_ROWS : 0) : s_top + PAGE_ROWS;
+    show_page(top);
+    show_summary();
+}
+
+static void on_file_changed(lv_event_t *e)
+{
+    (void)e;
+    open_selected();
+}
+
+static void on_screen_loaded(lv_event_t *e)
+{
+    (void)e;
+    refresh_files();
+}
+
+static void on_back_clicked(lv_event_t *e)
+{
+    (void)e;
+    if (keyboard) lv_obj_add_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+    ui_manager_show_screen(UI_SCREEN_HOME);
+}
+
+/* ── Keyboard show/hide on textarea focus ────────────────────────────── */
+
+static void on_ta_focused(lv_event_t *e)
+{
+    lv_obj_t *ta = lv_event_get_target(e);
+    if (keyboard) {
+        lv_keyboard_set_textarea(keyboard, ta);
+        lv_obj_remove_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+static void on_kb_ready(lv_event_t *e)
+{
+    (void)e;
+    if (keyboard) lv_obj_add_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+}
+
+/* ── Screen creation ─────────────────────────────────────────────────── */
+
+static void create_button(lv_obj_t *parent, const char *text, lv_coord_t w,
+                          lv_color_t color, lv_event_cb_t cb, void *user_data)
+{
+    lv_obj_t *btn = lv_btn_create(parent);
+    lv_obj_set_size(btn, w, 36);
+    lv_obj_set_style_bg_color(btn, color, 0);
+    lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, user_data);
+    lv_obj_t *lbl = lv_label_create(btn);
+    lv_label_set_text(lbl, text);
+    lv_obj_center(lbl);
+}
+
+static lv_obj_t *create_bar(lv_obj_t *parent, int32_t y)
+{
+    lv_obj_t *bar = lv_obj_create(parent);
+    lv_obj_set_size(bar, 1024, UI_TAB_BAR_H);
+    lv_obj_align(bar, LV_ALIGN_TOP_MID, 0, y);
+    lv_obj_set_style_bg_color(bar, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(bar, 0, 0);
+    lv_obj_set_style_radius(bar, 0, 0);
+    lv_obj_set_style_pad_hor(bar, UI_PAD_MEDIUM, 0);
+    lv_obj_set_flex_flow(bar, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(bar, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(bar, UI_PAD_SMALL, 0);
+    lv_obj_remove_flag(bar, LV_OBJ_FLAG_SCROLLABLE);
+    return bar;
+}
+
+lv_obj_t *ui_history_create(void)
+{
+    s_page = heap_caps_malloc(PAGE_ROWS * sizeof(log_history_line_t), MALLOC_CAP_SPIRAM);
+    if (s_page == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate page buffer");
+        return NULL;
+    }
+
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, UI_COLOR_BG, 0);
+    lv_obj_add_event_cb(scr, on_screen_loaded, LV_EVENT_SCREEN_LOADED, NULL);
+
+    /* ── Header bar: file selection ──────────────────────────────────── */
+    lv_obj_t *header = create_bar(scr, 0);
+    create_button(header, "< Back", 80, UI_COLOR_ACCENT, on_back_clicked, NULL);
+
+    lv_obj_t *title = lv_label_create(header);
+    lv_label_set_text(title, "Log History");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_color(title, UI_COLOR_TEXT, 0);
+    lv_obj_set_flex_grow(title, 1);
+
+    file_dropdown = lv_dropdown_create(header);
+    lv_obj_set_width(file_dropdown, 300);
+    lv_dropdown_set_options(file_dropdown, "(no logs)");
+    lv_obj_add_event_cb(file_dropdown, on_file_changed, LV_EVENT_VALUE_CHANGED, NULL);
+    create_button(header, "Open", 80, UI_COLOR_ACCENT, on_file_changed, NULL);
+
+    /* ── Navigation bar ──────────────────────────────────────────────── */
+    lv_obj_t *nav = create_bar(scr, UI_TAB_BAR_H);
+
+    ta_input = lv_textarea_create(nav);
+    lv_textarea_set_one_line(ta_input, true);
+    lv_textarea_set_placeholder_text(ta_input, "Line, ms or text");
+    lv_obj_set_width(ta_input, 240);
+    lv_obj_set_style_bg_color(ta_input, lv_color_hex(0x0D1B2A), 0);
+    lv_obj_set_style_text_color(ta_input, UI_COLOR_TEXT, 0);
+    lv_obj_set_style_border_color(ta_input, UI_COLOR_ACCENT, 0);
+    lv_obj_set_style_border_width(ta_input, 1, 0);
+    lv_obj_add_event_cb(ta_input, on_ta_focused, LV_EVENT_FOCUSED, NULL);
+
+    create_button(nav, "Go Line", 90, UI_COLOR_ACCENT, on_line_clicked, NULL);
+    create_button(nav, "Go ms", 80, UI_COLOR_ACCENT, on_time_clicked, NULL);
+    create_button(nav, "Find", 70, UI_COLOR_ACCENT, on_find_clicked, NULL);
+    create_button(nav, "Next Err", 100, UI_COLOR_HIGHLIGHT, on_next_error_clicked, NULL);
+    create_button(nav, "Next Warn", 110, UI_COLOR_ACCENT, on_next_warn_clicked, NULL);
+    create_button(nav, "< Page", 80, UI_COLOR_ACCENT, on_page_clicked, (void *)(intptr_t)-1);
+    create_button(nav, "Page >", 80, UI_COLOR_ACCENT, on_page_clicked, (void *)(intptr_t)1);
+
+    /* ── Page of lines ───────────────────────────────────────────────── */
+    lv_obj_t *page = lv_obj_create(scr);
+    lv_obj_set_size(page, 1024, 600 - 2 * UI_TAB_BAR_H - 28);
+    lv_obj_align(page, LV_ALIGN_TOP_MID, 0, 2 * UI_TAB_BAR_H);
+    lv_obj_set_style_bg_color(page, lv_color_hex(0x0D0D1A), 0);
+    lv_obj_set_style_bg_opa(page, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(page, 0, 0);
+    lv_obj_set_style_radius(page, 0, 0);
+    lv_obj_set_style_pad_all(page, 4, 0);
+    lv_obj_set_style_pad_row(page, 0, 0);
+    lv_obj_set_flex_flow(page, LV_FLEX_FLOW_COLUMN);
+    lv_obj_remove_flag(page, LV_OBJ_FLAG_SCROLLABLE);
+    for (int i = 0; i < PAGE_ROWS; i++) {
+        row_labels[i] = lv_label_create(page);
+        lv_label_set_text(row_labels[i], "");
+        lv_label_set_long_mode(row_labels[i], LV_LABEL_LONG_CLIP);
+        lv_obj_set_width(row_labels[i], lv_pct(100));
+        lv_obj_set_style_text_font(row_labels[i], &FT_LOG_VIEW_FONT, 0);
+    }
+
+    /* ── Status bar (bottom) ─────────────────────────────────────────── */
+    status_label = lv_label_create(scr);
+    lv_label_set_text(status_label, "Pick a log file");
+    lv_obj_set_style_text_font(status_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT_DIM, 0);
+    lv_obj_set_size(status_label, 1024, 28);
+    lv_obj_set_style_pad_hor(status_label, UI_PAD_MEDIUM, 0);
+    lv_obj_set_style_pad_ver(status_label, 4, 0);
+    lv_obj_align(status_label, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_obj_set_style_bg_color(status_label, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(status_label, LV_OPA_COVER, 0);
+
+    /* ── On-screen keyboard (hidden by default) ──────────────────────── */
+    keyboard = lv_keyboard_create(scr);
+    lv_obj_set_size(keyboard, 1024, 220);
+    lv_obj_align(keyboard, LV_ALIGN_BOTTOM_MID, 0, 0);
+    lv_obj_add_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_event_cb(keyboard, on_kb_ready, LV_EVENT_READY, NULL);
+    lv_obj_add_event_cb(keyboard, on_kb_ready, LV_EVENT_CANCEL, NULL);
+
+    lv_timer_create(poll_timer_cb, POLL_MS, NULL);
+
+    return scr;
+}
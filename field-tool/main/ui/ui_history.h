@@ -0,0 +1,9 @@
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Create the log history screen (browse indexed SD logs)
+ * @return Pointer to the screen object
+ */
+lv_obj_t *ui_history_create(void);
@@ -31,6 +31,13 @@ static void on_wifi_clicked(lv_event_t *e)
     ui_manager_show_screen(UI_SCREEN_WIFI_AP);
 }
 
+static void on_history_clicked(lv_event_t *e)
+{
+    (void)e;
+    ESP_LOGI(TAG, "Log history selected");
+    ui_manager_show_screen(UI_SCREEN_HISTORY);
+}
+
 static void on_settings_clicked(lv_event_t *e)
 {
     (void)e;
@@ -125,6 +132,19 @@ lv_obj_t *ui_home_create(void)
     create_tile(content, "WiFi\nHotspot", "Broadcast AP",
                 UI_COLOR_TILE_WIFI, on_wifi_clicked);
 
+    /* ── Log history button (bottom-left) ────────────────────────────── */
+    lv_obj_t *btn_history = lv_btn_create(scr);
+    lv_obj_set_size(btn_history, 140, 44);
+    lv_obj_align(btn_history, LV_ALIGN_BOTTOM_LEFT, UI_PAD_LARGE, -UI_PAD_LARGE);
+    lv_obj_set_style_bg_color(btn_history, UI_COLOR_ACCENT, 0);
+    lv_obj_set_style_radius(btn_history, 8, 0);
+    lv_obj_add_event_cb(btn_history, on_history_clicked, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t *lbl_history = lv_label_create(btn_history);
+    lv_label_set_text(lbl_history, "Log History");
+    lv_obj_set_style_text_font(lbl_history, &lv_font_montserrat_16, 0);
+    lv_obj_center(lbl_history);
+
     /* ── Settings button (bottom-right) ──────────────────────────────── */
     lv_obj_t *btn_settings = lv_btn_create(scr);
     lv_obj_set_size(btn_settings, 140, 44);
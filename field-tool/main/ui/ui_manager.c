@@ -5,6 +5,11 @@
 #include "ui_flasher.h"
 #include "ui_wifi_ap.h"
 #include "ui_settings.h"
+#include "ui_diagnostics.h"
+#include "ui_history.h"
+#include "ui_stats.h"
+#include "ui_chart.h"
+#include "ui_boot_profile.h"
 #include "esp_log.h"
 
 static const char *TAG = "UI_MGR";
@@ -22,6 +27,11 @@ void ui_manager_init(void)
     screens[UI_SCREEN_FLASHER] = ui_flasher_create();
     screens[UI_SCREEN_WIFI_AP] = ui_wifi_ap_create();
     screens[UI_SCREEN_SETTINGS] = ui_settings_create();
+    screens[UI_SCREEN_DIAGNOSTICS] = ui_diagnostics_create();
+    screens[UI_SCREEN_HISTORY] = ui_history_create();
+    screens[UI_SCREEN_STATS] = ui_stats_create();
+    screens[UI_SCREEN_CHART] = ui_chart_create();
+    screens[UI_SCREEN_BOOT_PROFILE] = ui_boot_profile_create();
 
     /* Show home screen */
     lv_screen_load(screens[UI_SCREEN_HOME]);
@@ -11,6 +11,11 @@ typedef enum {
     UI_SCREEN_FLASHER,
     UI_SCREEN_WIFI_AP,
     UI_SCREEN_SETTINGS,
+    UI_SCREEN_DIAGNOSTICS,
+    UI_SCREEN_HISTORY,
+    UI_SCREEN_STATS,
+    UI_SCREEN_CHART,
+    UI_SCREEN_BOOT_PROFILE,
     UI_SCREEN_COUNT,
 } ui_screen_id_t;
 
@@ -2,8 +2,19 @@
 #include "ui_manager.h"
 #include "ui_styles.h"
 #include "serial/serial_monitor.h"
+#include "serial/log_filter.h"
+#include "serial/log_trigger.h"
+#include "serial/latency_stats.h"
+#include "serial/log_search.h"
+#include "serial/log_cold.h"
+#include "serial/log_dedup.h"
+#include "serial/log_stats.h"
+#include "wifi/wall_clock.h"
+#include "log_view.h"
+#include "esp_timer.h"
 #include "app_config.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -12,15 +23,90 @@ static const char *TAG = "UI_SERIAL";
 
 /* ── UI state ────────────────────────────────────────────────────────── */
 
-static lv_obj_t *log_container = NULL;    /* Scrollable container for log lines */
+static lv_obj_t *log_area = NULL;         /* Fixed viewport holding the log view */
+static lv_obj_t *scroll_thumb = NULL;     /* Position indicator on the right edge */
 static lv_obj_t *status_label = NULL;     /* Bottom status bar */
 static lv_obj_t *btn_pause_label = NULL;
+static lv_obj_t *btn_level_label = NULL;
+static lv_obj_t *btn_baud_label = NULL;
+static lv_obj_t *btn_fold_label = NULL;
+static lv_obj_t *btn_time_label = NULL;
+static lv_obj_t *view_obj = NULL;         /* Glyph canvas, for tap-to-row mapping */
 
-static bool s_paused = false;
-static uint32_t s_last_displayed_count = 0;
+static bool s_paused = false;             /* Not following new lines */
+static uint32_t s_pause_requests = 0;     /* Last log_trigger_pause_requests() seen */
+static uint32_t s_view_lost = 0;          /* Lines evicted from the ring before indexed */
 
-/* Max lines shown on screen (older lines get deleted from the LVGL container) */
-#define MAX_DISPLAY_LINES  200
+/* Time column: the target's own "(ms)", or when the line arrived here as
+ * tool uptime or wall-clock time (UTC) */
+typedef enum {
+    TIME_TARGET = 0,
+    TIME_RX,
+    TIME_WALL,
+    TIME_MODE_COUNT,
+} time_mode_t;
+static time_mode_t s_time_mode = TIME_TARGET;
+
+/*
+ * Virtual list: the rows of a monospace log view (log_view.h) cover the
+ * visible area and are rebound to ring lines as the view moves. The
+ * display index holds the sequence numbers of ring lines routed to the
+ * display; entries outlive the ring while the cold tier (log_cold.h)
+ * still holds their lines, so scrollback reaches well past the ring.
+ * Work per frame is bounded
+ * by the row count (only rows whose line changed are drawn; a scroll
+ * moves the drawn rows), whatever the input rate; indexing new lines
+ * reads slot metadata only.
+ */
+#define VIEW_H        (600 - UI_TAB_BAR_H - 28)
+#define MAX_ROWS      (64)
+#define INDEX_SIZE    (FT_LOG_HISTORY_LINES)
+#define INDEX_MASK    (INDEX_SIZE - 1)
+
+static uint32_t s_visible_rows = 0;       /* From the log view's font */
+static int32_t s_row_h = 1;
+static uint32_t s_row_seq[MAX_ROWS];
+static bool s_row_bound[MAX_ROWS];
+static uint32_t s_drawn_top = 0;          /* Index position drawn in row 0 */
+
+static uint32_t *s_index = NULL;          /* Ring seq per display line (PSRAM) */
+static uint32_t s_index_head = 0;         /* Index positions, monotonic */
+static uint32_t s_index_tail = 0;
+static uint32_t s_scan_seq = 0;           /* Next ring line to index */
+static uint32_t s_top = 0;                /* Index position of the first row */
+static uint32_t s_shown_seq = 0;          /* Lines before this were rendered once */
+static int32_t s_drag_px = 0;             /* Drag not yet turned into whole rows */
+static int32_t s_press_travel = 0;        /* Distance moved since the press; small = tap */
+static int32_t s_thumb_y = -1;
+static int32_t s_thumb_h = -1;
+
+/* Frame-time mode: redraw every row at 60 fps and show the draw and
+ * display refresh times (also in the latency histograms) */
+#define REFRESH_MS       (100)
+#define PERF_REFRESH_MS  (16)
+static lv_timer_t *s_refresh_timer = NULL;
+static lv_obj_t *btn_perf_label = NULL;
+static bool s_perf_mode = false;
+static int64_t s_refr_start_us = 0;
+static uint32_t s_frames = 0;             /* Display refreshes since the last status */
+static uint32_t s_rows_drawn = 0;         /* Rows drawn since the last status */
+static int64_t s_perf_window_us = 0;
+
+/* Search: a bar over the top of the log area; the current hit is drawn
+ * in HIT_COLOR and Prev/Next step through the ring from it */
+#define HIT_COLOR        lv_color_hex(0x33CCFF)
+static lv_obj_t *search_bar = NULL;
+static lv_obj_t *ta_search = NULL;
+static lv_obj_t *search_label = NULL;
+static lv_obj_t *keyboard = NULL;
+static log_search_query_t s_query;
+static bool s_hit_valid = false;
+static uint32_t s_hit_seq = 0;
+
+static inline bool pos_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
 
 /* ── Color for log level ─────────────────────────────────────────────── */
 
@@ -36,84 +122,729 @@ static lv_color_t level_color(char level)
     }
 }
 
-/* ── Refresh timer (runs in LVGL task context) ───────────────────────── */
+/* ── Status bar ──────────────────────────────────────────────────────── */
 
-static void refresh_timer_cb(lv_timer_t *timer)
+static void update_status(void)
 {
-    if (s_paused || log_container == NULL) {
+    if (status_label == NULL) {
         return;
     }
 
-    uint32_t total = serial_monitor_get_count();
-    if (total == s_last_displayed_count) {
-        /* Update status bar even if no new lines */
-        if (status_label) {
-            bool connected = serial_monitor_is_connected();
-            lv_label_set_text_fmt(status_label, "%s | %d baud | Lines: %lu",
-                                  connected ? "USB: Connected" : "USB: Waiting...",
-                                  FT_UART_BAUD_RATE,
-                                  (unsigned long)serial_monitor_get_total_lines());
-            lv_obj_set_style_text_color(status_label,
-                                        connected ? UI_COLOR_SUCCESS : UI_COLOR_TEXT_DIM, 0);
+    bool connected = serial_monitor_is_connected();
+    char baud[32];
+    switch (serial_monitor_get_baud_state()) {
+    case SERIAL_BAUD_HUNTING:
+        snprintf(baud, sizeof(baud), "Auto: trying %lu", (unsigned long)serial_monitor_get_baud());
+        break;
+    case SERIAL_BAUD_LOCKED:
+        snprintf(baud, sizeof(baud), "%lu baud (auto)", (unsigned long)serial_monitor_get_baud());
+        break;
+    default:
+        snprintf(baud, sizeof(baud), "%lu baud", (unsigned long)serial_monitor_get_baud());
+        break;
+    }
+
+    /* Any loss on the way from USB to screen or card */
+    serial_loss_stats_t loss;
+    serial_monitor_get_loss_stats(&loss);
+    char lost[64] = "";
+    if (loss.usb_lost_bytes > 0 || loss.sd_lost_lines > 0 || s_view_lost > 0) {
+        snprintf(lost, sizeof(lost), " | Lost: USB %luB SD %lu View %lu",
+                 (unsigned long)loss.usb_lost_bytes, (unsigned long)loss.sd_lost_lines,
+                 (unsigned long)s_view_lost);
+    }
+
+    /* Frame-time mode replaces the usual summary */
+    if (s_perf_mode) {
+        int64_t now = esp_timer_get_time();
+        int64_t window_us = now - s_perf_window_us;
+        if (window_us < 1000000) {
+            return;     /* Update once a second */
         }
+        lat_stage_stats_t draw;
+        lat_stage_stats_t refr;
+        latency_get(LAT_STAGE_UI_DRAW, &draw);
+        latency_get(LAT_STAGE_UI_REFRESH, &refr);
+        uint32_t fps10 = (uint32_t)((int64_t)s_frames * 10000000 / window_us);
+        lv_label_set_text_fmt(status_label,
+                              "Perf: %lu.%lu fps | %lu rows/frame | draw p50 %lu us p99 %lu us"
+                              " | refresh p50 %lu us p99 %lu us max %lu us",
+                              (unsigned long)(fps10 / 10), (unsigned long)(fps10 % 10),
+                              (unsigned long)(s_frames ? s_rows_drawn / s_frames : 0),
+                              (unsigned long)draw.p50_us, (unsigned long)draw.p99_us,
+                              (unsigned long)refr.p50_us, (unsigned long)refr.p99_us,
+                              (unsigned long)refr.max_us);
+        lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT, 0);
+        s_frames = 0;
+        s_rows_drawn = 0;
+        s_perf_window_us = now;
         return;
     }
 
-    /* New lines available — add them */
-    uint32_t new_start = s_last_displayed_count;
-    uint32_t new_count = total - new_start;
+    char held[48];
+    uint32_t folded = log_dedup_folded();
+    log_stats_t rates;
+    log_stats_get(&rates);
+    int n = snprintf(held, sizeof(held), "%lu held", (unsigned long)(s_index_head - s_index_tail));
+    if (folded > 0) {
+        snprintf(held + n, sizeof(held) - n, ", %lu folded", (unsigned long)folded);
+    }
 
-    /* Read new entries */
-    log_entry_t entry;
-    for (uint32_t i = 0; i < new_count; i++) {
-        if (!serial_monitor_get_entry(new_start + i, &entry)) {
-            break;
+    log_trigger_info_t last;
+    if (log_trigger_get_last(&last)) {
+        lv_label_set_text_fmt(status_label, "%s | %s | Lines: %lu (%s) %lu/s%s | Triggers: %lu (%s)",
+                              connected ? "USB: Connected" : "USB: Waiting...", baud,
+                              (unsigned long)serial_monitor_get_total_lines(), held,
+                              (unsigned long)(rates.lines_rate_x10[1] / 10), lost,
+                              (unsigned long)log_trigger_total_hits(), last.text);
+    } else {
+        lv_label_set_text_fmt(status_label, "%s | %s | Lines: %lu (%s) %lu/s%s",
+                              connected ? "USB: Connected" : "USB: Waiting...", baud,
+                              (unsigned long)serial_monitor_get_total_lines(), held,
+                              (unsigned long)(rates.lines_rate_x10[1] / 10), lost);
+    }
+    lv_obj_set_style_text_color(status_label,
+                                lost[0] != '\0' ? UI_COLOR_LOG_WARN :
+                                connected ? UI_COLOR_SUCCESS : UI_COLOR_TEXT_DIM, 0);
+}
+
+static void set_paused(bool paused);
+
+/* ── Virtual list ────────────────────────────────────────────────────── */
+
+/* Append new display lines to the index; drop entries no tier holds */
+static void index_new_lines(const log_ring_t *ring)
+{
+    uint32_t next = log_ring_next_seq(ring);
+    uint32_t first = log_ring_first_seq(ring);
+    if (pos_before(s_scan_seq, first)) {
+        s_view_lost += first - s_scan_seq;
+        s_scan_seq = first;
+    }
+
+    /* Slot metadata only — no line bytes are copied here */
+    for (; s_scan_seq != next; s_scan_seq++) {
+        uint8_t sinks;
+        if (log_ring_peek_sinks(ring, s_scan_seq, &sinks) != LOG_RING_READ_OK ||
+            !(sinks & LOG_SINK_BIT(LOG_SINK_DISPLAY))) {
+            continue;   /* Evicted, or only in the ring for the network sink */
+        }
+        if (s_index_head - s_index_tail == INDEX_SIZE) {
+            s_index_tail++;     /* Never overwrite entries still in use */
+        }
+        s_index[s_index_head & INDEX_MASK] = s_scan_seq;
+        s_index_head++;
+    }
+
+    first = serial_monitor_first_seq();
+    while (s_index_tail != s_index_head &&
+           pos_before(s_index[s_index_tail & INDEX_MASK], first)) {
+        s_index_tail++;
+    }
+}
+
+/* Index position of the top row when showing the newest lines */
+static uint32_t bottom_top(void)
+{
+    uint32_t count = s_index_head - s_index_tail;
+    return count > s_visible_rows ? s_index_head - s_visible_rows : s_index_tail;
+}
+
+static void clamp_top(void)
+{
+    if (!s_paused || pos_before(bottom_top(), s_top)) {
+        s_top = bottom_top();
+    }
+    if (pos_before(s_top, s_index_tail)) {
+        s_top = s_index_tail;
+    }
+}
+
+static void unbind_row(uint32_t i)
+{
+    if (s_row_bound[i]) {
+        log_view_clear_row(i);
+        s_row_bound[i] = false;
+    }
+}
+
+/* Follow a move of the view by moving the drawn rows instead of redrawing them */
+static void shift_rows(void)
+{
+    int32_t shift = (int32_t)(s_top - s_drawn_top);
+    s_drawn_top = s_top;
+    if (shift == 0) {
+        return;
+    }
+    uint32_t n = shift > 0 ? (uint32_t)shift : (uint32_t)-shift;
+    if (n >= s_visible_rows) {
+        return;     /* Nothing reusable; every row redraws */
+    }
+
+    log_view_scroll(shift);
+    uint32_t keep = s_visible_rows - n;
+    if (shift > 0) {
+        memmove(s_row_seq, s_row_seq + n, keep * sizeof(s_row_seq[0]));
+        memmove(s_row_bound, s_row_bound + n, keep * sizeof(s_row_bound[0]));
+        memset(s_row_bound + keep, 0, n * sizeof(s_row_bound[0]));
+    } else {
+        memmove(s_row_seq + n, s_row_seq, keep * sizeof(s_row_seq[0]));
+        memmove(s_row_bound + n, s_row_bound, keep * sizeof(s_row_bound[0]));
+        memset(s_row_bound, 0, n * sizeof(s_row_bound[0]));
+    }
+}
+
+/* Receive time for the time column: "12:34:56.123456" or uptime "85.123456" */
+static void format_rx_time(char *out, size_t len, int64_t rx_us)
+{
+    int64_t wall_us = s_time_mode == TIME_WALL ? wall_clock_us(rx_us) : 0;
+    if (wall_us != 0) {
+        char full[32];
+        wall_clock_format(full, sizeof(full), wall_us, false);
+        snprintf(out, len, "%s", full + 11);    /* Time of day only */
+    } else {
+        snprintf(out, len, "%lu.%06lu", (unsigned long)(rx_us / 1000000),
+                 (unsigned long)(rx_us % 1000000));
+    }
+}
+
+/* Point every row at its line, touching only rows whose line changed */
+static void bind_rows(void)
+{
+    char raw[FT_LOG_LINE_MAX_LEN];
+    char display_text[384];
+    log_span_t span;
+    int64_t start_us = esp_timer_get_time();
+    uint32_t drawn = 0;
+
+    shift_rows();
+    if (s_perf_mode) {
+        /* Worst case on purpose: every row drawn every frame */
+        memset(s_row_bound, 0, sizeof(s_row_bound));
+    }
+
+    for (uint32_t i = 0; i < s_visible_rows; i++) {
+        uint32_t pos = s_top + i;
+        if (!pos_before(pos, s_index_head)) {
+            unbind_row(i);
+            continue;
+        }
+        uint32_t seq = s_index[pos & INDEX_MASK];
+        if (s_row_bound[i] && s_row_seq[i] == seq) {
+            continue;
+        }
+        if (serial_monitor_read_line(seq, raw, sizeof(raw), &span) != LOG_RING_READ_OK) {
+            unbind_row(i);
+            continue;
         }
 
         /* Build display text: "[I] (1234) TAG: message" */
-        char display_text[384];
-        if (entry.tag[0] != '\0') {
-            snprintf(display_text, sizeof(display_text), "[%c] (%lu) %s: %s",
-                     entry.level, (unsigned long)entry.timestamp_ms,
-                     entry.tag, entry.message);
+        int n;
+        char when[24] = "";
+        if (s_time_mode != TIME_TARGET && span.rx_us != 0) {
+            format_rx_time(when, sizeof(when), span.rx_us);
+        }
+        bool summary = span.tag_len == 0 &&
+                       log_dedup_is_summary(span.raw, span.raw_len);
+        if (summary) {
+            /* Collapsed under the run's first line; tap for the number ranges */
+            const char *text = span.raw + 4;        /* Past "--- " */
+            const char *end = memchr(text, '|', span.raw_len - 4);
+            int len = end != NULL ? (int)(end - text) - 1 : span.raw_len - 8;
+            n = snprintf(display_text, sizeof(display_text), "      ^ %.*s%s",
+                         len, text, end != NULL ? " [+]" : "");
+        } else if (span.tag_len > 0 && when[0] != '\0') {
+            n = snprintf(display_text, sizeof(display_text), "[%c] %s %.*s: %.*s",
+                         span.level, when, span.tag_len, span.raw + span.tag_off,
+                         log_span_msg_len(&span), span.raw + span.msg_off);
+        } else if (span.tag_len > 0) {
+            n = snprintf(display_text, sizeof(display_text), "[%c] (%lu) %.*s: %.*s",
+                         span.level, (unsigned long)span.timestamp_ms,
+                         span.tag_len, span.raw + span.tag_off,
+                         log_span_msg_len(&span), span.raw + span.msg_off);
+        } else if (when[0] != '\0') {
+            n = snprintf(display_text, sizeof(display_text), "%s %.*s",
+                         when, log_span_msg_len(&span), span.raw + span.msg_off);
+        } else {
+            n = snprintf(display_text, sizeof(display_text), "%.*s",
+                         log_span_msg_len(&span), span.raw + span.msg_off);
+        }
+        if (n > (int)sizeof(display_text) - 1) {
+            n = sizeof(display_text) - 1;
+        }
+        bool hit = s_hit_valid && seq == s_hit_seq;
+        log_view_draw_row(i, display_text, n, hit ? HIT_COLOR :
+                          summary ? UI_COLOR_TEXT_DIM : level_color(span.level));
+        s_row_seq[i] = seq;
+        s_row_bound[i] = true;
+        drawn++;
+
+        /* Ring-to-screen latency, once per line */
+        if (!pos_before(seq, s_shown_seq)) {
+            uint32_t age_us = latency_push_age_us(seq, esp_timer_get_time());
+            if (age_us > 0) {
+                latency_record(LAT_STAGE_UI_RENDER, age_us, span.raw_len);
+            }
+            s_shown_seq = seq + 1;
+        }
+    }
+
+    if (log_view_flush()) {
+        latency_record(LAT_STAGE_UI_DRAW, (uint32_t)(esp_timer_get_time() - start_us),
+                       drawn * log_view_cols());
+    }
+    s_rows_drawn += drawn;
+}
+
+static void update_scroll_thumb(void)
+{
+    uint32_t count = s_index_head - s_index_tail;
+    int32_t h = VIEW_H;
+    int32_t y = 0;
+    if (count > s_visible_rows) {
+        h = (int32_t)((uint64_t)VIEW_H * s_visible_rows / count);
+        if (h < 24) {
+            h = 24;
+        }
+        uint32_t range = count - s_visible_rows;
+        y = (int32_t)((uint64_t)(VIEW_H - h) * (s_top - s_index_tail) / range);
+    }
+    if (h != s_thumb_h) {
+        lv_obj_set_height(scroll_thumb, h);
+        s_thumb_h = h;
+    }
+    if (y != s_thumb_y) {
+        lv_obj_set_y(scroll_thumb, UI_TAB_BAR_H + y);
+        s_thumb_y = y;
+    }
+}
+
+/* Move the view by whole rows (negative = older) */
+static void scroll_rows(int32_t rows)
+{
+    if (rows == 0 || s_index == NULL) {
+        return;
+    }
+    if (rows < 0 && s_top == s_index_tail) {
+        return;                         /* Already at the oldest line */
+    }
+    if (rows < 0 && !s_paused) {
+        set_paused(true);               /* Scrolling back stops following */
+    }
+    s_top += rows;
+    clamp_top();
+    if (rows > 0 && s_paused && s_top == bottom_top()) {
+        set_paused(false);              /* Dragged back to the end: follow again */
+    }
+    bind_rows();
+    update_scroll_thumb();
+}
+
+static void on_view_pressed(lv_event_t *e)
+{
+    (void)e;
+    s_press_travel = 0;
+}
+
+static void on_view_pressing(lv_event_t *e)
+{
+    (void)e;
+    lv_point_t vect;
+    lv_indev_get_vect(lv_indev_active(), &vect);
+    s_drag_px += vect.y;
+    s_press_travel += LV_ABS(vect.x) + LV_ABS(vect.y);
+
+    /* Dragging down pulls older lines into view */
+    int32_t rows = s_drag_px / s_row_h;
+    s_drag_px -= rows * s_row_h;
+    scroll_rows(-rows);
+}
+
+static void on_view_released(lv_event_t *e)
+{
+    (void)e;
+    s_drag_px = 0;
+}
+
+/* ── Repeat folding ──────────────────────────────────────────────────── */
+
+static lv_obj_t *fold_panel = NULL;
+static lv_obj_t *fold_first_label = NULL;
+static lv_obj_t *fold_summary_label = NULL;
+
+static const char *const s_fold_names[] = { "Fold", "Fold=", "Fold#" };
+
+static void update_fold_label(void)
+{
+    if (btn_fold_label) {
+        lv_label_set_text(btn_fold_label, s_fold_names[log_dedup_get_mode()]);
+    }
+}
+
+/* ── Time column ─────────────────────────────────────────────────────── */
+
+static const char *const s_time_names[TIME_MODE_COUNT] = { "(ms)", "Rx", "UTC" };
+
+static void update_time_label(void)
+{
+    if (btn_time_label) {
+        lv_label_set_text(btn_time_label, s_time_names[s_time_mode]);
+    }
+}
+
+/* Target timestamp -> receive uptime -> receive wall clock (if set) */
+static void on_time_clicked(lv_event_t *e)
+{
+    (void)e;
+    s_time_mode = (time_mode_t)((s_time_mode + 1) % TIME_MODE_COUNT);
+    if (s_time_mode == TIME_WALL && wall_clock_source() == WALL_CLOCK_NONE) {
+        s_time_mode = TIME_TARGET;      /* Nothing to show until the clock is set */
+    }
+    update_time_label();
+    memset(s_row_bound, 0, sizeof(s_row_bound));    /* Redraw every row */
+}
+
+/* Off -> identical lines -> identical apart from numbers */
+static void on_fold_clicked(lv_event_t *e)
+{
+    (void)e;
+    log_dedup_set_mode((log_dedup_get_mode() + 1) % 3);
+    update_fold_label();
+}
+
+static void on_fold_close_clicked(lv_event_t *e)
+{
+    (void)e;
+    lv_obj_add_flag(fold_panel, LV_OBJ_FLAG_HIDDEN);
+}
+
+/* Show what a summary row stands for: the run's first line and the full summary */
+static void show_fold_details(uint32_t pos)
+{
+    char raw[FT_LOG_LINE_MAX_LEN];
+    char text[FT_LOG_LINE_MAX_LEN + 32];
+    log_span_t span;
+
+    if (serial_monitor_read_line(s_index[pos & INDEX_MASK], raw, sizeof(raw), &span) !=
+        LOG_RING_READ_OK) {
+        return;
+    }
+    lv_label_set_text_fmt(fold_summary_label, "%.*s", (int)span.raw_len, span.raw);
+
+    /* The run's first line is the nearest earlier line that isn't a summary
+     * (a long run leaves one summary every FT_LOG_DEDUP_SUMMARY_MS) */
+    lv_label_set_text(fold_first_label, "(first line no longer held)");
+    for (uint32_t i = 0; i < 64 && pos != s_index_tail; i++) {
+        pos--;
+        if (serial_monitor_read_line(s_index[pos & INDEX_MASK], raw, sizeof(raw), &span) !=
+            LOG_RING_READ_OK) {
+            break;
+        }
+        if (span.tag_len > 0 || !log_dedup_is_summary(span.raw, span.raw_len)) {
+            snprintf(text, sizeof(text), "%.*s", (int)span.raw_len, span.raw);
+            lv_label_set_text(fold_first_label, text);
+            break;
+        }
+    }
+    lv_obj_remove_flag(fold_panel, LV_OBJ_FLAG_HIDDEN);
+}
+
+/* A tap (not a drag) on a summary row expands it */
+static void on_view_clicked(lv_event_t *e)
+{
+    (void)e;
+    if (s_press_travel > s_row_h / 2 || view_obj == NULL || s_index == NULL) {
+        return;
+    }
+    lv_point_t p;
+    lv_area_t area;
+    lv_indev_get_point(lv_indev_active(), &p);
+    lv_obj_get_coords(view_obj, &area);
+    if (p.y < area.y1) {
+        return;
+    }
+    uint32_t row = (uint32_t)(p.y - area.y1) / s_row_h;
+    uint32_t pos = s_top + row;
+    if (row >= s_visible_rows || !pos_before(pos, s_index_head)) {
+        return;
+    }
+
+    char raw[FT_LOG_LINE_MAX_LEN];
+    log_span_t span;
+    if (serial_monitor_read_line(s_index[pos & INDEX_MASK], raw, sizeof(raw), &span) ==
+            LOG_RING_READ_OK &&
+        span.tag_len == 0 && log_dedup_is_summary(span.raw, span.raw_len)) {
+        show_fold_details(pos);
+    }
+}
+
+static lv_obj_t *create_fold_panel(lv_obj_t *scr)
+{
+    lv_obj_t *panel = lv_obj_create(scr);
+    lv_obj_set_size(panel, 900, LV_SIZE_CONTENT);
+    lv_obj_center(panel);
+    lv_obj_set_style_bg_color(panel, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_border_color(panel, UI_COLOR_ACCENT, 0);
+    lv_obj_set_style_border_width(panel, 2, 0);
+    lv_obj_set_style_pad_all(panel, UI_PAD_MEDIUM, 0);
+    lv_obj_set_flex_flow(panel, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_row(panel, UI_PAD_SMALL, 0);
+
+    lv_obj_t *title = lv_label_create(panel);
+    lv_label_set_text(title, "Repeated line");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_color(title, UI_COLOR_TEXT, 0);
+
+    fold_first_label = lv_label_create(panel);
+    lv_obj_set_width(fold_first_label, lv_pct(100));
+    lv_label_set_long_mode(fold_first_label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_style_text_color(fold_first_label, UI_COLOR_TEXT, 0);
+
+    fold_summary_label = lv_label_create(panel);
+    lv_obj_set_width(fold_summary_label, lv_pct(100));
+    lv_label_set_long_mode(fold_summary_label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_style_text_color(fold_summary_label, UI_COLOR_TEXT_DIM, 0);
+
+    lv_obj_t *btn = lv_btn_create(panel);
+    lv_obj_set_size(btn, 100, 36);
+    lv_obj_set_style_bg_color(btn, UI_COLOR_ACCENT, 0);
+    lv_obj_add_event_cb(btn, on_fold_close_clicked, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl = lv_label_create(btn);
+    lv_label_set_text(lbl, "Close");
+    lv_obj_center(lbl);
+
+    lv_obj_add_flag(panel, LV_OBJ_FLAG_HIDDEN);
+    return panel;
+}
+
+/* ── Search ──────────────────────────────────────────────────────────── */
+
+/* Index position of a ring line (the index is in sequence order) */
+static bool index_find(uint32_t seq, uint32_t *pos)
+{
+    uint32_t lo = s_index_tail, hi = s_index_head;
+    while (lo != hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (pos_before(s_index[mid & INDEX_MASK], seq)) {
+            lo = mid + 1;
         } else {
-            snprintf(display_text, sizeof(display_text), "%s", entry.message);
+            hi = mid;
         }
+    }
+    if (lo == s_index_head || s_index[lo & INDEX_MASK] != seq) {
+        return false;
+    }
+    *pos = lo;
+    return true;
+}
 
-        /* Create label for this line */
-        lv_obj_t *line_label = lv_label_create(log_container);
-        lv_label_set_text(line_label, display_text);
-        lv_obj_set_width(line_label, lv_pct(100));
-        lv_label_set_long_mode(line_label, LV_LABEL_LONG_WRAP);
-        lv_obj_set_style_text_font(line_label, &lv_font_montserrat_14, 0);
-        lv_obj_set_style_text_color(line_label, level_color(entry.level), 0);
-        lv_obj_set_style_pad_ver(line_label, 1, 0);
+/* Bring a hit into view a third of the way down and stop following */
+static bool show_hit(uint32_t seq)
+{
+    uint32_t pos;
+    if (!index_find(seq, &pos)) {
+        return false;
     }
+    s_hit_valid = true;
+    s_hit_seq = seq;
+    if (!s_paused) {
+        set_paused(true);
+    }
+    s_top = pos - s_index_tail > s_visible_rows / 3 ? pos - s_visible_rows / 3 : s_index_tail;
+    clamp_top();
+    memset(s_row_bound, 0, sizeof(s_row_bound));    /* Old and new hit change color */
+    bind_rows();
+    update_scroll_thumb();
+    return true;
+}
+
+static void run_search(bool backward)
+{
+    const char *text = lv_textarea_get_text(ta_search);
+    if (!log_search_compile(text, &s_query)) {
+        lv_label_set_text(search_label, "Type something to find");
+        return;
+    }
+    if (s_index_head == s_index_tail) {
+        lv_label_set_text(search_label, "Nothing to search yet");
+        return;
+    }
+
+    /* Step on from the current hit, else start from the visible rows */
+    uint32_t from;
+    if (s_hit_valid) {
+        from = backward ? s_hit_seq - 1 : s_hit_seq + 1;
+    } else if (backward) {
+        uint32_t last = s_top + s_visible_rows;
+        from = s_index[(pos_before(last, s_index_head) ? last : s_index_head - 1) & INDEX_MASK];
+    } else {
+        from = s_index[s_top & INDEX_MASK];
+    }
+
+    /* The cold tier holds the older lines: forward searches start there,
+     * backward ones end there */
+    const log_ring_t *ring = serial_monitor_get_ring();
+    uint8_t sinks = LOG_SINK_BIT(LOG_SINK_DISPLAY);
+    uint32_t seq;
+    log_search_stats_t stats = { 0 }, cold = { 0 };
+    bool found = false;
+    if (!backward && pos_before(from, log_ring_first_seq(ring))) {
+        found = log_cold_search(&s_query, from, false, sinks, &seq, &cold);
+    }
+    if (!found) {
+        found = log_search_ring(ring, &s_query, from, backward, sinks, &seq, &stats);
+    }
+    if (!found && backward) {
+        uint32_t first = log_ring_first_seq(ring);
+        found = log_cold_search(&s_query, pos_before(from, first) ? from : first - 1, true,
+                                sinks, &seq, &cold);
+    }
+    stats.blocks += cold.blocks;
+    stats.candidates += cold.candidates;
+    stats.elapsed_us += cold.elapsed_us;
+
+    if (found && show_hit(seq)) {
+        lv_label_set_text_fmt(search_label, "%lu of %lu blocks read, %lu us",
+                              (unsigned long)stats.candidates, (unsigned long)stats.blocks,
+                              (unsigned long)stats.elapsed_us);
+    } else {
+        lv_label_set_text_fmt(search_label, "No %s match (%lu us)",
+                              backward ? "earlier" : "later", (unsigned long)stats.elapsed_us);
+    }
+}
 
-    s_last_displayed_count = total;
+static void on_search_prev_clicked(lv_event_t *e)
+{
+    (void)e;
+    run_search(true);
+}
+
+static void on_search_next_clicked(lv_event_t *e)
+{
+    (void)e;
+    run_search(false);
+}
+
+/* New text searches from the view again */
+static void on_search_changed(lv_event_t *e)
+{
+    (void)e;
+    s_hit_valid = false;
+}
+
+static void on_search_ready(lv_event_t *e)
+{
+    (void)e;
+    lv_obj_add_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+    run_search(true);       /* Enter finds the newest match */
+}
+
+static void on_search_focused(lv_event_t *e)
+{
+    (void)e;
+    lv_keyboard_set_textarea(keyboard, ta_search);
+    lv_obj_remove_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+}
 
-    /* Trim old lines from display to keep memory bounded */
-    uint32_t child_count = lv_obj_get_child_count(log_container);
-    while (child_count > MAX_DISPLAY_LINES) {
-        lv_obj_t *oldest = lv_obj_get_child(log_container, 0);
-        if (oldest) {
-            lv_obj_delete(oldest);
+static void on_kb_cancel(lv_event_t *e)
+{
+    (void)e;
+    lv_obj_add_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+}
+
+static void on_find_clicked(lv_event_t *e)
+{
+    (void)e;
+    if (lv_obj_has_flag(search_bar, LV_OBJ_FLAG_HIDDEN)) {
+        lv_obj_remove_flag(search_bar, LV_OBJ_FLAG_HIDDEN);
+        on_search_focused(e);
+    } else {
+        lv_obj_add_flag(search_bar, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_add_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+        if (s_hit_valid) {
+            s_hit_valid = false;
+            memset(s_row_bound, 0, sizeof(s_row_bound));
         }
-        child_count--;
     }
+}
+
+static lv_obj_t *create_search_bar(lv_obj_t *scr)
+{
+    lv_obj_t *bar = lv_obj_create(scr);
+    lv_obj_set_size(bar, 1024, 52);
+    lv_obj_align(bar, LV_ALIGN_TOP_MID, 0, UI_TAB_BAR_H);
+    lv_obj_set_style_bg_color(bar, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(bar, 0, 0);
+    lv_obj_set_style_radius(bar, 0, 0);
+    lv_obj_set_style_pad_hor(bar, UI_PAD_MEDIUM, 0);
+    lv_obj_set_style_pad_ver(bar, 4, 0);
+    lv_obj_set_flex_flow(bar, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(bar, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(bar, UI_PAD_SMALL, 0);
+    lv_obj_remove_flag(bar, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(bar, LV_OBJ_FLAG_HIDDEN);
 
-    /* Auto-scroll to bottom */
-    lv_obj_scroll_to_y(log_container, LV_COORD_MAX, LV_ANIM_OFF);
+    ta_search = lv_textarea_create(bar);
+    lv_textarea_set_one_line(ta_search, true);
+    lv_textarea_set_placeholder_text(ta_search, "Find in log (any case)");
+    lv_textarea_set_max_length(ta_search, FT_LOG_SEARCH_MAX_LEN);
+    lv_obj_set_width(ta_search, 360);
+    lv_obj_set_style_bg_color(ta_search, lv_color_hex(0x0D1B2A), 0);
+    lv_obj_set_style_text_color(ta_search, UI_COLOR_TEXT, 0);
+    lv_obj_set_style_border_color(ta_search, UI_COLOR_ACCENT, 0);
+    lv_obj_set_style_border_width(ta_search, 1, 0);
+    lv_obj_add_event_cb(ta_search, on_search_focused, LV_EVENT_FOCUSED, NULL);
+    lv_obj_add_event_cb(ta_search, on_search_changed, LV_EVENT_VALUE_CHANGED, NULL);
 
-    /* Update status */
-    if (status_label) {
-        bool connected = serial_monitor_is_connected();
-        lv_label_set_text_fmt(status_label, "%s | %d baud | Lines: %lu",
-                              connected ? "USB: Connected" : "USB: Waiting...",
-                              FT_UART_BAUD_RATE,
-                              (unsigned long)serial_monitor_get_total_lines());
-        lv_obj_set_style_text_color(status_label,
-                                    connected ? UI_COLOR_SUCCESS : UI_COLOR_TEXT_DIM, 0);
+    static const struct {
+        const char *text;
+        lv_event_cb_t cb;
+    } buttons[] = {
+        { "< Prev", on_search_prev_clicked },
+        { "Next >", on_search_next_clicked },
+    };
+    for (size_t i = 0; i < sizeof(buttons) / sizeof(buttons[0]); i++) {
+        lv_obj_t *btn = lv_btn_create(bar);
+        lv_obj_set_size(btn, 90, 36);
+        lv_obj_set_style_bg_color(btn, UI_COLOR_ACCENT, 0);
+        lv_obj_add_event_cb(btn, buttons[i].cb, LV_EVENT_CLICKED, NULL);
+        lv_obj_t *lbl = lv_label_create(btn);
+        lv_label_set_text(lbl, buttons[i].text);
+        lv_obj_center(lbl);
+    }
+
+    search_label = lv_label_create(bar);
+    lv_label_set_text(search_label, "");
+    lv_obj_set_style_text_font(search_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(search_label, UI_COLOR_TEXT_DIM, 0);
+    lv_obj_set_flex_grow(search_label, 1);
+    return bar;
+}
+
+/* ── Refresh timer (runs in LVGL task context) ───────────────────────── */
+
+static void refresh_timer_cb(lv_timer_t *timer)
+{
+    if (log_area == NULL || s_index == NULL) {
+        return;
+    }
+
+    /* A pause trigger fired: show what has arrived, then freeze the view */
+    uint32_t pause_requests = log_trigger_pause_requests();
+    bool pause_now = (pause_requests != s_pause_requests);
+    s_pause_requests = pause_requests;
+
+    /* Index new lines even while paused so scrollback reaches them later */
+    const log_ring_t *ring = serial_monitor_get_ring();
+    index_new_lines(ring);
+    clamp_top();
+    bind_rows();
+    update_scroll_thumb();
+
+    update_status();
+    if (pause_now && !s_paused) {
+        set_paused(true);
     }
 }
 
@@ -125,35 +856,142 @@ static void on_back_clicked(lv_event_t *e)
     ui_manager_show_screen(UI_SCREEN_HOME);
 }
 
-static void on_pause_clicked(lv_event_t *e)
+static void set_paused(bool paused)
 {
-    (void)e;
-    s_paused = !s_paused;
+    s_paused = paused;
     if (btn_pause_label) {
         lv_label_set_text(btn_pause_label, s_paused ? "Resume" : "Pause");
     }
-    if (!s_paused) {
-        /* Catch up: reset display counter to force refresh */
-        /* We keep the ring buffer position but re-render from current state */
-        uint32_t total = serial_monitor_get_count();
-        if (total > MAX_DISPLAY_LINES) {
-            s_last_displayed_count = total - MAX_DISPLAY_LINES;
+    ESP_LOGI(TAG, "Monitor %s", s_paused ? "paused" : "resumed");
+}
+
+static void on_pause_clicked(lv_event_t *e)
+{
+    (void)e;
+    set_paused(!s_paused);
+    if (!s_paused && s_index != NULL) {
+        /* Jump back to the newest lines */
+        clamp_top();
+        bind_rows();
+        update_scroll_thumb();
+    }
+}
+
+/* Display-sink level filter, cycled by the level button */
+static const char s_level_steps[] = { 'V', 'I', 'W', 'E' };
+static const char *const s_level_names[] = { "All", "Info+", "Warn+", "Error" };
+
+static void update_level_label(char min_level)
+{
+    for (size_t i = 0; i < sizeof(s_level_steps); i++) {
+        if (s_level_steps[i] == min_level && btn_level_label) {
+            lv_label_set_text(btn_level_label, s_level_names[i]);
+        }
+    }
+}
+
+static void on_level_clicked(lv_event_t *e)
+{
+    (void)e;
+    log_filter_rules_t rules;
+    log_filter_get_rules(LOG_SINK_DISPLAY, &rules);
+
+    size_t i = 0;
+    while (i < sizeof(s_level_steps) && s_level_steps[i] != rules.min_level) {
+        i++;
+    }
+    rules.min_level = s_level_steps[(i + 1) % sizeof(s_level_steps)];
+    rules.pass_unparsed = (rules.min_level == 'V');
+
+    /* Applies from the next line received; SD still gets everything */
+    if (log_filter_set_rules(LOG_SINK_DISPLAY, &rules) == ESP_OK) {
+        update_level_label(rules.min_level);
+    }
+}
+
+/* Baud choices cycled by the baud button (0 = auto) */
+static const uint32_t s_baud_steps[] = { 0, 115200, 74880, 230400, 460800, 921600, 1500000, 2000000 };
+#define BAUD_STEP_COUNT  (sizeof(s_baud_steps) / sizeof(s_baud_steps[0]))
+
+static void update_baud_label(void)
+{
+    if (btn_baud_label == NULL) {
+        return;
+    }
+    if (serial_monitor_is_auto_baud()) {
+        lv_label_set_text(btn_baud_label, "Auto");
+    } else {
+        lv_label_set_text_fmt(btn_baud_label, "%lu", (unsigned long)serial_monitor_get_baud());
+    }
+}
+
+static void on_baud_clicked(lv_event_t *e)
+{
+    (void)e;
+    uint32_t current = serial_monitor_is_auto_baud() ? 0 : serial_monitor_get_baud();
+    size_t i = 0;
+    while (i < BAUD_STEP_COUNT && s_baud_steps[i] != current) {
+        i++;
+    }
+    uint32_t baud = s_baud_steps[(i + 1) % BAUD_STEP_COUNT];
+    serial_monitor_set_baud(baud);
+
+    if (btn_baud_label) {
+        if (baud == 0) {
+            lv_label_set_text(btn_baud_label, "Auto");
         } else {
-            s_last_displayed_count = 0;
+            lv_label_set_text_fmt(btn_baud_label, "%lu", (unsigned long)baud);
         }
-        /* Clear and re-render */
-        lv_obj_clean(log_container);
     }
-    ESP_LOGI(TAG, "Monitor %s", s_paused ? "paused" : "resumed");
+}
+
+static void on_perf_clicked(lv_event_t *e)
+{
+    (void)e;
+    s_perf_mode = !s_perf_mode;
+    s_frames = 0;
+    s_rows_drawn = 0;
+    s_perf_window_us = esp_timer_get_time();
+    if (s_refresh_timer) {
+        lv_timer_set_period(s_refresh_timer, s_perf_mode ? PERF_REFRESH_MS : REFRESH_MS);
+    }
+    lv_label_set_text(btn_perf_label, s_perf_mode ? "Perf*" : "Perf");
+    ESP_LOGI(TAG, "Frame-time mode %s", s_perf_mode ? "on" : "off");
+}
+
+/* Display refresh start/end — times every frame LVGL renders */
+static void on_display_refresh(lv_event_t *e)
+{
+    int64_t now = esp_timer_get_time();
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        s_refr_start_us = now;
+    } else if (s_refr_start_us != 0) {
+        latency_record(LAT_STAGE_UI_REFRESH, (uint32_t)(now - s_refr_start_us), 0);
+        s_refr_start_us = 0;
+        s_frames++;
+    }
+}
+
+static void on_stats_clicked(lv_event_t *e)
+{
+    (void)e;
+    ui_manager_show_screen(UI_SCREEN_STATS);
 }
 
 static void on_clear_clicked(lv_event_t *e)
 {
     (void)e;
     serial_monitor_clear();
-    s_last_displayed_count = 0;
-    if (log_container) {
-        lv_obj_clean(log_container);
+    s_scan_seq = log_ring_next_seq(serial_monitor_get_ring());
+    s_index_tail = s_index_head;
+    s_top = s_index_head;
+    s_hit_valid = false;
+    if (log_area) {
+        for (uint32_t i = 0; i < s_visible_rows; i++) {
+            unbind_row(i);
+        }
+        log_view_flush();
+        update_scroll_thumb();
     }
     ESP_LOGI(TAG, "Log cleared");
 }
@@ -193,6 +1031,46 @@ lv_obj_t *ui_serial_monitor_create(void)
     lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
     lv_obj_set_style_text_color(title, UI_COLOR_TEXT, 0);
     lv_obj_set_flex_grow(title, 1);
+    lv_label_set_long_mode(title, LV_LABEL_LONG_DOT);     /* Header is nearly full */
+
+    /* Baud rate button */
+    lv_obj_t *btn_baud = lv_btn_create(header);
+    lv_obj_set_size(btn_baud, 100, 36);
+    lv_obj_set_style_bg_color(btn_baud, UI_COLOR_ACCENT, 0);
+    lv_obj_add_event_cb(btn_baud, on_baud_clicked, LV_EVENT_CLICKED, NULL);
+    btn_baud_label = lv_label_create(btn_baud);
+    lv_obj_center(btn_baud_label);
+    update_baud_label();
+
+    /* Level filter button */
+    lv_obj_t *btn_level = lv_btn_create(header);
+    lv_obj_set_size(btn_level, 90, 36);
+    lv_obj_set_style_bg_color(btn_level, UI_COLOR_ACCENT, 0);
+    lv_obj_add_event_cb(btn_level, on_level_clicked, LV_EVENT_CLICKED, NULL);
+    btn_level_label = lv_label_create(btn_level);
+    lv_obj_center(btn_level_label);
+    log_filter_rules_t rules;
+    log_filter_get_rules(LOG_SINK_DISPLAY, &rules);
+    lv_label_set_text(btn_level_label, "All");
+    update_level_label(rules.min_level);
+
+    /* Repeat folding button */
+    lv_obj_t *btn_fold = lv_btn_create(header);
+    lv_obj_set_size(btn_fold, 80, 36);
+    lv_obj_set_style_bg_color(btn_fold, UI_COLOR_ACCENT, 0);
+    lv_obj_add_event_cb(btn_fold, on_fold_clicked, LV_EVENT_CLICKED, NULL);
+    btn_fold_label = lv_label_create(btn_fold);
+    lv_obj_center(btn_fold_label);
+    update_fold_label();
+
+    /* Time column button */
+    lv_obj_t *btn_time = lv_btn_create(header);
+    lv_obj_set_size(btn_time, 64, 36);
+    lv_obj_set_style_bg_color(btn_time, UI_COLOR_ACCENT, 0);
+    lv_obj_add_event_cb(btn_time, on_time_clicked, LV_EVENT_CLICKED, NULL);
+    btn_time_label = lv_label_create(btn_time);
+    lv_obj_center(btn_time_label);
+    update_time_label();
 
     /* Pause button */
     lv_obj_t *btn_pause = lv_btn_create(header);
@@ -203,6 +1081,33 @@ lv_obj_t *ui_serial_monitor_create(void)
     lv_label_set_text(btn_pause_label, "Pause");
     lv_obj_center(btn_pause_label);
 
+    /* Frame-time mode button */
+    lv_obj_t *btn_perf = lv_btn_create(header);
+    lv_obj_set_size(btn_perf, 70, 36);
+    lv_obj_set_style_bg_color(btn_perf, UI_COLOR_ACCENT, 0);
+    lv_obj_add_event_cb(btn_perf, on_perf_clicked, LV_EVENT_CLICKED, NULL);
+    btn_perf_label = lv_label_create(btn_perf);
+    lv_label_set_text(btn_perf_label, "Perf");
+    lv_obj_center(btn_perf_label);
+
+    /* Search button */
+    lv_obj_t *btn_find = lv_btn_create(header);
+    lv_obj_set_size(btn_find, 70, 36);
+    lv_obj_set_style_bg_color(btn_find, UI_COLOR_ACCENT, 0);
+    lv_obj_add_event_cb(btn_find, on_find_clicked, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl_find = lv_label_create(btn_find);
+    lv_label_set_text(lbl_find, "Find");
+    lv_obj_center(lbl_find);
+
+    /* Statistics dashboard button */
+    lv_obj_t *btn_stats = lv_btn_create(header);
+    lv_obj_set_size(btn_stats, 70, 36);
+    lv_obj_set_style_bg_color(btn_stats, UI_COLOR_ACCENT, 0);
+    lv_obj_add_event_cb(btn_stats, on_stats_clicked, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl_stats = lv_label_create(btn_stats);
+    lv_label_set_text(lbl_stats, "Stats");
+    lv_obj_center(lbl_stats);
+
     /* Clear button */
     lv_obj_t *btn_clear = lv_btn_create(header);
     lv_obj_set_size(btn_clear, 80, 36);
@@ -212,20 +1117,48 @@ lv_obj_t *ui_serial_monitor_create(void)
     lv_label_set_text(lbl_clear, "Clear");
     lv_obj_center(lbl_clear);
 
-    /* ── Log container (scrollable) ──────────────────────────────────── */
+    /* ── Log view (virtual list) ─────────────────────────────────────── */
     /* Screen is 600px tall: 48px header + log area + 28px status bar */
-    log_container = lv_obj_create(scr);
-    lv_obj_set_size(log_container, 1024, 600 - UI_TAB_BAR_H - 28);
-    lv_obj_align(log_container, LV_ALIGN_TOP_MID, 0, UI_TAB_BAR_H);
-    lv_obj_set_style_bg_color(log_container, lv_color_hex(0x0D0D1A), 0);
-    lv_obj_set_style_bg_opa(log_container, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(log_container, 0, 0);
-    lv_obj_set_style_radius(log_container, 0, 0);
-    lv_obj_set_style_pad_all(log_container, UI_PAD_SMALL, 0);
-    lv_obj_set_flex_flow(log_container, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_style_pad_row(log_container, 0, 0);
-    lv_obj_set_scroll_dir(log_container, LV_DIR_VER);
-    lv_obj_add_flag(log_container, LV_OBJ_FLAG_SCROLL_MOMENTUM);
+    log_area = lv_obj_create(scr);
+    lv_obj_set_size(log_area, 1024, VIEW_H);
+    lv_obj_align(log_area, LV_ALIGN_TOP_MID, 0, UI_TAB_BAR_H);
+    lv_obj_set_style_bg_color(log_area, lv_color_hex(0x0D0D1A), 0);
+    lv_obj_set_style_bg_opa(log_area, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(log_area, 0, 0);
+    lv_obj_set_style_radius(log_area, 0, 0);
+    lv_obj_set_style_pad_all(log_area, UI_PAD_SMALL, 0);
+    lv_obj_remove_flag(log_area, LV_OBJ_FLAG_SCROLLABLE);   /* We scroll by rebinding rows */
+    lv_obj_add_event_cb(log_area, on_view_pressed, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(log_area, on_view_pressing, LV_EVENT_PRESSING, NULL);
+    lv_obj_add_event_cb(log_area, on_view_released, LV_EVENT_RELEASED, NULL);
+    lv_obj_add_event_cb(log_area, on_view_clicked, LV_EVENT_CLICKED, NULL);
+
+    view_obj = log_view_create(log_area, 1024 - 2 * UI_PAD_SMALL - 8,
+                               VIEW_H - 2 * UI_PAD_SMALL);
+    if (view_obj != NULL) {
+        s_visible_rows = log_view_rows();
+        if (s_visible_rows > MAX_ROWS) {
+            s_visible_rows = MAX_ROWS;
+        }
+        s_row_h = log_view_row_height();
+    }
+
+    scroll_thumb = lv_obj_create(scr);
+    lv_obj_set_size(scroll_thumb, 4, VIEW_H);
+    lv_obj_set_pos(scroll_thumb, 1024 - 6, UI_TAB_BAR_H);
+    lv_obj_set_style_bg_color(scroll_thumb, UI_COLOR_TEXT_DIM, 0);
+    lv_obj_set_style_bg_opa(scroll_thumb, LV_OPA_60, 0);
+    lv_obj_set_style_border_width(scroll_thumb, 0, 0);
+    lv_obj_set_style_radius(scroll_thumb, 2, 0);
+    lv_obj_remove_flag(scroll_thumb, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(scroll_thumb, LV_OBJ_FLAG_IGNORE_LAYOUT);
+
+    /* Display index: one entry per ring slot, so the whole ring is reachable */
+    s_index = heap_caps_malloc(INDEX_SIZE * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+    if (s_index == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate display index");
+    }
+    s_scan_seq = log_ring_first_seq(serial_monitor_get_ring());
 
     /* ── Status bar (bottom) ─────────────────────────────────────────── */
     status_label = lv_label_create(scr);
@@ -239,8 +1172,27 @@ lv_obj_t *ui_serial_monitor_create(void)
     lv_obj_set_style_bg_color(status_label, UI_COLOR_PANEL, 0);
     lv_obj_set_style_bg_opa(status_label, LV_OPA_COVER, 0);
 
+    /* Details of a folded run (hidden until a summary row is tapped) */
+    fold_panel = create_fold_panel(scr);
+
+    /* ── Search bar and its keyboard (hidden until Find) ─────────────── */
+    search_bar = create_search_bar(scr);
+    keyboard = lv_keyboard_create(scr);
+    lv_obj_set_size(keyboard, 1024, 220);
+    lv_obj_align(keyboard, LV_ALIGN_BOTTOM_MID, 0, 0);
+    lv_obj_add_flag(keyboard, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_event_cb(keyboard, on_search_ready, LV_EVENT_READY, NULL);
+    lv_obj_add_event_cb(keyboard, on_kb_cancel, LV_EVENT_CANCEL, NULL);
+
+    /* Time display refreshes for the frame-time mode */
+    lv_display_t *disp = lv_display_get_default();
+    if (disp != NULL) {
+        lv_display_add_event_cb(disp, on_display_refresh, LV_EVENT_REFR_START, NULL);
+        lv_display_add_event_cb(disp, on_display_refresh, LV_EVENT_REFR_READY, NULL);
+    }
+
     /* ── Refresh timer (100ms = ~10fps update rate) ──────────────────── */
-    lv_timer_create(refresh_timer_cb, 100, NULL);
+    s_refresh_timer = lv_timer_create(refresh_timer_cb, REFRESH_MS, NULL);
 
     return scr;
 }
@@ -2,6 +2,10 @@
 #include "ui_manager.h"
 #include "ui_styles.h"
 #include "app_config.h"
+#include "serial/log_storage.h"
+
+static lv_obj_t *s_format_label = NULL;
+static lv_obj_t *s_format_warning = NULL;
 
 static void on_back_clicked(lv_event_t *e)
 {
@@ -9,10 +13,64 @@ static void on_back_clicked(lv_event_t *e)
     ui_manager_show_screen(UI_SCREEN_HOME);
 }
 
+static void on_diagnostics_clicked(lv_event_t *e)
+{
+    (void)e;
+    ui_manager_show_screen(UI_SCREEN_DIAGNOSTICS);
+}
+
+static void on_boot_profile_clicked(lv_event_t *e)
+{
+    (void)e;
+    ui_manager_show_screen(UI_SCREEN_BOOT_PROFILE);
+}
+
+static void update_format_label(void)
+{
+    log_storage_config_t config;
+    log_storage_stats_t stats;
+    log_storage_get_config(&config);
+    log_storage_get_stats(&stats);
+
+    /* Text bytes per byte on the card, over everything written so far */
+    uint32_t ratio10 = stats.bytes_written > 0 ?
+                       (uint32_t)(stats.text_bytes * 10ULL / stats.bytes_written) : 10;
+    lv_label_set_text_fmt(s_format_label, "SD log: %s  (%lu.%lux)",
+                          config.binary ? "Binary .ftl" : "Text .txt",
+                          (unsigned long)(ratio10 / 10), (unsigned long)(ratio10 % 10));
+
+    /* The History screen only reads text logs */
+    if (s_format_warning != NULL) {
+        if (config.binary) {
+            lv_obj_clear_flag(s_format_warning, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_add_flag(s_format_warning, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+}
+
+static void on_screen_loaded(lv_event_t *e)
+{
+    (void)e;
+    update_format_label();
+}
+
+/* Takes effect from the next write buffer, which starts a new file */
+static void on_format_clicked(lv_event_t *e)
+{
+    (void)e;
+    log_storage_config_t config;
+    log_storage_get_config(&config);
+    config.binary = !config.binary;
+    log_storage_set_config(&config);
+    update_format_label();
+}
+
 lv_obj_t *ui_settings_create(void)
 {
     lv_obj_t *scr = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(scr, UI_COLOR_BG, 0);
+    lv_obj_add_event_cb(scr, on_screen_loaded, LV_EVENT_SCREEN_LOADED, NULL);
 
     /* Header */
     lv_obj_t *header = lv_obj_create(scr);
@@ -62,13 +120,52 @@ lv_obj_t *ui_settings_create(void)
 
     /* UART info */
     lv_obj_t *uart = lv_label_create(content);
-    lv_label_set_text_fmt(uart, "UART: Port %d, %d baud\n"
+    lv_label_set_text_fmt(uart, "UART: Port %d, %d baud%s\n"
                                 "TX=GPIO%d, RX=GPIO%d",
                           FT_UART_PORT_NUM, FT_UART_BAUD_RATE,
+                          FT_UART_AUTO_BAUD ? " (auto-baud on)" : "",
                           FT_UART_TXD, FT_UART_RXD);
     lv_obj_set_style_text_color(uart, UI_COLOR_TEXT_DIM, 0);
     lv_obj_set_style_text_font(uart, &lv_font_montserrat_14, 0);
 
+    /* Pipeline diagnostics */
+    lv_obj_t *btn_diag = lv_btn_create(content);
+    lv_obj_set_size(btn_diag, 200, 44);
+    lv_obj_set_style_bg_color(btn_diag, UI_COLOR_ACCENT, 0);
+    lv_obj_set_style_radius(btn_diag, 8, 0);
+    lv_obj_add_event_cb(btn_diag, on_diagnostics_clicked, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl_diag = lv_label_create(btn_diag);
+    lv_label_set_text(lbl_diag, "Diagnostics");
+    lv_obj_set_style_text_font(lbl_diag, &lv_font_montserrat_16, 0);
+    lv_obj_center(lbl_diag);
+
+    /* Target boot timing */
+    lv_obj_t *btn_boot = lv_btn_create(content);
+    lv_obj_set_size(btn_boot, 200, 44);
+    lv_obj_set_style_bg_color(btn_boot, UI_COLOR_ACCENT, 0);
+    lv_obj_set_style_radius(btn_boot, 8, 0);
+    lv_obj_add_event_cb(btn_boot, on_boot_profile_clicked, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl_boot = lv_label_create(btn_boot);
+    lv_label_set_text(lbl_boot, "Boot Profiler");
+    lv_obj_set_style_text_font(lbl_boot, &lv_font_montserrat_16, 0);
+    lv_obj_center(lbl_boot);
+
+    /* SD log format */
+    lv_obj_t *btn_format = lv_btn_create(content);
+    lv_obj_set_size(btn_format, 300, 44);
+    lv_obj_set_style_bg_color(btn_format, UI_COLOR_ACCENT, 0);
+    lv_obj_set_style_radius(btn_format, 8, 0);
+    lv_obj_add_event_cb(btn_format, on_format_clicked, LV_EVENT_CLICKED, NULL);
+    s_format_label = lv_label_create(btn_format);
+    lv_obj_set_style_text_font(s_format_label, &lv_font_montserrat_16, 0);
+    lv_obj_center(s_format_label);
+    s_format_warning = lv_label_create(content);
+    lv_label_set_text(s_format_warning, "Binary logs don't show in History; "
+                                        "read them on a PC with tools/ftlog_decode");
+    lv_obj_set_style_text_color(s_format_warning, UI_COLOR_LOG_WARN, 0);
+    lv_obj_set_style_text_font(s_format_warning, &lv_font_montserrat_14, 0);
+    update_format_label();
+
     /* Placeholder note */
     lv_obj_t *note = lv_label_create(content);
     lv_label_set_text(note, "Settings persistence will be added in Phase 6.");
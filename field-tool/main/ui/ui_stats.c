@@ -0,0 +1,358 @@
+#include "ui_stats.h"
+#include "ui_manager.h"
+#include "ui_styles.h"
+#include "serial/log_stats.h"
+#include "serial/tag_table.h"
+#include "app_config.h"
+#include "esp_log.h"
+
+#include <stdio.h>
+
+static const char *TAG = "UI_STATS";
+
+/* ── UI state ────────────────────────────────────────────────────────── */
+
+typedef enum {
+    CARD_LINES = 0,
+    CARD_BYTES,
+    CARD_ERRORS,
+    CARD_COUNT,
+} card_id_t;
+
+typedef struct {
+    lv_obj_t *value;            /* Current rate, large */
+    lv_obj_t *detail;           /* Longer windows and peak */
+    lv_obj_t *chart;            /* Sparkline of the last FT_LOG_STATS_SECONDS */
+    lv_chart_series_t *series;
+} stat_card_t;
+
+static stat_card_t s_cards[CARD_COUNT];
+static lv_obj_t *tag_table = NULL;
+static lv_obj_t *status_label = NULL;
+
+#define REFRESH_MS  (1000)
+#define TOP_TAGS    (10)
+#define CARD_W      (324)
+#define CARD_H      (176)
+
+enum {
+    COL_TAG = 0,
+    COL_LINES,
+    COL_RATE,
+    COL_PEAK,
+    COL_SHARE,
+    COL_TOTAL,
+};
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+/* Milliseconds as "850 ms", "12.4 s" or "3 min 20 s" */
+static void format_ms(char *out, size_t len, uint32_t ms)
+{
+    if (ms < 1000) {
+        snprintf(out, len, "%lu ms", (unsigned long)ms);
+    } else if (ms < 60000) {
+        snprintf(out, len, "%lu.%lu s", (unsigned long)(ms / 1000),
+                 (unsigned long)(ms % 1000 / 100));
+    } else {
+        snprintf(out, len, "%lu min %lu s", (unsigned long)(ms / 60000),
+                 (unsigned long)(ms % 60000 / 1000));
+    }
+}
+
+/* Counts as "950", "12.3k" or "4.56M" */
+static void format_count(char *out, size_t len, uint64_t n)
+{
+    if (n < 10000) {
+        snprintf(out, len, "%lu", (unsigned long)n);
+    } else if (n < 10000000) {
+        snprintf(out, len, "%lu.%luk", (unsigned long)(n / 1000),
+                 (unsigned long)(n % 1000 / 100));
+    } else {
+        snprintf(out, len, "%lu.%02luM", (unsigned long)(n / 1000000),
+                 (unsigned long)(n % 1000000 / 10000));
+    }
+}
+
+/* Load a sparkline, scaling it to its own peak */
+static void set_sparkline(stat_card_t *card, const uint32_t *values, uint32_t count)
+{
+    uint32_t max = 1;
+    for (uint32_t i = 0; i < count; i++) {
+        if (values[i] > max) {
+            max = values[i];
+        }
+    }
+    lv_chart_set_range(card->chart, LV_CHART_AXIS_PRIMARY_Y, 0, (int32_t)(max + max / 8));
+    for (uint32_t i = 0; i < count; i++) {
+        lv_chart_set_value_by_id(card->chart, card->series, i, (int32_t)values[i]);
+    }
+    lv_chart_refresh(card->chart);
+}
+
+/* ── Refresh timer ───────────────────────────────────────────────────── */
+
+static void refresh_stats(void)
+{
+    log_stats_t st;
+    log_stats_get(&st);
+
+    /* Rate cards: the last second large, the longer windows below */
+    lv_label_set_text_fmt(s_cards[CARD_LINES].value, "%lu.%lu /s",
+                          (unsigned long)(st.lines_rate_x10[0] / 10),
+                          (unsigned long)(st.lines_rate_x10[0] % 10));
+    lv_label_set_text_fmt(s_cards[CARD_LINES].detail, "10 s %lu.%lu  60 s %lu.%lu  peak %lu",
+                          (unsigned long)(st.lines_rate_x10[1] / 10),
+                          (unsigned long)(st.lines_rate_x10[1] % 10),
+                          (unsigned long)(st.lines_rate_x10[2] / 10),
+                          (unsigned long)(st.lines_rate_x10[2] % 10),
+                          (unsigned long)st.peak_lines_per_s);
+
+    lv_label_set_text_fmt(s_cards[CARD_BYTES].value, "%lu.%lu KB/s",
+                          (unsigned long)(st.bytes_rate[0] / 1024),
+                          (unsigned long)(st.bytes_rate[0] % 1024 * 10 / 1024));
+    char total[16];
+    format_count(total, sizeof(total), st.bytes);
+    lv_label_set_text_fmt(s_cards[CARD_BYTES].detail, "10 s %lu  60 s %lu B/s  total %sB",
+                          (unsigned long)st.bytes_rate[1], (unsigned long)st.bytes_rate[2],
+                          total);
+
+    uint32_t lines[FT_LOG_STATS_SECONDS];
+    uint32_t bytes[FT_LOG_STATS_SECONDS];
+    uint32_t errors[FT_LOG_STATS_SECONDS];
+    uint32_t n = log_stats_history(lines, bytes, errors, FT_LOG_STATS_SECONDS);
+    uint32_t errors_60s = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        errors_60s += errors[i];
+    }
+    lv_label_set_text_fmt(s_cards[CARD_ERRORS].value, "%lu /s",
+                          (unsigned long)(n > 0 ? errors[n - 1] : 0));
+    lv_label_set_text_fmt(s_cards[CARD_ERRORS].detail, "60 s %lu  total E %lu W %lu",
+                          (unsigned long)errors_60s,
+                          (unsigned long)st.level_lines[LOG_STATS_LEVEL_E],
+                          (unsigned long)st.level_lines[LOG_STATS_LEVEL_W]);
+
+    set_sparkline(&s_cards[CARD_LINES], lines, n);
+    set_sparkline(&s_cards[CARD_BYTES], bytes, n);
+    set_sparkline(&s_cards[CARD_ERRORS], errors, n);
+
+    /* Busiest tags */
+    log_stats_tag_t tags[TOP_TAGS];
+    uint32_t count = log_stats_top_tags(tags, TOP_TAGS);
+    char cell[24];
+    for (uint32_t r = 0; r < TOP_TAGS; r++) {
+        uint32_t row = r + 1;
+        if (r >= count) {
+            for (int c = 0; c < COL_TOTAL; c++) {
+                lv_table_set_cell_value(tag_table, row, c, "");
+            }
+            continue;
+        }
+        const char *name = tag_table_name(tags[r].tag_id);
+        lv_table_set_cell_value(tag_table, row, COL_TAG, name[0] != '\0' ? name : "(no tag)");
+        format_count(cell, sizeof(cell), tags[r].lines);
+        lv_table_set_cell_value(tag_table, row, COL_LINES, cell);
+        lv_table_set_cell_value_fmt(tag_table, row, COL_RATE, "%lu.%lu",
+                                    (unsigned long)(tags[r].rate_x10 / 10),
+                                    (unsigned long)(tags[r].rate_x10 % 10));
+        lv_table_set_cell_value_fmt(tag_table, row, COL_PEAK, "%lu",
+                                    (unsigned long)tags[r].peak_window);
+        lv_table_set_cell_value_fmt(tag_table, row, COL_SHARE, "%lu%%",
+                                    (unsigned long)(st.lines ? (uint64_t)tags[r].lines * 100 /
+                                                               st.lines : 0));
+    }
+
+    /* Levels and silences */
+    char gap[24];
+    char at[24];
+    char silent[24];
+    format_ms(gap, sizeof(gap), st.longest_gap_ms);
+    format_ms(at, sizeof(at), st.longest_gap_at_ms);
+    format_ms(silent, sizeof(silent), st.silent_ms);
+    lv_label_set_text_fmt(status_label,
+                          "Lines %lu: E %lu W %lu I %lu D %lu V %lu other %lu"
+                          " | Longest gap %s (ended at uptime %s) | Silent %s",
+                          (unsigned long)st.lines,
+                          (unsigned long)st.level_lines[LOG_STATS_LEVEL_E],
+                          (unsigned long)st.level_lines[LOG_STATS_LEVEL_W],
+                          (unsigned long)st.level_lines[LOG_STATS_LEVEL_I],
+                          (unsigned long)st.level_lines[LOG_STATS_LEVEL_D],
+                          (unsigned long)st.level_lines[LOG_STATS_LEVEL_V],
+                          (unsigned long)st.level_lines[LOG_STATS_LEVEL_OTHER],
+                          gap, at, silent);
+    lv_obj_set_style_text_color(status_label, st.silent_ms > st.longest_gap_ms && st.lines > 0 ?
+                                UI_COLOR_LOG_WARN : UI_COLOR_TEXT_DIM, 0);
+}
+
+static void refresh_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    if (tag_table == NULL || ui_manager_get_current_screen() != UI_SCREEN_STATS) {
+        return;
+    }
+    refresh_stats();
+}
+
+/* ── Button handlers ─────────────────────────────────────────────────── */
+
+static void on_back_clicked(lv_event_t *e)
+{
+    (void)e;
+    ui_manager_show_screen(UI_SCREEN_SERIAL_MONITOR);
+}
+
+static void on_charts_clicked(lv_event_t *e)
+{
+    (void)e;
+    ui_manager_show_screen(UI_SCREEN_CHART);
+}
+
+static void on_reset_clicked(lv_event_t *e)
+{
+    (void)e;
+    log_stats_reset();
+    refresh_stats();
+    ESP_LOGI(TAG, "Statistics cleared");
+}
+
+static lv_obj_t *create_header_button(lv_obj_t *parent, const char *text, lv_coord_t w,
+                                      lv_color_t color, lv_event_cb_t cb)
+{
+    lv_obj_t *btn = lv_btn_create(parent);
+    lv_obj_set_size(btn, w, 36);
+    lv_obj_set_style_bg_color(btn, color, 0);
+    lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl = lv_label_create(btn);
+    lv_label_set_text(lbl, text);
+    lv_obj_center(lbl);
+    return lbl;
+}
+
+/* One rate card: title, current value, longer windows, sparkline */
+static void create_card(lv_obj_t *parent, stat_card_t *card, const char *title,
+                        lv_color_t color)
+{
+    lv_obj_t *panel = lv_obj_create(parent);
+    lv_obj_set_size(panel, CARD_W, CARD_H);
+    lv_obj_set_style_bg_color(panel, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_border_width(panel, 0, 0);
+    lv_obj_set_style_pad_all(panel, UI_PAD_SMALL, 0);
+    lv_obj_set_style_pad_row(panel, 2, 0);
+    lv_obj_set_flex_flow(panel, LV_FLEX_FLOW_COLUMN);
+    lv_obj_remove_flag(panel, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t *lbl = lv_label_create(panel);
+    lv_label_set_text(lbl, title);
+    lv_obj_set_style_text_font(lbl, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(lbl, UI_COLOR_TEXT_DIM, 0);
+
+    card->value = lv_label_create(panel);
+    lv_label_set_text(card->value, "-");
+    lv_obj_set_style_text_font(card->value, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_color(card->value, UI_COLOR_TEXT, 0);
+
+    card->detail = lv_label_create(panel);
+    lv_label_set_text(card->detail, "");
+    lv_obj_set_style_text_font(card->detail, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_color(card->detail, UI_COLOR_TEXT_DIM, 0);
+
+    /* Bare line chart: no points, grid or axes */
+    card->chart = lv_chart_create(panel);
+    lv_obj_set_size(card->chart, CARD_W - 2 * UI_PAD_SMALL, 70);
+    lv_chart_set_type(card->chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_point_count(card->chart, FT_LOG_STATS_SECONDS);
+    lv_chart_set_div_line_count(card->chart, 0, 0);
+    lv_obj_set_style_bg_opa(card->chart, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(card->chart, 0, 0);
+    lv_obj_set_style_pad_all(card->chart, 0, 0);
+    lv_obj_set_style_line_width(card->chart, 2, LV_PART_ITEMS);
+    lv_obj_set_style_size(card->chart, 0, 0, LV_PART_INDICATOR);
+    card->series = lv_chart_add_series(card->chart, color, LV_CHART_AXIS_PRIMARY_Y);
+}
+
+/* ── Screen creation ─────────────────────────────────────────────────── */
+
+lv_obj_t *ui_stats_create(void)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(scr, UI_COLOR_BG, 0);
+
+    /* ── Header bar ──────────────────────────────────────────────────── */
+    lv_obj_t *header = lv_obj_create(scr);
+    lv_obj_set_size(header, lv_pct(100), UI_TAB_BAR_H);
+    lv_obj_align(header, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_style_bg_color(header, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(header, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(header, 0, 0);
+    lv_obj_set_style_radius(header, 0, 0);
+    lv_obj_set_style_pad_hor(header, UI_PAD_MEDIUM, 0);
+    lv_obj_set_flex_flow(header, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(header, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_column(header, UI_PAD_SMALL, 0);
+
+    create_header_button(header, "< Back", 80, UI_COLOR_ACCENT, on_back_clicked);
+
+    lv_obj_t *title = lv_label_create(header);
+    lv_label_set_text(title, "Log Statistics");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_color(title, UI_COLOR_TEXT, 0);
+    lv_obj_set_flex_grow(title, 1);
+
+    create_header_button(header, "Charts", 90, UI_COLOR_ACCENT, on_charts_clicked);
+    create_header_button(header, "Reset", 80, UI_COLOR_HIGHLIGHT, on_reset_clicked);
+
+    /* ── Rate cards with sparklines ──────────────────────────────────── */
+    lv_obj_t *cards = lv_obj_create(scr);
+    lv_obj_set_size(cards, 1024, CARD_H + 2 * UI_PAD_SMALL);
+    lv_obj_align(cards, LV_ALIGN_TOP_MID, 0, UI_TAB_BAR_H);
+    lv_obj_set_style_bg_opa(cards, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(cards, 0, 0);
+    lv_obj_set_style_pad_all(cards, UI_PAD_SMALL, 0);
+    lv_obj_set_flex_flow(cards, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(cards, LV_FLEX_ALIGN_SPACE_EVENLY, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_remove_flag(cards, LV_OBJ_FLAG_SCROLLABLE);
+
+    create_card(cards, &s_cards[CARD_LINES], "Lines", UI_COLOR_LOG_INFO);
+    create_card(cards, &s_cards[CARD_BYTES], "Throughput", UI_COLOR_TILE_SERIAL);
+    create_card(cards, &s_cards[CARD_ERRORS], "Errors + warnings", UI_COLOR_LOG_ERROR);
+
+    /* ── Busiest tags ────────────────────────────────────────────────── */
+    static const char *const headings[COL_TOTAL] = {
+        "Tag", "Lines", "Per s (10 s)", "Peak / 10 s", "Share",
+    };
+    static const lv_coord_t widths[COL_TOTAL] = { 320, 160, 180, 180, 150 };
+
+    int32_t table_y = UI_TAB_BAR_H + CARD_H + 2 * UI_PAD_SMALL;
+    tag_table = lv_table_create(scr);
+    lv_table_set_column_count(tag_table, COL_TOTAL);
+    lv_table_set_row_count(tag_table, TOP_TAGS + 1);
+    for (int c = 0; c < COL_TOTAL; c++) {
+        lv_table_set_column_width(tag_table, c, widths[c]);
+        lv_table_set_cell_value(tag_table, 0, c, headings[c]);
+    }
+    lv_obj_set_size(tag_table, 1000, 600 - table_y - 28 - UI_PAD_SMALL);
+    lv_obj_align(tag_table, LV_ALIGN_TOP_MID, 0, table_y);
+    lv_obj_set_style_bg_color(tag_table, UI_COLOR_PANEL, LV_PART_ITEMS);
+    lv_obj_set_style_text_color(tag_table, UI_COLOR_TEXT, LV_PART_ITEMS);
+    lv_obj_set_style_text_font(tag_table, &lv_font_montserrat_14, LV_PART_ITEMS);
+    lv_obj_set_style_pad_ver(tag_table, 4, LV_PART_ITEMS);
+    lv_obj_set_style_bg_color(tag_table, UI_COLOR_BG, 0);
+    lv_obj_set_style_border_width(tag_table, 0, 0);
+
+    /* ── Status bar (bottom): levels and gaps ────────────────────────── */
+    status_label = lv_label_create(scr);
+    lv_label_set_text(status_label, "");
+    lv_obj_set_style_text_font(status_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(status_label, UI_COLOR_TEXT_DIM, 0);
+    lv_obj_set_size(status_label, 1024, 28);
+    lv_obj_set_style_pad_hor(status_label, UI_PAD_MEDIUM, 0);
+    lv_obj_set_style_pad_ver(status_label, 4, 0);
+    lv_obj_align(status_label, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_obj_set_style_bg_color(status_label, UI_COLOR_PANEL, 0);
+    lv_obj_set_style_bg_opa(status_label, LV_OPA_COVER, 0);
+
+    refresh_stats();
+    lv_timer_create(refresh_timer_cb, REFRESH_MS, NULL);
+
+    return scr;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "lvgl.h"
+
+/**
+ * @brief Create the log statistics screen (rates, sparklines, busiest tags)
+ * @return Pointer to the screen object
+ */
+lv_obj_t *ui_stats_create(void);
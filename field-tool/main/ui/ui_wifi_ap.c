@@ -3,6 +3,8 @@
 #include "ui_styles.h"
 #include "wifi/wifi_manager.h"
 #include "wifi/firmware_download.h"
+#include "wifi/log_server.h"
+#include "wifi/serial_bridge.h"
 #include "flasher/flasher_manager.h"
 #include "app_config.h"
 #include "esp_log.h"
@@ -95,9 +97,17 @@ static void refresh_timer_cb(lv_timer_t *timer)
     /* --- SoftAP status --- */
     if (ap_status_lbl) {
         if (ws->ap_active) {
+            log_server_stats_t ls;
+            log_server_get_stats(&ls);
+            serial_bridge_status_t bs;
+            serial_bridge_get_status(&bs);
+            const char *ip = ws->ap_ip[0] ? ws->ap_ip : "192.168.4.1";
             lv_label_set_text_fmt(ap_status_lbl,
-                "AP: Active  SSID: %s  Clients: %d",
-                FT_WIFI_AP_SSID, ws->ap_connected_count);
+                "AP: Active  SSID: %s  Clients: %d\nLog: http://%s/  Viewers: %lu\n"
+                "Serial: rfc2217://%s:%d  %s%s",
+                FT_WIFI_AP_SSID, ws->ap_connected_count, ip, (unsigned long)ls.clients,
+                ip, FT_BRIDGE_RFC2217_PORT, bs.connected ? "In use by " : "Idle",
+                bs.connected ? bs.peer : "");
             lv_obj_set_style_text_color(ap_status_lbl, UI_COLOR_SUCCESS, 0);
         } else {
             lv_label_set_text(ap_status_lbl, "AP: Stopped");
@@ -0,0 +1,425 @@
+#include "log_server.h"
+#include "serial/serial_monitor.h"
+#include "serial/log_ring.h"
+#include "serial/log_filter.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "LOG_SRV";
+
+#define SEND_TIMEOUT_S  (2)     /* A stalled client's send gives up after this */
+#define STOP_WAIT_MS    (3000)  /* For client tasks to notice the stop */
+
+typedef struct {
+    bool              used;
+    bool              websocket;
+    bool              closed;       /* Server closed the session; the task closes the socket */
+    int               fd;
+    httpd_req_t      *req;          /* Chunked: the request handed over by the server */
+    char             *frame;        /* FT_LOG_SERVER_FRAME_SIZE, PSRAM, kept for the next client */
+    log_ring_cursor_t cursor;
+    uint32_t          skipped;      /* Lines skipped since the last "skipped" line sent */
+} client_t;
+
+static httpd_handle_t s_server = NULL;
+static SemaphoreHandle_t s_mutex = NULL;       /* Client table and stats */
+static client_t s_clients[FT_LOG_SERVER_MAX_CLIENTS];
+static volatile bool s_stopping = false;
+static log_server_stats_t s_stats;
+
+static const char INDEX_HTML[] =
+    "<!DOCTYPE html><html><head><meta charset=\"utf-8\">"
+    "<meta name=\"viewport\" content=\"width=device-width\"><title>" FT_WIFI_AP_SSID " log</title>"
+    "<style>body{margin:0;background:#111;color:#ddd;font:13px monospace}"
+    "pre{margin:0;padding:8px;white-space:pre-wrap;word-break:break-all}"
+    "#s{position:fixed;top:0;right:0;padding:2px 8px;background:#333}</style></head>"
+    "<body><div id=\"s\">connecting</div><pre id=\"log\"></pre><script>"
+    "const log=document.getElementById('log'),st=document.getElementById('s'),"
+    "dec=new TextDecoder();"
+    "function connect(){const ws=new WebSocket('ws://'+location.host+'/ws');"
+    "ws.binaryType='arraybuffer';ws.onopen=()=>st.textContent='live';"
+    "ws.onmessage=e=>{const end=innerHeight+scrollY>=document.body.scrollHeight-8;"
+    "log.append(dec.decode(e.data,{stream:true}));"
+    "while(log.childNodes.length>2000)log.firstChild.remove();"
+    "if(end)scrollTo(0,document.body.scrollHeight);};"
+    "ws.onclose=()=>{st.textContent='reconnecting';setTimeout(connect,1000);};}"
+    "connect();</script></body></html>";
+
+/* ── Client streaming ────────────────────────────────────────────────── */
+
+/* Batch everything the client hasn't seen (up to a frame) into its buffer */
+static size_t fill_frame(client_t *c, const log_ring_t *ring)
+{
+    /* Too far behind to catch up: jump to the newest lines */
+    uint32_t next = log_ring_next_seq(ring);
+    if (next - c->cursor.seq > FT_LOG_SERVER_MAX_LAG_LINES) {
+        c->skipped += next - FT_LOG_SERVER_BACKLOG_LINES - c->cursor.seq;
+        c->cursor.seq = next - FT_LOG_SERVER_BACKLOG_LINES;
+    }
+
+    size_t used = 0;
+    while (used + FT_LOG_LINE_MAX_LEN + 1 <= FT_LOG_SERVER_FRAME_SIZE) {
+        /* Lapped by the ring: say so before the first line after the gap */
+        uint32_t first = log_ring_first_seq(ring);
+        if ((int32_t)(c->cursor.seq - first) < 0) {
+            c->skipped += first - c->cursor.seq;
+            c->cursor.seq = first;
+        }
+        if (c->skipped > 0) {
+            used += snprintf(c->frame + used, FT_LOG_SERVER_FRAME_SIZE - used,
+                             "--- %lu lines skipped (client too slow) ---\n",
+                             (unsigned long)c->skipped);
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            s_stats.lines_skipped += c->skipped;
+            xSemaphoreGive(s_mutex);
+            c->skipped = 0;
+            continue;
+        }
+
+        /* Lines in the ring only for the display aren't copied at all */
+        uint8_t sinks;
+        log_ring_read_t r = log_ring_peek_sinks(ring, c->cursor.seq, &sinks);
+        if (r == LOG_RING_READ_PENDING) {
+            break;
+        }
+        if (r == LOG_RING_READ_OK && !(sinks & LOG_SINK_BIT(LOG_SINK_NETWORK))) {
+            c->cursor.seq++;
+            continue;
+        }
+
+        /* Read straight into the frame */
+        log_span_t span;
+        uint32_t lost = c->cursor.lost;
+        if (!log_ring_cursor_next(ring, &c->cursor, c->frame + used, FT_LOG_LINE_MAX_LEN, &span)) {
+            break;
+        }
+        c->skipped += c->cursor.lost - lost;
+        if (!(span.sinks & LOG_SINK_BIT(LOG_SINK_NETWORK))) {
+            continue;
+        }
+        used += span.raw_len;
+        c->frame[used++] = '\n';
+    }
+    return used;
+}
+
+static esp_err_t send_frame(client_t *c, size_t len)
+{
+    if (c->websocket) {
+        /* Binary: the target's bytes aren't guaranteed to be UTF-8 */
+        httpd_ws_frame_t frame = {
+            .final = true,
+            .type = HTTPD_WS_TYPE_BINARY,
+            .payload = (uint8_t *)c->frame,
+            .len = len,
+        };
+        return httpd_ws_send_frame_async(s_server, c->fd, &frame);
+    }
+    return httpd_resp_send_chunk(c->req, c->frame, len);
+}
+
+static void client_task(void *arg)
+{
+    client_t *c = (client_t *)arg;
+    const log_ring_t *ring = serial_monitor_get_ring();
+
+    /* Start a little way back so the client has context */
+    uint32_t next = log_ring_next_seq(ring);
+    uint32_t held = log_ring_count(ring);
+    c->cursor.seq = next - (held < FT_LOG_SERVER_BACKLOG_LINES ? held : FT_LOG_SERVER_BACKLOG_LINES);
+    c->cursor.lost = 0;
+    c->skipped = 0;
+
+    esp_err_t err = ESP_OK;
+    while (!s_stopping && !c->closed) {
+        size_t used = fill_frame(c, ring);
+        if (used > 0) {
+            err = send_frame(c, used);
+            if (err != ESP_OK) {
+                break;
+            }
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            s_stats.bytes_sent += used;
+            s_stats.frames_sent++;
+            xSemaphoreGive(s_mutex);
+        }
+        /* A full frame means more is waiting; otherwise let lines gather */
+        if (used + FT_LOG_LINE_MAX_LEN + 1 <= FT_LOG_SERVER_FRAME_SIZE) {
+            vTaskDelay(pdMS_TO_TICKS(FT_LOG_SERVER_POLL_MS));
+        }
+    }
+
+    if (c->websocket) {
+        if (!c->closed) {
+            httpd_sess_trigger_close(s_server, c->fd);
+        }
+    } else {
+        if (err == ESP_OK && !c->closed) {
+            httpd_resp_send_chunk(c->req, NULL, 0);     /* Stopping: end the response cleanly */
+        } else {
+            httpd_sess_trigger_close(s_server, c->fd);
+        }
+        httpd_req_async_handler_complete(c->req);
+    }
+    ESP_LOGI(TAG, "Client on socket %d gone (%s)", c->fd, esp_err_to_name(err));
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool closed = c->closed;
+    c->used = false;
+    xSemaphoreGive(s_mutex);
+    if (closed) {
+        close(c->fd);
+    }
+    vTaskDelete(NULL);
+}
+
+/* Take a free client slot, or NULL if all are streaming */
+static client_t *claim_client(int fd, bool websocket)
+{
+    client_t *c = NULL;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < FT_LOG_SERVER_MAX_CLIENTS; i++) {
+        if (!s_clients[i].used) {
+            c = &s_clients[i];
+            break;
+        }
+    }
+    if (c != NULL && c->frame == NULL) {
+        c->frame = heap_caps_malloc(FT_LOG_SERVER_FRAME_SIZE, MALLOC_CAP_SPIRAM);
+        if (c->frame == NULL) {
+            c = NULL;
+        }
+    }
+    if (c != NULL) {
+        c->used = true;
+        c->websocket = websocket;
+        c->closed = false;
+        c->fd = fd;
+        c->req = NULL;
+    } else {
+        s_stats.rejected++;
+    }
+    xSemaphoreGive(s_mutex);
+    return c;
+}
+
+static esp_err_t start_client(client_t *c)
+{
+    char name[16];
+    snprintf(name, sizeof(name), "log_srv%d", (int)(c - s_clients));
+    if (xTaskCreate(client_task, name, 4096, c, 3, NULL) != pdPASS) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        c->used = false;
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "%s client on socket %d", c->websocket ? "WebSocket" : "HTTP", c->fd);
+    return ESP_OK;
+}
+
+/* ── HTTP handlers ───────────────────────────────────────────────────── */
+
+static esp_err_t index_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_send(req, INDEX_HTML, sizeof(INDEX_HTML) - 1);
+}
+
+static esp_err_t ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        /* Handshake done: the socket is the client task's to send on */
+        client_t *c = claim_client(httpd_req_to_sockfd(req), true);
+        if (c == NULL) {
+            ESP_LOGW(TAG, "WebSocket client turned away, %d already streaming",
+                     FT_LOG_SERVER_MAX_CLIENTS);
+            return ESP_FAIL;
+        }
+        return start_client(c);
+    }
+
+    /* Nothing is expected from the page; drain small frames, drop big ones */
+    uint8_t buf[64];
+    httpd_ws_frame_t frame = { .payload = buf };
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);
+    if (err != ESP_OK || frame.len > sizeof(buf)) {
+        return ESP_FAIL;
+    }
+    return httpd_ws_recv_frame(req, &frame, sizeof(buf));
+}
+
+static esp_err_t log_handler(httpd_req_t *req)
+{
+    client_t *c = claim_client(httpd_req_to_sockfd(req), false);
+    if (c == NULL) {
+        httpd_resp_set_status(req, HTTPD_503);
+        httpd_resp_set_type(req, "text/plain");
+        return httpd_resp_send(req, "All log streams in use\n", HTTPD_RESP_USE_STRLEN);
+    }
+    httpd_resp_set_type(req, "text/plain; charset=utf-8");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    /* The response outlives this handler: hand it to the client task */
+    httpd_req_t *async = NULL;
+    esp_err_t err = httpd_req_async_handler_begin(req, &async);
+    if (err != ESP_OK) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        c->used = false;
+        xSemaphoreGive(s_mutex);
+        return err;
+    }
+    c->req = async;
+    err = start_client(c);
+    if (err != ESP_OK) {
+        httpd_req_async_handler_complete(async);
+    }
+    return err;
+}
+
+/* ── Sessions ────────────────────────────────────────────────────────── */
+
+static esp_err_t on_open(httpd_handle_t hd, int fd)
+{
+    (void)hd;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));    /* Frames are batched already */
+    return ESP_OK;
+}
+
+/* A streaming client's socket stays open until its task is done with it,
+ * so the number can't be reused by a new session under the task */
+static void on_close(httpd_handle_t hd, int fd)
+{
+    (void)hd;
+    bool deferred = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < FT_LOG_SERVER_MAX_CLIENTS; i++) {
+        if (s_clients[i].used && s_clients[i].fd == fd) {
+            s_clients[i].closed = true;
+            deferred = true;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    if (!deferred) {
+        close(fd);
+    }
+}
+
+static void set_network_sink(bool enabled)
+{
+    log_filter_rules_t rules;
+    log_filter_get_rules(LOG_SINK_NETWORK, &rules);
+    rules.enabled = enabled;
+    esp_err_t err = log_filter_set_rules(LOG_SINK_NETWORK, &rules);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Network sink not %s: %s", enabled ? "enabled" : "disabled",
+                 esp_err_to_name(err));
+    }
+}
+
+static uint32_t client_count(void)
+{
+    uint32_t n = 0;
+    for (int i = 0; i < FT_LOG_SERVER_MAX_CLIENTS; i++) {
+        n += s_clients[i].used;
+    }
+    return n;
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+esp_err_t log_server_start(void)
+{
+    if (s_server != NULL) {
+        return ESP_OK;
+    }
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = FT_LOG_SERVER_PORT;
+    config.max_open_sockets = FT_LOG_SERVER_MAX_CLIENTS + 2;   /* Plus page loads */
+    config.send_wait_timeout = SEND_TIMEOUT_S;
+    config.open_fn = on_open;
+    config.close_fn = on_close;
+    s_stopping = false;
+    esp_err_t err = httpd_start(&s_server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "HTTP server start failed: %s", esp_err_to_name(err));
+        s_server = NULL;
+        return err;
+    }
+
+    static const httpd_uri_t uris[] = {
+        { .uri = "/",    .method = HTTP_GET, .handler = index_handler },
+        { .uri = "/ws",  .method = HTTP_GET, .handler = ws_handler, .is_websocket = true },
+        { .uri = "/log", .method = HTTP_GET, .handler = log_handler },
+    };
+    for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        httpd_register_uri_handler(s_server, &uris[i]);
+    }
+
+    set_network_sink(true);
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_stats.running = true;
+    xSemaphoreGive(s_mutex);
+    ESP_LOGI(TAG, "Serving the log on port %d (/, /ws, /log)", FT_LOG_SERVER_PORT);
+    return ESP_OK;
+}
+
+void log_server_stop(void)
+{
+    if (s_server == NULL) {
+        return;
+    }
+    set_network_sink(false);
+
+    /* Client tasks notice within a poll, or a send timeout if stalled */
+    s_stopping = true;
+    uint32_t waited = 0;
+    uint32_t left;
+    do {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        left = client_count();
+        xSemaphoreGive(s_mutex);
+        if (left > 0) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            waited += 10;
+        }
+    } while (left > 0 && waited < STOP_WAIT_MS);
+    if (left > 0) {
+        ESP_LOGW(TAG, "%lu clients still sending at stop", (unsigned long)left);
+    }
+
+    httpd_stop(s_server);
+    s_server = NULL;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_stats.running = false;
+    xSemaphoreGive(s_mutex);
+    ESP_LOGI(TAG, "Stopped");
+}
+
+void log_server_get_stats(log_server_stats_t *stats)
+{
+    if (s_mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    stats->clients = client_count();
+    xSemaphoreGive(s_mutex);
+}
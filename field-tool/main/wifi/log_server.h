@@ -0,0 +1,47 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Live log streaming over HTTP.
+ *
+ * While running, the server enables LOG_SINK_NETWORK and serves the lines
+ * routed to it straight from the log ring:
+ *
+ *     /        a small page that tails the log over the WebSocket
+ *     /ws      WebSocket, one binary frame per batch of lines
+ *     /log     chunked text/plain for clients without WebSocket
+ *              (curl -N http://192.168.4.1/log)
+ *
+ * Each client gets its own task and ring cursor, starting
+ * FT_LOG_SERVER_BACKLOG_LINES back. A client batches whatever has arrived
+ * since its last send into one frame of up to FT_LOG_SERVER_FRAME_SIZE,
+ * so a busy target costs a frame per batch, not per line. A slow client
+ * only holds up its own task: the ring never waits for readers, and a
+ * client that falls more than FT_LOG_SERVER_MAX_LAG_LINES behind (or is
+ * lapped by the ring) skips ahead and is sent a line saying how many
+ * lines it missed.
+ */
+
+typedef struct {
+    bool     running;
+    uint32_t clients;           /* Connected streaming clients */
+    uint32_t rejected;          /* Turned away, all FT_LOG_SERVER_MAX_CLIENTS in use */
+    uint64_t bytes_sent;
+    uint32_t frames_sent;
+    uint32_t lines_skipped;     /* Dropped for clients that fell behind */
+} log_server_stats_t;
+
+/**
+ * @brief Start the HTTP server and enable the network sink (no-op if running)
+ */
+esp_err_t log_server_start(void);
+
+/**
+ * @brief Disconnect every client, stop the server and disable the network sink
+ */
+void log_server_stop(void);
+
+void log_server_get_stats(log_server_stats_t *stats);
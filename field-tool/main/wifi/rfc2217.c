@@ -0,0 +1,408 @@
+#include "rfc2217.h"
+
+#include <string.h>
+
+/* Telnet (RFC 854) */
+#define IAC     (255)
+#define DONT    (254)
+#define DO      (253)
+#define WONT    (252)
+#define WILL    (251)
+#define SB      (250)
+#define SE      (240)
+
+#define OPT_BINARY      (0)
+#define OPT_ECHO        (1)
+#define OPT_SGA         (3)
+#define OPT_COM_PORT    (44)
+
+/* Com-port commands from the client; the server answers with +100 */
+enum {
+    CPC_SIGNATURE = 0,
+    CPC_SET_BAUDRATE,
+    CPC_SET_DATASIZE,
+    CPC_SET_PARITY,
+    CPC_SET_STOPSIZE,
+    CPC_SET_CONTROL,
+    CPC_NOTIFY_LINESTATE,
+    CPC_NOTIFY_MODEMSTATE,
+    CPC_FLOWCONTROL_SUSPEND,
+    CPC_FLOWCONTROL_RESUME,
+    CPC_SET_LINESTATE_MASK,
+    CPC_SET_MODEMSTATE_MASK,
+    CPC_PURGE_DATA,
+};
+#define CPC_SERVER(cmd)     ((uint8_t)((cmd) + 100))
+
+/* SET-CONTROL values */
+enum {
+    CTL_FLOW_REQUEST = 0,
+    CTL_FLOW_NONE,
+    CTL_FLOW_XONXOFF,
+    CTL_FLOW_HARDWARE,
+    CTL_BREAK_REQUEST,
+    CTL_BREAK_ON,
+    CTL_BREAK_OFF,
+    CTL_DTR_REQUEST,
+    CTL_DTR_ON,
+    CTL_DTR_OFF,
+    CTL_RTS_REQUEST,
+    CTL_RTS_ON,
+    CTL_RTS_OFF,
+    CTL_INBOUND_FLOW_REQUEST,
+    CTL_INBOUND_FLOW_NONE,
+};
+
+#define SIGNATURE   "ESP32-P4 field tool"
+
+enum {
+    ST_DATA = 0,
+    ST_IAC,
+    ST_OPT,         /* Option byte after WILL/WONT/DO/DONT */
+    ST_SB_OPT,      /* Option byte after SB */
+    ST_SB,          /* Subnegotiation bytes */
+    ST_SB_IAC,      /* IAC inside a subnegotiation */
+    ST_SB_SKIP,     /* Subnegotiation of an option we don't serve */
+    ST_SB_SKIP_IAC,
+};
+
+/* ── Replies ─────────────────────────────────────────────────────────── */
+
+static void send_option(rfc2217_t *t, uint8_t verb, uint8_t opt)
+{
+    const uint8_t msg[3] = { IAC, verb, opt };
+    t->ops.reply(msg, sizeof(msg), t->ops.ctx);
+}
+
+/* IAC SB COM-PORT-OPTION <cmd> <value, IAC doubled> IAC SE */
+static void send_com_port(rfc2217_t *t, uint8_t cmd, const uint8_t *value, size_t len)
+{
+    uint8_t msg[8 + 2 * 32];
+    size_t n = 0;
+    msg[n++] = IAC;
+    msg[n++] = SB;
+    msg[n++] = OPT_COM_PORT;
+    msg[n++] = cmd;
+    for (size_t i = 0; i < len && i < 32; i++) {
+        if (value[i] == IAC) {
+            msg[n++] = IAC;
+        }
+        msg[n++] = value[i];
+    }
+    msg[n++] = IAC;
+    msg[n++] = SE;
+    t->ops.reply(msg, n, t->ops.ctx);
+}
+
+static void send_byte(rfc2217_t *t, uint8_t cmd, uint8_t value)
+{
+    send_com_port(t, CPC_SERVER(cmd), &value, 1);
+}
+
+/* ── Negotiation ─────────────────────────────────────────────────────── */
+
+static bool we_serve(uint8_t opt)
+{
+    return opt == OPT_BINARY || opt == OPT_SGA || opt == OPT_ECHO;
+}
+
+static bool they_may(uint8_t opt)
+{
+    return opt == OPT_BINARY || opt == OPT_SGA;
+}
+
+/* Answer only changes of state, so the two sides can't loop */
+static void negotiate(rfc2217_t *t, uint8_t verb, uint8_t opt)
+{
+    uint32_t bit = opt < 32 ? 1u << opt : 0;
+    switch (verb) {
+    case WILL:
+        if (opt == OPT_COM_PORT) {
+            if (!t->com_port) {
+                t->com_port = true;
+                send_option(t, DO, opt);
+            }
+        } else if (they_may(opt)) {
+            if (!(t->they_on & bit)) {
+                t->they_on |= bit;
+                send_option(t, DO, opt);
+            }
+        } else {
+            send_option(t, DONT, opt);
+        }
+        break;
+    case WONT:
+        if (opt == OPT_COM_PORT ? t->com_port : (t->they_on & bit) != 0) {
+            t->they_on &= ~bit;
+            t->com_port = opt == OPT_COM_PORT ? false : t->com_port;
+            send_option(t, DONT, opt);
+        }
+        break;
+    case DO:
+        if (we_serve(opt)) {
+            if (!(t->we_on & bit)) {
+                t->we_on |= bit;
+                send_option(t, WILL, opt);
+            }
+        } else {
+            send_option(t, WONT, opt);
+        }
+        break;
+    case DONT:
+        if (t->we_on & bit) {
+            t->we_on &= ~bit;
+            send_option(t, WONT, opt);
+        }
+        break;
+    }
+}
+
+/* ── Com-port commands ───────────────────────────────────────────────── */
+
+static void change_line(rfc2217_t *t, const rfc2217_line_t *line)
+{
+    if (line->baud == t->line.baud && line->data_bits == t->line.data_bits &&
+        line->parity == t->line.parity && line->stop_bits == t->line.stop_bits) {
+        return;
+    }
+    if (t->ops.set_line == NULL || t->ops.set_line(line, t->ops.ctx)) {
+        t->line = *line;
+    }
+}
+
+static void set_control(rfc2217_t *t, uint8_t value)
+{
+    uint8_t reply = value;
+    bool dtr = t->dtr;
+    bool rts = t->rts;
+    switch (value) {
+    case CTL_FLOW_REQUEST:
+    case CTL_FLOW_XONXOFF:
+    case CTL_FLOW_HARDWARE:         /* No flow control lines to the target */
+        reply = CTL_FLOW_NONE;
+        break;
+    case CTL_BREAK_REQUEST:
+    case CTL_BREAK_ON:
+        reply = CTL_BREAK_OFF;
+        break;
+    case CTL_DTR_REQUEST:
+        reply = t->dtr ? CTL_DTR_ON : CTL_DTR_OFF;
+        break;
+    case CTL_DTR_ON:
+    case CTL_DTR_OFF:
+        dtr = value == CTL_DTR_ON;
+        break;
+    case CTL_RTS_REQUEST:
+        reply = t->rts ? CTL_RTS_ON : CTL_RTS_OFF;
+        break;
+    case CTL_RTS_ON:
+    case CTL_RTS_OFF:
+        rts = value == CTL_RTS_ON;
+        break;
+    case CTL_INBOUND_FLOW_REQUEST:
+        reply = CTL_INBOUND_FLOW_NONE;
+        break;
+    default:
+        break;
+    }
+    if (dtr != t->dtr || rts != t->rts) {
+        t->dtr = dtr;
+        t->rts = rts;
+        if (t->ops.set_control != NULL) {
+            t->ops.set_control(dtr, rts, t->ops.ctx);
+        }
+    }
+    send_byte(t, CPC_SET_CONTROL, reply);
+}
+
+static void com_port_command(rfc2217_t *t)
+{
+    if (t->sub_len == 0 || t->sub_overflow) {
+        return;
+    }
+    uint8_t cmd = t->sub[0];
+    const uint8_t *value = t->sub + 1;
+    size_t len = t->sub_len - 1;
+    uint8_t v = len > 0 ? value[0] : 0;
+    rfc2217_line_t line = t->line;
+
+    switch (cmd) {
+    case CPC_SIGNATURE:
+        if (len == 0) {
+            send_com_port(t, CPC_SERVER(cmd), (const uint8_t *)SIGNATURE, sizeof(SIGNATURE) - 1);
+        }
+        break;
+    case CPC_SET_BAUDRATE: {
+        if (len >= 4) {
+            uint32_t baud = (uint32_t)value[0] << 24 | (uint32_t)value[1] << 16 |
+                            (uint32_t)value[2] << 8 | value[3];
+            if (baud != 0) {    /* 0 asks for the current rate */
+                line.baud = baud;
+                change_line(t, &line);
+            }
+        }
+        const uint8_t be[4] = {
+            (uint8_t)(t->line.baud >> 24), (uint8_t)(t->line.baud >> 16),
+            (uint8_t)(t->line.baud >> 8), (uint8_t)t->line.baud,
+        };
+        send_com_port(t, CPC_SERVER(cmd), be, sizeof(be));
+        break;
+    }
+    case CPC_SET_DATASIZE:
+        if (v >= 5 && v <= 8) {
+            line.data_bits = v;
+            change_line(t, &line);
+        }
+        send_byte(t, cmd, t->line.data_bits);
+        break;
+    case CPC_SET_PARITY:
+        if (v >= RFC2217_PARITY_NONE && v <= RFC2217_PARITY_SPACE) {
+            line.parity = v;
+            change_line(t, &line);
+        }
+        send_byte(t, cmd, t->line.parity);
+        break;
+    case CPC_SET_STOPSIZE:
+        if (v >= RFC2217_STOP_1 && v <= RFC2217_STOP_1_5) {
+            line.stop_bits = v;
+            change_line(t, &line);
+        }
+        send_byte(t, cmd, t->line.stop_bits);
+        break;
+    case CPC_SET_CONTROL:
+        set_control(t, v);
+        break;
+    case CPC_NOTIFY_LINESTATE:
+    case CPC_NOTIFY_MODEMSTATE:     /* Polls: no errors, no modem lines from the CH340 */
+        send_byte(t, cmd, 0);
+        break;
+    case CPC_PURGE_DATA:
+        if (v >= RFC2217_PURGE_RX && v <= RFC2217_PURGE_BOTH && t->ops.purge != NULL) {
+            t->ops.purge(v, t->ops.ctx);
+        }
+        send_byte(t, cmd, v);
+        break;
+    case CPC_FLOWCONTROL_SUSPEND:
+    case CPC_FLOWCONTROL_RESUME:
+    case CPC_SET_LINESTATE_MASK:
+    case CPC_SET_MODEMSTATE_MASK:
+        send_com_port(t, CPC_SERVER(cmd), value, len);
+        break;
+    default:
+        break;
+    }
+}
+
+static void sub_add(rfc2217_t *t, uint8_t b)
+{
+    if (t->sub_len < sizeof(t->sub)) {
+        t->sub[t->sub_len++] = b;
+    } else {
+        t->sub_overflow = true;
+    }
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+void rfc2217_init(rfc2217_t *t, const rfc2217_ops_t *ops, const rfc2217_line_t *line)
+{
+    memset(t, 0, sizeof(*t));
+    t->ops = *ops;
+    t->line = *line;
+    t->state = ST_DATA;
+}
+
+void rfc2217_start(rfc2217_t *t)
+{
+    /* Offer binary both ways and ask for the com-port option, as if the
+     * client had asked; its own requests for the same then find them on
+     * and aren't answered twice */
+    negotiate(t, DO, OPT_BINARY);
+    negotiate(t, WILL, OPT_BINARY);
+    negotiate(t, DO, OPT_SGA);
+    negotiate(t, WILL, OPT_SGA);
+    negotiate(t, WILL, OPT_COM_PORT);
+}
+
+size_t rfc2217_decode(rfc2217_t *t, uint8_t *buf, size_t len)
+{
+    size_t w = 0;
+    for (size_t r = 0; r < len; r++) {
+        uint8_t b = buf[r];
+        switch (t->state) {
+        case ST_DATA:
+            if (b == IAC) {
+                t->state = ST_IAC;
+            } else {
+                buf[w++] = b;
+            }
+            break;
+        case ST_IAC:
+            t->state = ST_DATA;
+            if (b == IAC) {
+                buf[w++] = IAC;         /* Escaped 0xFF data byte */
+            } else if (b >= WILL) {
+                t->verb = b;
+                t->state = ST_OPT;
+            } else if (b == SB) {
+                t->state = ST_SB_OPT;
+            }
+            break;                      /* Other commands (NOP, AYT, ...) are dropped */
+        case ST_OPT:
+            negotiate(t, t->verb, b);
+            t->state = ST_DATA;
+            break;
+        case ST_SB_OPT:
+            t->sub_len = 0;
+            t->sub_overflow = false;
+            t->state = b == OPT_COM_PORT ? ST_SB : ST_SB_SKIP;
+            break;
+        case ST_SB:
+            if (b == IAC) {
+                t->state = ST_SB_IAC;
+            } else {
+                sub_add(t, b);
+            }
+            break;
+        case ST_SB_IAC:
+            if (b == IAC) {
+                sub_add(t, IAC);
+                t->state = ST_SB;
+            } else {
+                if (b == SE) {
+                    com_port_command(t);
+                }
+                t->state = ST_DATA;
+            }
+            break;
+        case ST_SB_SKIP:
+            if (b == IAC) {
+                t->state = ST_SB_SKIP_IAC;
+            }
+            break;
+        case ST_SB_SKIP_IAC:
+            t->state = b == IAC ? ST_SB_SKIP : ST_DATA;
+            break;
+        }
+    }
+    return w;
+}
+
+size_t rfc2217_escape(const uint8_t *in, size_t len, uint8_t *out, size_t out_size,
+                      size_t *consumed)
+{
+    size_t r = 0;
+    size_t w = 0;
+    while (r < len) {
+        size_t need = in[r] == IAC ? 2 : 1;
+        if (w + need > out_size) {
+            break;
+        }
+        if (in[r] == IAC) {
+            out[w++] = IAC;
+        }
+        out[w++] = in[r++];
+    }
+    *consumed = r;
+    return w;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * RFC 2217 (Telnet Com Port Control) server side, transport-free.
+ *
+ * Bytes from the client go through rfc2217_decode(), which strips the
+ * Telnet commands out in place and leaves the serial data. Option
+ * negotiation and com-port subnegotiations are answered through the
+ * reply callback, and port changes are reported through the line and
+ * control callbacks. Bytes for the client go through rfc2217_escape()
+ * (IAC doubled). Nothing here touches a socket or the USB device, so the
+ * codec runs the same against a loopback stand-in on the host.
+ *
+ * Supported: BINARY, SGA and COM-PORT-OPTION negotiation; SIGNATURE,
+ * SET-BAUDRATE, SET-DATASIZE, SET-PARITY, SET-STOPSIZE, SET-CONTROL
+ * (DTR, RTS; flow control and BREAK are acknowledged as "none"/"off"),
+ * PURGE-DATA, the state masks and modem-state polls. That is what
+ * pyserial's rfc2217:// client (esptool, idf.py monitor) uses.
+ */
+
+#define RFC2217_PARITY_NONE     (1)     /* RFC 2217 encodings, as on the wire */
+#define RFC2217_PARITY_ODD      (2)
+#define RFC2217_PARITY_EVEN     (3)
+#define RFC2217_PARITY_MARK     (4)
+#define RFC2217_PARITY_SPACE    (5)
+#define RFC2217_STOP_1          (1)
+#define RFC2217_STOP_2          (2)
+#define RFC2217_STOP_1_5        (3)
+
+#define RFC2217_PURGE_RX        (1)     /* Purge-data: target-to-client buffer */
+#define RFC2217_PURGE_TX        (2)     /* Purge-data: client-to-target buffer */
+#define RFC2217_PURGE_BOTH      (3)
+
+typedef struct {
+    uint32_t baud;
+    uint8_t  data_bits;         /* 5..8 */
+    uint8_t  parity;            /* RFC2217_PARITY_* */
+    uint8_t  stop_bits;         /* RFC2217_STOP_* */
+} rfc2217_line_t;
+
+typedef struct {
+    /* Bytes to send back to the client (negotiation, acknowledgements) */
+    void (*reply)(const uint8_t *data, size_t len, void *ctx);
+    /* Client changed the line coding; return false to refuse (the old one is acknowledged) */
+    bool (*set_line)(const rfc2217_line_t *line, void *ctx);
+    /* Client changed DTR or RTS (true = asserted) */
+    void (*set_control)(bool dtr, bool rts, void *ctx);
+    /* Client asked to drop buffered data (RFC2217_PURGE_*; may be NULL) */
+    void (*purge)(uint8_t which, void *ctx);
+    void *ctx;
+} rfc2217_ops_t;
+
+typedef struct {
+    rfc2217_ops_t  ops;
+    rfc2217_line_t line;
+    bool           dtr;
+    bool           rts;
+    uint8_t        state;           /* Parser state */
+    uint8_t        verb;            /* WILL/WONT/DO/DONT being parsed */
+    uint32_t       we_on;           /* Options enabled on our side, bit per option < 32 */
+    uint32_t       they_on;         /* Options enabled on the client's side */
+    bool           com_port;        /* Client agreed to COM-PORT-OPTION */
+    uint8_t        sub[16];         /* Subnegotiation being collected */
+    uint8_t        sub_len;
+    bool           sub_overflow;
+} rfc2217_t;
+
+/**
+ * @brief Start a session with the port at @p line (DTR and RTS released)
+ */
+void rfc2217_init(rfc2217_t *t, const rfc2217_ops_t *ops, const rfc2217_line_t *line);
+
+/**
+ * @brief Send the server's opening offers (call once after init)
+ */
+void rfc2217_start(rfc2217_t *t);
+
+/**
+ * @brief Strip Telnet commands from client bytes, acting on them
+ *
+ * Commands may be split across calls at any byte.
+ *
+ * @param buf  Received bytes; the serial data is compacted to the front
+ * @param len  Bytes in @p buf
+ * @return Serial data bytes left at the front of @p buf
+ */
+size_t rfc2217_decode(rfc2217_t *t, uint8_t *buf, size_t len);
+
+/**
+ * @brief Escape serial data for the client (IAC doubled)
+ *
+ * @param in        Serial data
+ * @param len       Bytes in @p in
+ * @param out       Destination
+ * @param out_size  Room in @p out (2 * len always fits)
+ * @param consumed  Receives how many bytes of @p in were escaped
+ * @return Bytes written to @p out
+ */
+size_t rfc2217_escape(const uint8_t *in, size_t len, uint8_t *out, size_t out_size,
+                      size_t *consumed);
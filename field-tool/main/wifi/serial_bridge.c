@@ -0,0 +1,394 @@
+#include "serial_bridge.h"
+#include "rfc2217.h"
+#include "serial/serial_monitor.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "lwip/sockets.h"
+
+#include <string.h>
+#include <stdatomic.h>
+
+static const char *TAG = "BRIDGE";
+
+#define SEND_TIMEOUT_S  (2)     /* A stalled client's send gives up after this */
+#define STOP_WAIT_MS    (3000)  /* For the old session's tasks to exit */
+#define KEEPALIVE_IDLE  (5)     /* Seconds; a vanished client is dropped within ~11 s */
+#define KEEPALIVE_INTVL (2)
+#define KEEPALIVE_COUNT (3)
+
+enum { PORT_RFC2217 = 0, PORT_RAW, PORT_COUNT };
+
+static int s_listen[PORT_COUNT] = { -1, -1 };
+static StreamBufferHandle_t s_stream = NULL;    /* Target bytes: USB callback → client */
+static SemaphoreHandle_t s_send_mutex = NULL;   /* Data and RFC 2217 replies share the socket */
+static volatile int s_fd = -1;                  /* Session socket, -1 when idle */
+static volatile bool s_stop = false;            /* Session tasks: wind down */
+static _Atomic uint32_t s_rx_in;                /* USB callback: target bytes queued */
+static uint32_t s_rx_out;                       /* Tx task: target bytes taken */
+static volatile uint32_t s_purge_to;            /* Drop target bytes queued before this count */
+static _Atomic int s_tasks;                     /* Session tasks still running */
+static rfc2217_t s_rfc;                         /* Net task only, once the session is up */
+static serial_bridge_status_t s_status;
+
+/* Session buffers, one session at a time */
+static uint8_t s_net_buf[FT_BRIDGE_SEGMENT];
+static uint8_t s_tx_buf[FT_BRIDGE_SEGMENT];
+static uint8_t s_esc_buf[2 * FT_BRIDGE_SEGMENT];
+
+/* ── Target side ─────────────────────────────────────────────────────── */
+
+/* USB host context: queue for the client task, never block */
+static void on_target_rx(const uint8_t *data, size_t len, void *ctx)
+{
+    size_t sent = xStreamBufferSendFromISR(s_stream, data, len, NULL);
+    atomic_fetch_add_explicit(&s_rx_in, sent, memory_order_relaxed);
+    if (sent < len) {
+        s_status.dropped_bytes += len - sent;
+    }
+}
+
+/* ── Socket helpers ──────────────────────────────────────────────────── */
+
+static bool send_all(const uint8_t *data, size_t len)
+{
+    bool ok = true;
+    xSemaphoreTake(s_send_mutex, portMAX_DELAY);
+    while (len > 0) {
+        int n = send(s_fd, data, len, 0);
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        data += n;
+        len -= n;
+    }
+    xSemaphoreGive(s_send_mutex);
+    return ok;
+}
+
+static void tune_socket(int fd)
+{
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   /* Batching is ours */
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    int idle = KEEPALIVE_IDLE, intvl = KEEPALIVE_INTVL, count = KEEPALIVE_COUNT;
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &intvl, sizeof(intvl));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+    struct timeval tv = { .tv_sec = SEND_TIMEOUT_S };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+/* ── RFC 2217 callbacks (net task) ───────────────────────────────────── */
+
+static void rfc_reply(const uint8_t *data, size_t len, void *ctx)
+{
+    if (!send_all(data, len)) {
+        s_stop = true;
+    }
+}
+
+static bool rfc_set_line(const rfc2217_line_t *line, void *ctx)
+{
+    /* RFC 2217 parity is 1-based (1 = none); CDC's stop bits are 0 = 1, 1 = 1.5, 2 = 2 */
+    uint8_t stop = line->stop_bits == RFC2217_STOP_2   ? 2
+                 : line->stop_bits == RFC2217_STOP_1_5 ? 1 : 0;
+    esp_err_t err = serial_monitor_bridge_set_line(line->baud, line->data_bits,
+                                                   line->parity - 1, stop);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Line coding %lu %u/%u/%u refused: %s", (unsigned long)line->baud,
+                 line->data_bits, line->parity, line->stop_bits, esp_err_to_name(err));
+        return false;
+    }
+    s_status.baud = line->baud;
+    return true;
+}
+
+static void rfc_set_control(bool dtr, bool rts, void *ctx)
+{
+    serial_monitor_bridge_set_control(dtr, rts);
+}
+
+static void rfc_purge(uint8_t which, void *ctx)
+{
+    /* Writes to the target block until queued, so only the receive side
+     * holds data. The tx task is the stream's only reader and may be
+     * blocked on it, so it drops the bytes as it reaches them. */
+    if (which & RFC2217_PURGE_RX) {
+        s_purge_to = atomic_load_explicit(&s_rx_in, memory_order_relaxed);
+    }
+}
+
+/* ── Session tasks ───────────────────────────────────────────────────── */
+
+/* Drop one reference to the session; the last one hands the target back */
+static void session_release(void)
+{
+    s_stop = true;
+    shutdown(s_fd, SHUT_RDWR);     /* Wake the other task's recv() */
+    if (atomic_fetch_sub(&s_tasks, 1) == 1) {
+        serial_monitor_bridge_end();
+        close(s_fd);
+        s_status.connected = false;
+        s_status.peer[0] = '\0';
+        ESP_LOGI(TAG, "Client disconnected (%llu bytes to target, %llu to client)",
+                 (unsigned long long)s_status.to_target_bytes,
+                 (unsigned long long)s_status.to_client_bytes);
+        s_fd = -1;
+    }
+}
+
+/* Client → target, answering RFC 2217 commands on the way */
+static void net_task(void *arg)
+{
+    bool rfc = s_status.rfc2217;
+    if (rfc) {
+        rfc2217_start(&s_rfc);
+    }
+
+    while (!s_stop) {
+        int n = recv(s_fd, s_net_buf, sizeof(s_net_buf), 0);
+        if (n <= 0) {
+            break;
+        }
+        size_t len = rfc ? rfc2217_decode(&s_rfc, s_net_buf, n) : (size_t)n;
+        if (len > 0 && serial_monitor_bridge_write(s_net_buf, len) != ESP_OK) {
+            ESP_LOGW(TAG, "Target write failed, ending session");
+            break;
+        }
+        s_status.to_target_bytes += len;
+    }
+    session_release();
+    vTaskDelete(NULL);
+}
+
+/* Target → client, batching while data streams */
+static void tx_task(void *arg)
+{
+    bool rfc = s_status.rfc2217;
+    int64_t last_send_us = 0;
+
+    while (!s_stop) {
+        size_t n = xStreamBufferReceive(s_stream, s_tx_buf, sizeof(s_tx_buf),
+                                        pdMS_TO_TICKS(100));
+        if (n == 0) {
+            if (!serial_monitor_is_connected()) {
+                ESP_LOGW(TAG, "Target unplugged, ending session");
+                break;
+            }
+            continue;
+        }
+
+        /* A lone burst (a prompt, an esptool response) goes out at once.
+         * Right after a send the target is streaming: top up the segment
+         * for at most FT_BRIDGE_BATCH_MS so bulk data goes in full segments. */
+        int64_t now = esp_timer_get_time();
+        if (now - last_send_us < FT_BRIDGE_BATCH_MS * 1000) {
+            int64_t deadline = now + FT_BRIDGE_BATCH_MS * 1000;
+            while (n < sizeof(s_tx_buf) && now < deadline) {
+                TickType_t wait = pdMS_TO_TICKS((deadline - now + 999) / 1000);
+                n += xStreamBufferReceive(s_stream, s_tx_buf + n, sizeof(s_tx_buf) - n, wait);
+                now = esp_timer_get_time();
+            }
+        }
+
+        /* Skip what arrived before a purge request */
+        const uint8_t *data = s_tx_buf;
+        int32_t purge = (int32_t)(s_purge_to - s_rx_out);
+        s_rx_out += n;
+        if (purge > 0) {
+            if ((size_t)purge >= n) {
+                continue;
+            }
+            data += purge;
+            n -= purge;
+        }
+
+        const uint8_t *out = data;
+        size_t out_len = n;
+        if (rfc) {
+            size_t consumed;
+            out = s_esc_buf;
+            out_len = rfc2217_escape(data, n, s_esc_buf, sizeof(s_esc_buf), &consumed);
+        }
+        if (!send_all(out, out_len)) {
+            break;
+        }
+        s_status.to_client_bytes += n;
+        last_send_us = esp_timer_get_time();
+    }
+    session_release();
+    vTaskDelete(NULL);
+}
+
+/* ── Sessions ────────────────────────────────────────────────────────── */
+
+/* Make the running session (if any) let go of the target */
+static void end_session(void)
+{
+    if (s_fd < 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "New client, dropping %s", s_status.peer);
+    s_stop = true;
+    shutdown(s_fd, SHUT_RDWR);
+    for (int waited = 0; s_fd >= 0 && waited < STOP_WAIT_MS; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+static void begin_session(int fd, bool rfc, const struct sockaddr_in *peer)
+{
+    end_session();
+    if (s_fd >= 0) {
+        ESP_LOGE(TAG, "Previous session did not exit, refusing client");
+        close(fd);
+        return;
+    }
+
+    xStreamBufferReset(s_stream);
+    s_stop = false;
+    s_rx_out = atomic_load(&s_rx_in);
+    s_purge_to = s_rx_out;
+    if (serial_monitor_bridge_begin(on_target_rx, NULL) != ESP_OK) {
+        ESP_LOGW(TAG, "No target to bridge (not connected or flashing)");
+        close(fd);
+        return;
+    }
+
+    tune_socket(fd);
+    inet_ntoa_r(peer->sin_addr, s_status.peer, sizeof(s_status.peer));
+    s_status.rfc2217 = rfc;
+    s_status.baud = serial_monitor_get_baud();
+    s_status.to_target_bytes = 0;
+    s_status.to_client_bytes = 0;
+    s_status.sessions++;
+    if (rfc) {
+        const rfc2217_ops_t ops = {
+            .reply = rfc_reply,
+            .set_line = rfc_set_line,
+            .set_control = rfc_set_control,
+            .purge = rfc_purge,
+        };
+        const rfc2217_line_t line = {
+            .baud = s_status.baud,
+            .data_bits = 8,
+            .parity = RFC2217_PARITY_NONE,
+            .stop_bits = RFC2217_STOP_1,
+        };
+        rfc2217_init(&s_rfc, &ops, &line);
+    }
+    s_fd = fd;
+    s_status.connected = true;
+
+    /* One reference per task; a task that fails to start gives its own back */
+    atomic_store(&s_tasks, 2);
+    if (xTaskCreate(tx_task, "bridge_tx", 4096, NULL, 5, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Out of memory for session tasks");
+        session_release();
+    }
+    if (xTaskCreate(net_task, "bridge_net", 4096, NULL, 5, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Out of memory for session tasks");
+        session_release();
+        return;
+    }
+    ESP_LOGI(TAG, "%s client %s at %lu baud", rfc ? "RFC 2217" : "Raw", s_status.peer,
+             (unsigned long)s_status.baud);
+}
+
+/* ── Listener ────────────────────────────────────────────────────────── */
+
+static int open_listener(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),     /* SoftAP and station alike */
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void listener_task(void *arg)
+{
+    while (true) {
+        fd_set ready;
+        FD_ZERO(&ready);
+        int max_fd = -1;
+        for (int i = 0; i < PORT_COUNT; i++) {
+            FD_SET(s_listen[i], &ready);
+            if (s_listen[i] > max_fd) {
+                max_fd = s_listen[i];
+            }
+        }
+        if (select(max_fd + 1, &ready, NULL, NULL, NULL) <= 0) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        for (int i = 0; i < PORT_COUNT; i++) {
+            if (!FD_ISSET(s_listen[i], &ready)) {
+                continue;
+            }
+            struct sockaddr_in peer;
+            socklen_t peer_len = sizeof(peer);
+            int fd = accept(s_listen[i], (struct sockaddr *)&peer, &peer_len);
+            if (fd >= 0) {
+                begin_session(fd, i == PORT_RFC2217, &peer);
+            }
+        }
+    }
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+esp_err_t serial_bridge_start(void)
+{
+    if (s_status.listening) {
+        return ESP_OK;
+    }
+
+    s_stream = xStreamBufferCreateWithCaps(FT_BRIDGE_RX_BUF_SIZE, 1, MALLOC_CAP_SPIRAM);
+    s_send_mutex = xSemaphoreCreateMutex();
+    if (s_stream == NULL || s_send_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate bridge buffers");
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_listen[PORT_RFC2217] = open_listener(FT_BRIDGE_RFC2217_PORT);
+    s_listen[PORT_RAW] = open_listener(FT_BRIDGE_RAW_PORT);
+    if (s_listen[PORT_RFC2217] < 0 || s_listen[PORT_RAW] < 0) {
+        ESP_LOGE(TAG, "Failed to open ports %d/%d", FT_BRIDGE_RFC2217_PORT, FT_BRIDGE_RAW_PORT);
+        return ESP_FAIL;
+    }
+
+    if (xTaskCreate(listener_task, "bridge_listen", 3072, NULL, 4, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_status.listening = true;
+    ESP_LOGI(TAG, "Serial bridge on ports %d (RFC 2217) and %d (raw)",
+             FT_BRIDGE_RFC2217_PORT, FT_BRIDGE_RAW_PORT);
+    return ESP_OK;
+}
+
+void serial_bridge_get_status(serial_bridge_status_t *status)
+{
+    if (status != NULL) {
+        *status = s_status;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * The CH340-connected target as a network serial port.
+ *
+ * Two TCP ports, on every interface that is up (SoftAP and station):
+ *
+ *     FT_BRIDGE_RFC2217_PORT   RFC 2217, the client sets the line coding
+ *                              and drives DTR/RTS (esptool --port
+ *                              rfc2217://192.168.4.1:4000)
+ *     FT_BRIDGE_RAW_PORT       plain bytes at the monitor's current rate
+ *                              (nc 192.168.4.1 4001, socket://...)
+ *
+ * One client at a time; a new connection takes over from the old one.
+ * While a client is connected the serial monitor hands the raw byte
+ * stream to the bridge and stops parsing lines, and gets the target back
+ * (8N1 at its own rate, DTR/RTS released) when the client leaves.
+ *
+ * Client sockets run without Nagle. Target bytes are sent as soon as they
+ * arrive when the link is quiet; while data keeps streaming, each send
+ * waits up to FT_BRIDGE_BATCH_MS to fill a FT_BRIDGE_SEGMENT, so
+ * interactive traffic stays low-latency and bulk traffic (esptool at
+ * 460800) goes out in full segments.
+ */
+
+typedef struct {
+    bool     listening;
+    bool     connected;
+    bool     rfc2217;           /* Connected client came in on the RFC 2217 port */
+    char     peer[16];          /* Client address, while connected */
+    uint32_t baud;              /* Rate the client is running at */
+    uint64_t to_target_bytes;
+    uint64_t to_client_bytes;
+    uint32_t dropped_bytes;     /* Target bytes lost, client too slow to drain the buffer */
+    uint32_t sessions;          /* Clients served since boot */
+} serial_bridge_status_t;
+
+/**
+ * @brief Open both listening ports (call once, after serial_monitor_init())
+ */
+esp_err_t serial_bridge_start(void);
+
+void serial_bridge_get_status(serial_bridge_status_t *status);
@@ -0,0 +1,111 @@
+#include "wall_clock.h"
+#include "app_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_event.h"
+#include "esp_netif_sntp.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/time.h>
+
+static const char *TAG = "WALL_CLOCK";
+
+static volatile wall_clock_source_t s_source = WALL_CLOCK_NONE;
+static bool s_sntp_started = false;
+
+/* ── SNTP ────────────────────────────────────────────────────────────── */
+
+/* lwIP task: the system clock has just been set */
+static void on_sntp_sync(struct timeval *tv)
+{
+    bool first = s_source != WALL_CLOCK_SNTP;
+    s_source = WALL_CLOCK_SNTP;
+    if (first) {
+        char text[32];
+        wall_clock_format(text, sizeof(text), (int64_t)tv->tv_sec * 1000000 + tv->tv_usec, false);
+        ESP_LOGI(TAG, "Synced: %s UTC", text);
+    }
+}
+
+static void on_got_ip(void *arg, esp_event_base_t base, int32_t id, void *data)
+{
+    if (s_sntp_started) {
+        return;     /* Keeps polling on its own */
+    }
+    esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(FT_SNTP_SERVER);
+    config.sync_cb = on_sntp_sync;
+    esp_err_t err = esp_netif_sntp_init(&config);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "SNTP start failed: %s", esp_err_to_name(err));
+        return;
+    }
+    s_sntp_started = true;
+    ESP_LOGI(TAG, "SNTP started (%s)", FT_SNTP_SERVER);
+}
+
+/* ── Public API ──────────────────────────────────────────────────────── */
+
+void wall_clock_init(void)
+{
+    time_t now = time(NULL);
+    if (now >= FT_WALL_CLOCK_MIN_EPOCH) {
+        s_source = WALL_CLOCK_RTC;
+        char text[32];
+        wall_clock_format(text, sizeof(text), (int64_t)now * 1000000, false);
+        ESP_LOGI(TAG, "RTC: %s UTC (not synced yet)", text);
+    }
+
+    esp_err_t err = esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                                        on_got_ip, NULL, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "No IP event hook, SNTP disabled: %s", esp_err_to_name(err));
+    }
+}
+
+wall_clock_source_t wall_clock_source(void)
+{
+    return s_source;
+}
+
+const char *wall_clock_source_name(wall_clock_source_t source)
+{
+    switch (source) {
+    case WALL_CLOCK_RTC:  return "RTC";
+    case WALL_CLOCK_SNTP: return "SNTP";
+    default:              return "none";
+    }
+}
+
+int64_t wall_clock_us(int64_t timer_us)
+{
+    if (s_source == WALL_CLOCK_NONE) {
+        return 0;
+    }
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    int64_t now_us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    return now_us - (esp_timer_get_time() - timer_us);
+}
+
+size_t wall_clock_format(char *out, size_t len, int64_t epoch_us, bool file_name)
+{
+    time_t sec = (time_t)(epoch_us / 1000000);
+    struct tm tm;
+    gmtime_r(&sec, &tm);
+    int n;
+    if (file_name) {
+        n = snprintf(out, len, "%04d%02d%02d_%02d%02d%02d",
+                     tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                     tm.tm_hour, tm.tm_min, tm.tm_sec);
+    } else {
+        n = snprintf(out, len, "%04d-%02d-%02d %02d:%02d:%02d.%06lu",
+                     tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                     tm.tm_hour, tm.tm_min, tm.tm_sec,
+                     (unsigned long)(epoch_us % 1000000));
+    }
+    if (n < 0) {
+        return 0;
+    }
+    return (size_t)n < len ? (size_t)n : len - 1;
+}
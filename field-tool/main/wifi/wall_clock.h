@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Wall-clock time for the tool.
+ *
+ * The system clock is set by SNTP once the station interface has an IP
+ * address. Until then, a clock set before the last reset (the RTC keeps
+ * counting through software resets and deep sleep) is trusted if it reads
+ * a plausible date. All times are UTC.
+ *
+ * Lines are stamped with esp_timer time at receive; wall_clock_us() maps
+ * such a stamp to wall-clock time using the clock as it is now, so lines
+ * received before the first SNTP sync line up too.
+ */
+
+typedef enum {
+    WALL_CLOCK_NONE = 0,        /* Not set: only uptime is known */
+    WALL_CLOCK_RTC,             /* Kept from before the last reset, not synced since */
+    WALL_CLOCK_SNTP,            /* Synced from the network */
+} wall_clock_source_t;
+
+/**
+ * @brief Check the RTC and arm SNTP for when the station gets an IP
+ *
+ * Call after the default event loop exists (wifi_mgr_init does this).
+ */
+void wall_clock_init(void);
+
+wall_clock_source_t wall_clock_source(void);
+
+const char *wall_clock_source_name(wall_clock_source_t source);
+
+/**
+ * @brief Wall-clock time of an esp_timer_get_time() value
+ * @return Microseconds since the Unix epoch, 0 if the clock isn't set
+ */
+int64_t wall_clock_us(int64_t timer_us);
+
+/**
+ * @brief Format wall-clock time
+ * @param file_name  true: "20261016_123456", false: "2026-10-16 12:34:56.123456"
+ * @return Length written
+ */
+size_t wall_clock_format(char *out, size_t len, int64_t epoch_us, bool file_name);
@@ -1,4 +1,6 @@
 #include "wifi_manager.h"
+#include "wall_clock.h"
+#include "log_server.h"
 #include "app_config.h"
 #include "esp_log.h"
 #include "esp_wifi.h"
@@ -155,6 +157,9 @@ esp_err_t wifi_mgr_init(void)
     ESP_ERROR_CHECK(esp_event_handler_instance_register(
         IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL, NULL));
 
+    /* SNTP starts once the station has an address */
+    wall_clock_init();
+
     s_initialized = true;
     ESP_LOGI(TAG, "WiFi initialized");
     return ESP_OK;
@@ -198,7 +203,20 @@ esp_err_t wifi_mgr_ap_start(void)
     s_status.ap_connected_count = 0;
 
     ESP_LOGI(TAG, "Starting SoftAP: %s", FT_WIFI_AP_SSID);
-    return apply_mode();
+    esp_err_t err = apply_mode();
+    if (err != ESP_OK) return err;
+
+    esp_netif_ip_info_t ip;
+    if (esp_netif_get_ip_info(s_ap_netif, &ip) == ESP_OK) {
+        snprintf(s_status.ap_ip, sizeof(s_status.ap_ip), IPSTR, IP2STR(&ip.ip));
+    }
+
+    /* Live log over the hotspot */
+    err = log_server_start();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Log server not started: %s", esp_err_to_name(err));
+    }
+    return ESP_OK;
 }
 
 esp_err_t wifi_mgr_ap_stop(void)
@@ -210,6 +228,8 @@ esp_err_t wifi_mgr_ap_stop(void)
     s_status.ap_connected_count = 0;
 
     ESP_LOGI(TAG, "Stopping SoftAP");
+    log_server_stop();
+    s_status.ap_ip[0] = '\0';
     return apply_mode();
 }
 
@@ -14,6 +14,7 @@ typedef struct {
     wifi_sta_state_t sta_state;
     char             sta_ip[16];       /* "xxx.xxx.xxx.xxx" */
     bool             ap_active;
+    char             ap_ip[16];        /* Where the log server is, while ap_active */
     int              ap_connected_count;
 } wifi_mgr_status_t;
 
@@ -0,0 +1,816 @@
+/*
+ * bridge_test — run the serial bridge's sessions against a loopback target
+ *
+ * Build and run on the host (from field-tool/test/host):
+ *   cc -O2 -pthread -DHOST_RUN_TASKS -Istubs -I../../main -I../../main/serial \
+ *      -o bridge_test bridge_test.c ../../main/wifi/serial_bridge.c ../../main/wifi/rfc2217.c
+ *   ./bridge_test
+ *
+ * serial_bridge.c and rfc2217.c run as they are, their tasks on pthreads
+ * (-DHOST_RUN_TASKS), listening on FT_BRIDGE_RFC2217_PORT and
+ * FT_BRIDGE_RAW_PORT of the host. The serial monitor is replaced by a
+ * loopback target: what the bridge writes comes back through its receive
+ * callback in 64-byte USB packets at the line rate, and the line coding
+ * and DTR/RTS are recorded. Clients connect over 127.0.0.1 as pyserial
+ * (rfc2217://) and nc would. In order:
+ *
+ *   - an RFC 2217 client negotiates, sets the line coding and DTR/RTS,
+ *     and has an out-of-range rate refused,
+ *   - 15-byte requests echo back (round trip timed, at 460800),
+ *   - 300 KB of IAC-heavy data echoes intact at 460800 (throughput timed
+ *     against the 8N1 line rate),
+ *   - a raw client takes over, and the RFC 2217 client is dropped,
+ *   - an RFC 2217 client takes over from the raw one while it streams
+ *     without reading, so the old session winds down with its tasks
+ *     blocked on the target and on the socket,
+ *   - that client stalls until the bridge's buffer overflows, then asks
+ *     for PURGE-DATA: every byte queued before it must be gone and every
+ *     byte after it must arrive,
+ *   - the last client leaves and the target goes back to the monitor.
+ *
+ * Throughout, each session must begin and end exactly once, and the bridge
+ * must never write to the target or end a session outside one. Timings
+ * are printed, not checked. Exits non-zero on any failure.
+ */
+
+#include "wifi/serial_bridge.h"
+#include "serial/serial_monitor.h"
+#include "app_config.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define IAC         (255)
+#define WILL        (251)
+#define DO          (253)
+#define SB          (250)
+#define SE          (240)
+#define OPT_BINARY  (0)
+#define OPT_SGA     (3)
+#define COM_PORT    (44)
+
+#define MONITOR_BAUD    (115200)
+#define BRIDGE_BAUD     (460800)
+#define USB_PACKET      (64)
+#define LOOP_SIZE       (4096)          /* Bytes on their way through the target */
+#define PINGS           (200)
+#define PING_LEN        (15)
+#define BULK_BYTES      (300 * 1024)
+#define NEW_BYTES       (4000)
+#define SMALL_RCVBUF    (4096)          /* A client that stalls soon */
+#define STALLED_DROPS   (16 * 1024)     /* Overflow that shows the bridge is stuck on the socket */
+
+static int s_failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        if (s_failures++ < 20) {                    \
+            printf("FAIL " __VA_ARGS__);            \
+            printf("\n");                           \
+        }                                           \
+    }                                               \
+} while (0)
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+/* ── Loopback target, in place of serial_monitor.c ──────────────────── */
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  space;
+    serial_monitor_bridge_cb_t cb;      /* Set while bridged */
+    void    *ctx;
+    uint32_t baud;
+    uint8_t  data_bits;
+    uint8_t  parity;                    /* CDC: 0 none, 1 odd, 2 even, ... */
+    uint8_t  stop_bits;                 /* CDC: 0 = 1, 1 = 1.5, 2 = 2 */
+    bool     dtr;
+    bool     rts;
+    uint8_t  loop[LOOP_SIZE];           /* Written by the bridge, not yet echoed */
+    size_t   head;
+    size_t   count;
+    int      begins;
+    int      ends;
+    int      misuse;                    /* Calls outside a session */
+} s_target = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .space = PTHREAD_COND_INITIALIZER,
+    .baud = MONITOR_BAUD,
+    .data_bits = 8,
+};
+
+bool serial_monitor_is_connected(void)
+{
+    return true;
+}
+
+uint32_t serial_monitor_get_baud(void)
+{
+    pthread_mutex_lock(&s_target.mutex);
+    uint32_t baud = s_target.baud;
+    pthread_mutex_unlock(&s_target.mutex);
+    return baud;
+}
+
+esp_err_t serial_monitor_bridge_begin(serial_monitor_bridge_cb_t cb, void *ctx)
+{
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    pthread_mutex_lock(&s_target.mutex);
+    if (s_target.cb == NULL) {
+        s_target.cb = cb;
+        s_target.ctx = ctx;
+        s_target.count = 0;
+        s_target.begins++;
+        err = ESP_OK;
+    } else {
+        s_target.misuse++;
+    }
+    pthread_mutex_unlock(&s_target.mutex);
+    return err;
+}
+
+/* The monitor takes the port back: 8N1 at its own rate, DTR/RTS released */
+void serial_monitor_bridge_end(void)
+{
+    pthread_mutex_lock(&s_target.mutex);
+    if (s_target.cb == NULL) {
+        s_target.misuse++;
+    }
+    s_target.cb = NULL;
+    s_target.ends++;
+    s_target.baud = MONITOR_BAUD;
+    s_target.data_bits = 8;
+    s_target.parity = 0;
+    s_target.stop_bits = 0;
+    s_target.dtr = false;
+    s_target.rts = false;
+    s_target.count = 0;
+    pthread_cond_broadcast(&s_target.space);
+    pthread_mutex_unlock(&s_target.mutex);
+}
+
+/* Blocks while the target's buffers are full, giving up after a second
+ * as cdc_acm_host_data_tx_blocking() does */
+esp_err_t serial_monitor_bridge_write(const uint8_t *data, size_t len)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += 1;
+
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&s_target.mutex);
+    while (len > 0) {
+        if (s_target.cb == NULL) {
+            s_target.misuse++;
+            err = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        if (s_target.count == LOOP_SIZE) {
+            if (pthread_cond_timedwait(&s_target.space, &s_target.mutex, &deadline) != 0) {
+                err = ESP_ERR_TIMEOUT;
+                break;
+            }
+            continue;
+        }
+        s_target.loop[(s_target.head + s_target.count) % LOOP_SIZE] = *data++;
+        s_target.count++;
+        len--;
+    }
+    pthread_mutex_unlock(&s_target.mutex);
+    return err;
+}
+
+esp_err_t serial_monitor_bridge_set_line(uint32_t baud, uint8_t data_bits, uint8_t parity,
+                                         uint8_t stop_bits)
+{
+    if (baud < 300 || baud > 3000000 || data_bits < 5 || data_bits > 8 ||
+        parity > 4 || stop_bits > 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&s_target.mutex);
+    if (s_target.cb == NULL) {
+        s_target.misuse++;
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        s_target.baud = baud;
+        s_target.data_bits = data_bits;
+        s_target.parity = parity;
+        s_target.stop_bits = stop_bits;
+    }
+    pthread_mutex_unlock(&s_target.mutex);
+    return err;
+}
+
+esp_err_t serial_monitor_bridge_set_control(bool dtr, bool rts)
+{
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&s_target.mutex);
+    if (s_target.cb == NULL) {
+        s_target.misuse++;
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        s_target.dtr = dtr;
+        s_target.rts = rts;
+    }
+    pthread_mutex_unlock(&s_target.mutex);
+    return err;
+}
+
+/* Echo what the bridge wrote, in USB packets at the line rate (8N1: ten
+ * bits a byte) */
+static void *target_thread(void *arg)
+{
+    (void)arg;
+    uint8_t packet[USB_PACKET];
+    double credit = 0;
+    double last = now_ms();
+    while (true) {
+        usleep(100);
+        pthread_mutex_lock(&s_target.mutex);
+        double now = now_ms();
+        credit += (now - last) * s_target.baud / 10000.0;
+        last = now;
+        if (s_target.count == 0 || credit > 2 * USB_PACKET) {
+            credit = s_target.count == 0 ? 0 : 2 * USB_PACKET;     /* An idle line saves nothing */
+        }
+        while (credit >= 1 && s_target.count > 0) {
+            size_t n = s_target.count < USB_PACKET ? s_target.count : USB_PACKET;
+            n = n < (size_t)credit ? n : (size_t)credit;
+            for (size_t i = 0; i < n; i++) {
+                packet[i] = s_target.loop[(s_target.head + i) % LOOP_SIZE];
+            }
+            s_target.head = (s_target.head + n) % LOOP_SIZE;
+            s_target.count -= n;
+            credit -= n;
+            pthread_cond_broadcast(&s_target.space);
+            if (s_target.cb != NULL) {
+                s_target.cb(packet, n, s_target.ctx);
+            }
+        }
+        pthread_mutex_unlock(&s_target.mutex);
+    }
+    return NULL;
+}
+
+/* Bytes from the target that no client sent, as the USB callback would */
+static void target_emit(const uint8_t *data, size_t len)
+{
+    pthread_mutex_lock(&s_target.mutex);
+    if (s_target.cb != NULL) {
+        s_target.cb(data, len, s_target.ctx);
+    }
+    pthread_mutex_unlock(&s_target.mutex);
+}
+
+/* ── Clients ────────────────────────────────────────────────────────── */
+
+enum { C_DATA, C_IAC, C_OPT, C_SB, C_SB_IAC };
+
+typedef struct {
+    int      fd;
+    bool     rfc;
+    int      state;             /* Telnet decoder */
+    uint8_t  sb[40];
+    size_t   sb_len;
+    int      replies;           /* Com-port replies seen */
+    uint8_t  reply_cmd;         /* The last one */
+    uint8_t  reply[32];
+    size_t   reply_len;
+    size_t   reply_data_at;     /* Data bytes before it in the last read */
+} client_t;
+
+/* What pyserial sends first */
+static const uint8_t s_hello[] = {
+    IAC, WILL, OPT_BINARY, IAC, DO, OPT_BINARY, IAC, WILL, OPT_SGA, IAC, DO, OPT_SGA,
+    IAC, WILL, COM_PORT,
+};
+
+static bool client_open(client_t *c, uint16_t port, bool rfc, int rcvbuf)
+{
+    memset(c, 0, sizeof(*c));
+    c->rfc = rfc;
+    c->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (rcvbuf > 0) {
+        setsockopt(c->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    int one = 1;
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    struct timeval tv = { .tv_sec = 3 };
+    setsockopt(c->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(c->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("connect");
+        return false;
+    }
+    if (rfc) {
+        send(c->fd, s_hello, sizeof(s_hello), 0);
+    }
+    return true;
+}
+
+/* Strip Telnet commands in place, noting com-port replies */
+static size_t client_decode(client_t *c, uint8_t *buf, size_t len)
+{
+    size_t w = 0;
+    for (size_t r = 0; r < len; r++) {
+        uint8_t b = buf[r];
+        switch (c->state) {
+        case C_DATA:
+            if (b == IAC) {
+                c->state = C_IAC;
+            } else {
+                buf[w++] = b;
+            }
+            break;
+        case C_IAC:
+            c->state = C_DATA;
+            if (b == IAC) {
+                buf[w++] = IAC;
+            } else if (b == SB) {
+                c->state = C_SB;
+                c->sb_len = 0;
+            } else if (b >= WILL) {
+                c->state = C_OPT;
+            }
+            break;
+        case C_OPT:
+            c->state = C_DATA;
+            break;
+        case C_SB:
+            if (b == IAC) {
+                c->state = C_SB_IAC;
+            } else if (c->sb_len < sizeof(c->sb)) {
+                c->sb[c->sb_len++] = b;
+            }
+            break;
+        case C_SB_IAC:
+            if (b == IAC) {
+                if (c->sb_len < sizeof(c->sb)) {
+                    c->sb[c->sb_len++] = IAC;
+                }
+                c->state = C_SB;
+                break;
+            }
+            if (b == SE && c->sb_len >= 2 && c->sb[0] == COM_PORT) {
+                c->reply_cmd = c->sb[1];
+                c->reply_len = c->sb_len - 2;
+                memcpy(c->reply, c->sb + 2, c->reply_len);
+                c->reply_data_at = w;
+                c->replies++;
+            }
+            c->state = C_DATA;
+            break;
+        }
+    }
+    return w;
+}
+
+/* Serial data that arrived, -1 once the bridge has closed or gone quiet */
+static long client_read(client_t *c, uint8_t *buf, size_t cap)
+{
+    long n = recv(c->fd, buf, cap, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    return c->rfc ? (long)client_decode(c, buf, n) : n;
+}
+
+/* Double IAC in serial data for an RFC 2217 client */
+static size_t client_escape(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t w = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == IAC) {
+            out[w++] = IAC;
+        }
+        out[w++] = in[i];
+    }
+    return w;
+}
+
+static void client_send_command(client_t *c, uint8_t cmd, const uint8_t *value, size_t len)
+{
+    uint8_t msg[64] = { IAC, SB, COM_PORT, cmd };
+    size_t n = 4 + client_escape(value, len, msg + 4);
+    msg[n++] = IAC;
+    msg[n++] = SE;
+    CHECK(send(c->fd, msg, n, 0) == (ssize_t)n, "command %u not sent", cmd);
+}
+
+/* Send a com-port command and wait for its reply (cmd + 100) */
+static bool client_command(client_t *c, uint8_t cmd, const uint8_t *value, size_t len)
+{
+    client_send_command(c, cmd, value, len);
+    int seen = c->replies;
+    uint8_t buf[2048];
+    while (c->replies == seen || c->reply_cmd != cmd + 100) {
+        seen = c->replies;
+        if (client_read(c, buf, sizeof(buf)) < 0) {
+            CHECK(false, "no reply to command %u", cmd);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Read until the bridge closes the connection: true if it did */
+static bool client_wait_closed(client_t *c)
+{
+    uint8_t buf[2048];
+    ssize_t n;
+    while ((n = recv(c->fd, buf, sizeof(buf), 0)) > 0) {
+    }
+    return n == 0;
+}
+
+/* Wait for the bridge's session count and connection state */
+static bool wait_session(uint32_t sessions, bool connected)
+{
+    for (int i = 0; i < 500; i++) {
+        serial_bridge_status_t st;
+        serial_bridge_get_status(&st);
+        if (st.sessions == sessions && st.connected == connected) {
+            return true;
+        }
+        usleep(10000);
+    }
+    return false;
+}
+
+static void target_state(int *begins, int *ends, int *misuse)
+{
+    pthread_mutex_lock(&s_target.mutex);
+    *begins = s_target.begins;
+    *ends = s_target.ends;
+    *misuse = s_target.misuse;
+    pthread_mutex_unlock(&s_target.mutex);
+}
+
+/* ── RFC 2217 session ───────────────────────────────────────────────── */
+
+static void be32(uint32_t v, uint8_t *out)
+{
+    out[0] = v >> 24;
+    out[1] = v >> 16;
+    out[2] = v >> 8;
+    out[3] = v;
+}
+
+static void check_commands(client_t *c)
+{
+    uint8_t v[4];
+
+    CHECK(client_command(c, 0, NULL, 0) && c->reply_len > 8 &&
+          memcmp(c->reply, "ESP32-P4", 8) == 0, "signature");
+
+    be32(BRIDGE_BAUD, v);
+    CHECK(client_command(c, 1, v, 4) && c->reply_len == 4 && memcmp(c->reply, v, 4) == 0 &&
+          serial_monitor_get_baud() == BRIDGE_BAUD, "set baud: target at %lu",
+          (unsigned long)serial_monitor_get_baud());
+
+    /* Out of range: refused, the reply gives the rate still in use */
+    uint8_t bad[4];
+    be32(5000000, bad);
+    CHECK(client_command(c, 1, bad, 4) && c->reply_len == 4 && memcmp(c->reply, v, 4) == 0 &&
+          serial_monitor_get_baud() == BRIDGE_BAUD, "bad baud not refused");
+
+    /* 7E2, then back to 8N1 */
+    uint8_t seven = 7, even = 3, two = 2, eight = 8, none = 1, one = 1;
+    client_command(c, 2, &seven, 1);
+    client_command(c, 3, &even, 1);
+    client_command(c, 4, &two, 1);
+    pthread_mutex_lock(&s_target.mutex);
+    CHECK(s_target.data_bits == 7 && s_target.parity == 2 && s_target.stop_bits == 2,
+          "7E2: target at %u/%u/%u", s_target.data_bits, s_target.parity, s_target.stop_bits);
+    pthread_mutex_unlock(&s_target.mutex);
+    client_command(c, 2, &eight, 1);
+    client_command(c, 3, &none, 1);
+    client_command(c, 4, &one, 1);
+
+    /* DTR/RTS: the callback runs before the reply goes out */
+    static const struct {
+        uint8_t value;
+        bool    dtr;
+        bool    rts;
+    } controls[] = { { 8, true, false }, { 11, true, true }, { 9, false, true }, { 12, false, false } };
+    for (size_t i = 0; i < sizeof(controls) / sizeof(controls[0]); i++) {
+        bool replied = client_command(c, 5, &controls[i].value, 1) && c->reply_len == 1 &&
+                       c->reply[0] == controls[i].value;
+        pthread_mutex_lock(&s_target.mutex);
+        CHECK(replied && s_target.dtr == controls[i].dtr && s_target.rts == controls[i].rts,
+              "SET-CONTROL %u: DTR %d RTS %d", controls[i].value, s_target.dtr, s_target.rts);
+        pthread_mutex_unlock(&s_target.mutex);
+    }
+
+    serial_bridge_status_t st;
+    serial_bridge_get_status(&st);
+    CHECK(st.rfc2217 && st.baud == BRIDGE_BAUD, "status: rfc2217 %d, baud %lu", st.rfc2217,
+          (unsigned long)st.baud);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Echo what was sent, checking it byte for byte */
+static bool read_echo(client_t *c, const uint8_t *want, size_t len)
+{
+    uint8_t buf[4096];
+    size_t got = 0;
+    while (got < len) {
+        long n = client_read(c, buf, sizeof(buf) < len - got ? sizeof(buf) : len - got);
+        if (n < 0) {
+            CHECK(false, "echo stopped at %zu of %zu bytes", got, len);
+            return false;
+        }
+        if (memcmp(buf, want + got, n) != 0) {
+            CHECK(false, "echo differs after %zu bytes", got);
+            return false;
+        }
+        got += n;
+    }
+    return true;
+}
+
+static void check_round_trip(client_t *c)
+{
+    static double ms[PINGS];
+    uint8_t req[PING_LEN], wire[2 * PING_LEN];
+    for (int i = 0; i < PINGS; i++) {
+        for (int k = 0; k < PING_LEN; k++) {
+            req[k] = (uint8_t)(i * 31 + k * 17);
+        }
+        req[i % PING_LEN] = IAC;
+        usleep(5000);                   /* A quiet link, as between esptool commands */
+        size_t n = client_escape(req, PING_LEN, wire);
+        double t0 = now_ms();
+        send(c->fd, wire, n, 0);
+        if (!read_echo(c, req, PING_LEN)) {
+            return;
+        }
+        ms[i] = now_ms() - t0;
+    }
+    qsort(ms, PINGS, sizeof(ms[0]), cmp_double);
+    printf("%d-byte round trip at %d: median %.2f ms, max %.2f ms (%.2f ms on the wire)\n",
+           PING_LEN, BRIDGE_BAUD, ms[PINGS / 2], ms[PINGS - 1],
+           PING_LEN * 10.0 / BRIDGE_BAUD * 1e3);
+}
+
+typedef struct {
+    client_t      *c;
+    const uint8_t *data;
+    size_t         len;
+} pump_t;
+
+static void *bulk_writer(void *arg)
+{
+    pump_t *p = arg;
+    uint8_t wire[2 * 1024];
+    for (size_t off = 0; off < p->len; off += 1024) {
+        size_t n = p->len - off < 1024 ? p->len - off : 1024;
+        n = client_escape(p->data + off, n, wire);
+        if (send(p->c->fd, wire, n, 0) != (ssize_t)n) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void check_bulk(client_t *c)
+{
+    uint8_t *data = malloc(BULK_BYTES);
+    for (size_t i = 0; i < BULK_BYTES; i++) {
+        data[i] = (i % 4 == 0) ? IAC : (uint8_t)(i * 7 + (i >> 10));
+    }
+    pump_t pump = { .c = c, .data = data, .len = BULK_BYTES };
+    pthread_t writer;
+    double t0 = now_ms();
+    pthread_create(&writer, NULL, bulk_writer, &pump);
+    bool ok = read_echo(c, data, BULK_BYTES);
+    double t = now_ms() - t0;
+    pthread_join(writer, NULL);
+    free(data);
+    if (ok) {
+        double rate = BULK_BYTES / t * 1e3;
+        printf("%d KB echoed at %d: %.1f KB/s, %.0f%% of the line rate\n", BULK_BYTES / 1024,
+               BRIDGE_BAUD, rate / 1024, rate / (BRIDGE_BAUD / 10.0) * 100);
+    }
+
+    usleep(50000);                      /* Counters follow the sends */
+    serial_bridge_status_t st;
+    serial_bridge_get_status(&st);
+    uint64_t want = (uint64_t)PINGS * PING_LEN + BULK_BYTES;
+    CHECK(st.to_target_bytes == want && st.to_client_bytes == want && st.dropped_bytes == 0,
+          "counters: %llu to target, %llu to client, %lu dropped, want %llu",
+          (unsigned long long)st.to_target_bytes, (unsigned long long)st.to_client_bytes,
+          (unsigned long)st.dropped_bytes, (unsigned long long)want);
+}
+
+/* ── Takeover ───────────────────────────────────────────────────────── */
+
+/* A raw client streaming and never reading */
+static void *raw_pump(void *arg)
+{
+    client_t *c = arg;
+    uint8_t buf[1024];
+    memset(buf, 'r', sizeof(buf));
+    while (send(c->fd, buf, sizeof(buf), 0) > 0) {
+    }
+    return NULL;
+}
+
+static void check_raw_takeover(client_t *rfc, client_t *raw, pthread_t *pump)
+{
+    CHECK(client_open(raw, FT_BRIDGE_RAW_PORT, false, SMALL_RCVBUF) && wait_session(2, true),
+          "raw client didn't get a session");
+    CHECK(client_wait_closed(rfc), "RFC 2217 client not dropped");
+    close(rfc->fd);
+
+    int begins, ends, misuse;
+    target_state(&begins, &ends, &misuse);
+    serial_bridge_status_t st;
+    serial_bridge_get_status(&st);
+    CHECK(begins == 2 && ends == 1 && !st.rfc2217 && st.baud == MONITOR_BAUD,
+          "raw takeover: %d begins, %d ends, rfc2217 %d, baud %lu", begins, ends, st.rfc2217,
+          (unsigned long)st.baud);
+
+    static const uint8_t hello[] = "hello raw\n";
+    send(raw->fd, hello, sizeof(hello) - 1, 0);
+    read_echo(raw, hello, sizeof(hello) - 1);
+
+    pthread_create(pump, NULL, raw_pump, raw);
+    usleep(300000);
+}
+
+/* ── Purge ──────────────────────────────────────────────────────────── */
+
+typedef struct {
+    size_t   emitted;           /* Old bytes the target sent */
+    uint32_t overflow;          /* Lost to the full buffer */
+    size_t   delivered;         /* Reached the client before the purge reply */
+} purge_run_t;
+
+/* Stall the client until the bridge's buffer overflows, purge, and read
+ * up to the reply; false if the reply never came */
+static bool purge_once(client_t *c, purge_run_t *run)
+{
+    serial_bridge_status_t st;
+    serial_bridge_get_status(&st);
+    uint32_t dropped0 = st.dropped_bytes;
+
+    /* The client stops reading; old bytes (0..127) pile up until the
+     * socket is full and the bridge's buffer keeps overflowing */
+    uint8_t chunk[1024];
+    run->emitted = 0;
+    while (st.dropped_bytes - dropped0 < STALLED_DROPS && run->emitted < 64 * 1024 * 1024) {
+        for (size_t i = 0; i < sizeof(chunk); i++) {
+            chunk[i] = (uint8_t)((run->emitted + i) % 128);
+        }
+        target_emit(chunk, sizeof(chunk));
+        run->emitted += sizeof(chunk);
+        usleep(200);                    /* Let the bridge fill the socket first */
+        serial_bridge_get_status(&st);
+    }
+    CHECK(st.dropped_bytes - dropped0 >= STALLED_DROPS, "bridge buffer never filled");
+    run->overflow = st.dropped_bytes - dropped0;
+
+    const uint8_t rx = 1;
+    client_send_command(c, 12, &rx, 1);
+    usleep(20000);                      /* Well inside the bridge's send timeout */
+
+    /* Everything up to the reply is old; nothing old may follow it */
+    uint8_t buf[4096];
+    run->delivered = 0;
+    int seen = c->replies;
+    while (c->replies == seen || c->reply_cmd != 112) {
+        seen = c->replies;
+        long n = client_read(c, buf, sizeof(buf));
+        if (n < 0) {
+            CHECK(false, "no reply to PURGE-DATA");
+            return false;
+        }
+        size_t before = c->replies != seen ? c->reply_data_at : (size_t)n;
+        CHECK((size_t)n == before, "%zu old bytes after the purge reply", (size_t)n - before);
+        run->delivered += n;
+    }
+    CHECK(c->reply_len == 1 && c->reply[0] == rx, "purge reply");
+    return true;
+}
+
+static void check_purge(client_t *c)
+{
+    /* The host's socket buffers grow on their own, so a stalled bridge
+     * sometimes gets to drain its buffer before the purge lands: try
+     * again until one finds bytes to drop */
+    purge_run_t run;
+    long purged = 0;
+    int tries = 0;
+    while (purged <= 0 && tries++ < 5) {
+        if (!purge_once(c, &run)) {
+            return;
+        }
+        purged = (long)run.emitted - (long)run.overflow - (long)run.delivered;
+        CHECK(purged >= 0, "%ld bytes more delivered than queued", -purged);
+    }
+    CHECK(purged > 0, "purge dropped nothing in %d tries", tries);
+
+    /* New bytes (128..254) must all come, in order */
+    serial_bridge_status_t st;
+    serial_bridge_get_status(&st);
+    uint32_t dropped0 = st.dropped_bytes;
+    uint8_t fresh[USB_PACKET];
+    for (size_t off = 0; off < NEW_BYTES; off += USB_PACKET) {
+        for (size_t i = 0; i < USB_PACKET; i++) {
+            fresh[i] = (uint8_t)(128 + (off + i) % 127);
+        }
+        target_emit(fresh, NEW_BYTES - off < USB_PACKET ? NEW_BYTES - off : USB_PACKET);
+        usleep(500);
+    }
+    uint8_t buf[4096];
+    size_t got = 0;
+    while (got < NEW_BYTES) {
+        long n = client_read(c, buf, sizeof(buf));
+        if (n < 0) {
+            CHECK(false, "%zu of %d bytes after the purge arrived", got, NEW_BYTES);
+            break;
+        }
+        for (long i = 0; i < n; i++, got++) {
+            if (buf[i] != (uint8_t)(128 + got % 127)) {
+                CHECK(false, "byte %zu after the purge is %u", got, buf[i]);
+                got = NEW_BYTES;
+                break;
+            }
+        }
+    }
+    serial_bridge_get_status(&st);
+    CHECK(st.dropped_bytes == dropped0, "bytes dropped after the purge");
+    printf("Purge (try %d): %zu KB queued, %lu KB overflowed, %zu KB delivered before it, "
+           "%ld bytes dropped\n", tries, run.emitted / 1024, (unsigned long)run.overflow / 1024,
+           run.delivered / 1024, purged);
+}
+
+int main(void)
+{
+    signal(SIGPIPE, SIG_IGN);
+    pthread_t target;
+    pthread_create(&target, NULL, target_thread, NULL);
+    if (serial_bridge_start() != ESP_OK) {
+        printf("FAIL bridge didn't start (ports %d/%d in use?)\n", FT_BRIDGE_RFC2217_PORT,
+               FT_BRIDGE_RAW_PORT);
+        return 2;
+    }
+
+    client_t rfc, raw, late;
+    if (!client_open(&rfc, FT_BRIDGE_RFC2217_PORT, true, 0) || !wait_session(1, true)) {
+        printf("FAIL RFC 2217 client didn't get a session\n");
+        return 1;
+    }
+    check_commands(&rfc);
+    check_round_trip(&rfc);
+    check_bulk(&rfc);
+
+    pthread_t pump;
+    check_raw_takeover(&rfc, &raw, &pump);
+
+    /* An RFC 2217 client takes over from the streaming raw one */
+    CHECK(client_open(&late, FT_BRIDGE_RFC2217_PORT, true, SMALL_RCVBUF) &&
+          wait_session(3, true), "RFC 2217 client didn't take over from the raw one");
+    pthread_join(pump, NULL);
+    close(raw.fd);
+    CHECK(client_command(&late, 0, NULL, 0), "new session doesn't answer");
+    int begins, ends, misuse;
+    target_state(&begins, &ends, &misuse);
+    CHECK(begins == 3 && ends == 2, "takeover: %d begins, %d ends", begins, ends);
+
+    check_purge(&late);
+
+    close(late.fd);
+    CHECK(wait_session(3, false), "bridge didn't notice the client leave");
+    target_state(&begins, &ends, &misuse);
+    CHECK(begins == 3 && ends == 3 && misuse == 0 && serial_monitor_get_baud() == MONITOR_BAUD,
+          "end: %d begins, %d ends, %d calls outside a session", begins, ends, misuse);
+
+    printf("bridge test: %s (%d failures)\n", s_failures ? "FAILED" : "PASSED", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+/*
+ * codec_test — round-trip lines through the binary SD log codec
+ *
+ * Build and run on the host (from field-tool/test/host):
+ *   cc -O1 -g -fsanitize=address,undefined -Istubs -I../../main -I../../main/serial \
+ *      -o codec_test codec_test.c ../../main/serial/log_codec.c
+ *   ./codec_test
+ *
+ * Random blocks of header and plain lines (some tags new, some repeated,
+ * timestamps jumping both ways) must seal, check, unpack and decode back
+ * to the same text byte for byte. The longest possible header, a 10-digit
+ * timestamp with a LOG_CODEC_TAG_MAX_LEN tag, must fit in exactly
+ * LOG_CODEC_HEADER_MAX() bytes when formatted, matched and decoded, and a
+ * decode buffer one byte short must be refused. A block that runs out of
+ * tag numbers must refuse the next new tag without moving the timestamp,
+ * so later header lines still decode to their own time. Built with
+ * AddressSanitizer so an overrun fails even when it lands in padding.
+ */
+
+#include "log_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINES   (400)
+#define TEXT_MAX    (200)
+
+static int s_failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        if (s_failures++ < 10) {                    \
+            printf("FAIL " __VA_ARGS__);            \
+            printf("\n");                           \
+        }                                           \
+    }                                               \
+} while (0)
+
+static unsigned s_rng = 1;
+
+static unsigned rnd(unsigned n)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (s_rng >> 8) % n;
+}
+
+static uint8_t s_work[LOG_CODEC_WORK_SIZE];
+static uint8_t s_records[LOG_CODEC_MAX_RAW];
+static uint8_t s_block[LOG_CODEC_BLOCK_BOUND(LOG_CODEC_MAX_RAW)];
+static uint8_t s_raw[LOG_CODEC_MAX_RAW];
+
+/* Seal records, check and unpack the block, and start decoding it */
+static bool seal_and_open(const log_codec_encoder_t *enc, size_t fill,
+                          log_codec_decoder_t *dec)
+{
+    size_t len = log_codec_seal_block(enc, s_records, fill, 0, s_block, s_work);
+    log_codec_block_header_t hdr;
+    long checked = log_codec_check_block(s_block, len, &hdr);
+    CHECK(checked == (long)len, "block check: %ld of %zu bytes", checked, len);
+    if (checked != (long)len || !log_codec_unpack_block(s_block, &hdr, s_raw)) {
+        return false;
+    }
+    CHECK(hdr.raw_len == fill && memcmp(s_raw, s_records, fill) == 0, "unpacked records differ");
+    log_codec_decoder_init(dec, s_raw, hdr.raw_len);
+    return true;
+}
+
+/* ── Round trip ─────────────────────────────────────────────────────── */
+
+static void check_round_trip(void)
+{
+    static const char *const tags[] = { "wifi", "MAIN", "sensor", "boot", "x" };
+    static char texts[MAX_LINES][TEXT_MAX];
+    static log_codec_line_t lines[MAX_LINES];
+
+    for (int round = 0; round < 500; round++) {
+        log_codec_encoder_t enc;
+        log_codec_encoder_reset(&enc);
+        size_t fill = 0;
+        int count = 1 + rnd(MAX_LINES);
+        for (int i = 0; i < count; i++) {
+            uint16_t len = rnd(TEXT_MAX);
+            for (uint16_t k = 0; k < len; k++) {
+                texts[i][k] = rnd(4) ? "flow=12.3 L/min "[k % 16] : (char)(' ' + rnd(95));
+            }
+            int t = rnd(5);
+            lines[i] = (log_codec_line_t) {
+                .level = "EWIDV "[rnd(6)],
+                .header = rnd(3) != 0,
+                .timestamp_ms = rnd(2) ? (uint32_t)rnd(1u << 30) * 4 : (uint32_t)i * 10,
+                .tag_id = (uint16_t)(t + 1),
+                .tag = tags[t],
+                .tag_len = (uint8_t)strlen(tags[t]),
+                .text = texts[i],
+                .text_len = len,
+            };
+            size_t n = log_codec_encode_line(&enc, s_records + fill, sizeof(s_records) - fill,
+                                             &lines[i]);
+            if (n == 0) {
+                count = i;      /* Block full */
+                break;
+            }
+            fill += n;
+        }
+
+        log_codec_decoder_t dec;
+        if (!seal_and_open(&enc, fill, &dec)) {
+            continue;
+        }
+        char out[LOG_CODEC_HEADER_MAX(LOG_CODEC_TAG_MAX_LEN) + TEXT_MAX];
+        log_codec_decoded_t d;
+        int i = 0;
+        while (log_codec_decode_line(&dec, out, sizeof(out), &d)) {
+            const log_codec_line_t *l = &lines[i];
+            char want[sizeof(out)];
+            size_t n = 0;
+            if (l->header) {
+                n = log_codec_format_header(want, l->level, l->timestamp_ms, l->tag, l->tag_len);
+            }
+            memcpy(want + n, l->text, l->text_len);
+            n += l->text_len;
+            CHECK(d.len == n && memcmp(out, want, n) == 0 && d.has_ts == l->header,
+                  "round %d line %d: \"%.*s\", want \"%.*s\"", round, i, (int)d.len, out,
+                  (int)n, want);
+            i++;
+        }
+        CHECK(i == count, "round %d: decoded %d of %d lines", round, i, count);
+    }
+}
+
+/* ── Longest header ─────────────────────────────────────────────────── */
+
+static void check_longest_header(void)
+{
+    char tag[LOG_CODEC_TAG_MAX_LEN];
+    for (size_t i = 0; i < sizeof(tag); i++) {
+        tag[i] = (char)('a' + i % 26);
+    }
+    const uint32_t ts = 4294967295u;
+    const size_t max = LOG_CODEC_HEADER_MAX(LOG_CODEC_TAG_MAX_LEN);
+
+    /* Formatting fills the buffer exactly */
+    char *header = malloc(max);     /* Heap, so ASan guards its end */
+    size_t n = log_codec_format_header(header, 'W', ts, tag, sizeof(tag));
+    CHECK(n == max, "longest header is %zu bytes, LOG_CODEC_HEADER_MAX gives %zu", n, max);
+    CHECK(memcmp(header, "W (4294967295) ", 15) == 0 && memcmp(header + n - 2, ": ", 2) == 0,
+          "longest header: \"%.*s\"", (int)n, header);
+
+    /* A line with that header matches */
+    char line[256];
+    memcpy(line, header, n);
+    memcpy(line + n, "boom", 4);
+    CHECK(log_codec_header_matches(line, n, 'W', ts, tag, sizeof(tag)),
+          "longest header doesn't match itself");
+
+    /* Round trip, into a buffer of exactly the line's size, then one short */
+    log_codec_encoder_t enc;
+    log_codec_encoder_reset(&enc);
+    log_codec_line_t l = {
+        .level = 'W', .header = true, .timestamp_ms = ts, .tag_id = 7,
+        .tag = tag, .tag_len = sizeof(tag), .text = "boom", .text_len = 4,
+    };
+    size_t fill = log_codec_encode_line(&enc, s_records, sizeof(s_records), &l);
+    fill += log_codec_encode_line(&enc, s_records + fill, sizeof(s_records) - fill, &l);
+    log_codec_decoder_t dec;
+    if (seal_and_open(&enc, fill, &dec)) {
+        char *out = malloc(n + 4);
+        log_codec_decoded_t d;
+        bool ok = log_codec_decode_line(&dec, out, n + 4, &d);
+        CHECK(ok && d.len == n + 4 && memcmp(out, line, n + 4) == 0 && d.timestamp_ms == ts,
+              "longest header line doesn't decode");
+        free(out);
+
+        out = malloc(max - 1);
+        CHECK(!log_codec_decode_line(&dec, out, max - 1, &d),
+              "header decoded into a buffer one byte short");
+        free(out);
+    }
+    free(header);
+}
+
+/* ── Out of tag numbers ─────────────────────────────────────────────── */
+
+static void check_out_of_tags(void)
+{
+    log_codec_encoder_t enc;
+    log_codec_encoder_reset(&enc);
+    static char names[LOG_CODEC_MAX_TAGS][12];
+    static char want[LOG_CODEC_MAX_TAGS + 2][64];
+    size_t fill = 0;
+    int count = 0;
+
+    /* 255 tags over two generations use up the block's tag numbers */
+    for (int i = 0; i < LOG_CODEC_MAX_TAGS - 1; i++) {
+        if (i == 200) {
+            log_codec_encoder_set_tag_gen(&enc, 1);
+        }
+        uint16_t id = (uint16_t)(i < 200 ? i : i - 200);
+        snprintf(names[i], sizeof(names[i]), "T%u", (unsigned)i);
+        log_codec_line_t l = {
+            .level = 'I', .header = true, .timestamp_ms = (uint32_t)i, .tag_id = id,
+            .tag = names[i], .tag_len = (uint8_t)strlen(names[i]), .text = "x", .text_len = 1,
+        };
+        fill += log_codec_encode_line(&enc, s_records + fill, sizeof(s_records) - fill, &l);
+        size_t n = log_codec_format_header(want[count], 'I', l.timestamp_ms, l.tag, l.tag_len);
+        want[count++][n] = 'x';
+    }
+
+    /* A new tag is refused, and goes again as text, as the callers do */
+    static const char text[] = "W (5000) late: new tag";
+    log_codec_line_t l = {
+        .level = 'W', .header = true, .timestamp_ms = 5000, .tag_id = 100,
+        .tag = "late", .tag_len = 4, .text = "new tag", .text_len = 7,
+    };
+    size_t n = log_codec_encode_line(&enc, s_records + fill, sizeof(s_records) - fill, &l);
+    CHECK(n == 0, "256th tag in a block encoded");
+    l.header = false;
+    l.text = text;
+    l.text_len = sizeof(text) - 1;
+    fill += log_codec_encode_line(&enc, s_records + fill, sizeof(s_records) - fill, &l);
+    strcpy(want[count++], text);
+
+    /* A known tag after it keeps its timestamp */
+    l = (log_codec_line_t) {
+        .level = 'I', .header = true, .timestamp_ms = 1001, .tag_id = 10,
+        .tag = names[210], .tag_len = (uint8_t)strlen(names[210]), .text = "z", .text_len = 1,
+    };
+    fill += log_codec_encode_line(&enc, s_records + fill, sizeof(s_records) - fill, &l);
+    n = log_codec_format_header(want[count], 'I', 1001, l.tag, l.tag_len);
+    want[count++][n] = 'z';
+
+    log_codec_decoder_t dec;
+    if (!seal_and_open(&enc, fill, &dec)) {
+        return;
+    }
+    char out[128];
+    log_codec_decoded_t d;
+    int i = 0;
+    while (log_codec_decode_line(&dec, out, sizeof(out), &d)) {
+        CHECK(i < count && d.len == strlen(want[i]) && memcmp(out, want[i], d.len) == 0,
+              "out of tags, line %d: \"%.*s\", want \"%s\"", i, (int)d.len, out,
+              i < count ? want[i] : "");
+        i++;
+    }
+    CHECK(i == count, "out of tags: decoded %d of %d lines", i, count);
+}
+
+int main(void)
+{
+    check_round_trip();
+    check_longest_header();
+    check_out_of_tags();
+    printf("codec test: %s (%d failures)\n", s_failures ? "FAILED" : "PASSED", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,312 @@
+/*
+ * framer_bench — check the line framer against a byte-at-a-time framer,
+ * then time both on a serial stream
+ *
+ * Build and run on the host (from field-tool/test/host):
+ *   cc -O2 -Istubs -I../../main -I../../main/serial -o framer_bench \
+ *      framer_bench.c ../../main/serial/line_framer.c
+ *   ./framer_bench [capture.bin]
+ *
+ * The check feeds streams mixing CR, LF, CRLF, LFCR, blank lines and
+ * lines at, just over and far over FT_LOG_LINE_MAX_LEN, split at every
+ * position and in random chunks starting at every offset within a word,
+ * so line ends land on both sides of chunk and word boundaries. The lines
+ * and the truncation counters must match the reference exactly.
+ *
+ * The benchmark replays a captured stream (raw bytes as read from the
+ * UART) if one is given, else 64 MB of generated ESP-IDF-style lines, in
+ * random chunks of up to 2 KB as the RX task reads them. Exits non-zero
+ * if the check fails.
+ */
+
+#include "line_framer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_BYTES     (64u << 20)
+#define MAX_CHUNK       (2048)
+
+/* ── Line records ───────────────────────────────────────────────────── */
+
+typedef struct {
+    char    *text;              /* All lines back to back */
+    size_t  *lens;
+    size_t   count;
+    size_t   bytes;
+    size_t   cap_lines;
+    size_t   cap_bytes;
+    uint32_t truncated;
+    uint32_t truncated_bytes;
+} lines_t;
+
+static void lines_add(lines_t *l, const char *line, size_t len)
+{
+    if (l->count == l->cap_lines) {
+        l->cap_lines = l->cap_lines ? l->cap_lines * 2 : 256;
+        l->lens = realloc(l->lens, l->cap_lines * sizeof(*l->lens));
+    }
+    if (l->bytes + len > l->cap_bytes) {
+        l->cap_bytes = (l->bytes + len) * 2;
+        l->text = realloc(l->text, l->cap_bytes);
+    }
+    memcpy(l->text + l->bytes, line, len);
+    l->lens[l->count++] = len;
+    l->bytes += len;
+}
+
+static void lines_clear(lines_t *l)
+{
+    l->count = 0;
+    l->bytes = 0;
+    l->truncated = 0;
+    l->truncated_bytes = 0;
+}
+
+static bool lines_equal(const lines_t *a, const lines_t *b)
+{
+    return a->count == b->count && a->bytes == b->bytes && a->truncated == b->truncated &&
+           a->truncated_bytes == b->truncated_bytes &&
+           memcmp(a->lens, b->lens, a->count * sizeof(*a->lens)) == 0 &&
+           memcmp(a->text, b->text, a->bytes) == 0;
+}
+
+static void record_line(char *line, size_t len, void *ctx)
+{
+    lines_add(ctx, line, len);
+}
+
+/* ── Reference framer ───────────────────────────────────────────────── */
+
+/* What the RX task did before the framer: one byte at a time into a
+ * line buffer, cut at the max length, blank lines skipped */
+typedef struct {
+    char   line[FT_LOG_LINE_MAX_LEN];
+    size_t len;
+    size_t dropped;             /* Bytes past the max length in this line */
+} ref_framer_t;
+
+static void ref_end_line(ref_framer_t *r, lines_t *out)
+{
+    if (r->len > 0) {
+        lines_add(out, r->line, r->len);
+        if (r->dropped > 0) {
+            out->truncated++;
+            out->truncated_bytes += r->dropped;
+        }
+    }
+    r->len = 0;
+    r->dropped = 0;
+}
+
+static void ref_feed(ref_framer_t *r, const char *data, size_t len, lines_t *out)
+{
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\n' || c == '\r') {
+            ref_end_line(r, out);
+        } else if (r->len < sizeof(r->line)) {
+            r->line[r->len++] = c;
+        } else {
+            r->dropped++;
+        }
+    }
+}
+
+/* ── Correctness ────────────────────────────────────────────────────── */
+
+static unsigned s_rng = 1;
+
+static unsigned rnd(unsigned n)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (s_rng >> 8) % n;
+}
+
+/* Lines of awkward lengths with every kind of line ending */
+static size_t make_stream(char *out, size_t cap, bool small)
+{
+    static const char *const eols[] = { "\n", "\r", "\r\n", "\n\r", "\n\n", "\r\r\n" };
+    static const size_t lens[] = {
+        1, 2, 7, 8, 9, 15, 16, 17,
+        FT_LOG_LINE_MAX_LEN - 1, FT_LOG_LINE_MAX_LEN, FT_LOG_LINE_MAX_LEN + 1,
+        FT_LOG_LINE_MAX_LEN * 3 + 5,
+    };
+    size_t n = 0;
+    size_t line = 0;
+    while (true) {
+        size_t len = small ? 1 + rnd(12) : lens[rnd(sizeof(lens) / sizeof(lens[0]))];
+        const char *eol = eols[rnd(sizeof(eols) / sizeof(eols[0]))];
+        if (n + len + strlen(eol) > cap) {
+            break;
+        }
+        for (size_t i = 0; i < len; i++) {
+            out[n++] = (char)('a' + (line + i) % 26);
+        }
+        memcpy(out + n, eol, strlen(eol));
+        n += strlen(eol);
+        line++;
+    }
+    if (n < cap) {
+        out[n++] = 'z';         /* Unterminated last line, for the flush */
+    }
+    return n;
+}
+
+static void ref_frame(const char *data, size_t len, lines_t *out)
+{
+    ref_framer_t r = { .len = 0 };
+    lines_clear(out);
+    ref_feed(&r, data, len, out);
+    ref_end_line(&r, out);
+}
+
+/* Feed data in the given chunk sizes, starting at an offset into a
+ * word-aligned buffer, and flush at the end */
+static void framer_frame(const char *data, size_t len, const size_t *chunks, size_t n_chunks,
+                         size_t align, lines_t *out)
+{
+    static _Alignas(8) char buf[8 + 64 * 1024];
+    line_framer_t framer;
+    lines_clear(out);
+    line_framer_init(&framer, record_line, out);
+    memcpy(buf + align, data, len);
+    size_t pos = 0;
+    for (size_t i = 0; i < n_chunks && pos < len; i++) {
+        size_t c = chunks[i] < len - pos ? chunks[i] : len - pos;
+        line_framer_feed(&framer, buf + align + pos, c);
+        pos += c;
+    }
+    line_framer_flush(&framer);
+    out->truncated = framer.truncated;
+    out->truncated_bytes = framer.truncated_bytes;
+}
+
+static int check_framer(void)
+{
+    static char stream[16 * 1024];
+    static lines_t want, got;
+    size_t chunks[MAX_CHUNK];
+    int failures = 0;
+
+    /* Short lines split in two at every position and every alignment */
+    for (int round = 0; round < 20; round++) {
+        size_t len = make_stream(stream, 200, true);
+        ref_frame(stream, len, &want);
+        for (size_t split = 0; split <= len; split++) {
+            for (size_t align = 0; align < 8; align++) {
+                chunks[0] = split;
+                chunks[1] = len - split;
+                framer_frame(stream, len, chunks, 2, align, &got);
+                if (!lines_equal(&want, &got)) {
+                    if (failures++ < 5) {
+                        printf("FAIL split at %zu, align %zu (round %d): %zu lines, want %zu\n",
+                               split, align, round, got.count, want.count);
+                    }
+                }
+            }
+        }
+    }
+
+    /* Long and over-long lines in random chunks, including 1-byte ones */
+    for (int round = 0; round < 500; round++) {
+        size_t len = make_stream(stream, sizeof(stream), false);
+        ref_frame(stream, len, &want);
+        size_t n = 0;
+        for (size_t pos = 0; pos < len && n < MAX_CHUNK; n++) {
+            chunks[n] = rnd(4) == 0 ? 1 + rnd(3) : 1 + rnd(FT_LOG_LINE_MAX_LEN * 2);
+            pos += chunks[n];
+        }
+        framer_frame(stream, len, chunks, n, round % 8, &got);
+        if (!lines_equal(&want, &got)) {
+            if (failures++ < 10) {
+                printf("FAIL random chunks (round %d): %zu lines %u cut, want %zu lines %u cut\n",
+                       round, got.count, (unsigned)got.truncated, want.count,
+                       (unsigned)want.truncated);
+            }
+        }
+    }
+    if (want.truncated == 0) {
+        printf("FAIL: no over-long lines in the check\n");
+        failures++;
+    }
+    return failures;
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────────── */
+
+static size_t generate_capture(char *out, size_t cap)
+{
+    static const char levels[] = "IIIIWED";
+    size_t n = 0;
+    uint32_t ms = 0;
+    while (n + FT_LOG_LINE_MAX_LEN * 2 < cap) {
+        ms += rnd(50);
+        n += sprintf(out + n, "%c (%u) tag%u: ", levels[rnd(7)], (unsigned)ms, rnd(20));
+        size_t len = rnd(10) ? 20 + rnd(100) : 200 + rnd(700);
+        for (size_t i = 0; i < len; i++) {
+            out[n++] = (char)(' ' + rnd(95));
+        }
+        n += sprintf(out + n, rnd(3) ? "\r\n" : "\n");
+    }
+    return n;
+}
+
+static void benchmark(const char *path)
+{
+    char *capture = malloc(BENCH_BYTES);
+    size_t len;
+    if (path != NULL) {
+        FILE *f = fopen(path, "rb");
+        if (f == NULL) {
+            perror(path);
+            exit(2);
+        }
+        len = fread(capture, 1, BENCH_BYTES, f);
+        fclose(f);
+    } else {
+        len = generate_capture(capture, BENCH_BYTES);
+    }
+
+    static lines_t want, got;
+    ref_framer_t *ref = calloc(1, sizeof(*ref));
+    clock_t t = clock();
+    for (size_t pos = 0; pos < len; pos += MAX_CHUNK) {
+        ref_feed(ref, capture + pos, len - pos < MAX_CHUNK ? len - pos : MAX_CHUNK, &want);
+    }
+    ref_end_line(ref, &want);
+    double ref_s = (double)(clock() - t) / CLOCKS_PER_SEC;
+
+    line_framer_t framer;
+    line_framer_init(&framer, record_line, &got);
+    t = clock();
+    for (size_t pos = 0; pos < len;) {
+        size_t c = 1 + rnd(MAX_CHUNK);
+        if (c > len - pos) {
+            c = len - pos;
+        }
+        line_framer_feed(&framer, capture + pos, c);
+        pos += c;
+    }
+    line_framer_flush(&framer);
+    double framer_s = (double)(clock() - t) / CLOCKS_PER_SEC;
+
+    printf("%s: %.1f MB, %zu lines\n", path ? path : "generated", len / 1e6, got.count);
+    printf("  byte at a time  %7.1f MB/s\n", len / 1e6 / ref_s);
+    printf("  line_framer     %7.1f MB/s (%.0fx a 3 Mbaud UART)\n", len / 1e6 / framer_s,
+           len / framer_s / 300000.0);
+    if (got.count != want.count || got.bytes != want.bytes) {
+        printf("  (line counts differ: %zu vs %zu)\n", got.count, want.count);
+    }
+    free(ref);
+    free(capture);
+}
+
+int main(int argc, char **argv)
+{
+    int failures = check_framer();
+    printf("framer check: %s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+    benchmark(argc > 1 ? argv[1] : NULL);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * parser_bench — check log_parser_parse_span() on known lines, then time
+ * it against the parser it replaced
+ *
+ * Build and run on the host (from field-tool/test/host):
+ *   cc -O2 -Istubs -I../../main -I../../main/serial -o parser_bench \
+ *      parser_bench.c ../../main/serial/log_parser.c
+ *   ./parser_bench [capture.log ...]
+ *
+ * The check runs a table of lines with the fields they must parse to:
+ * truncated and split SGR sequences, the tag clamp at
+ * FT_LOG_TAG_MAX_LEN - 1 characters, headers without a "(ts)", and lines
+ * that are not ESP-IDF output at all.
+ *
+ * The benchmark replays the given captures (default: the seed corpus in
+ * corpus/parser) line by line through the old memset/snprintf/strstr
+ * parser and the span parser, and reports lines per second for each.
+ * Exits non-zero if the check fails.
+ */
+
+#include "log_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_LINES     (5 * 1000 * 1000)
+
+/* ── Known lines ────────────────────────────────────────────────────── */
+
+typedef struct {
+    const char *line;
+    bool        parsed;
+    char        level;
+    uint32_t    ts;
+    const char *tag;
+    const char *msg;
+    const char *visible;        /* Line after stripping escapes, NULL if unchanged */
+} parse_case_t;
+
+static const parse_case_t s_cases[] = {
+    /* Plain ESP-IDF lines */
+    { "I (1234) wifi: connected to ap", true, 'I', 1234, "wifi", "connected to ap", NULL },
+    { "W (55123) FLOW: flow=12.34 L/min", true, 'W', 55123, "FLOW", "flow=12.34 L/min", NULL },
+    { "D (0) x: ", true, 'D', 0, "x", "", NULL },
+    { "I (5) x:y: z", true, 'I', 5, "x:y", "z", NULL },
+    { "I (99) a: : b", true, 'I', 99, "a", ": b", NULL },
+    { "I (4294967295) MAIN: max", true, 'I', 4294967295u, "MAIN", "max", NULL },
+    { "I (12:34:56.789) main_task: clock", true, 'I', 45296789, "main_task", "clock", NULL },
+
+    /* Header without a tag separator: the rest is the message */
+    { "I (1) tag:no space", true, 'I', 1, "", "tag:no space", NULL },
+    { "E (7) no colon here", true, 'E', 7, "", "no colon here", NULL },
+    { "I (42)", true, 'I', 42, "", "", NULL },
+
+    /* Tag clamp: FT_LOG_TAG_MAX_LEN - 1 characters at most */
+    { "I (5) ABCDEFGHIJKLMNOPQRSTUVW: 23", true, 'I', 5, "ABCDEFGHIJKLMNOPQRSTUVW", "23", NULL },
+    { "I (5) ABCDEFGHIJKLMNOPQRSTUVWX: 24", true, 'I', 5, "ABCDEFGHIJKLMNOPQRSTUVW", "24", NULL },
+    { "I (5) ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789: long", true, 'I', 5,
+      "ABCDEFGHIJKLMNOPQRSTUVW", "long", NULL },
+
+    /* No "(ts)": not an ESP-IDF header */
+    { "I MAIN: no timestamp", false, ' ', 0, "", "I MAIN: no timestamp", NULL },
+    { "I 1234 MAIN: no parens", false, ' ', 0, "", "I 1234 MAIN: no parens", NULL },
+    { "I (123 MAIN: unclosed", false, ' ', 0, "", "I (123 MAIN: unclosed", NULL },
+    { "W(5) MAIN: no space", false, ' ', 0, "", "W(5) MAIN: no space", NULL },
+    { "I", false, ' ', 0, "", "I", NULL },
+
+    /* Not ESP-IDF output */
+    { "ets Jun  8 2016 00:22:57", false, ' ', 0, "", "ets Jun  8 2016 00:22:57", NULL },
+    { "rst:0x1 (POWERON_RESET),boot:0x13", false, ' ', 0, "",
+      "rst:0x1 (POWERON_RESET),boot:0x13", NULL },
+    { "Guru Meditation Error: Core  0 panic'ed", false, ' ', 0, "",
+      "Guru Meditation Error: Core  0 panic'ed", NULL },
+    { "X (5) MAIN: bad level", false, ' ', 0, "", "X (5) MAIN: bad level", NULL },
+    { "i (5) MAIN: lower case", false, ' ', 0, "", "i (5) MAIN: lower case", NULL },
+    { "", false, ' ', 0, "", "", NULL },
+
+    /* Colors (CONFIG_LOG_COLORS) */
+    { "\033[0;32mI (7) col: green\033[0m", true, 'I', 7, "col", "green", "I (7) col: green" },
+    { "\033[1;33mW (8) bold: yellow\033[0m", true, 'W', 8, "bold", "yellow", "W (8) bold: yellow" },
+    { "I\033[0m (9) split: esc in header", true, 'I', 9, "split", "esc in header",
+      "I (9) split: esc in header" },
+    { "\033[0;32mI (10) tag\033[0m: esc before colon", true, 'I', 10, "tag", "esc before colon",
+      "I (10) tag: esc before colon" },
+    { "\033[38;5;208mI (12) c: 256 colors", true, 'I', 12, "c", "256 colors",
+      "I (12) c: 256 colors" },
+    { "\033[0;31mpanic, no level\033[0m", false, 'E', 0, "", "panic, no level",
+      "panic, no level" },
+    { "\033[0;93mbright yellow", false, 'W', 0, "", "bright yellow", "bright yellow" },
+
+    /* Truncated SGR sequences, the line cut mid-escape (or mid-header,
+     * where a colored line takes its level from the color) */
+    { "\033[0;3", false, ' ', 0, "", "", "" },
+    { "\033[", false, ' ', 0, "", "", "" },
+    { "\033", false, ' ', 0, "", "", "" },
+    { "\033[0;32", false, ' ', 0, "", "", "" },
+    { "\033[0;32mI (3", false, 'I', 0, "", "I (3", "I (3" },
+    { "I (7) t: msg\033[0;3", true, 'I', 7, "t", "msg", "I (7) t: msg" },
+    { "I (7) t: msg\033[", true, 'I', 7, "t", "msg", "I (7) t: msg" },
+    { "I (7) t: msg\033", true, 'I', 7, "t", "msg", "I (7) t: msg" },
+    { "I (7) t\033[0;3", true, 'I', 7, "", "t", "I (7) t" },
+};
+
+static bool field_is(const char *what, const char *got, size_t got_len, const char *want)
+{
+    if (got_len == strlen(want) && memcmp(got, want, got_len) == 0) {
+        return true;
+    }
+    printf("    %s: got \"%.*s\", want \"%s\"\n", what, (int)got_len, got, want);
+    return false;
+}
+
+static int check_cases(void)
+{
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++) {
+        const parse_case_t *c = &s_cases[i];
+        char line[FT_LOG_LINE_MAX_LEN];
+        size_t len = strlen(c->line);
+        memcpy(line, c->line, len);
+
+        log_span_t span;
+        bool parsed = log_parser_parse_span(line, len, &span);
+        const char *visible = c->visible ? c->visible : c->line;
+
+        bool ok = true;
+        if (parsed != c->parsed || span.level != c->level || span.timestamp_ms != c->ts) {
+            printf("    parsed %d level '%c' ts %u, want %d '%c' %u\n", parsed, span.level,
+                   (unsigned)span.timestamp_ms, c->parsed, c->level, (unsigned)c->ts);
+            ok = false;
+        }
+        ok &= field_is("tag", span.raw + span.tag_off, span.tag_len, c->tag);
+        ok &= field_is("message", span.raw + span.msg_off, log_span_msg_len(&span), c->msg);
+        ok &= field_is("visible", span.raw, span.raw_len, visible);
+        if (!ok) {
+            printf("FAIL case %zu\n", i);
+            failures++;
+        }
+    }
+
+    /* An over-long line is parsed as its first FT_LOG_LINE_MAX_LEN bytes */
+    char line[FT_LOG_LINE_MAX_LEN * 2];
+    int n = sprintf(line, "I (1) LONG: ");
+    memset(line + n, 'x', sizeof(line) - n);
+    log_span_t span;
+    if (!log_parser_parse_span(line, sizeof(line), &span) ||
+        span.raw_len != FT_LOG_LINE_MAX_LEN || log_span_msg_len(&span) != FT_LOG_LINE_MAX_LEN - n) {
+        printf("FAIL over-long line: raw_len %u\n", span.raw_len);
+        failures++;
+    }
+    return failures;
+}
+
+/* ── Baseline ───────────────────────────────────────────────────────── */
+
+/* log_parser_parse() as it was before the span parser */
+static bool baseline_parse(const char *line, log_entry_t *entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->raw, sizeof(entry->raw), "%s", line);
+
+    if (line[0] != 'I' && line[0] != 'W' && line[0] != 'E' &&
+        line[0] != 'D' && line[0] != 'V') {
+        entry->level = ' ';
+        snprintf(entry->message, sizeof(entry->message), "%s", line);
+        return false;
+    }
+    if (line[1] != ' ' || line[2] != '(') {
+        entry->level = ' ';
+        snprintf(entry->message, sizeof(entry->message), "%s", line);
+        return false;
+    }
+    entry->level = line[0];
+
+    const char *ts_start = line + 3;
+    const char *ts_end = strchr(ts_start, ')');
+    if (ts_end == NULL) {
+        entry->level = ' ';
+        snprintf(entry->message, sizeof(entry->message), "%s", line);
+        return false;
+    }
+    entry->timestamp_ms = (uint32_t)strtoul(ts_start, NULL, 10);
+
+    const char *tag_start = ts_end + 2;
+    const char *colon = strstr(tag_start, ": ");
+    if (colon == NULL) {
+        snprintf(entry->message, sizeof(entry->message), "%s", tag_start);
+        return true;
+    }
+    size_t tag_len = colon - tag_start;
+    if (tag_len >= sizeof(entry->tag)) {
+        tag_len = sizeof(entry->tag) - 1;
+    }
+    memcpy(entry->tag, tag_start, tag_len);
+    entry->tag[tag_len] = '\0';
+    snprintf(entry->message, sizeof(entry->message), "%s", colon + 2);
+    return true;
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────────── */
+
+typedef struct {
+    char  **lines;              /* Null-terminated copies */
+    size_t *lens;
+    size_t  count;
+} corpus_t;
+
+static void corpus_load(corpus_t *c, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        exit(2);
+    }
+    char buf[4096];
+    while (fgets(buf, sizeof(buf), f) != NULL) {
+        size_t len = strcspn(buf, "\r\n");
+        if (len == 0) {
+            continue;
+        }
+        if (len > FT_LOG_LINE_MAX_LEN) {
+            len = FT_LOG_LINE_MAX_LEN;
+        }
+        c->lines = realloc(c->lines, (c->count + 1) * sizeof(*c->lines));
+        c->lens = realloc(c->lens, (c->count + 1) * sizeof(*c->lens));
+        c->lines[c->count] = strndup(buf, len);
+        c->lens[c->count] = len;
+        c->count++;
+    }
+    fclose(f);
+}
+
+static void benchmark(const corpus_t *c)
+{
+    static log_entry_t entry;
+    volatile uint32_t sink = 0;
+
+    clock_t t = clock();
+    for (size_t i = 0; i < BENCH_LINES; i++) {
+        size_t k = i % c->count;
+        baseline_parse(c->lines[k], &entry);
+        sink += entry.timestamp_ms;
+    }
+    double before = (double)(clock() - t) / CLOCKS_PER_SEC;
+
+    /* The span parser strips escapes in place, so each pass parses a
+     * fresh copy; the copy is part of the timing */
+    char line[FT_LOG_LINE_MAX_LEN];
+    t = clock();
+    for (size_t i = 0; i < BENCH_LINES; i++) {
+        size_t k = i % c->count;
+        log_span_t span;
+        memcpy(line, c->lines[k], c->lens[k]);
+        log_parser_parse_span(line, c->lens[k], &span);
+        sink += span.timestamp_ms;
+    }
+    double after = (double)(clock() - t) / CLOCKS_PER_SEC;
+
+    printf("%zu corpus lines, %d parses each way\n", c->count, BENCH_LINES);
+    printf("  before (memset/snprintf/strstr)  %6.2f Mlines/s\n", BENCH_LINES / before / 1e6);
+    printf("  log_parser_parse_span            %6.2f Mlines/s\n", BENCH_LINES / after / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    int failures = check_cases();
+    printf("parser check: %s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+
+    corpus_t corpus = { 0 };
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            corpus_load(&corpus, argv[i]);
+        }
+    } else {
+        corpus_load(&corpus, "corpus/parser/esp_idf_boot.log");
+        corpus_load(&corpus, "corpus/parser/edge_cases.log");
+    }
+    benchmark(&corpus);
+    return failures ? 1 : 0;
+}
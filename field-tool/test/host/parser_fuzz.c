@@ -0,0 +1,218 @@
+/*
+ * parser_fuzz — fuzz log_parser_parse_span() and check what it returns
+ *
+ * Standalone, mutating the seed corpus (from field-tool/test/host):
+ *   cc -O1 -g -fsanitize=address,undefined -Istubs -I../../main -I../../main/serial \
+ *      -o parser_fuzz parser_fuzz.c ../../main/serial/log_parser.c
+ *   ./parser_fuzz [iterations] [seed files ...]
+ *
+ * With libFuzzer:
+ *   clang -O1 -g -fsanitize=fuzzer,address,undefined -DFUZZ_LIBFUZZER \
+ *      -Istubs -I../../main -I../../main/serial \
+ *      -o parser_fuzz parser_fuzz.c ../../main/serial/log_parser.c
+ *   ./parser_fuzz corpus/parser
+ *
+ * Each input is split into lines and every line must parse to a span
+ * that stays inside the line, holds no escape bytes, clamps the tag, and
+ * parses to the same fields again once the escapes are gone. The
+ * standalone driver's mutations lean on the bytes the header and escape
+ * states turn on (ESC, '[', ';', 'm', digits, '(', ')', ':', ' ').
+ */
+
+#include "log_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_INPUT   (FT_LOG_LINE_MAX_LEN * 2)
+
+static void fail(const char *what, const char *line, size_t len)
+{
+    fprintf(stderr, "FAIL %s on %zu bytes:", what, len);
+    for (size_t i = 0; i < len; i++) {
+        fprintf(stderr, " %02x", (unsigned char)line[i]);
+    }
+    fprintf(stderr, "\n");
+    abort();
+}
+
+static void check_line(const char *input, size_t len)
+{
+    static char line[MAX_INPUT], again[MAX_INPUT];
+    memcpy(line, input, len);
+
+    log_span_t span;
+    bool parsed = log_parser_parse_span(line, len, &span);
+
+    if (span.raw != line || span.raw_len > len || span.raw_len > FT_LOG_LINE_MAX_LEN) {
+        fail("span outside the line", input, len);
+    }
+    if (memchr(span.raw, '\033', span.raw_len) != NULL) {
+        fail("escape byte left in the span", input, len);
+    }
+    if (span.msg_off > span.raw_len || span.tag_off + span.tag_len > span.raw_len) {
+        fail("field outside the span", input, len);
+    }
+    if (span.tag_len >= FT_LOG_TAG_MAX_LEN) {
+        fail("tag not clamped", input, len);
+    }
+    if (!parsed && (span.msg_off != 0 || span.tag_len != 0 || span.timestamp_ms != 0)) {
+        fail("unparsed line with fields", input, len);
+    }
+    if (parsed && (span.level == ' ' || span.msg_off < 4)) {
+        fail("parsed line without a header", input, len);
+    }
+
+    /* The visible text alone must give the same fields */
+    log_span_t span2;
+    memcpy(again, span.raw, span.raw_len);
+    bool parsed2 = log_parser_parse_span(again, span.raw_len, &span2);
+    if (parsed2 != parsed || span2.raw_len != span.raw_len ||
+        memcmp(again, span.raw, span.raw_len) != 0 || span2.msg_off != span.msg_off ||
+        span2.tag_off != span.tag_off || span2.tag_len != span.tag_len ||
+        span2.timestamp_ms != span.timestamp_ms || (parsed && span2.level != span.level)) {
+        fail("reparse of the visible text differs", input, len);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const char *p = (const char *)data;
+    const char *end = p + size;
+    while (p < end) {
+        const char *nl = memchr(p, '\n', end - p);
+        const char *line_end = nl ? nl : end;
+        size_t len = line_end - p;
+        check_line(p, len < MAX_INPUT ? len : MAX_INPUT);
+        p = line_end + 1;
+    }
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+static unsigned s_rng = 12345;
+
+static unsigned rnd(unsigned n)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (s_rng >> 8) % n;
+}
+
+typedef struct {
+    char  **lines;
+    size_t *lens;
+    size_t  count;
+} seeds_t;
+
+static void seeds_load(seeds_t *s, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        exit(2);
+    }
+    char buf[MAX_INPUT];
+    while (fgets(buf, sizeof(buf), f) != NULL) {
+        size_t len = strcspn(buf, "\n");
+        s->lines = realloc(s->lines, (s->count + 1) * sizeof(*s->lines));
+        s->lens = realloc(s->lens, (s->count + 1) * sizeof(*s->lens));
+        s->lines[s->count] = malloc(len + 1);
+        memcpy(s->lines[s->count], buf, len);
+        s->lens[s->count] = len;
+        s->count++;
+    }
+    fclose(f);
+}
+
+static size_t mutate(char *buf, size_t len)
+{
+    static const char interesting[] = "\033\033[;m0123456789():: \r\t\x80\xff";
+    int rounds = 1 + rnd(4);
+    while (rounds-- > 0) {
+        size_t at = len ? rnd(len + 1) : 0;
+        switch (rnd(6)) {
+        case 0:     /* Overwrite a byte */
+            if (at < len) {
+                buf[at] = interesting[rnd(sizeof(interesting) - 1)];
+            }
+            break;
+        case 1:     /* Insert a byte */
+            if (len < MAX_INPUT) {
+                memmove(buf + at + 1, buf + at, len - at);
+                buf[at] = interesting[rnd(sizeof(interesting) - 1)];
+                len++;
+            }
+            break;
+        case 2:     /* Insert an SGR sequence, maybe cut short */
+        {
+            char sgr[16];
+            int n = snprintf(sgr, sizeof(sgr), "\033[%u;%um", rnd(2), 30 + rnd(70));
+            n = rnd(3) ? n : (int)rnd(n + 1);
+            if (len + n <= MAX_INPUT) {
+                memmove(buf + at + n, buf + at, len - at);
+                memcpy(buf + at, sgr, n);
+                len += n;
+            }
+            break;
+        }
+        case 3:     /* Delete a run */
+            if (at < len) {
+                size_t n = 1 + rnd(len - at);
+                memmove(buf + at, buf + at + n, len - at - n);
+                len -= n;
+            }
+            break;
+        case 4:     /* Cut the line */
+            len = at;
+            break;
+        case 5:     /* Repeat a run, for long tags and over-long lines */
+            if (at < len) {
+                size_t n = 1 + rnd(len - at);
+                size_t times = 1 + rnd(40);
+                while (times-- > 0 && len + n <= MAX_INPUT) {
+                    memmove(buf + at + n, buf + at, len - at);
+                    len += n;
+                }
+            }
+            break;
+        }
+    }
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 2000000;
+    seeds_t seeds = { 0 };
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++) {
+            seeds_load(&seeds, argv[i]);
+        }
+    } else {
+        seeds_load(&seeds, "corpus/parser/esp_idf_boot.log");
+        seeds_load(&seeds, "corpus/parser/edge_cases.log");
+    }
+
+    /* Seeds as they are, then mutated */
+    for (size_t i = 0; i < seeds.count; i++) {
+        LLVMFuzzerTestOneInput((const uint8_t *)seeds.lines[i], seeds.lens[i]);
+    }
+    char buf[MAX_INPUT];
+    for (long i = 0; i < iterations; i++) {
+        size_t k = rnd(seeds.count);
+        memcpy(buf, seeds.lines[k], seeds.lens[k]);
+        size_t len = mutate(buf, seeds.lens[k]);
+        check_line(buf, len);
+    }
+    printf("parser fuzz: %ld mutated lines from %zu seeds, PASSED\n", iterations, seeds.count);
+
+    for (size_t i = 0; i < seeds.count; i++) {
+        free(seeds.lines[i]);
+    }
+    free(seeds.lines);
+    free(seeds.lens);
+    return 0;
+}
+
+#endif
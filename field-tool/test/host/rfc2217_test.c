@@ -0,0 +1,505 @@
+/*
+ * rfc2217_test — run the RFC 2217 server codec against a client over a
+ * socketpair
+ *
+ * Build and run on the host (from field-tool/test/host):
+ *   cc -O1 -g -fsanitize=address,undefined -Istubs -I../../main \
+ *      -o rfc2217_test rfc2217_test.c ../../main/wifi/rfc2217.c
+ *   ./rfc2217_test
+ *
+ * The test plays the client (as pyserial's rfc2217:// does) on one end of
+ * a socketpair; the other end is read by the server side, which decodes
+ * what arrives with rfc2217_decode() and writes its replies back through
+ * the reply callback. Each exchange is also sent split into two segments
+ * at every byte, so Telnet commands, subnegotiations and doubled IACs
+ * cut in half must come out the same. Checked:
+ *
+ *   - the opening offers, and option negotiation answering only changes
+ *     (no loops, refusals for options the server doesn't serve),
+ *   - serial data with escaped 0xFF bytes and other Telnet commands mixed in,
+ *   - rfc2217_escape() doubling IAC, and stopping short of a split pair,
+ *   - SIGNATURE, SET-BAUDRATE (set, query, refused, with an 0xFF byte),
+ *     SET-DATASIZE/PARITY/STOPSIZE,
+ *   - SET-CONTROL DTR on/off (8/9) and RTS on/off (11/12), the state
+ *     queries and the flow control/BREAK answers,
+ *   - PURGE-DATA, and subnegotiations of other options skipped.
+ *
+ * Server replies are the client's command + 100. Exits non-zero on any
+ * failure.
+ */
+
+#include "wifi/rfc2217.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define IAC     (255)
+#define DONT    (254)
+#define DO      (253)
+#define WONT    (252)
+#define WILL    (251)
+#define SB      (250)
+#define SE      (240)
+#define NOP     (241)
+
+#define OPT_BINARY  (0)
+#define OPT_ECHO    (1)
+#define OPT_SGA     (3)
+#define OPT_TTYPE   (24)
+#define COM_PORT    (44)
+
+#define MAX_BYTES   (512)
+
+static int s_failures;
+
+#define CHECK(cond, ...) do {                       \
+    if (!(cond)) {                                  \
+        if (s_failures++ < 20) {                    \
+            printf("FAIL " __VA_ARGS__);            \
+            printf("\n");                           \
+        }                                           \
+    }                                               \
+} while (0)
+
+/* ── Server side ────────────────────────────────────────────────────── */
+
+typedef struct {
+    int  fd;                    /* Server end of the socketpair */
+    bool refuse_line;           /* set_line says no */
+    int  line_calls;
+    rfc2217_line_t last_line;
+    int  control_calls;
+    bool dtr;
+    bool rts;
+    int  purge_calls;
+    uint8_t last_purge;
+} server_t;
+
+static void on_reply(const uint8_t *data, size_t len, void *ctx)
+{
+    server_t *s = ctx;
+    CHECK(write(s->fd, data, len) == (ssize_t)len, "reply write");
+}
+
+static bool on_set_line(const rfc2217_line_t *line, void *ctx)
+{
+    server_t *s = ctx;
+    s->line_calls++;
+    s->last_line = *line;
+    return !s->refuse_line;
+}
+
+static void on_set_control(bool dtr, bool rts, void *ctx)
+{
+    server_t *s = ctx;
+    s->control_calls++;
+    s->dtr = dtr;
+    s->rts = rts;
+}
+
+static void on_purge(uint8_t which, void *ctx)
+{
+    server_t *s = ctx;
+    s->purge_calls++;
+    s->last_purge = which;
+}
+
+static const rfc2217_line_t s_default_line = {
+    .baud = 115200, .data_bits = 8, .parity = RFC2217_PARITY_NONE, .stop_bits = RFC2217_STOP_1,
+};
+
+typedef struct {
+    int       fds[2];           /* [0] client, [1] server */
+    server_t  server;
+    rfc2217_t t;
+} session_t;
+
+/* A session past the opening offers, whose replies are read and dropped */
+static void session_open(session_t *s)
+{
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, s->fds) != 0) {
+        perror("socketpair");
+        exit(2);
+    }
+    memset(&s->server, 0, sizeof(s->server));
+    s->server.fd = s->fds[1];
+    rfc2217_ops_t ops = {
+        .reply = on_reply,
+        .set_line = on_set_line,
+        .set_control = on_set_control,
+        .purge = on_purge,
+        .ctx = &s->server,
+    };
+    rfc2217_init(&s->t, &ops, &s_default_line);
+}
+
+static void session_close(session_t *s)
+{
+    close(s->fds[0]);
+    close(s->fds[1]);
+}
+
+/* Whatever is waiting on a socket (never blocks) */
+static size_t drain(int fd, uint8_t *out, size_t cap)
+{
+    size_t n = 0;
+    while (n < cap) {
+        ssize_t r = recv(fd, out + n, cap - n, MSG_DONTWAIT);
+        if (r <= 0) {
+            break;
+        }
+        n += r;
+    }
+    return n;
+}
+
+/* The server reads one segment off its socket and decodes it */
+static size_t server_receive(session_t *s, size_t expect, uint8_t *data)
+{
+    uint8_t buf[MAX_BYTES];
+    size_t n = drain(s->fds[1], buf, sizeof(buf));
+    CHECK(n == expect, "server read %zu of %zu bytes", n, expect);
+    size_t w = rfc2217_decode(&s->t, buf, n);
+    memcpy(data, buf, w);
+    return w;
+}
+
+/*
+ * Client sends bytes, split into two segments at @p split (the server
+ * reads and decodes each in turn); collects the serial data and the
+ * replies the client gets back.
+ */
+static void exchange(session_t *s, const uint8_t *out, size_t len, size_t split,
+                     uint8_t *data, size_t *data_len, uint8_t *reply, size_t *reply_len)
+{
+    *data_len = 0;
+    size_t parts[2] = { split, len - split };
+    const uint8_t *p = out;
+    for (int i = 0; i < 2; i++) {
+        if (parts[i] == 0) {
+            continue;
+        }
+        CHECK(write(s->fds[0], p, parts[i]) == (ssize_t)parts[i], "client write");
+        *data_len += server_receive(s, parts[i], data + *data_len);
+        p += parts[i];
+    }
+    *reply_len = drain(s->fds[0], reply, MAX_BYTES);
+}
+
+static void dump(const char *what, const uint8_t *p, size_t len)
+{
+    printf("  %s:", what);
+    for (size_t i = 0; i < len; i++) {
+        printf(" %u", p[i]);
+    }
+    printf("\n");
+}
+
+/*
+ * Run one exchange in a fresh session after @p setup bytes (whose
+ * replies are dropped), whole and split at every byte, and check the
+ * data, the replies and (through @p after) the callbacks each time.
+ */
+typedef void (*after_fn_t)(const session_t *s, const char *name, size_t split);
+
+static void expect_exchange(const char *name, const uint8_t *setup, size_t setup_len,
+                            const uint8_t *out, size_t len,
+                            const uint8_t *want_data, size_t want_data_len,
+                            const uint8_t *want_reply, size_t want_reply_len,
+                            bool refuse_line, after_fn_t after)
+{
+    for (size_t split = 0; split < len; split++) {
+        session_t s;
+        session_open(&s);
+        uint8_t data[MAX_BYTES], reply[MAX_BYTES];
+        size_t data_len, reply_len;
+        if (setup_len > 0) {
+            exchange(&s, setup, setup_len, setup_len, data, &data_len, reply, &reply_len);
+        }
+        s.server.refuse_line = refuse_line;
+        s.server.line_calls = s.server.control_calls = s.server.purge_calls = 0;
+
+        exchange(&s, out, len, split, data, &data_len, reply, &reply_len);
+        bool data_ok = data_len == want_data_len &&
+                       (data_len == 0 || memcmp(data, want_data, data_len) == 0);
+        bool reply_ok = reply_len == want_reply_len &&
+                        (reply_len == 0 || memcmp(reply, want_reply, reply_len) == 0);
+        CHECK(data_ok && reply_ok, "%s, split at %zu: %s", name, split,
+              data_ok ? "replies differ" : "data differs");
+        if (!data_ok || !reply_ok) {
+            dump("data ", data, data_len);
+            dump("want ", want_data, want_data_len);
+            dump("reply", reply, reply_len);
+            dump("want ", want_reply, want_reply_len);
+        }
+        if (after != NULL) {
+            after(&s, name, split);
+        }
+        session_close(&s);
+    }
+}
+
+#define BYTES(...)      ((const uint8_t[]) { __VA_ARGS__ })
+#define LEN(...)        sizeof((const uint8_t[]) { __VA_ARGS__ })
+#define ARG(...)        BYTES(__VA_ARGS__), LEN(__VA_ARGS__)
+#define NONE            NULL, 0
+
+/* ── Negotiation ────────────────────────────────────────────────────── */
+
+/* What pyserial sends first */
+static const uint8_t s_client_hello[] = {
+    IAC, WILL, OPT_BINARY, IAC, DO, OPT_BINARY, IAC, WILL, OPT_SGA, IAC, DO, OPT_SGA,
+    IAC, WILL, COM_PORT,
+};
+
+static void check_start(void)
+{
+    session_t s;
+    session_open(&s);
+    rfc2217_start(&s.t);
+    uint8_t reply[MAX_BYTES];
+    size_t n = drain(s.fds[0], reply, sizeof(reply));
+    static const uint8_t want[] = {
+        IAC, WILL, OPT_BINARY, IAC, DO, OPT_BINARY, IAC, WILL, OPT_SGA, IAC, DO, OPT_SGA,
+        IAC, DO, COM_PORT,
+    };
+    CHECK(n == sizeof(want) && memcmp(reply, want, n) == 0, "opening offers");
+    if (n != sizeof(want) || memcmp(reply, want, n) != 0) {
+        dump("reply", reply, n);
+    }
+
+    /* The client agreeing to all of it gets no answer: nothing changed */
+    uint8_t data[MAX_BYTES];
+    size_t data_len, reply_len;
+    exchange(&s, s_client_hello, sizeof(s_client_hello), sizeof(s_client_hello),
+             data, &data_len, reply, &reply_len);
+    CHECK(data_len == 0 && reply_len == 0, "agreeing to the offers was answered (%zu bytes)",
+          reply_len);
+    session_close(&s);
+}
+
+static void check_negotiation(void)
+{
+    /* A client that asks first gets each answer once */
+    expect_exchange("client hello", NONE, s_client_hello, sizeof(s_client_hello), NONE,
+                    ARG(IAC, DO, OPT_BINARY, IAC, WILL, OPT_BINARY, IAC, DO, OPT_SGA,
+                        IAC, WILL, OPT_SGA, IAC, DO, COM_PORT), false, NULL);
+    expect_exchange("repeated hello", s_client_hello, sizeof(s_client_hello),
+                    s_client_hello, sizeof(s_client_hello), NONE, NONE, false, NULL);
+
+    /* ECHO is served but not accepted from the client; unknown options are refused */
+    expect_exchange("echo and unknown", NONE,
+                    ARG(IAC, DO, OPT_ECHO, IAC, WILL, OPT_ECHO, IAC, DO, 99, IAC, WILL, 99),
+                    NONE,
+                    ARG(IAC, WILL, OPT_ECHO, IAC, DONT, OPT_ECHO, IAC, WONT, 99, IAC, DONT, 99),
+                    false, NULL);
+
+    /* Turning options off is acknowledged once */
+    expect_exchange("options off", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, DONT, OPT_SGA, IAC, DONT, OPT_SGA, IAC, WONT, OPT_BINARY,
+                        IAC, WONT, OPT_BINARY, IAC, WONT, COM_PORT, IAC, WONT, COM_PORT),
+                    NONE,
+                    ARG(IAC, WONT, OPT_SGA, IAC, DONT, OPT_BINARY, IAC, DONT, COM_PORT),
+                    false, NULL);
+}
+
+/* ── Data ───────────────────────────────────────────────────────────── */
+
+static void check_data(void)
+{
+    /* Escaped 0xFF, commands that carry no data, another option's
+     * subnegotiation (with its own doubled IAC) in between */
+    expect_exchange("data", s_client_hello, sizeof(s_client_hello),
+                    ARG('a', IAC, IAC, 'b', IAC, NOP, 'c', IAC, IAC, IAC, IAC,
+                        IAC, SB, OPT_TTYPE, 0, 'x', IAC, IAC, 'y', IAC, SE, 'd', 0, 13, 10),
+                    ARG('a', IAC, 'b', 'c', IAC, IAC, 'd', 0, 13, 10),
+                    NONE, false, NULL);
+
+    /* Escaping doubles IAC, and stops before a pair that doesn't fit */
+    const uint8_t in[] = { 'a', IAC, 'b', IAC, IAC };
+    uint8_t out[16];
+    size_t consumed;
+    size_t n = rfc2217_escape(in, sizeof(in), out, sizeof(out), &consumed);
+    CHECK(consumed == sizeof(in) && n == 8 &&
+          memcmp(out, BYTES('a', IAC, IAC, 'b', IAC, IAC, IAC, IAC), 8) == 0, "escape");
+    n = rfc2217_escape(in, sizeof(in), out, 2, &consumed);
+    CHECK(consumed == 1 && n == 1, "escape into 2 bytes: %zu consumed, %zu out", consumed, n);
+    n = rfc2217_escape(in, sizeof(in), out, 3, &consumed);
+    CHECK(consumed == 2 && n == 3, "escape into 3 bytes: %zu consumed, %zu out", consumed, n);
+
+    /* Escaped on one side, decoded on the other, every byte value comes through */
+    session_t s;
+    session_open(&s);
+    uint8_t all[256], wire[512], data[MAX_BYTES];
+    for (int i = 0; i < 256; i++) {
+        all[i] = (uint8_t)i;
+    }
+    n = rfc2217_escape(all, sizeof(all), wire, sizeof(wire), &consumed);
+    CHECK(consumed == 256 && n == 257, "escape all bytes: %zu out", n);
+    CHECK(write(s.fds[0], wire, n) == (ssize_t)n, "client write");
+    size_t got = server_receive(&s, n, data);
+    CHECK(got == 256 && memcmp(data, all, 256) == 0, "all byte values: %zu decoded", got);
+    session_close(&s);
+}
+
+/* ── Com-port commands ──────────────────────────────────────────────── */
+
+static void after_baud_set(const session_t *s, const char *name, size_t split)
+{
+    CHECK(s->server.line_calls == 1 && s->server.last_line.baud == 921600 &&
+          s->t.line.baud == 921600 && s->t.line.data_bits == 8,
+          "%s, split at %zu: %d set_line calls, baud %lu", name, split, s->server.line_calls,
+          (unsigned long)s->t.line.baud);
+}
+
+static void after_baud_iac(const session_t *s, const char *name, size_t split)
+{
+    CHECK(s->server.line_calls == 1 && s->t.line.baud == 0x0001C1FF,
+          "%s, split at %zu: baud %lu", name, split, (unsigned long)s->t.line.baud);
+}
+
+static void after_no_line_change(const session_t *s, const char *name, size_t split)
+{
+    CHECK(s->t.line.baud == 115200, "%s, split at %zu: baud %lu", name, split,
+          (unsigned long)s->t.line.baud);
+}
+
+static void after_line_bits(const session_t *s, const char *name, size_t split)
+{
+    CHECK(s->server.line_calls == 3 && s->t.line.data_bits == 7 &&
+          s->t.line.parity == RFC2217_PARITY_EVEN && s->t.line.stop_bits == RFC2217_STOP_2,
+          "%s, split at %zu: %d calls, %u%u%u", name, split, s->server.line_calls,
+          s->t.line.data_bits, s->t.line.parity, s->t.line.stop_bits);
+}
+
+static void check_line_commands(void)
+{
+    expect_exchange("signature", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 0, IAC, SE), NONE,
+                    ARG(IAC, SB, COM_PORT, 100, 'E', 'S', 'P', '3', '2', '-', 'P', '4', ' ',
+                        'f', 'i', 'e', 'l', 'd', ' ', 't', 'o', 'o', 'l', IAC, SE),
+                    false, NULL);
+
+    /* 921600 = 00 0E 10 00 */
+    expect_exchange("set baud", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 1, 0x00, 0x0E, 0x10, 0x00, IAC, SE), NONE,
+                    ARG(IAC, SB, COM_PORT, 101, 0x00, 0x0E, 0x10, 0x00, IAC, SE),
+                    false, after_baud_set);
+
+    /* A rate with an 0xFF byte is doubled both ways */
+    expect_exchange("set baud with IAC", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 1, 0x00, 0x01, 0xC1, IAC, IAC, IAC, SE), NONE,
+                    ARG(IAC, SB, COM_PORT, 101, 0x00, 0x01, 0xC1, IAC, IAC, IAC, SE),
+                    false, after_baud_iac);
+
+    /* 0 asks for the current rate (115200 = 00 01 C2 00); a refused rate
+     * is answered with the old one */
+    expect_exchange("query baud", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 1, 0, 0, 0, 0, IAC, SE), NONE,
+                    ARG(IAC, SB, COM_PORT, 101, 0x00, 0x01, 0xC2, 0x00, IAC, SE),
+                    false, after_no_line_change);
+    expect_exchange("refused baud", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 1, 0x00, 0x0E, 0x10, 0x00, IAC, SE), NONE,
+                    ARG(IAC, SB, COM_PORT, 101, 0x00, 0x01, 0xC2, 0x00, IAC, SE),
+                    true, after_no_line_change);
+
+    expect_exchange("data bits, parity, stop bits", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 2, 7, IAC, SE, IAC, SB, COM_PORT, 3, 3, IAC, SE,
+                        IAC, SB, COM_PORT, 4, 2, IAC, SE,
+                        IAC, SB, COM_PORT, 2, 9, IAC, SE),      /* Out of range: kept */
+                    NONE,
+                    ARG(IAC, SB, COM_PORT, 102, 7, IAC, SE, IAC, SB, COM_PORT, 103, 3, IAC, SE,
+                        IAC, SB, COM_PORT, 104, 2, IAC, SE, IAC, SB, COM_PORT, 102, 7, IAC, SE),
+                    false, after_line_bits);
+}
+
+static void after_control(const session_t *s, const char *name, size_t split)
+{
+    /* DTR on, on again (no call), RTS on, DTR off, RTS off */
+    CHECK(s->server.control_calls == 4 && !s->server.dtr && !s->server.rts &&
+          !s->t.dtr && !s->t.rts,
+          "%s, split at %zu: %d set_control calls, DTR %d RTS %d", name, split,
+          s->server.control_calls, s->server.dtr, s->server.rts);
+}
+
+static void after_dtr_on(const session_t *s, const char *name, size_t split)
+{
+    CHECK(s->server.control_calls == 1 && s->server.dtr && !s->server.rts,
+          "%s, split at %zu: DTR %d RTS %d", name, split, s->server.dtr, s->server.rts);
+}
+
+static void check_control(void)
+{
+    expect_exchange("DTR and RTS", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 5, 8, IAC, SE, IAC, SB, COM_PORT, 5, 8, IAC, SE,
+                        IAC, SB, COM_PORT, 5, 11, IAC, SE, IAC, SB, COM_PORT, 5, 7, IAC, SE,
+                        IAC, SB, COM_PORT, 5, 10, IAC, SE, IAC, SB, COM_PORT, 5, 9, IAC, SE,
+                        IAC, SB, COM_PORT, 5, 12, IAC, SE, IAC, SB, COM_PORT, 5, 7, IAC, SE,
+                        IAC, SB, COM_PORT, 5, 10, IAC, SE),
+                    NONE,
+                    ARG(IAC, SB, COM_PORT, 105, 8, IAC, SE, IAC, SB, COM_PORT, 105, 8, IAC, SE,
+                        IAC, SB, COM_PORT, 105, 11, IAC, SE, IAC, SB, COM_PORT, 105, 8, IAC, SE,
+                        IAC, SB, COM_PORT, 105, 11, IAC, SE, IAC, SB, COM_PORT, 105, 9, IAC, SE,
+                        IAC, SB, COM_PORT, 105, 12, IAC, SE, IAC, SB, COM_PORT, 105, 9, IAC, SE,
+                        IAC, SB, COM_PORT, 105, 12, IAC, SE),
+                    false, after_control);
+
+    /* The esptool reset dance: DTR on with RTS released */
+    expect_exchange("DTR on", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 5, 8, IAC, SE, IAC, SB, COM_PORT, 5, 12, IAC, SE),
+                    NONE,
+                    ARG(IAC, SB, COM_PORT, 105, 8, IAC, SE, IAC, SB, COM_PORT, 105, 12, IAC, SE),
+                    false, after_dtr_on);
+
+    /* No flow control or BREAK on this port */
+    expect_exchange("flow and break", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 5, 0, IAC, SE, IAC, SB, COM_PORT, 5, 3, IAC, SE,
+                        IAC, SB, COM_PORT, 5, 5, IAC, SE, IAC, SB, COM_PORT, 5, 13, IAC, SE),
+                    NONE,
+                    ARG(IAC, SB, COM_PORT, 105, 1, IAC, SE, IAC, SB, COM_PORT, 105, 1, IAC, SE,
+                        IAC, SB, COM_PORT, 105, 6, IAC, SE, IAC, SB, COM_PORT, 105, 14, IAC, SE),
+                    false, NULL);
+}
+
+static void after_purge(const session_t *s, const char *name, size_t split)
+{
+    CHECK(s->server.purge_calls == 3 && s->server.last_purge == RFC2217_PURGE_BOTH,
+          "%s, split at %zu: %d purge calls, last %u", name, split, s->server.purge_calls,
+          s->server.last_purge);
+}
+
+static void check_purge(void)
+{
+    expect_exchange("purge", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 12, 1, IAC, SE, IAC, SB, COM_PORT, 12, 2, IAC, SE,
+                        IAC, SB, COM_PORT, 12, 4, IAC, SE,      /* Unknown: no call */
+                        IAC, SB, COM_PORT, 12, 3, IAC, SE),
+                    NONE,
+                    ARG(IAC, SB, COM_PORT, 112, 1, IAC, SE, IAC, SB, COM_PORT, 112, 2, IAC, SE,
+                        IAC, SB, COM_PORT, 112, 4, IAC, SE, IAC, SB, COM_PORT, 112, 3, IAC, SE),
+                    false, after_purge);
+
+    /* Modem and line state polls, and the masks echoed */
+    expect_exchange("polls and masks", s_client_hello, sizeof(s_client_hello),
+                    ARG(IAC, SB, COM_PORT, 6, IAC, SE, IAC, SB, COM_PORT, 7, IAC, SE,
+                        IAC, SB, COM_PORT, 11, IAC, IAC, IAC, SE),
+                    NONE,
+                    ARG(IAC, SB, COM_PORT, 106, 0, IAC, SE, IAC, SB, COM_PORT, 107, 0, IAC, SE,
+                        IAC, SB, COM_PORT, 111, IAC, IAC, IAC, SE),
+                    false, NULL);
+}
+
+int main(void)
+{
+    check_start();
+    check_negotiation();
+    check_data();
+    check_line_commands();
+    check_control();
+    check_purge();
+    printf("rfc2217 test: %s (%d failures)\n", s_failures ? "FAILED" : "PASSED", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,246 @@
+/*
+ * ring_stress — hammer the lock-free log ring from several threads
+ *
+ * Build and run on the host (from field-tool/test/host):
+ *   cc -O2 -pthread -Istubs -I../../main -I../../main/serial -o ring_stress \
+ *      ring_stress.c ../../main/serial/log_ring.c ../../main/serial/log_parser.c \
+ *      ../../main/serial/tag_table.c ../../main/serial/log_codec.c
+ *   ./ring_stress [seconds]
+ *
+ * One writer pushes lines whose bytes are a function of their sequence
+ * number into a small ring, so the arena and the slot table wrap
+ * thousands of times a second, and the sequence numbers start just short
+ * of 2^32 so they wrap during the run too. At the same time:
+ *
+ *   - random readers read arbitrary held sequence numbers,
+ *   - cursor readers tail the ring in order,
+ *   - a clearer drops everything now and then.
+ *
+ * After each clear, and every few thousand lines as after a baud change,
+ * the writer resets the tag table as soon as no line from before the
+ * previous reset is held (as the RX task does), so compact lines of the
+ * previous tag generation are read back while the new one fills.
+ *
+ * Every line a reader gets back as LOG_RING_READ_OK is compared byte for
+ * byte with what was pushed under that number (a torn slot or a line
+ * copied while being overwritten fails this), cursor readers check that
+ * they see strictly consecutive numbers apart from the gaps they are told
+ * about, and the gaps must add up. Exits non-zero on any failure.
+ */
+
+#include "log_ring.h"
+#include "log_parser.h"
+#include "tag_table.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define ARENA_SIZE      (8 * 1024)
+#define SLOT_COUNT      (128)
+#define RANDOM_READERS  (3)
+#define CURSOR_READERS  (3)
+#define SEQ_START       (0u - 20000u)       /* Wraps after 20k lines */
+
+static char s_arena[ARENA_SIZE];
+static log_ring_slot_t s_slots[SLOT_COUNT];
+static log_ring_t s_ring;
+static atomic_bool s_done;
+
+static atomic_ulong s_pushed, s_read_ok, s_read_gone, s_read_pending;
+static atomic_ulong s_cursor_lines, s_cursor_lost, s_clears, s_tag_resets;
+static atomic_bool s_tags_reset_pending;
+static atomic_ulong s_failures;
+
+/* The line pushed as sequence number seq: canonical ESP-IDF lines (stored
+ * compact) mixed with free-form ones (stored verbatim), 20..450 bytes */
+static size_t make_line(uint32_t seq, char *out)
+{
+    int n;
+    if (seq % 5 == 4) {
+        n = sprintf(out, "raw line %u >", (unsigned)seq);
+    } else {
+        n = sprintf(out, "%c (%u) T%02u: m%u ", "IWE"[seq % 3], (unsigned)(seq * 7u),
+                    (unsigned)(seq % 20), (unsigned)seq);
+    }
+    size_t fill = (seq * 37u) % 400u;
+    for (size_t i = 0; i < fill; i++) {
+        out[n + i] = (char)('a' + (seq + i) % 26);
+    }
+    return n + fill;
+}
+
+static void fail(const char *what, uint32_t seq, const log_span_t *span)
+{
+    if (atomic_fetch_add(&s_failures, 1) < 10) {
+        char want[FT_LOG_LINE_MAX_LEN];
+        size_t len = make_line(seq, want);
+        fprintf(stderr, "FAIL %s at seq %u\n  want %.*s\n  got  %.*s\n", what, (unsigned)seq,
+                (int)len, want, span ? (int)span->raw_len : 0, span ? span->raw : "");
+    }
+}
+
+static void check_line(uint32_t seq, const log_span_t *span)
+{
+    char want[FT_LOG_LINE_MAX_LEN];
+    size_t len = make_line(seq, want);
+    if (span->raw_len != len || memcmp(span->raw, want, len) != 0) {
+        fail("torn or wrong bytes", seq, span);
+    } else if (span->sinks != (uint8_t)seq || span->rx_us != (int64_t)seq * 3) {
+        fail("slot metadata mismatch", seq, span);
+    }
+}
+
+static void *writer(void *arg)
+{
+    (void)arg;
+    char line[FT_LOG_LINE_MAX_LEN];
+    uint32_t seq = log_ring_next_seq(&s_ring);
+    uint32_t reset_seq = seq;
+    while (!atomic_load(&s_done)) {
+        if (atomic_load(&s_tags_reset_pending) &&
+            (int32_t)(log_ring_first_seq(&s_ring) - reset_seq) >= 0) {
+            atomic_store(&s_tags_reset_pending, false);
+            reset_seq = log_ring_next_seq(&s_ring);
+            tag_table_reset();
+            atomic_fetch_add(&s_tag_resets, 1);
+        }
+        log_span_t span;
+        size_t len = make_line(seq, line);
+        log_parser_parse_span(line, len, &span);
+        span.tag_id = tag_table_intern(span.raw + span.tag_off, span.tag_len);
+        span.sinks = (uint8_t)seq;
+        span.rx_us = (int64_t)seq * 3;
+        log_ring_push(&s_ring, &span);
+        seq++;
+        atomic_fetch_add_explicit(&s_pushed, 1, memory_order_relaxed);
+        if (seq % 3001 == 0) {
+            atomic_store(&s_tags_reset_pending, true);
+        }
+        if ((seq & 1023) == 0) {
+            sched_yield();      /* Let the cursors keep up some of the time */
+        }
+    }
+    return NULL;
+}
+
+static void *random_reader(void *arg)
+{
+    unsigned rng = (unsigned)(uintptr_t)arg * 2654435761u;
+    char buf[FT_LOG_LINE_MAX_LEN + FT_LOG_TAG_MAX_LEN + 24];
+    while (!atomic_load(&s_done)) {
+        uint32_t first = log_ring_first_seq(&s_ring);
+        uint32_t next = log_ring_next_seq(&s_ring);
+        rng = rng * 1103515245u + 12345u;
+        /* Mostly held lines, some just evicted or not written yet */
+        uint32_t seq = first - 4 + (rng >> 8) % (next - first + 8);
+        log_span_t span;
+        switch (log_ring_read(&s_ring, seq, buf, sizeof(buf), &span)) {
+        case LOG_RING_READ_OK:
+            check_line(seq, &span);
+            atomic_fetch_add_explicit(&s_read_ok, 1, memory_order_relaxed);
+            break;
+        case LOG_RING_READ_OVERWRITTEN:
+            atomic_fetch_add_explicit(&s_read_gone, 1, memory_order_relaxed);
+            break;
+        case LOG_RING_READ_PENDING:
+            atomic_fetch_add_explicit(&s_read_pending, 1, memory_order_relaxed);
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void *cursor_reader(void *arg)
+{
+    (void)arg;
+    char buf[FT_LOG_LINE_MAX_LEN + FT_LOG_TAG_MAX_LEN + 24];
+    log_ring_cursor_t cursor;
+    log_ring_cursor_init(&s_ring, &cursor);
+    uint32_t start = cursor.seq;
+    unsigned long lines = 0;
+
+    while (!atomic_load(&s_done)) {
+        uint32_t expect = cursor.seq;
+        uint32_t lost = cursor.lost;
+        log_span_t span;
+        if (!log_ring_cursor_next(&s_ring, &cursor, buf, sizeof(buf), &span)) {
+            continue;
+        }
+        uint32_t seq = cursor.seq - 1;
+        if (seq != expect + (cursor.lost - lost)) {
+            fail("cursor skipped without counting", seq, &span);
+        }
+        check_line(seq, &span);
+        lines++;
+    }
+    if (cursor.seq - start != lines + cursor.lost) {
+        fprintf(stderr, "FAIL cursor accounting: %u advanced, %lu read + %u lost\n",
+                (unsigned)(cursor.seq - start), lines, (unsigned)cursor.lost);
+        atomic_fetch_add(&s_failures, 1);
+    }
+    atomic_fetch_add(&s_cursor_lines, lines);
+    atomic_fetch_add(&s_cursor_lost, cursor.lost);
+    return NULL;
+}
+
+static void *clearer(void *arg)
+{
+    (void)arg;
+    while (!atomic_load(&s_done)) {
+        struct timespec ts = { 0, 50 * 1000 * 1000 };
+        nanosleep(&ts, NULL);
+        log_ring_clear(&s_ring);
+        atomic_store(&s_tags_reset_pending, true);
+        atomic_fetch_add(&s_clears, 1);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 2;
+
+    tag_table_init();
+    log_ring_init(&s_ring, s_arena, sizeof(s_arena), s_slots, SLOT_COUNT);
+    atomic_store(&s_ring.head_seq, SEQ_START);
+    atomic_store(&s_ring.tail_seq, SEQ_START);
+
+    pthread_t threads[RANDOM_READERS + CURSOR_READERS + 2];
+    int n = 0;
+    pthread_create(&threads[n++], NULL, writer, NULL);
+    for (int i = 0; i < RANDOM_READERS; i++) {
+        pthread_create(&threads[n++], NULL, random_reader, (void *)(uintptr_t)(i + 1));
+    }
+    for (int i = 0; i < CURSOR_READERS; i++) {
+        pthread_create(&threads[n++], NULL, cursor_reader, NULL);
+    }
+    pthread_create(&threads[n++], NULL, clearer, NULL);
+
+    struct timespec ts = { seconds, 0 };
+    nanosleep(&ts, NULL);
+    atomic_store(&s_done, true);
+    for (int i = 0; i < n; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    uint32_t pushed_to = log_ring_next_seq(&s_ring);
+    printf("pushed %lu lines (seq wrapped: %s), %lu clears, %lu tag resets\n",
+           atomic_load(&s_pushed), pushed_to < SEQ_START ? "yes" : "no",
+           atomic_load(&s_clears), atomic_load(&s_tag_resets));
+    printf("random reads: %lu ok, %lu overwritten, %lu pending\n", atomic_load(&s_read_ok),
+           atomic_load(&s_read_gone), atomic_load(&s_read_pending));
+    printf("cursor reads: %lu lines, %lu lost to the writer\n", atomic_load(&s_cursor_lines),
+           atomic_load(&s_cursor_lost));
+
+    unsigned long failures = atomic_load(&s_failures);
+    if (atomic_load(&s_read_ok) == 0 || atomic_load(&s_cursor_lines) == 0) {
+        printf("FAIL: readers never got a line\n");
+        failures++;
+    }
+    printf("%s (%lu failures)\n", failures ? "FAILED" : "PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Build and run the host tests (from any directory): ./run.sh
+# Each test's own header has the same cc line for building it alone.
+set -e
+cd "$(dirname "$0")"
+CC="${CC:-cc}"
+CFLAGS="-O2 -Wall -pthread -Istubs -I../../main -I../../main/serial"
+SERIAL=../../main/serial
+OUT="${OUT:-build}"
+mkdir -p "$OUT"
+
+run() {
+    name=$1
+    shift
+    echo "== $name"
+    $CC $CFLAGS -o "$OUT/$name" "$@"
+    "./$OUT/$name"
+}
+
+run ring_stress ring_stress.c $SERIAL/log_ring.c $SERIAL/log_parser.c \
+    $SERIAL/tag_table.c $SERIAL/log_codec.c
+run framer_bench framer_bench.c $SERIAL/line_framer.c
+run parser_bench parser_bench.c $SERIAL/log_parser.c
+run parser_fuzz -g -fsanitize=address,undefined -fno-sanitize-recover=undefined \
+    parser_fuzz.c $SERIAL/log_parser.c
+run trigger_bench trigger_bench.c $SERIAL/log_trigger.c
+run codec_test -g -fsanitize=address,undefined -fno-sanitize-recover=undefined \
+    codec_test.c $SERIAL/log_codec.c
+run rfc2217_test -g -fsanitize=address,undefined -fno-sanitize-recover=undefined \
+    rfc2217_test.c ../../main/wifi/rfc2217.c
+run bridge_test -DHOST_RUN_TASKS bridge_test.c ../../main/wifi/serial_bridge.c \
+    ../../main/wifi/rfc2217.c
@@ -0,0 +1,14 @@
+/* Host stand-in for the ESP-IDF header: logging compiled but silent */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ESP_HOST_LOG(tag, fmt, ...) \
+    do { if (0) printf("%s: " fmt "\n", tag, ##__VA_ARGS__); } while (0)
+
+#define ESP_LOGE(tag, fmt, ...)  ESP_HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)  ESP_HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)  ESP_HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...)  ESP_HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...)  ESP_HOST_LOG(tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,13 @@
+/* Host stand-in for the FreeRTOS header, enough for the modules under test */
+#pragma once
+
+#include <stdint.h>
+
+typedef int      BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE          (1)
+#define pdFALSE         (0)
+#define pdPASS          (1)
+#define portMAX_DELAY   (0xffffffffu)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
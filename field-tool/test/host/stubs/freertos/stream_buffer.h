@@ -0,0 +1,91 @@
+/* Host stand-in for the FreeRTOS header: a byte ring on a pthread mutex
+ * and condition variable, one writer and one reader */
+#pragma once
+
+#include "FreeRTOS.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t  ready;
+    uint8_t        *buf;
+    size_t          size;
+    size_t          head;       /* Next byte to read */
+    size_t          count;
+} host_stream_t;
+
+typedef host_stream_t *StreamBufferHandle_t;
+
+static inline StreamBufferHandle_t xStreamBufferCreateWithCaps(size_t size, size_t trigger,
+                                                               uint32_t caps)
+{
+    (void)trigger; (void)caps;
+    host_stream_t *s = calloc(1, sizeof(*s));
+    if (s == NULL || (s->buf = malloc(size)) == NULL) {
+        free(s);
+        return NULL;
+    }
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->ready, NULL);
+    s->size = size;
+    return s;
+}
+
+/* Never blocks: what doesn't fit is not taken */
+static inline size_t xStreamBufferSendFromISR(StreamBufferHandle_t s, const void *data,
+                                              size_t len, BaseType_t *woken)
+{
+    (void)woken;
+    pthread_mutex_lock(&s->mutex);
+    size_t n = len < s->size - s->count ? len : s->size - s->count;
+    for (size_t i = 0; i < n; i++) {
+        s->buf[(s->head + s->count + i) % s->size] = ((const uint8_t *)data)[i];
+    }
+    s->count += n;
+    if (n > 0) {
+        pthread_cond_signal(&s->ready);
+    }
+    pthread_mutex_unlock(&s->mutex);
+    return n;
+}
+
+static inline size_t xStreamBufferReceive(StreamBufferHandle_t s, void *out, size_t len,
+                                          TickType_t wait)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += wait / 1000;
+    deadline.tv_nsec += (long)(wait % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&s->mutex);
+    while (s->count == 0 && wait > 0) {
+        if (wait == portMAX_DELAY) {
+            pthread_cond_wait(&s->ready, &s->mutex);
+        } else if (pthread_cond_timedwait(&s->ready, &s->mutex, &deadline) != 0) {
+            break;
+        }
+    }
+    size_t n = len < s->count ? len : s->count;
+    for (size_t i = 0; i < n; i++) {
+        ((uint8_t *)out)[i] = s->buf[(s->head + i) % s->size];
+    }
+    s->head = (s->head + n) % s->size;
+    s->count -= n;
+    pthread_mutex_unlock(&s->mutex);
+    return n;
+}
+
+static inline void xStreamBufferReset(StreamBufferHandle_t s)
+{
+    pthread_mutex_lock(&s->mutex);
+    s->head = 0;
+    s->count = 0;
+    pthread_mutex_unlock(&s->mutex);
+}
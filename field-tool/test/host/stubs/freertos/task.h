@@ -0,0 +1,80 @@
+/* Host stand-in for the FreeRTOS header: tasks are never started, unless
+ * the test is built with -DHOST_RUN_TASKS, which runs each on a detached
+ * pthread */
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#ifdef HOST_RUN_TASKS
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+    TaskFunction_t fn;
+    void          *arg;
+} host_task_t;
+
+static inline void *host_task_main(void *p)
+{
+    host_task_t task = *(host_task_t *)p;
+    free(p);
+    task.fn(task.arg);
+    return NULL;
+}
+
+static inline BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack,
+                                     void *arg, unsigned prio, TaskHandle_t *handle)
+{
+    (void)name; (void)stack; (void)prio;
+    host_task_t *task = malloc(sizeof(*task));
+    pthread_t thread;
+    if (task == NULL) {
+        return pdFALSE;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    if (pthread_create(&thread, NULL, host_task_main, task) != 0) {
+        free(task);
+        return pdFALSE;
+    }
+    pthread_detach(thread);
+    if (handle != NULL) {
+        *handle = NULL;
+    }
+    return pdPASS;
+}
+
+static inline void vTaskDelay(TickType_t ticks)
+{
+    usleep((useconds_t)ticks * 1000);
+}
+
+static inline void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;         /* Only ever the calling task */
+    pthread_exit(NULL);
+}
+
+#else
+
+static inline BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack,
+                                     void *arg, unsigned prio, TaskHandle_t *handle)
+{
+    (void)fn; (void)name; (void)stack; (void)arg; (void)prio;
+    if (handle != NULL) {
+        *handle = NULL;
+    }
+    return pdPASS;
+}
+
+static inline void vTaskDelay(TickType_t ticks)
+{
+    (void)ticks;
+}
+
+#endif
@@ -0,0 +1,14 @@
+/* Host stand-in for the lwIP header: the BSD sockets it mirrors */
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static inline char *inet_ntoa_r(struct in_addr addr, char *buf, int len)
+{
+    return (char *)inet_ntop(AF_INET, &addr, buf, (socklen_t)len);
+}
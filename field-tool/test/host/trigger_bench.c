@@ -0,0 +1,274 @@
+/*
+ * trigger_bench — check the trigger automaton against memmem(), then time
+ * it with a few hundred patterns
+ *
+ * Build and run on the host (from field-tool/test/host):
+ *   cc -O2 -Istubs -I../../main -I../../main/serial -o trigger_bench \
+ *      trigger_bench.c ../../main/serial/log_trigger.c
+ *   ./trigger_bench [patterns]
+ *
+ * The check loads the built-in crash patterns, patterns that are prefixes,
+ * suffixes and infixes of each other (so hits come through the suffix
+ * chain) and generated fault codes, then scans lines that hold none, one
+ * or several of them, at the start, the end, overlapping and repeated.
+ * Each pattern's count must equal the number of lines memmem() finds it
+ * in (a pattern counts once per line), and a reload must reset the
+ * counts.
+ *
+ * The benchmark scans the same kind of lines, with a hit in about one
+ * line in 500, against the crash patterns plus generated fault codes up
+ * to the given number of patterns (default 300), and compares one pass
+ * of the automaton with one memmem() per pattern. Exits non-zero if the
+ * check fails.
+ */
+
+#define _GNU_SOURCE
+#include "log_trigger.h"
+#include "serial_monitor.h"
+#include "sdcard/sdcard_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CHECK_LINES     (20000)
+#define BENCH_LINES     (200000)
+
+/* ── Stand-ins: the snapshot task never runs on the host ────────────── */
+
+bool sdcard_manager_is_mounted(void)
+{
+    return false;
+}
+
+esp_err_t sdcard_manager_ensure_dir(const char *path)
+{
+    (void)path;
+    return ESP_FAIL;
+}
+
+const log_ring_t *serial_monitor_get_ring(void)
+{
+    return NULL;
+}
+
+uint32_t log_ring_next_seq(const log_ring_t *ring)
+{
+    (void)ring;
+    return 0;
+}
+
+uint32_t serial_monitor_first_seq(void)
+{
+    return 0;
+}
+
+log_ring_read_t serial_monitor_read_line(uint32_t seq, char *buf, size_t buf_size,
+                                         log_span_t *span)
+{
+    (void)seq; (void)buf; (void)buf_size; (void)span;
+    return LOG_RING_READ_PENDING;
+}
+
+/* ── Patterns and lines ─────────────────────────────────────────────── */
+
+static unsigned s_rng = 1;
+
+static unsigned rnd(unsigned n)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (s_rng >> 8) % n;
+}
+
+static const char *const s_crash[] = {
+    "Guru Meditation", "abort()", "Brownout", "stack overflow", "assert failed", "rst:0x",
+};
+#define CRASH_COUNT  (sizeof(s_crash) / sizeof(s_crash[0]))
+
+/* Nested and overlapping, so hits come through the suffix chain */
+static const char *const s_nested[] = {
+    "abc", "bc", "c)", "abcabd", "cab", "bca", "aaaa", "aa", "E (", ": ",
+};
+#define NESTED_COUNT  (sizeof(s_nested) / sizeof(s_nested[0]))
+
+static char s_texts[FT_TRIGGER_MAX_PATTERNS][FT_TRIGGER_PATTERN_MAX_LEN];
+static log_trigger_pattern_t s_patterns[FT_TRIGGER_MAX_PATTERNS];
+
+/* The crash patterns, the nested ones if asked, then distinct generated
+ * fault codes */
+static uint16_t make_patterns(uint16_t count, bool nested)
+{
+    uint16_t fixed = 0;
+    for (uint16_t i = 0; i < CRASH_COUNT; i++) {
+        strcpy(s_texts[fixed++], s_crash[i]);
+    }
+    for (uint16_t i = 0; nested && i < NESTED_COUNT; i++) {
+        strcpy(s_texts[fixed++], s_nested[i]);
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        if (i >= fixed) {
+            snprintf(s_texts[i], sizeof(s_texts[i]), "FM_FAULT_%04u_%c%c", (unsigned)i,
+                     'A' + rnd(26), 'A' + rnd(26));
+        }
+        s_patterns[i].text = s_texts[i];
+        s_patterns[i].actions = (i % 3 == 0) ? LOG_TRIGGER_SNAPSHOT : 0;
+    }
+    return count;
+}
+
+/* An ESP-IDF-style line, now and then carrying patterns (and near misses) */
+static size_t make_line(char *out, uint32_t i, uint16_t n_patterns, bool busy)
+{
+    int n = sprintf(out, "%c (%u) wifi: sta rssi=%d ch=%u FM_FAULT_ near ", "IWE"[rnd(3)],
+                    (unsigned)i, -(int)rnd(90), 1 + rnd(13));
+    int inserts = busy ? rnd(4) : (rnd(500) == 0);
+    while (inserts-- > 0 && n < FT_LOG_LINE_MAX_LEN - 2 * FT_TRIGGER_PATTERN_MAX_LEN) {
+        const char *p = s_texts[rnd(n_patterns)];
+        size_t len = strlen(p);
+        if (rnd(4) == 0 && n > 0) {
+            n--;                        /* Overlap the previous byte */
+        }
+        if (rnd(4) == 0 && len > 1) {
+            len--;                      /* Near miss */
+        }
+        memcpy(out + n, p, len);
+        n += len;
+        if (rnd(2)) {
+            out[n++] = ' ';
+        }
+    }
+    return n;
+}
+
+/* ── Correctness ────────────────────────────────────────────────────── */
+
+static int check_counts(char (*lines)[FT_LOG_LINE_MAX_LEN], const size_t *lens,
+                        uint32_t n_lines, uint16_t n_patterns)
+{
+    int failures = 0;
+    uint32_t total = 0;
+    for (uint16_t p = 0; p < n_patterns; p++) {
+        uint32_t want = 0;
+        for (uint32_t i = 0; i < n_lines; i++) {
+            want += memmem(lines[i], lens[i], s_texts[p], strlen(s_texts[p])) != NULL;
+        }
+        total += want;
+        log_trigger_info_t info;
+        if (!log_trigger_get(p, &info) || strcmp(info.text, s_texts[p]) != 0) {
+            printf("FAIL pattern %u \"%s\" missing\n", (unsigned)p, s_texts[p]);
+            failures++;
+        } else if (info.count != want) {
+            if (failures++ < 10) {
+                printf("FAIL \"%s\": %lu hits, want %lu\n", s_texts[p],
+                       (unsigned long)info.count, (unsigned long)want);
+            }
+        }
+    }
+    if (log_trigger_total_hits() != total) {
+        printf("FAIL total hits %lu, want %lu\n", (unsigned long)log_trigger_total_hits(),
+               (unsigned long)total);
+        failures++;
+    }
+    return failures;
+}
+
+static int check_trigger(void)
+{
+    static char lines[CHECK_LINES][FT_LOG_LINE_MAX_LEN];
+    static size_t lens[CHECK_LINES];
+    int failures = 0;
+
+    uint16_t n_patterns = make_patterns(120, true);
+    if (log_trigger_set_patterns(s_patterns, n_patterns) != ESP_OK) {
+        printf("FAIL set_patterns\n");
+        return 1;
+    }
+    for (uint32_t i = 0; i < CHECK_LINES; i++) {
+        lens[i] = make_line(lines[i], i, n_patterns, true);
+    }
+
+    log_span_t span = { 0 };
+    for (uint32_t i = 0; i < CHECK_LINES; i++) {
+        span.raw = lines[i];
+        span.raw_len = lens[i];
+        log_trigger_process(&span, i);
+    }
+    if (log_trigger_pattern_count() != n_patterns) {
+        printf("FAIL %u patterns installed, want %u\n", log_trigger_pattern_count(), n_patterns);
+        failures++;
+    }
+    failures += check_counts(lines, lens, CHECK_LINES, n_patterns);
+
+    /* A reload starts the counts again */
+    log_trigger_set_patterns(s_patterns, n_patterns);
+    for (uint32_t i = 0; i < CHECK_LINES / 2; i++) {
+        span.raw = lines[i];
+        span.raw_len = lens[i];
+        log_trigger_process(&span, i);
+    }
+    failures += check_counts(lines, lens, CHECK_LINES / 2, n_patterns);
+    return failures;
+}
+
+/* ── Benchmark ──────────────────────────────────────────────────────── */
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void benchmark(uint16_t n_patterns)
+{
+    static char lines[BENCH_LINES][FT_LOG_LINE_MAX_LEN];
+    static size_t lens[BENCH_LINES];
+    size_t bytes = 0;
+
+    make_patterns(n_patterns, false);
+    log_trigger_set_patterns(s_patterns, n_patterns);
+    for (uint32_t i = 0; i < BENCH_LINES; i++) {
+        lens[i] = make_line(lines[i], i, n_patterns, false);
+        bytes += lens[i];
+    }
+
+    log_span_t span = { 0 };
+    double t0 = now_s();
+    for (uint32_t i = 0; i < BENCH_LINES; i++) {
+        span.raw = lines[i];
+        span.raw_len = lens[i];
+        log_trigger_process(&span, i);
+    }
+    double t1 = now_s();
+    unsigned long naive = 0;
+    for (uint32_t i = 0; i < BENCH_LINES; i++) {
+        for (uint16_t p = 0; p < n_patterns; p++) {
+            naive += memmem(lines[i], lens[i], s_texts[p], strlen(s_texts[p])) != NULL;
+        }
+    }
+    double t2 = now_s();
+
+    printf("%u patterns, %u lines (%.1f MB), %lu hits\n", (unsigned)n_patterns, BENCH_LINES,
+           bytes / 1e6, (unsigned long)log_trigger_total_hits());
+    printf("  memmem per pattern  %7.2f Mlines/s\n", BENCH_LINES / (t2 - t1) / 1e6);
+    printf("  automaton           %7.2f Mlines/s (%.0f MB/s)\n", BENCH_LINES / (t1 - t0) / 1e6,
+           bytes / (t1 - t0) / 1e6);
+    if (naive != log_trigger_total_hits()) {
+        printf("  (hit counts differ: %lu by memmem)\n", naive);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int n_patterns = argc > 1 ? atoi(argv[1]) : 300;
+    if (n_patterns < (int)CRASH_COUNT || n_patterns > FT_TRIGGER_MAX_PATTERNS) {
+        fprintf(stderr, "patterns: %u..%u\n", (unsigned)CRASH_COUNT, FT_TRIGGER_MAX_PATTERNS);
+        return 2;
+    }
+
+    log_trigger_init();
+    int failures = check_trigger();
+    printf("trigger check: %s (%d failures)\n", failures ? "FAILED" : "PASSED", failures);
+    benchmark((uint16_t)n_patterns);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * ftlog_decode — turn a binary Field Tool log (.ftl) back into ESP-IDF text
+ *
+ * Build on the host:
+ *   cc -O2 -I../main/serial -o ftlog_decode ftlog_decode.c ../main/serial/log_codec.c
+ *
+ * Usage:
+ *   ftlog_decode [-l line] [-t ms] [-s] log_123.ftl [out.txt]
+ *     -l line  start at this 0-based line number
+ *     -t ms    start at the first line stamped at or after this target time
+ *     -s       print per-file statistics to stderr
+ *
+ * Both seeks skip whole blocks by their headers without decompressing
+ * them. Blocks that fail their CRC (a torn write at power loss, a bad
+ * sector) are reported on stderr and skipped by scanning for the next
+ * block magic.
+ */
+
+#include "log_codec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_BYTES  (4096)
+
+typedef struct {
+    unsigned long blocks;
+    unsigned long stored;       /* Blocks kept uncompressed */
+    unsigned long corrupt;      /* Bad CRC or undecodable */
+    unsigned long skipped;      /* Skipped by -l / -t */
+    unsigned long lines;
+    unsigned long long file_bytes;
+    unsigned long long raw_bytes;
+    unsigned long long text_bytes;
+} decode_stats_t;
+
+static uint8_t *read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(size > 0 ? size : 1);
+    if (data == NULL || fread(data, 1, size, f) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", path);
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *len = size;
+    return data;
+}
+
+/* Offset of the next block magic after @p from, or @p len */
+static size_t resync(const uint8_t *data, size_t len, size_t from)
+{
+    uint32_t magic = LOG_CODEC_BLOCK_MAGIC;
+    for (size_t i = from + 1; i + sizeof(magic) <= len; i++) {
+        if (memcmp(data + i, &magic, sizeof(magic)) == 0) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: ftlog_decode [-l line] [-t ms] [-s] file.ftl [out.txt]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long from_line = 0;
+    unsigned long from_ms = 0;
+    int seek_time = 0;
+    int show_stats = 0;
+    const char *in_path = NULL;
+    const char *out_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            from_line = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            from_ms = strtoul(argv[++i], NULL, 10);
+            seek_time = 1;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            show_stats = 1;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage();
+        } else if (in_path == NULL) {
+            in_path = argv[i];
+        } else if (out_path == NULL) {
+            out_path = argv[i];
+        } else {
+            usage();
+        }
+    }
+    if (in_path == NULL) {
+        usage();
+    }
+
+    size_t len;
+    uint8_t *data = read_file(in_path, &len);
+    if (data == NULL) {
+        return 1;
+    }
+    log_codec_file_header_t fh;
+    if (len < sizeof(fh) || memcmp(data, LOG_CODEC_FILE_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not a Field Tool binary log\n", in_path);
+        return 1;
+    }
+    memcpy(&fh, data, sizeof(fh));
+    if (fh.version != LOG_CODEC_VERSION) {
+        fprintf(stderr, "%s: unsupported version %u\n", in_path, fh.version);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (out_path != NULL && (out = fopen(out_path, "w")) == NULL) {
+        perror(out_path);
+        return 1;
+    }
+
+    static uint8_t raw[LOG_CODEC_MAX_RAW];
+    static char line[LINE_MAX_BYTES];
+    decode_stats_t st = { .file_bytes = len };
+    int started = !seek_time;
+    size_t pos = sizeof(fh);
+
+    while (pos < len) {
+        log_codec_block_header_t hdr;
+        long size = log_codec_check_block(data + pos, len - pos, &hdr);
+        if (size == 0) {
+            fprintf(stderr, "offset %zu: truncated block (%zu bytes), stopping\n", pos, len - pos);
+            st.corrupt++;
+            break;
+        }
+        if (size < 0) {
+            size_t next = resync(data, len, pos);
+            fprintf(stderr, "offset %zu: bad block, skipped %zu bytes\n", pos, next - pos);
+            st.corrupt++;
+            pos = next;
+            continue;
+        }
+        st.blocks++;
+        if (hdr.flags & LOG_CODEC_BLOCK_STORED) {
+            st.stored++;
+        }
+
+        /* Seek by block header alone */
+        int skip = hdr.first_line + hdr.lines <= from_line;
+        if (!started && (hdr.lines == 0 || hdr.max_ts_ms < from_ms)) {
+            skip = 1;
+        }
+        if (skip && !show_stats) {
+            st.skipped++;
+            pos += size;
+            continue;
+        }
+
+        if (!log_codec_unpack_block(data + pos, &hdr, raw)) {
+            fprintf(stderr, "offset %zu: block does not decompress, skipped\n", pos);
+            st.corrupt++;
+            pos += size;
+            continue;
+        }
+        st.raw_bytes += hdr.raw_len;
+
+        log_codec_decoder_t dec;
+        log_codec_decoder_init(&dec, raw, hdr.raw_len);
+        log_codec_decoded_t d;
+        unsigned long n = hdr.first_line;
+        while (log_codec_decode_line(&dec, line, sizeof(line), &d)) {
+            st.lines++;
+            st.text_bytes += d.len + 1;
+            if (!started && d.has_ts && d.timestamp_ms >= from_ms) {
+                started = 1;
+            }
+            if (!skip && started && n >= from_line) {
+                fwrite(line, 1, d.len, out);
+                fputc('\n', out);
+            }
+            n++;
+        }
+        if (dec.p != dec.end) {
+            fprintf(stderr, "offset %zu: malformed record after line %lu\n", pos, n);
+            st.corrupt++;
+        }
+        if (skip) {
+            st.skipped++;
+        }
+        pos += size;
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    if (show_stats) {
+        fprintf(stderr, "%lu blocks (%lu stored, %lu bad), %lu lines\n",
+                st.blocks, st.stored, st.corrupt, st.lines);
+        fprintf(stderr, "file %llu bytes, records %llu bytes, text %llu bytes (%.2fx)\n",
+                st.file_bytes, st.raw_bytes, st.text_bytes,
+                st.file_bytes ? (double)st.text_bytes / st.file_bytes : 0.0);
+    }
+    free(data);
+    return st.corrupt ? 1 : 0;
+}